@@ -0,0 +1,170 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include "cache/admission_cache.h"
+
+#include <inttypes.h>
+
+#include <algorithm>
+
+#include "rocksdb/terark_namespace.h"
+#include "util/xxhash.h"
+
+namespace TERARKDB_NAMESPACE {
+
+namespace {
+inline uint64_t SketchHash(const Slice& key) {
+  return XXH64(key.data(), key.size(), 0);
+}
+}  // namespace
+
+FrequencySketch::FrequencySketch(size_t width) : samples_(0) {
+  size_t w = 64;
+  while (w < width) {
+    w <<= 1;
+  }
+  mask_ = w - 1;
+  sample_size_ = 10 * w;
+  table_.reset(new std::atomic<uint8_t>[kDepth * w]);
+  for (size_t i = 0; i < kDepth * w; ++i) {
+    table_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+size_t FrequencySketch::Index(uint64_t hash, int row) const {
+  // double hashing, h2 is odd so the rows don't collide on the same slot
+  uint64_t h1 = hash;
+  uint64_t h2 = (hash >> 32) | 1;
+  return row * (mask_ + 1) + ((h1 + row * h2) & mask_);
+}
+
+uint32_t FrequencySketch::Increment(uint64_t hash) {
+  uint32_t estimate = kMaxCount;
+  for (int row = 0; row < kDepth; ++row) {
+    auto& counter = table_[Index(hash, row)];
+    uint8_t count = counter.load(std::memory_order_relaxed);
+    if (count < kMaxCount) {
+      // lost updates under contention only make the estimate a bit lower
+      counter.store(++count, std::memory_order_relaxed);
+    }
+    estimate = std::min<uint32_t>(estimate, count);
+  }
+  if (samples_.fetch_add(1, std::memory_order_relaxed) + 1 == sample_size_) {
+    Age();
+  }
+  return estimate;
+}
+
+uint32_t FrequencySketch::Estimate(uint64_t hash) const {
+  uint32_t estimate = kMaxCount;
+  for (int row = 0; row < kDepth; ++row) {
+    estimate = std::min<uint32_t>(
+        estimate, table_[Index(hash, row)].load(std::memory_order_relaxed));
+  }
+  return estimate;
+}
+
+void FrequencySketch::Age() {
+  // only the thread reaching sample_size_ gets here
+  size_t size = kDepth * (mask_ + 1);
+  for (size_t i = 0; i < size; ++i) {
+    table_[i].store(table_[i].load(std::memory_order_relaxed) >> 1,
+                    std::memory_order_relaxed);
+  }
+  samples_.store(0, std::memory_order_relaxed);
+}
+
+AdmissionCache::AdmissionCache(std::shared_ptr<Cache> cache,
+                               const AdmissionCacheOptions& options)
+    // share the allocator of the wrapped cache, readers allocate the blocks
+    // through the cache they see
+    : Cache(std::shared_ptr<MemoryAllocator>(cache,
+                                             cache->memory_allocator())),
+      cache_(std::move(cache)),
+      options_(options),
+      sketch_(options.sketch_width != 0
+                  ? options.sketch_width
+                  : std::max<size_t>(cache_->GetCapacity() / 4096, 1024)),
+      rejects_(0) {}
+
+bool AdmissionCache::Admit(const Slice& key, size_t charge, Priority priority,
+                           CacheAdmission admission) const {
+  if (admission == CacheAdmission::kAdmitAlways || priority == Priority::HIGH) {
+    return true;
+  }
+  if (admission == CacheAdmission::kAdmitDefault &&
+      cache_->GetUsage() + charge <= cache_->GetCapacity()) {
+    return true;
+  }
+  return sketch_.Estimate(SketchHash(key)) >= options_.frequency_threshold;
+}
+
+Status AdmissionCache::Insert(const Slice& key, void* value, size_t charge,
+                              void (*deleter)(const Slice& key, void* value),
+                              Handle** handle, Priority priority) {
+  // Callers of the plain Insert() rely on getting a handle back, only entries
+  // they don't hold on to go through the admission policy
+  return InsertWithAdmission(key, value, charge, deleter, handle, priority,
+                             handle != nullptr ? CacheAdmission::kAdmitAlways
+                                               : CacheAdmission::kAdmitDefault);
+}
+
+Status AdmissionCache::InsertWithAdmission(
+    const Slice& key, void* value, size_t charge,
+    void (*deleter)(const Slice& key, void* value), Handle** handle,
+    Priority priority, CacheAdmission admission) {
+  if (Admit(key, charge, priority, admission)) {
+    return cache_->Insert(key, value, charge, deleter, handle, priority);
+  }
+  rejects_.fetch_add(1, std::memory_order_relaxed);
+  if (handle == nullptr) {
+    // as if it was inserted and evicted at once
+    if (deleter != nullptr) {
+      (*deleter)(key, value);
+    }
+  } else {
+    // The entry never reaches the wrapped cache, inserting it would evict
+    // other entries to make room. The caller keeps owning the value, as for
+    // a read with fill_cache == false.
+    *handle = nullptr;
+  }
+  return Status::OK();
+}
+
+Cache::Handle* AdmissionCache::Lookup(const Slice& key, Statistics* stats) {
+  sketch_.Increment(SketchHash(key));
+  return cache_->Lookup(key, stats);
+}
+
+std::string AdmissionCache::GetPrintableOptions() const {
+  std::string ret;
+  const int kBufferSize = 200;
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize, "    admission_sketch_width : %zd\n",
+           sketch_.width());
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    admission_frequency_threshold : %u\n",
+           options_.frequency_threshold);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    admission_rejects : %" PRIu64 "\n",
+           GetRejectCount());
+  ret.append(buffer);
+  ret.append(cache_->GetPrintableOptions());
+  return ret;
+}
+
+std::shared_ptr<Cache> NewAdmissionCache(std::shared_ptr<Cache> cache,
+                                         const AdmissionCacheOptions& options) {
+  if (cache == nullptr) {
+    return nullptr;
+  }
+  return std::make_shared<AdmissionCache>(std::move(cache), options);
+}
+
+}  // namespace TERARKDB_NAMESPACE
@@ -0,0 +1,113 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/terark_namespace.h"
+
+namespace TERARKDB_NAMESPACE {
+
+// Count-min sketch of access frequencies with 4 bit saturating counters.
+// All counters are halved every 10 * width samples so the estimate follows
+// the recent workload, as in TinyLFU.
+class FrequencySketch {
+ public:
+  explicit FrequencySketch(size_t width);
+
+  // Records an access and returns the updated frequency estimate
+  uint32_t Increment(uint64_t hash);
+  uint32_t Estimate(uint64_t hash) const;
+
+  size_t width() const { return mask_ + 1; }
+
+ private:
+  static const int kDepth = 4;
+  static const uint8_t kMaxCount = 15;
+
+  size_t Index(uint64_t hash, int row) const;
+  void Age();
+
+  size_t mask_;
+  size_t sample_size_;
+  std::atomic<size_t> samples_;
+  std::unique_ptr<std::atomic<uint8_t>[]> table_;
+};
+
+// Cache wrapper deciding which inserts reach the wrapped cache, see
+// NewAdmissionCache
+class AdmissionCache : public Cache {
+ public:
+  AdmissionCache(std::shared_ptr<Cache> cache,
+                 const AdmissionCacheOptions& options);
+
+  const char* Name() const override { return "AdmissionCache"; }
+
+  Status Insert(const Slice& key, void* value, size_t charge,
+                void (*deleter)(const Slice& key, void* value),
+                Handle** handle, Priority priority) override;
+  Status InsertWithAdmission(const Slice& key, void* value, size_t charge,
+                             void (*deleter)(const Slice& key, void* value),
+                             Handle** handle, Priority priority,
+                             CacheAdmission admission) override;
+  Handle* Lookup(const Slice& key, Statistics* stats) override;
+  bool Ref(Handle* handle) override { return cache_->Ref(handle); }
+  bool Release(Handle* handle, bool force_erase = false) override {
+    return cache_->Release(handle, force_erase);
+  }
+  void* Value(Handle* handle) override { return cache_->Value(handle); }
+  void Erase(const Slice& key) override { cache_->Erase(key); }
+  uint64_t NewId() override { return cache_->NewId(); }
+  void SetCapacity(size_t capacity) override { cache_->SetCapacity(capacity); }
+  void SetStrictCapacityLimit(bool strict_capacity_limit) override {
+    cache_->SetStrictCapacityLimit(strict_capacity_limit);
+  }
+  bool HasStrictCapacityLimit() const override {
+    return cache_->HasStrictCapacityLimit();
+  }
+  size_t GetCapacity() const override { return cache_->GetCapacity(); }
+  size_t GetUsage() const override { return cache_->GetUsage(); }
+  size_t GetUsage(Handle* handle) const override {
+    return cache_->GetUsage(handle);
+  }
+  size_t GetPinnedUsage() const override { return cache_->GetPinnedUsage(); }
+  void DisownData() override { cache_->DisownData(); }
+  void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
+                              bool thread_safe) override {
+    cache_->ApplyToAllCacheEntries(callback, thread_safe);
+  }
+  void EraseUnRefEntries() override { cache_->EraseUnRefEntries(); }
+  std::string GetPrintableOptions() const override;
+  void RecordHotKey(const Slice& key, uint64_t file_number,
+                    const char* block_type) override {
+    cache_->RecordHotKey(key, file_number, block_type);
+  }
+  void GetHotKeys(std::vector<CacheHotKey>* hot_keys) const override {
+    cache_->GetHotKeys(hot_keys);
+  }
+  void TEST_mark_as_data_block(const Slice& key, size_t charge) override {
+    cache_->TEST_mark_as_data_block(key, charge);
+  }
+
+  // Inserts dropped by the admission policy
+  uint64_t GetRejectCount() const {
+    return rejects_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  bool Admit(const Slice& key, size_t charge, Priority priority,
+             CacheAdmission admission) const;
+
+  std::shared_ptr<Cache> cache_;
+  AdmissionCacheOptions options_;
+  FrequencySketch sketch_;
+  std::atomic<uint64_t> rejects_;
+};
+
+}  // namespace TERARKDB_NAMESPACE
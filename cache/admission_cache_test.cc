@@ -0,0 +1,178 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/admission_cache.h"
+
+#include <algorithm>
+#include <string>
+
+#include "rocksdb/terark_namespace.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+
+namespace TERARKDB_NAMESPACE {
+
+namespace {
+int deleted = 0;
+void Deleter(const Slice& /*key*/, void* /*value*/) { ++deleted; }
+}  // namespace
+
+class AdmissionCacheTest : public testing::Test {
+ public:
+  AdmissionCacheTest() {
+    deleted = 0;
+    // one shard so the capacity check sees the whole cache
+    cache_ = NewAdmissionCache(NewLRUCache(10, 0));
+  }
+
+  AdmissionCache* admission() {
+    return static_cast<AdmissionCache*>(cache_.get());
+  }
+
+  bool Contains(const std::string& key) {
+    Cache::Handle* h = cache_->Lookup(key);
+    if (h == nullptr) {
+      return false;
+    }
+    cache_->Release(h);
+    return true;
+  }
+
+  std::shared_ptr<Cache> cache_;
+};
+
+TEST_F(AdmissionCacheTest, FrequencySketch) {
+  FrequencySketch sketch(1024);
+  ASSERT_EQ(1024U, sketch.width());
+  ASSERT_EQ(0U, sketch.Estimate(42));
+  for (uint32_t i = 1; i <= 20; ++i) {
+    ASSERT_EQ(std::min(i, 15U), sketch.Increment(42));
+  }
+  ASSERT_EQ(15U, sketch.Estimate(42));
+  // aging halves the counters after 10 * width samples
+  for (uint64_t i = 0; i < 10 * 1024; ++i) {
+    sketch.Increment(1000000 + i);
+  }
+  ASSERT_LT(sketch.Estimate(42), 15U);
+}
+
+TEST_F(AdmissionCacheTest, AdmitWhileNotFull) {
+  ASSERT_OK(cache_->Insert("a", nullptr, 5, &Deleter));
+  ASSERT_OK(cache_->Insert("b", nullptr, 5, &Deleter));
+  ASSERT_TRUE(Contains("a"));
+  ASSERT_TRUE(Contains("b"));
+  ASSERT_EQ(0U, admission()->GetRejectCount());
+}
+
+TEST_F(AdmissionCacheTest, RejectColdKeysWhenFull) {
+  ASSERT_OK(cache_->Insert("a", nullptr, 5, &Deleter));
+  ASSERT_OK(cache_->Insert("b", nullptr, 5, &Deleter));
+
+  // a one-hit wonder doesn't evict anything
+  ASSERT_OK(cache_->Insert("c", nullptr, 5, &Deleter));
+  ASSERT_EQ(1U, admission()->GetRejectCount());
+  ASSERT_EQ(1, deleted);
+  ASSERT_TRUE(Contains("a"));
+  ASSERT_TRUE(Contains("b"));
+
+  // misses count as accesses, the second one makes "c" frequent
+  ASSERT_FALSE(Contains("c"));
+  ASSERT_FALSE(Contains("c"));
+  ASSERT_OK(cache_->Insert("c", nullptr, 5, &Deleter));
+  ASSERT_TRUE(Contains("c"));
+  ASSERT_EQ(1U, admission()->GetRejectCount());
+}
+
+TEST_F(AdmissionCacheTest, AdmissionHint) {
+  ASSERT_OK(cache_->Insert("a", nullptr, 10, &Deleter));
+
+  ASSERT_OK(cache_->InsertWithAdmission("b", nullptr, 5, &Deleter, nullptr,
+                                        Cache::Priority::LOW,
+                                        CacheAdmission::kAdmitAlways));
+  ASSERT_TRUE(Contains("b"));
+
+  // kAdmitIfFrequent ignores the free space
+  ASSERT_OK(cache_->InsertWithAdmission("d", nullptr, 0, &Deleter, nullptr,
+                                        Cache::Priority::LOW,
+                                        CacheAdmission::kAdmitIfFrequent));
+  ASSERT_EQ(1U, admission()->GetRejectCount());
+
+  // high priority entries are always admitted
+  ASSERT_OK(cache_->Insert("e", nullptr, 5, &Deleter, nullptr,
+                           Cache::Priority::HIGH));
+  ASSERT_TRUE(Contains("e"));
+}
+
+TEST_F(AdmissionCacheTest, RejectedEntryLeftToCaller) {
+  ASSERT_OK(cache_->Insert("a", nullptr, 5, &Deleter));
+  ASSERT_OK(cache_->Insert("b", nullptr, 5, &Deleter));
+
+  int value = 1;
+  // any stale value of the handle is overwritten
+  Cache::Handle* h = reinterpret_cast<Cache::Handle*>(&value);
+  ASSERT_OK(cache_->InsertWithAdmission("c", &value, 5, &Deleter, &h,
+                                        Cache::Priority::LOW,
+                                        CacheAdmission::kAdmitDefault));
+  ASSERT_EQ(1U, admission()->GetRejectCount());
+  // not inserted, the caller still owns the value
+  ASSERT_TRUE(h == nullptr);
+  ASSERT_EQ(0, deleted);
+  ASSERT_FALSE(Contains("c"));
+  ASSERT_TRUE(Contains("a"));
+  ASSERT_TRUE(Contains("b"));
+
+  // plain Insert() callers need the handle, they are always admitted
+  ASSERT_OK(cache_->Insert("d", &value, 5, &Deleter, &h));
+  ASSERT_TRUE(h != nullptr);
+  ASSERT_EQ(&value, cache_->Value(h));
+  cache_->Release(h);
+  ASSERT_EQ(1U, admission()->GetRejectCount());
+}
+
+TEST_F(AdmissionCacheTest, ScanKeepsHotEntries) {
+  AdmissionCacheOptions options;
+  // wide enough that the scanned keys don't collide into frequent ones
+  options.sketch_width = 64 << 10;
+  cache_ = NewAdmissionCache(NewLRUCache(100, 0), options);
+  const int kHot = 10;
+  for (int i = 0; i < kHot; ++i) {
+    ASSERT_OK(cache_->Insert("hot" + ToString(i), nullptr, 10, &Deleter));
+  }
+  // the hot entries are read again and again
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < kHot; ++i) {
+      ASSERT_TRUE(Contains("hot" + ToString(i)));
+    }
+  }
+
+  // A scan reads each block once: a lookup misses, then the block is
+  // inserted with a handle, as BlockBasedTable does
+  const int kScan = 1000;
+  int value = 1;
+  for (int i = 0; i < kScan; ++i) {
+    std::string key = "scan" + ToString(i);
+    ASSERT_FALSE(Contains(key));
+    Cache::Handle* h = nullptr;
+    ASSERT_OK(cache_->InsertWithAdmission(key, &value, 10, &Deleter, &h,
+                                          Cache::Priority::LOW,
+                                          CacheAdmission::kAdmitDefault));
+    if (h != nullptr) {
+      cache_->Release(h);
+    }
+  }
+  ASSERT_EQ(static_cast<uint64_t>(kScan), admission()->GetRejectCount());
+  ASSERT_EQ(0, deleted);
+  for (int i = 0; i < kHot; ++i) {
+    ASSERT_TRUE(Contains("hot" + ToString(i)));
+  }
+  ASSERT_EQ(100U, cache_->GetUsage());
+}
+
+}  // namespace TERARKDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
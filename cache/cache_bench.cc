@@ -47,7 +47,9 @@ DEFINE_int32(lookup_percent, 50,
 DEFINE_int32(erase_percent, 10,
              "Ratio of erase to total workload (expressed as a percentage)");
 
-DEFINE_bool(use_clock_cache, false, "");
+DEFINE_bool(use_clock_cache, false, "Same as --cache_type=clock");
+DEFINE_string(cache_type, "lru",
+              "Cache to benchmark: lru, clock (lock free lookup) or lirs");
 
 namespace TERARKDB_NAMESPACE {
 
@@ -114,14 +116,19 @@ struct ThreadState {
 class CacheBench {
  public:
   CacheBench() : num_threads_(FLAGS_threads) {
-    if (FLAGS_use_clock_cache) {
+    if (FLAGS_use_clock_cache || FLAGS_cache_type == "clock") {
       cache_ = NewClockCache(FLAGS_cache_size, FLAGS_num_shard_bits);
       if (!cache_) {
         fprintf(stderr, "Clock cache not supported.\n");
         exit(1);
       }
-    } else {
+    } else if (FLAGS_cache_type == "lirs") {
+      cache_ = NewLIRSCache(FLAGS_cache_size, FLAGS_num_shard_bits);
+    } else if (FLAGS_cache_type == "lru") {
       cache_ = NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits);
+    } else {
+      fprintf(stderr, "Unknown cache type %s.\n", FLAGS_cache_type.c_str());
+      exit(1);
     }
   }
 
@@ -232,6 +239,7 @@ class CacheBench {
     printf("RocksDB version     : %d.%d\n", kMajorVersion, kMinorVersion);
     printf("Number of threads   : %d\n", FLAGS_threads);
     printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
+    printf("Cache type          : %s\n", cache_->Name());
     printf("Cache size          : %" PRIu64 "\n", FLAGS_cache_size);
     printf("Num shard bits      : %d\n", FLAGS_num_shard_bits);
     printf("Max key             : %" PRIu64 "\n", FLAGS_max_key);
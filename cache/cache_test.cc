@@ -379,6 +379,32 @@ TEST_P(CacheTest, EvictionPolicyRef) {
   cache_->Release(h204);
 }
 
+TEST_P(CacheTest, HotKeys) {
+  std::vector<CacheHotKey> hot_keys;
+  cache_->GetHotKeys(&hot_keys);
+  ASSERT_TRUE(hot_keys.empty());
+
+  // One hot key among many more distinct cold keys than the sketch tracks
+  for (int i = 0; i < 100000; i++) {
+    if (i % 4 == 0) {
+      cache_->RecordHotKey(EncodeKey(-1), 7, "data");
+    } else {
+      cache_->RecordHotKey(EncodeKey(i), 8, "index");
+    }
+  }
+  cache_->GetHotKeys(&hot_keys);
+  ASSERT_FALSE(hot_keys.empty());
+  ASSERT_EQ(EncodeKey(-1), hot_keys[0].key);
+  ASSERT_EQ(7U, hot_keys[0].file_number);
+  ASSERT_STREQ("data", hot_keys[0].block_type);
+  // accesses are sampled
+  ASSERT_GE(hot_keys[0].count, 20000U);
+  ASSERT_LE(hot_keys[0].count - hot_keys[0].error, 30000U);
+  for (size_t i = 1; i < hot_keys.size(); i++) {
+    ASSERT_LE(hot_keys[i].count, hot_keys[i - 1].count);
+  }
+}
+
 TEST_P(CacheTest, EvictEmptyCache) {
   // Insert item large than capacity to trigger eviction on empty cache.
   auto cache = NewCache(1, 0, false);
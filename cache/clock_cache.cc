@@ -30,15 +30,11 @@ std::shared_ptr<Cache> NewClockCache(size_t /*capacity*/,
 
 #include <atomic>
 #include <deque>
+#include <memory>
+#include <vector>
 
-// "tbb/concurrent_hash_map.h" requires RTTI if exception is enabled.
-// Disable it so users can chooose to disable RTTI.
-#ifndef ROCKSDB_USE_RTTI
-#define TBB_USE_EXCEPTIONS 0
-#endif
 #include "cache/sharded_cache.h"
 #include "port/port.h"
-#include "tbb/concurrent_hash_map.h"
 #include "util/autovector.h"
 #include "util/mutexlock.h"
 
@@ -62,9 +58,9 @@ namespace {
 // to be re-use. This is to avoid memory dealocation, which is hard to deal
 // with in concurrent environment.
 //
-// The cache also maintains a concurrent hash map for lookup. Any concurrent
-// hash map implementation should do the work. We currently use
-// tbb::concurrent_hash_map because it supports concurrent erase.
+// The cache also maintains a hash table for lookup (HandleTable below). It
+// is an open addressing table whose slots are atomics, so Lookup() reads it
+// without any lock, and it only has to support a single writer at a time.
 //
 // Each cache handle has the following flags and counters, which are squeeze
 // in an atomic interger, to make sure the handle always be in a consistent
@@ -142,8 +138,9 @@ namespace {
 // hold the mutex. Lookup() only access the hash map and the flags associated
 // with each handle, and don't require explicit locking. Release() has to
 // acquire the mutex only when it releases the last reference to the entry and
-// the entry has been erased from cache explicitly. A future improvement could
-// be to remove the mutex completely.
+// the entry has been erased from cache explicitly. So a hit costs one CAS on
+// the reference count and, for an entry not yet marked as used, one atomic or
+// on release, while LRUCache takes the shard mutex twice.
 //
 // Benchmark:
 // We run readrandom db_bench on a test DB of size 13GB, with size of each
@@ -207,25 +204,163 @@ struct CacheHandle {
   }
 };
 
-// Key of hash map. We store hash value with the key for convenience.
-struct CacheKey {
-  Slice key;
-  uint32_t hash_value;
+// Hash table from key to the cache handle, with linear probing.
+//
+// Readers (Lookup) never lock: they load the current slot array and the
+// slots with acquire semantics and may see a stale or half-moved table, so
+// a probe can return a handle for another key, or miss a key being moved by
+// a concurrent erase. The former is caught by the caller, which double
+// checks the key after taking a reference, and the latter is only a cache
+// miss. All modifications have to hold the shard mutex.
+//
+// Handles are never freed before the shard, so a reader can always
+// dereference what it loaded. Replaced slot arrays are kept until the table
+// is destroyed, as readers may still be probing them. The table only grows,
+// so they take at most as much memory as the current array.
+class HandleTable {
+ private:
+  struct Slot {
+    std::atomic<CacheHandle*> handle;
+    std::atomic<uint32_t> hash;
+  };
+
+  struct Array {
+    explicit Array(size_t size) : mask(size - 1), slots(new Slot[size]) {
+      for (size_t i = 0; i < size; ++i) {
+        slots[i].handle.store(nullptr, std::memory_order_relaxed);
+        slots[i].hash.store(0, std::memory_order_relaxed);
+      }
+    }
+    size_t mask;
+    std::unique_ptr<Slot[]> slots;
+  };
+
+ public:
+  // Iterates the handles whose hash matches, lock free.
+  class Probe {
+   public:
+    Probe(const HandleTable* table, uint32_t hash)
+        : array_(table->array_.load(std::memory_order_acquire)),
+          hash_(hash),
+          pos_(hash & array_->mask),
+          remaining_(array_->mask + 1) {}
+
+    CacheHandle* Next() {
+      for (; remaining_ > 0; --remaining_) {
+        Slot& slot = array_->slots[pos_];
+        pos_ = (pos_ + 1) & array_->mask;
+        CacheHandle* handle = slot.handle.load(std::memory_order_acquire);
+        if (handle == nullptr) {
+          break;
+        }
+        if (slot.hash.load(std::memory_order_relaxed) == hash_) {
+          --remaining_;
+          return handle;
+        }
+      }
+      remaining_ = 0;
+      return nullptr;
+    }
+
+   private:
+    const Array* array_;
+    uint32_t hash_;
+    size_t pos_;
+    size_t remaining_;
+  };
+
+  HandleTable() : array_(new Array(kInitSize)), size_(0) {}
 
-  CacheKey() = default;
+  ~HandleTable() { delete array_.load(std::memory_order_relaxed); }
 
-  CacheKey(const Slice& k, uint32_t h) {
-    key = k;
-    hash_value = h;
+  // The key must not be in the table.
+  void Insert(CacheHandle* handle) {
+    Array* array = array_.load(std::memory_order_relaxed);
+    if ((size_ + 1) * 2 > array->mask + 1) {
+      array = Grow(array);
+    }
+    Put(array, handle);
+    ++size_;
+  }
+
+  // Removes and returns the handle of the key, nullptr if it is not found.
+  CacheHandle* Remove(const Slice& key, uint32_t hash) {
+    Array* array = array_.load(std::memory_order_relaxed);
+    for (size_t i = hash & array->mask;; i = (i + 1) & array->mask) {
+      CacheHandle* handle =
+          array->slots[i].handle.load(std::memory_order_relaxed);
+      if (handle == nullptr) {
+        return nullptr;
+      }
+      if (handle->hash == hash && handle->key == key) {
+        RemoveAt(array, i);
+        return handle;
+      }
+    }
   }
 
-  static bool equal(const CacheKey& a, const CacheKey& b) {
-    return a.hash_value == b.hash_value && a.key == b.key;
+  void Clear() {
+    Array* array = array_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i <= array->mask; ++i) {
+      array->slots[i].handle.store(nullptr, std::memory_order_release);
+    }
+    size_ = 0;
   }
 
-  static size_t hash(const CacheKey& a) {
-    return static_cast<size_t>(a.hash_value);
+ private:
+  static const size_t kInitSize = 64;
+
+  static void Put(Array* array, CacheHandle* handle) {
+    size_t i = handle->hash & array->mask;
+    while (array->slots[i].handle.load(std::memory_order_relaxed) != nullptr) {
+      i = (i + 1) & array->mask;
+    }
+    // Publish the hash before the handle, readers load them reversely
+    array->slots[i].hash.store(handle->hash, std::memory_order_relaxed);
+    array->slots[i].handle.store(handle, std::memory_order_release);
+  }
+
+  Array* Grow(Array* array) {
+    Array* new_array = new Array((array->mask + 1) * 2);
+    for (size_t i = 0; i <= array->mask; ++i) {
+      CacheHandle* handle =
+          array->slots[i].handle.load(std::memory_order_relaxed);
+      if (handle != nullptr) {
+        Put(new_array, handle);
+      }
+    }
+    array_.store(new_array, std::memory_order_release);
+    retired_.emplace_back(array);
+    return new_array;
+  }
+
+  // Backward shift deletion, so no tombstone is needed and probes stop at
+  // the first empty slot.
+  void RemoveAt(Array* array, size_t i) {
+    size_t mask = array->mask;
+    for (size_t j = (i + 1) & mask;; j = (j + 1) & mask) {
+      CacheHandle* handle =
+          array->slots[j].handle.load(std::memory_order_relaxed);
+      if (handle == nullptr) {
+        break;
+      }
+      uint32_t hash = array->slots[j].hash.load(std::memory_order_relaxed);
+      size_t home = hash & mask;
+      // The entry stays if its home is cyclically in (i, j]
+      if (i <= j ? (i < home && home <= j) : (i < home || home <= j)) {
+        continue;
+      }
+      array->slots[i].hash.store(hash, std::memory_order_relaxed);
+      array->slots[i].handle.store(handle, std::memory_order_release);
+      i = j;
+    }
+    array->slots[i].handle.store(nullptr, std::memory_order_release);
+    --size_;
   }
+
+  std::atomic<Array*> array_;
+  size_t size_;
+  std::vector<std::unique_ptr<Array>> retired_;
 };
 
 struct CleanupContext {
@@ -239,9 +374,6 @@ struct CleanupContext {
 // A cache shard which maintains its own CLOCK cache.
 class ClockCacheShard : public CacheShard {
  public:
-  // Hash map type.
-  typedef tbb::concurrent_hash_map<CacheKey, CacheHandle*, CacheKey> HashTable;
-
   ClockCacheShard();
   ~ClockCacheShard();
 
@@ -359,8 +491,8 @@ class ClockCacheShard : public CacheShard {
   // Whether allow insert into cache if cache is full.
   std::atomic<bool> strict_capacity_limit_;
 
-  // Hash table (tbb::concurrent_hash_map) for lookup.
-  HashTable table_;
+  // Hash table for lookup.
+  HandleTable table_;
 };
 
 ClockCacheShard::ClockCacheShard()
@@ -450,17 +582,22 @@ bool ClockCacheShard::Ref(Cache::Handle* h) {
 
 bool ClockCacheShard::Unref(CacheHandle* handle, bool set_usage,
                             CleanupContext* context) {
-  if (set_usage) {
+  // Skip the atomic or if the bit is already set, so releases of a hot
+  // entry don't keep bouncing its cache line between readers.
+  if (set_usage &&
+      !HasUsage(handle->flags.load(std::memory_order_relaxed))) {
     handle->flags.fetch_or(kUsageBit, std::memory_order_relaxed);
   }
   // Use acquire-release semantics as previous operations on the cache entry
   // has to be order before reference count is decreased, and potential cleanup
-  // of the entry has to be order after.
+  // of the entry has to be order after. The charge is read before, once the
+  // reference is dropped the handle may be evicted and re-used.
+  size_t charge = handle->charge;
   uint32_t flags = handle->flags.fetch_sub(kOneRef, std::memory_order_acq_rel);
   assert(CountRefs(flags) > 0);
   if (CountRefs(flags) == 1) {
     // this is the last reference.
-    pinned_usage_.fetch_sub(handle->charge, std::memory_order_relaxed);
+    pinned_usage_.fetch_sub(charge, std::memory_order_relaxed);
     // Cleanup if it is the last reference.
     if (!InCache(flags)) {
       MutexLock l(&mutex_);
@@ -490,9 +627,9 @@ bool ClockCacheShard::TryEvict(CacheHandle* handle, CleanupContext* context) {
   uint32_t flags = kInCacheBit;
   if (handle->flags.compare_exchange_strong(flags, 0, std::memory_order_acquire,
                                             std::memory_order_relaxed)) {
-    bool erased __attribute__((__unused__)) =
-        table_.erase(CacheKey(handle->key, handle->hash));
-    assert(erased);
+    CacheHandle* erased __attribute__((__unused__)) =
+        table_.Remove(handle->key, handle->hash);
+    assert(erased == handle);
     RecycleHandle(handle, context);
     return true;
   }
@@ -572,14 +709,12 @@ CacheHandle* ClockCacheShard::Insert(
   handle->charge = charge;
   handle->deleter = deleter;
   uint32_t flags = hold_reference ? kInCacheBit + kOneRef : kInCacheBit;
-  handle->flags.store(flags, std::memory_order_relaxed);
-  HashTable::accessor accessor;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    CacheHandle* existing_handle = accessor->second;
-    table_.erase(accessor);
+  handle->flags.store(flags, std::memory_order_release);
+  CacheHandle* existing_handle = table_.Remove(key, hash);
+  if (existing_handle != nullptr) {
     UnsetInCache(existing_handle, context);
   }
-  table_.insert(HashTable::value_type(CacheKey(key, hash), handle));
+  table_.Insert(handle);
   if (hold_reference) {
     pinned_usage_.fetch_add(charge, std::memory_order_relaxed);
   }
@@ -593,7 +728,6 @@ Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                                Cache::Handle** out_handle,
                                Cache::Priority /*priority*/) {
   CleanupContext context;
-  HashTable::accessor accessor;
   char* key_data = new char[key.size()];
   memcpy(key_data, key.data(), key.size());
   Slice key_copy(key_data, key.size());
@@ -612,28 +746,26 @@ Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
 }
 
 Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash) {
-  HashTable::const_accessor accessor;
-  if (!table_.find(accessor, CacheKey(key, hash))) {
-    return nullptr;
-  }
-  CacheHandle* handle = accessor->second;
-  accessor.release();
-  // Ref() could fail if another thread sneak in and evict/erase the cache
-  // entry before we are able to hold reference.
-  if (!Ref(reinterpret_cast<Cache::Handle*>(handle))) {
-    return nullptr;
-  }
-  // Double check the key since the handle may now representing another key
-  // if other threads sneak in, evict/erase the entry and re-used the handle
-  // for another cache entry.
-  if (hash != handle->hash || key != handle->key) {
+  HandleTable::Probe probe(&table_, hash);
+  for (CacheHandle* handle = probe.Next(); handle != nullptr;
+       handle = probe.Next()) {
+    // Ref() could fail if another thread sneak in and evict/erase the cache
+    // entry before we are able to hold reference.
+    if (!Ref(reinterpret_cast<Cache::Handle*>(handle))) {
+      continue;
+    }
+    // Double check the key since the handle may be of another key with the
+    // same hash, or now representing another key if other threads sneak in,
+    // evict/erase the entry and re-used the handle for another cache entry.
+    if (hash == handle->hash && key == handle->key) {
+      return reinterpret_cast<Cache::Handle*>(handle);
+    }
     CleanupContext context;
     Unref(handle, false, &context);
     // It is possible Unref() delete the entry, so we need to cleanup.
     Cleanup(context);
-    return nullptr;
   }
-  return reinterpret_cast<Cache::Handle*>(handle);
+  return nullptr;
 }
 
 bool ClockCacheShard::Release(Cache::Handle* h, bool force_erase) {
@@ -656,11 +788,9 @@ void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
 bool ClockCacheShard::EraseAndConfirm(const Slice& key, uint32_t hash,
                                       CleanupContext* context) {
   MutexLock l(&mutex_);
-  HashTable::accessor accessor;
   bool erased = false;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    CacheHandle* handle = accessor->second;
-    table_.erase(accessor);
+  CacheHandle* handle = table_.Remove(key, hash);
+  if (handle != nullptr) {
     erased = UnsetInCache(handle, context);
   }
   return erased;
@@ -670,7 +800,7 @@ void ClockCacheShard::EraseUnRefEntries() {
   CleanupContext context;
   {
     MutexLock l(&mutex_);
-    table_.clear();
+    table_.Clear();
     for (auto& handle : list_) {
       UnsetInCache(&handle, &context);
     }
@@ -0,0 +1,56 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/hot_key_sketch.h"
+
+#include <mutex>
+
+#include "rocksdb/terark_namespace.h"
+
+namespace TERARKDB_NAMESPACE {
+
+void HotKeySketch::Record(const Slice& key, uint32_t hash,
+                          uint64_t file_number, const char* block_type) {
+  std::unique_lock<SpinMutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+  Entry* victim = nullptr;
+  for (auto& entry : entries_) {
+    if (entry.hash == hash && Slice(entry.key) == key) {
+      ++entry.count;
+      return;
+    }
+    if (victim == nullptr || entry.count < victim->count) {
+      victim = &entry;
+    }
+  }
+  if (entries_.size() < kCapacity) {
+    entries_.push_back(Entry{key.ToString(), hash, 1, 0, file_number,
+                             block_type});
+    return;
+  }
+  victim->key.assign(key.data(), key.size());
+  victim->hash = hash;
+  victim->error = victim->count;
+  ++victim->count;
+  victim->file_number = file_number;
+  victim->block_type = block_type;
+}
+
+void HotKeySketch::Dump(std::vector<CacheHotKey>* hot_keys) const {
+  std::lock_guard<SpinMutex> lock(mutex_);
+  for (auto& entry : entries_) {
+    hot_keys->emplace_back();
+    CacheHotKey& hot_key = hot_keys->back();
+    hot_key.key = entry.key;
+    hot_key.count = entry.count;
+    hot_key.error = entry.error;
+    hot_key.file_number = entry.file_number;
+    hot_key.block_type = entry.block_type;
+  }
+}
+
+}  // namespace TERARKDB_NAMESPACE
@@ -0,0 +1,50 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/terark_namespace.h"
+#include "util/mutexlock.h"
+
+namespace TERARKDB_NAMESPACE {
+
+// Space-saving heavy hitter sketch (Metwally et al.) of kCapacity counters.
+// A key not tracked yet replaces the key with the smallest count and
+// inherits that count as its error, so any key accessed more than
+// total / kCapacity times is guaranteed to be tracked.
+//
+// Record() gives up if another thread holds the sketch, so readers never
+// wait on it; under contention it just records fewer samples.
+class HotKeySketch {
+ public:
+  static const size_t kCapacity = 16;
+
+  HotKeySketch() { entries_.reserve(kCapacity); }
+
+  void Record(const Slice& key, uint32_t hash, uint64_t file_number,
+              const char* block_type);
+
+  // Appends the tracked keys to hot_keys
+  void Dump(std::vector<CacheHotKey>* hot_keys) const;
+
+ private:
+  struct Entry {
+    std::string key;
+    uint32_t hash;
+    uint64_t count;
+    uint64_t error;
+    uint64_t file_number;
+    const char* block_type;
+  };
+
+  mutable SpinMutex mutex_;
+  std::vector<Entry> entries_;
+};
+
+}  // namespace TERARKDB_NAMESPACE
@@ -13,10 +13,12 @@
 
 #include "cache/sharded_cache.h"
 
+#include <algorithm>
 #include <string>
 
 #include "rocksdb/terark_namespace.h"
 #include "util/mutexlock.h"
+#include "util/random.h"
 
 namespace TERARKDB_NAMESPACE {
 
@@ -27,7 +29,8 @@ ShardedCache::ShardedCache(size_t capacity, int num_shard_bits,
       num_shard_bits_(num_shard_bits),
       capacity_(capacity),
       strict_capacity_limit_(strict_capacity_limit),
-      last_id_(1) {}
+      last_id_(1),
+      hot_keys_(new HotKeySketch[1 << num_shard_bits]) {}
 
 void ShardedCache::SetCapacity(size_t capacity) {
   int num_shards = 1 << num_shard_bits_;
@@ -56,6 +59,32 @@ Status ShardedCache::Insert(const Slice& key, void* value, size_t charge,
       ->Insert(key, hash, value, charge, deleter, handle, priority);
 }
 
+void ShardedCache::RecordHotKey(const Slice& key, uint64_t file_number,
+                                const char* block_type) {
+  // Random sampling, a fixed stride could be in phase with the workload
+  if (!Random::GetTLSInstance()->OneIn(kHotKeySampleRate)) {
+    return;
+  }
+  uint32_t hash = HashSlice(key);
+  hot_keys_[Shard(hash)].Record(key, hash, file_number, block_type);
+}
+
+void ShardedCache::GetHotKeys(std::vector<CacheHotKey>* hot_keys) const {
+  hot_keys->clear();
+  int num_shards = 1 << num_shard_bits_;
+  for (int s = 0; s < num_shards; s++) {
+    hot_keys_[s].Dump(hot_keys);
+  }
+  for (auto& hot_key : *hot_keys) {
+    hot_key.count *= kHotKeySampleRate;
+    hot_key.error *= kHotKeySampleRate;
+  }
+  std::sort(hot_keys->begin(), hot_keys->end(),
+            [](const CacheHotKey& a, const CacheHotKey& b) {
+              return a.count > b.count;
+            });
+}
+
 Cache::Handle* ShardedCache::Lookup(const Slice& key, Statistics* /*stats*/) {
   uint32_t hash = HashSlice(key);
   return GetShard(Shard(hash))->Lookup(key, hash);
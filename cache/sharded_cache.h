@@ -10,8 +10,11 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "cache/hot_key_sketch.h"
 #include "port/port.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/terark_namespace.h"
@@ -79,6 +82,12 @@ class ShardedCache : public Cache {
                                       bool thread_safe) override;
   virtual void EraseUnRefEntries() override;
   virtual std::string GetPrintableOptions() const override;
+  virtual void RecordHotKey(const Slice& key, uint64_t file_number,
+                            const char* block_type) override;
+  virtual void GetHotKeys(std::vector<CacheHotKey>* hot_keys) const override;
+
+  // RecordHotKey() samples one in kHotKeySampleRate accesses
+  static const uint32_t kHotKeySampleRate = 16;
 
   int GetNumShardBits() const { return num_shard_bits_; }
 
@@ -97,6 +106,8 @@ class ShardedCache : public Cache {
   size_t capacity_;
   bool strict_capacity_limit_;
   std::atomic<uint64_t> last_id_;
+  // One heavy hitter sketch per shard, see RecordHotKey()
+  std::unique_ptr<HotKeySketch[]> hot_keys_;
 };
 
 extern int GetDefaultCacheShardBits(size_t capacity);
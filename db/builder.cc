@@ -21,6 +21,7 @@
 #include "db/range_del_aggregator.h"
 #include "db/table_cache.h"
 #include "db/version_edit.h"
+#include "monitoring/file_io_stats.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/thread_status_util.h"
 #include "rocksdb/env.h"
@@ -142,6 +143,7 @@ Status BuildTable(
       file_writer.reset(new WritableFileWriter(std::move(file), fname,
                                                env_options, ioptions.statistics,
                                                ioptions.listeners));
+      file_writer->set_io_file_type(kIOFileKeySst);
       builder = NewTableBuilder(
           ioptions, mutable_cf_options, internal_comparator,
           int_tbl_prop_collector_factories, column_family_id,
@@ -276,6 +278,7 @@ Status BuildTable(
         separate_helper.file_writer.reset(
             new WritableFileWriter(std::move(blob_file), fname, env_options,
                                    ioptions.statistics, ioptions.listeners));
+        separate_helper.file_writer->set_io_file_type(kIOFileBlobSst);
         separate_helper.builder.reset(NewTableBuilder(
             ioptions, mutable_cf_options, internal_comparator,
             int_tbl_prop_collector_factories_for_blob, column_family_id,
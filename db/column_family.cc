@@ -451,7 +451,11 @@ ColumnFamilyData::ColumnFamilyData(
   if (_dummy_versions != nullptr) {
     internal_stats_.reset(
         new InternalStats(ioptions_.num_levels, db_options.env, this));
-    table_cache_.reset(new TableCache(ioptions_, env_options, _table_cache));
+    MemoryGovernor* governor = write_buffer_manager != nullptr
+                                   ? write_buffer_manager->memory_governor()
+                                   : nullptr;
+    table_cache_.reset(
+        new TableCache(ioptions_, env_options, _table_cache, governor));
     if (ioptions_.compaction_style == kCompactionStyleLevel) {
       compaction_picker_.reset(new LevelCompactionPicker(
           table_cache_.get(), env_options, ioptions_, &internal_comparator_));
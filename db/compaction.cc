@@ -15,6 +15,7 @@
 
 #include <inttypes.h>
 
+#include <unordered_set>
 #include <vector>
 
 #include "db/column_family.h"
@@ -361,6 +362,42 @@ bool Compaction::KeyNotExistsBeyondOutputLevel(
   return false;
 }
 
+bool Compaction::InputsOlderThan(const Slice& begin, const Slice& end,
+                                 SequenceNumber seqno) const {
+  assert(input_vstorage_ != nullptr);
+  const Comparator* user_cmp = cfd_->user_comparator();
+  auto& dependence_map = input_vstorage_->dependence_map();
+  auto overlap = [&](const FileMetaData* f) {
+    return user_cmp->Compare(f->smallest.user_key(), end) < 0 &&
+           user_cmp->Compare(f->largest.user_key(), begin) >= 0;
+  };
+  // Files without point keys only hold range tombstones
+  auto older = [&](const FileMetaData* f) {
+    return f->prop.num_entries == 0 || f->fd.largest_seqno < seqno;
+  };
+  for (auto& level : inputs_) {
+    for (auto f : level.files) {
+      if (!overlap(f) || older(f)) {
+        continue;
+      }
+      if (!f->prop.is_map_sst()) {
+        return false;
+      }
+      for (auto& dependence : f->prop.dependence) {
+        auto find = dependence_map.find(dependence.file_number);
+        if (find == dependence_map.end() ||
+            find->second->prop.is_map_sst()) {
+          return false;
+        }
+        if (overlap(find->second) && !older(find->second)) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 // Mark (or clear) each file that is being compacted
 void Compaction::MarkFilesBeingCompacted(bool mark_as_compacted) {
   for (size_t i = 0; i < num_input_levels(); i++) {
@@ -506,18 +543,116 @@ std::unique_ptr<CompactionFilter> Compaction::CreateCompactionFilter() const {
       context);
 }
 
+namespace {
+// Read and garbage counters of key SSTs, together with the blob SSTs they
+// depend on
+struct SeparationHeat {
+  uint64_t num_entries = 0;
+  uint64_t num_reads = 0;
+  uint64_t blob_num_entries = 0;
+  uint64_t blob_num_antiquation = 0;
+  std::unordered_set<uint64_t> blobs;
+
+  void Add(const FileMetaData* f, const DependenceMap& dependence_map) {
+    num_entries += f->prop.num_entries;
+    num_reads += f->stats.num_reads_sampled.load(std::memory_order_relaxed);
+    for (auto& dependence : f->prop.dependence) {
+      auto find = dependence_map.find(dependence.file_number);
+      if (find == dependence_map.end() ||
+          !blobs.emplace(dependence.file_number).second) {
+        continue;
+      }
+      blob_num_entries += find->second->prop.num_entries;
+      blob_num_antiquation += find->second->num_antiquation;
+    }
+  }
+
+  // Map SSTs contribute the key SSTs they link
+  void AddOverlapping(const std::vector<FileMetaData*>& files,
+                      const DependenceMap& dependence_map,
+                      const Comparator* ucmp, const Slice* start,
+                      const Slice* end) {
+    auto overlap = [&](const FileMetaData* f) {
+      return (start == nullptr ||
+              ucmp->Compare(f->largest.user_key(), *start) >= 0) &&
+             (end == nullptr ||
+              ucmp->Compare(f->smallest.user_key(), *end) < 0);
+    };
+    for (auto f : files) {
+      if (!overlap(f)) {
+        continue;
+      }
+      if (!f->prop.is_map_sst()) {
+        Add(f, dependence_map);
+        continue;
+      }
+      for (auto& dependence : f->prop.dependence) {
+        auto find = dependence_map.find(dependence.file_number);
+        if (find != dependence_map.end() &&
+            !find->second->prop.is_map_sst() && overlap(find->second)) {
+          Add(find->second, dependence_map);
+        }
+      }
+    }
+  }
+};
+}  // namespace
+
+BlobConfig Compaction::GetBlobConfig(const Slice* start,
+                                     const Slice* end) const {
+  BlobConfig blob_config = mutable_cf_options_.get_blob_config();
+  if (!mutable_cf_options_.enable_adaptive_blob_size ||
+      blob_config.blob_size == size_t(-1) || input_vstorage_ == nullptr) {
+    return blob_config;
+  }
+  const double kMinScale = 0.25;
+  const double kMaxScale = 4;
+  auto ucmp = immutable_cf_options_.user_comparator;
+  auto& dependence_map = input_vstorage_->dependence_map();
+
+  SeparationHeat range_heat, total_heat;
+  for (auto& input_level : inputs_) {
+    range_heat.AddOverlapping(input_level.files, dependence_map, ucmp, start,
+                              end);
+  }
+  if (range_heat.num_entries == 0) {
+    return blob_config;
+  }
+  for (int level = 0; level < input_vstorage_->num_levels(); ++level) {
+    total_heat.AddOverlapping(input_vstorage_->LevelFiles(level),
+                              dependence_map, ucmp, nullptr, nullptr);
+  }
+  double scale = 1;
+  // Hot ranges keep more values inline to save the extra blob fetch
+  if (total_heat.num_reads > 0 && total_heat.num_entries > 0) {
+    scale = (double(range_heat.num_reads) / range_heat.num_entries) /
+            (double(total_heat.num_reads) / total_heat.num_entries);
+  }
+  // Frequently overwritten values are cheaper to rewrite as blob index
+  if (range_heat.blob_num_entries > 0) {
+    scale /= 1 + 3. * range_heat.blob_num_antiquation /
+                     range_heat.blob_num_entries;
+  }
+  scale = std::min(std::max(scale, kMinScale), kMaxScale);
+  double blob_size = blob_config.blob_size * scale;
+  if (blob_size < double(port::kMaxSizet)) {
+    blob_config.blob_size = std::max<size_t>(8, size_t(blob_size));
+  }
+  return blob_config;
+}
+
 bool Compaction::IsOutputLevelEmpty() const {
   return inputs_.back().level != output_level_ || inputs_.back().empty();
 }
 
-bool Compaction::ShouldFormSubcompactions() const {
+bool Compaction::ShouldFormSubcompactions(bool remote) const {
   if (compaction_type_ == kMapCompaction || max_subcompactions_ <= 1 ||
       cfd_ == nullptr) {
     return false;
   }
   if (cfd_->ioptions()->compaction_style == kCompactionStyleLevel) {
-    return (start_level_ == 0 || is_manual_compaction_) && output_level_ > 0 &&
-           !IsOutputLevelEmpty();
+    return (start_level_ == 0 || is_manual_compaction_ || remote) &&
+           output_level_ > 0 && !IsOutputLevelEmpty();
   } else if (cfd_->ioptions()->compaction_style == kCompactionStyleUniversal) {
     return number_levels_ > 1 && output_level_ > 0;
   } else {
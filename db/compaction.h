@@ -165,6 +165,9 @@ struct CompactionWorkerContext {
   int level, output_level, number_levels;
   bool skip_filters, bottommost_level, allow_ingest_behind, preserve_deletes;
   std::vector<NameParam> int_tbl_prop_collector_factories;
+  // appended to GenerateOutputFileName(), keeps the outputs of subcompactions
+  // running concurrently on the same worker apart
+  std::string output_file_suffix;
 };
 
 struct CompactionWorkerResult {
@@ -298,6 +301,13 @@ class Compaction {
   bool KeyNotExistsBeyondOutputLevel(const Slice& user_key,
                                      std::vector<size_t>* level_ptrs) const;
 
+  // Returns true if no input holds a point key with a user key in
+  // [begin, end) and a sequence number >= seqno, so a range tombstone of
+  // seqno covering [begin, end) deletes all of them. Map sst inputs are
+  // checked through the files they link to.
+  bool InputsOlderThan(const Slice& begin, const Slice& end,
+                       SequenceNumber seqno) const;
+
   // Clear all files to indicate that they are not being compacted
   // Delete this compaction from the list of running compactions.
   //
@@ -377,11 +387,19 @@ class Compaction {
   // Create a CompactionFilter from compaction_filter_factory
   std::unique_ptr<CompactionFilter> CreateCompactionFilter() const;
 
+  // Returns the value separation config for outputs in user key range
+  // [start, end), nullptr means unbounded. If enable_adaptive_blob_size is
+  // set, blob_size is scaled by the read and garbage heat of the input files
+  // overlapping the range, relative to the whole column family.
+  BlobConfig GetBlobConfig(const Slice* start, const Slice* end) const;
+
   // Is the input level corresponding to output_level_ empty?
   bool IsOutputLevelEmpty() const;
 
   // Should this compaction be broken up into smaller ones run in parallel?
-  bool ShouldFormSubcompactions() const;
+  // remote: subcompactions are dispatched to compaction workers, so any
+  // level compaction is worth splitting, not only the ones from L0
+  bool ShouldFormSubcompactions(bool remote = false) const;
 
   // test function to validate the functionality of IsBottommostLevel()
   // function -- determines if compaction with inputs and storage is bottommost
@@ -411,7 +429,7 @@ class Compaction {
 
   int GetInputBaseLevel() const;
 
-  CompactionReason compaction_reason() { return compaction_reason_; }
+  CompactionReason compaction_reason() const { return compaction_reason_; }
 
   const std::vector<FileMetaData*>& grandparents() const {
     return grandparents_;
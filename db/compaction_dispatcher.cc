@@ -16,8 +16,19 @@
 #endif
 
 #include <inttypes.h>
-
+#include <netdb.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
 #include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
 
 #ifdef WITH_TERARK_ZIP
 #include <terark/num_to_str.hpp>
@@ -44,6 +55,7 @@
 #include "table/table_reader.h"
 #include "table/two_level_iterator.h"
 #include "util/c_style_callback.h"
+#include "util/coding.h"
 #include "util/filename.h"
 
 #ifndef WITH_TERARK_ZIP
@@ -245,7 +257,8 @@ AJSON(CompactionWorkerContext, user_comparator, merge_operator,
       inputs, cf_name, target_file_size, compression, compression_opts,
       existing_snapshots, smallest_user_key, largest_user_key, level,
       output_level, number_levels, skip_filters, bottommost_level,
-      allow_ingest_behind, preserve_deletes, int_tbl_prop_collector_factories);
+      allow_ingest_behind, preserve_deletes, int_tbl_prop_collector_factories,
+      output_file_suffix);
 
 #ifdef USE_AJSON
 #else
@@ -352,6 +365,40 @@ bool IsCompactionWorkerNode() { return g_isCompactionWorkerNode; }
 struct RemoteCompactionDispatcher::Worker::Rep {
   EnvOptions env_options;
   Env* env;
+
+  // Objects rebuilt from the same name and options are shared by all jobs of
+  // this worker, so a long lived worker pays their construction only once
+  std::mutex cache_mutex;
+  STMap<MergeOperator> merge_operator_cache;
+  STMap<ValueExtractorFactory> value_meta_extractor_factory_cache;
+  STMap<CompactionFilterFactory> compaction_filter_factory_cache;
+  STMap<TableFactory> table_factory_cache;
+  STMap<const SliceTransform> prefix_extractor_cache;
+
+  // Serve() state
+  std::mutex serve_mutex;
+  std::condition_variable serve_cv;
+  size_t running_jobs = 0;
+  int listen_fd = -1;
+  std::atomic<bool> shutting_down{false};
+
+  template <class T, class Create>
+  std::shared_ptr<T> GetOrCreate(STMap<T>* cache, const std::string& name,
+                                 const std::string& options, Create&& create) {
+    std::string key = name;
+    key.push_back('\0');
+    key.append(options);
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto find = cache->find(key);
+    if (find != cache->end()) {
+      return find->second;
+    }
+    std::shared_ptr<T> ptr(create());
+    if (ptr) {
+      cache->emplace(std::move(key), ptr);
+    }
+    return ptr;
+  }
 };
 
 RemoteCompactionDispatcher::Worker::Worker(EnvOptions env_options, Env* env) {
@@ -387,6 +434,11 @@ class RemoteCompactionProxy : public CompactionIterator::CompactionProxy {
   Slice GetLargestUserKey() const override { return largest_user_key_; }
   bool allow_ingest_behind() const override { return allow_ingest_behind_; }
   bool preserve_deletes() const override { return preserve_deletes_; }
+  // The worker doesn't know the input files, drop covered keys one by one
+  bool InputsOlderThan(const Slice& /*begin*/, const Slice& /*end*/,
+                       SequenceNumber /*seqno*/) const override {
+    return false;
+  }
 
  protected:
   Slice largest_user_key_;
@@ -402,7 +454,8 @@ static std::string make_error(Status&& status) {
   return stream.str();
 };
 
-std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
+std::string RemoteCompactionDispatcher::Worker::DoCompaction(
+    Slice data, const ProgressCallback& progress) {
   CompactionWorkerContext context;
   ajson::load_from_buff(context, data);
   context.compaction_filter_context.smallest_user_key =
@@ -421,16 +474,25 @@ std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
     }
   }
   if (!context.merge_operator.empty()) {
-    cf_options.merge_operator.reset(MergeOperator::create(
-        context.merge_operator, context.merge_operator_data));
+    cf_options.merge_operator = rep_->GetOrCreate(
+        &rep_->merge_operator_cache, context.merge_operator,
+        context.merge_operator_data, [&] {
+          return MergeOperator::create(context.merge_operator,
+                                       context.merge_operator_data);
+        });
     if (!cf_options.merge_operator) {
       return make_error(Status::Corruption("Missing merge_operator !"));
     }
   }
   if (!context.value_meta_extractor_factory.empty()) {
-    cf_options.value_meta_extractor_factory.reset(ValueExtractorFactory::create(
+    cf_options.value_meta_extractor_factory = rep_->GetOrCreate(
+        &rep_->value_meta_extractor_factory_cache,
         context.value_meta_extractor_factory,
-        context.value_meta_extractor_factory_options));
+        context.value_meta_extractor_factory_options, [&] {
+          return ValueExtractorFactory::create(
+              context.value_meta_extractor_factory,
+              context.value_meta_extractor_factory_options);
+        });
     if (!cf_options.value_meta_extractor_factory) {
       return make_error(Status::Corruption("Missing value_meta_extractor !"));
     }
@@ -449,8 +511,14 @@ std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
     }
     cf_options.compaction_filter = filter_ptr.get();
   } else if (!context.compaction_filter_factory.empty()) {
-    cf_options.compaction_filter_factory.reset(CompactionFilterFactory::create(
-        context.compaction_filter_factory, context.compaction_filter_data));
+    cf_options.compaction_filter_factory = rep_->GetOrCreate(
+        &rep_->compaction_filter_factory_cache,
+        context.compaction_filter_factory, context.compaction_filter_data,
+        [&] {
+          return CompactionFilterFactory::create(
+              context.compaction_filter_factory,
+              context.compaction_filter_data);
+        });
     if (!cf_options.compaction_filter_factory) {
       return make_error(Status::Corruption("Missing CompactionFilterFactory!"));
     }
@@ -459,8 +527,12 @@ std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
     return make_error(Status::Corruption("Bad table_factory name !"));
   } else {
     Status s;
-    cf_options.table_factory.reset(TableFactory::create(
-        context.table_factory, context.table_factory_options, &s));
+    cf_options.table_factory = rep_->GetOrCreate(
+        &rep_->table_factory_cache, context.table_factory,
+        context.table_factory_options, [&] {
+          return TableFactory::create(context.table_factory,
+                                      context.table_factory_options, &s);
+        });
     if (!cf_options.table_factory) {
       return make_error(std::move(s));
     }
@@ -470,8 +542,12 @@ std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
     cf_options.cf_paths.emplace_back(DbPath(path, 0));
   }
   if (!context.prefix_extractor.empty()) {
-    cf_options.prefix_extractor.reset(SliceTransform::create(
-        context.prefix_extractor, context.prefix_extractor_options));
+    cf_options.prefix_extractor = rep_->GetOrCreate(
+        &rep_->prefix_extractor_cache, context.prefix_extractor,
+        context.prefix_extractor_options, [&] {
+          return SliceTransform::create(context.prefix_extractor,
+                                        context.prefix_extractor_options);
+        });
     if (!cf_options.prefix_extractor) {
       return make_error(Status::Corruption("Missing prefix_extractor !"));
     }
@@ -811,6 +887,7 @@ std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
   auto create_builder = [&](std::unique_ptr<WritableFileWriter>* writer_ptr,
                             std::unique_ptr<TableBuilder>* builder_ptr) {
     std::string file_name = GenerateOutputFileName(result.files.size());
+    file_name += context.output_file_suffix;
     Status s;
     TableBuilderOptions table_builder_options(
         immutable_cf_options, mutable_cf_options, *icmp,
@@ -990,6 +1067,8 @@ std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
 
   Status& status = result.status;
   const Slice* next_key = nullptr;
+  const uint64_t kProgressEvery = 65536;
+  uint64_t num_output_records = 0;
   while (status.ok() && c_iter->Valid()) {
     // Invariant: c_iter.status() is guaranteed to be OK if c_iter->Valid()
     // returns true.
@@ -1020,6 +1099,10 @@ std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
     }
     size_t current_output_file_size = builder->FileSize();
     meta.UpdateBoundaries(key, c_iter->ikey().sequence);
+    if (progress && ++num_output_records % kProgressEvery == 0) {
+      progress(c_iter->iter_stats().num_input_records,
+               current_output_file_size);
+    }
 
     bool output_file_ended = false;
     Status input_status;
@@ -1100,6 +1183,236 @@ std::string RemoteCompactionDispatcher::Worker::DoCompaction(Slice data) {
   return stream.str();
 }
 
+namespace {
+// Frames of the worker socket protocol:
+//   type(1 byte) | payload length(fixed64) | payload
+// The client sends one kWorkerRequest, the worker answers with any number of
+// kWorkerProgress frames followed by one kWorkerResult
+enum WorkerFrameType : char {
+  kWorkerRequest = 'Q',
+  kWorkerProgress = 'P',
+  kWorkerResult = 'R',
+};
+// Requests and results carry file metadata and stats, not data blocks, so a
+// larger length means a corrupted stream or a peer that isn't a worker
+const uint64_t kMaxWorkerFrameSize = 64ull << 20;
+
+bool WriteAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool ReadAll(int fd, char* data, size_t size) {
+  while (size > 0) {
+    ssize_t n = ::recv(fd, data, size, 0);
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool WriteFrame(int fd, char type, const Slice& payload) {
+  char header[9];
+  header[0] = type;
+  EncodeFixed64(header + 1, payload.size());
+  return WriteAll(fd, header, sizeof header) &&
+         WriteAll(fd, payload.data(), payload.size());
+}
+
+bool ReadFrame(int fd, char* type, std::string* payload) {
+  char header[9];
+  if (!ReadAll(fd, header, sizeof header)) {
+    return false;
+  }
+  uint64_t size = DecodeFixed64(header + 1);
+  if (size > kMaxWorkerFrameSize) {
+    return false;
+  }
+  *type = header[0];
+  payload->resize(size);
+  return ReadAll(fd, &(*payload)[0], size);
+}
+
+// address: "unix:<path>" or "tcp:<host>:<port>", empty host means any
+Status OpenWorkerSocket(const std::string& address, bool listen, int* fd_ptr) {
+  int fd = -1;
+  if (Slice(address).starts_with("unix:")) {
+    std::string path = address.substr(5);
+    sockaddr_un sa;
+    if (path.empty() || path.size() >= sizeof sa.sun_path) {
+      return Status::InvalidArgument("Bad unix socket path", address);
+    }
+    memset(&sa, 0, sizeof sa);
+    sa.sun_family = AF_UNIX;
+    memcpy(sa.sun_path, path.data(), path.size());
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+      return Status::IOError("socket", strerror(errno));
+    }
+    if (listen) {
+      ::unlink(path.c_str());
+    }
+    int r = listen ? ::bind(fd, (sockaddr*)&sa, sizeof sa)
+                   : ::connect(fd, (sockaddr*)&sa, sizeof sa);
+    if (r != 0) {
+      Status s = Status::IOError(address, strerror(errno));
+      ::close(fd);
+      return s;
+    }
+  } else if (Slice(address).starts_with("tcp:")) {
+    size_t colon = address.rfind(':');
+    if (colon <= 3) {
+      return Status::InvalidArgument("Bad tcp address", address);
+    }
+    std::string host = address.substr(4, colon - 4);
+    std::string port = address.substr(colon + 1);
+    addrinfo hints, *info = nullptr;
+    memset(&hints, 0, sizeof hints);
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listen ? AI_PASSIVE : 0;
+    int r = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(),
+                          &hints, &info);
+    if (r != 0) {
+      return Status::InvalidArgument(address, gai_strerror(r));
+    }
+    Status s = Status::IOError(address, "no usable address");
+    for (addrinfo* p = info; p != nullptr; p = p->ai_next) {
+      fd = ::socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+      if (fd < 0) {
+        continue;
+      }
+      int yes = 1;
+      if (listen) {
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes);
+        r = ::bind(fd, p->ai_addr, p->ai_addrlen);
+      } else {
+        r = ::connect(fd, p->ai_addr, p->ai_addrlen);
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof yes);
+      }
+      if (r == 0) {
+        s = Status::OK();
+        break;
+      }
+      s = Status::IOError(address, strerror(errno));
+      ::close(fd);
+      fd = -1;
+    }
+    ::freeaddrinfo(info);
+    if (!s.ok()) {
+      return s;
+    }
+  } else {
+    return Status::InvalidArgument("Unknown worker address", address);
+  }
+  if (listen && ::listen(fd, 128) != 0) {
+    Status s = Status::IOError("listen", strerror(errno));
+    ::close(fd);
+    return s;
+  }
+  *fd_ptr = fd;
+  return Status::OK();
+}
+}  // namespace
+
+Status RemoteCompactionDispatcher::Worker::Serve(const std::string& address,
+                                                 size_t max_jobs) {
+  int listen_fd;
+  Status s = OpenWorkerSocket(address, true, &listen_fd);
+  if (!s.ok()) {
+    return s;
+  }
+  max_jobs = std::max<size_t>(max_jobs, 1);
+  {
+    std::lock_guard<std::mutex> lock(rep_->serve_mutex);
+    rep_->listen_fd = listen_fd;
+  }
+  auto serve_connection = [this](int fd) {
+    char type;
+    std::string request;
+    std::string result;
+    if (!ReadFrame(fd, &type, &request)) {
+      ::close(fd);
+      return;
+    }
+    if (type != kWorkerRequest) {
+      result = make_error(Status::InvalidArgument("Bad worker request"));
+    } else {
+      bool connected = true;
+      result = DoCompaction(request, [fd, &connected](
+                                         uint64_t num_input_records,
+                                         uint64_t current_output_file_size) {
+        if (connected) {
+          char buffer[16];
+          EncodeFixed64(buffer, num_input_records);
+          EncodeFixed64(buffer + 8, current_output_file_size);
+          connected = WriteFrame(fd, kWorkerProgress, Slice(buffer, 16));
+        }
+      });
+    }
+    WriteFrame(fd, kWorkerResult, result);
+    ::close(fd);
+  };
+  while (!rep_->shutting_down.load(std::memory_order_relaxed)) {
+    int fd = ::accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      if (!rep_->shutting_down.load(std::memory_order_relaxed)) {
+        s = Status::IOError("accept", strerror(errno));
+      }
+      break;
+    }
+    std::unique_lock<std::mutex> lock(rep_->serve_mutex);
+    rep_->serve_cv.wait(lock, [&] { return rep_->running_jobs < max_jobs; });
+    ++rep_->running_jobs;
+    lock.unlock();
+    std::thread([this, fd, serve_connection] {
+      try {
+        serve_connection(fd);
+      } catch (const std::exception& ex) {
+        fprintf(stderr, "ERROR: CompactionWorker exception.what = %s\n",
+                ex.what());
+        ::close(fd);
+      }
+      std::lock_guard<std::mutex> guard(rep_->serve_mutex);
+      --rep_->running_jobs;
+      rep_->serve_cv.notify_all();
+    }).detach();
+  }
+  std::unique_lock<std::mutex> lock(rep_->serve_mutex);
+  rep_->serve_cv.wait(lock, [&] { return rep_->running_jobs == 0; });
+  rep_->listen_fd = -1;
+  ::close(listen_fd);
+  return s;
+}
+
+void RemoteCompactionDispatcher::Worker::Shutdown() {
+  rep_->shutting_down.store(true, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(rep_->serve_mutex);
+  if (rep_->listen_fd >= 0) {
+    // wake up accept()
+    ::shutdown(rep_->listen_fd, SHUT_RDWR);
+  }
+}
+
 void RemoteCompactionDispatcher::Worker::DebugSerializeCheckResult(Slice data) {
 #ifdef WITH_TERARK_ZIP
   using namespace terark;
@@ -1180,4 +1493,49 @@ std::shared_ptr<CompactionDispatcher> NewCommandLineCompactionDispatcher(
   return std::make_shared<CommandLineCompactionDispatcher>(std::move(cmd));
 }
 
+class SocketCompactionDispatcher : public RemoteCompactionDispatcher {
+  std::string m_address;
+
+ public:
+  SocketCompactionDispatcher(std::string&& address)
+      : m_address(std::move(address)) {}
+
+  std::future<std::string> DoCompaction(std::string data) override {
+    const std::string& address = m_address;
+    return std::async(std::launch::async, [address, data] {
+      int fd;
+      Status s = OpenWorkerSocket(address, false, &fd);
+      if (!s.ok()) {
+        return make_error(std::move(s));
+      }
+      std::string result;
+      char type = 0;
+      if (!WriteFrame(fd, kWorkerRequest, data)) {
+        s = Status::IOError("Send compaction request", strerror(errno));
+      }
+      while (s.ok()) {
+        if (!ReadFrame(fd, &type, &result)) {
+          s = Status::IOError("Compaction worker connection lost", address);
+        } else if (type == kWorkerResult) {
+          break;
+        } else if (type == kWorkerProgress && result.size() == 16) {
+          // The worker is alive, keep waiting for the result
+        } else {
+          s = Status::Corruption("Bad compaction worker frame", address);
+        }
+      }
+      ::close(fd);
+      if (!s.ok()) {
+        return make_error(std::move(s));
+      }
+      return result;
+    });
+  }
+};
+
+std::shared_ptr<CompactionDispatcher> NewSocketCompactionDispatcher(
+    std::string address) {
+  return std::make_shared<SocketCompactionDispatcher>(std::move(address));
+}
+
 }  // namespace TERARKDB_NAMESPACE
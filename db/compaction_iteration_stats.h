@@ -15,6 +15,9 @@ struct CompactionIterationStats {
   int64_t num_record_drop_hidden = 0;
   int64_t num_record_drop_obsolete = 0;
   int64_t num_record_drop_range_del = 0;
+  // Seeks past keys covered by a range tombstone, the skipped keys are not
+  // counted in any of the stats.
+  int64_t num_range_del_skip = 0;
   int64_t num_range_del_drop_obsolete = 0;
   // Deletions obsoleted before bottom level due to file gap optimization.
   int64_t num_optimized_del_drop_obsolete = 0;
@@ -29,6 +32,10 @@ struct CompactionIterationStats {
   uint64_t total_input_raw_key_bytes = 0;
   uint64_t total_input_raw_value_bytes = 0;
 
+  // Output statistics of key value separation
+  uint64_t num_output_value_separated = 0;
+  uint64_t num_output_value_inline = 0;
+
   // Single-Delete diagnostics for exceptional situations
   uint64_t num_single_del_fallthru = 0;
   uint64_t num_single_del_mismatch = 0;
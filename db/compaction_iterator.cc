@@ -199,6 +199,7 @@ void CompactionIterator::ResetRecordCounts() {
   iter_stats_.num_record_drop_hidden = 0;
   iter_stats_.num_record_drop_obsolete = 0;
   iter_stats_.num_record_drop_range_del = 0;
+  iter_stats_.num_range_del_skip = 0;
   iter_stats_.num_range_del_drop_obsolete = 0;
   iter_stats_.num_optimized_del_drop_obsolete = 0;
 }
@@ -707,7 +708,9 @@ void CompactionIterator::NextFromInput() {
         ++iter_stats_.num_record_drop_hidden;
         ++iter_stats_.num_record_drop_range_del;
         value_.reset();
-        input_->Next();
+        if (!SkipRangeDeletedKeys()) {
+          input_->Next();
+        }
       } else {
         valid_ = true;
       }
@@ -723,6 +726,36 @@ void CompactionIterator::NextFromInput() {
   }
 }
 
+bool CompactionIterator::SkipRangeDeletedKeys() {
+  // Not for flush, and keys may be uncommitted with a snapshot checker
+  if (compaction_ == nullptr || snapshot_checker_ != nullptr) {
+    return false;
+  }
+  if (range_del_skip_failed_ &&
+      cmp_->Compare(ikey_.user_key, range_del_skip_end_) < 0) {
+    return false;
+  }
+  range_del_skip_failed_ = false;
+  SequenceNumber seq;
+  if (!range_del_agg_->GetCoveringTombstone(ikey_, &seq,
+                                            &range_del_skip_end_)) {
+    return false;
+  }
+  // Every snapshot has to see the tombstone, and every input key in the
+  // range has to be older than it. Otherwise drop the keys one by one.
+  if (seq > earliest_snapshot_ ||
+      !compaction_->InputsOlderThan(ikey_.user_key, range_del_skip_end_,
+                                    seq)) {
+    range_del_skip_failed_ = true;
+    return false;
+  }
+  ++iter_stats_.num_range_del_skip;
+  range_del_skip_until_.Set(range_del_skip_end_, kMaxSequenceNumber,
+                            kValueTypeForSeek);
+  input_->Seek(range_del_skip_until_.Encode());
+  return true;
+}
+
 void CompactionIterator::PrepareOutput() {
   // Zeroing out the sequence number leads to better compression.
   // If this is the bottommost level (no files in lower levels)
@@ -759,6 +792,8 @@ void CompactionIterator::PrepareOutput() {
         if (!s.ok()) {
           valid_ = false;
           status_ = std::move(s);
+        } else {
+          ++iter_stats_.num_output_value_separated;
         }
         return;
       }
@@ -768,6 +803,7 @@ void CompactionIterator::PrepareOutput() {
         ikey_.type =
             ikey_.type == kTypeValue ? kTypeValueIndex : kTypeMergeIndex;
         current_key_.UpdateInternalKey(ikey_.sequence, ikey_.type);
+        ++iter_stats_.num_output_value_separated;
         return;
       }
       if (!s.IsNotSupported()) {
@@ -776,6 +812,7 @@ void CompactionIterator::PrepareOutput() {
         return;
       }
     }
+    ++iter_stats_.num_output_value_inline;
   }
   if (ikey_.type == kTypeValueIndex || ikey_.type == kTypeMergeIndex) {
     assert(value_.file_number() != uint64_t(-1));
@@ -785,6 +822,8 @@ void CompactionIterator::PrepareOutput() {
     if (!s.ok()) {
       valid_ = false;
       status_ = std::move(s);
+    } else {
+      ++iter_stats_.num_output_value_separated;
     }
     return;
   }
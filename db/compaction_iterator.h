@@ -53,6 +53,10 @@ class CompactionIterator {
     virtual bool preserve_deletes() const {
       return compaction_->immutable_cf_options()->preserve_deletes;
     }
+    virtual bool InputsOlderThan(const Slice& begin, const Slice& end,
+                                 SequenceNumber seqno) const {
+      return compaction_->InputsOlderThan(begin, end, seqno);
+    }
 
    protected:
     CompactionProxy() : compaction_(nullptr) {}
@@ -126,6 +130,11 @@ class CompactionIterator {
   // Invoke compaction filter if needed.
   void InvokeFilterIfNeeded(bool* need_skip, Slice* skip_until);
 
+  // The current key is deleted by a range tombstone. Seeks the input past
+  // all keys covered by that tombstone if it deletes them in every snapshot,
+  // so they are dropped without being read. Returns false if it didn't.
+  bool SkipRangeDeletedKeys();
+
   // Given a sequence number, return the sequence number of the
   // earliest snapshot that this sequence number is visible in.
   // The snapshots themselves are arranged in ascending order of
@@ -201,6 +210,11 @@ class CompactionIterator {
   MergeOutputIterator merge_out_iter_;
   LazyBuffer compaction_filter_value_;
   InternalKey compaction_filter_skip_until_;
+  // End of the range skipped by SkipRangeDeletedKeys(), or of the range it
+  // can't skip if range_del_skip_failed_
+  std::string range_del_skip_end_;
+  bool range_del_skip_failed_ = false;
+  InternalKey range_del_skip_until_;
   // "level_ptrs" holds indices that remember which file of an associated
   // level we were last checking during the last call to compaction->
   // KeyNotExistsBeyondOutputLevel(). This allows future calls to the function
@@ -180,8 +180,15 @@ class FakeCompaction : public CompactionIterator::CompactionProxy {
 
   virtual bool preserve_deletes() const override { return false; }
 
+  virtual bool InputsOlderThan(const Slice& /*begin*/, const Slice& /*end*/,
+                               SequenceNumber /*seqno*/) const override {
+    return inputs_older_than;
+  }
+
   bool key_not_exists_beyond_output_level = false;
 
+  bool inputs_older_than = false;
+
   bool is_bottommost_level = false;
 };
 
@@ -237,9 +244,10 @@ class CompactionIteratorTest : public testing::TestWithParam<bool> {
     range_del_agg_->AddTombstones(std::move(range_del_iter));
 
     std::unique_ptr<CompactionIterator::CompactionProxy> compaction;
-    if (filter || bottommost_level) {
+    if (filter || bottommost_level || inputs_older_than_) {
       compaction_proxy_ = new FakeCompaction();
       compaction_proxy_->is_bottommost_level = bottommost_level;
+      compaction_proxy_->inputs_older_than = inputs_older_than_;
       compaction.reset(compaction_proxy_);
     }
     bool use_snapshot_checker = UseSnapshotChecker() || GetParam();
@@ -308,6 +316,7 @@ class CompactionIteratorTest : public testing::TestWithParam<bool> {
   std::unique_ptr<SnapshotChecker> snapshot_checker_;
   std::atomic<bool> shutting_down_{false};
   FakeCompaction* compaction_proxy_;
+  bool inputs_older_than_ = false;
 };
 
 // It is possible that the output of the compaction iterator is empty even if
@@ -378,6 +387,65 @@ TEST_P(CompactionIteratorTest, RangeDeletionWithSnapshots) {
   ASSERT_FALSE(c_iter_->Valid());
 }
 
+TEST_P(CompactionIteratorTest, RangeDeletionSkip) {
+  inputs_older_than_ = true;
+  InitIterators({test::KeyStr("a", 10, kTypeValue),
+                 test::KeyStr("b", 5, kTypeValue),
+                 test::KeyStr("b", 3, kTypeValue),
+                 test::KeyStr("c", 4, kTypeValue),
+                 test::KeyStr("d", 2, kTypeValue),
+                 test::KeyStr("e", 6, kTypeValue)},
+                {"av10", "bv5", "bv3", "cv4", "dv2", "ev6"},
+                {test::KeyStr("b", 8, kTypeRangeDeletion)}, {"d+"}, 10);
+  c_iter_->SeekToFirst();
+  ASSERT_TRUE(c_iter_->Valid());
+  ASSERT_EQ(test::KeyStr("a", 10, kTypeValue), c_iter_->key().ToString());
+  c_iter_->Next();
+  ASSERT_TRUE(c_iter_->Valid());
+  ASSERT_EQ(test::KeyStr("e", 6, kTypeValue), c_iter_->key().ToString());
+  c_iter_->Next();
+  ASSERT_FALSE(c_iter_->Valid());
+
+  using A = LoggingForwardVectorIterator::Action;
+  using T = A::Type;
+  std::vector<A> expected_actions;
+  if (GetParam()) {
+    // Keys may be uncommitted, drop them one by one
+    expected_actions = {A(T::SEEK_TO_FIRST), A(T::NEXT), A(T::NEXT),
+                        A(T::NEXT),          A(T::NEXT), A(T::NEXT),
+                        A(T::NEXT)};
+  } else {
+    expected_actions = {
+        A(T::SEEK_TO_FIRST), A(T::NEXT),
+        A(T::SEEK, test::KeyStr("d+", kMaxSequenceNumber, kValueTypeForSeek)),
+        A(T::NEXT)};
+    ASSERT_EQ(1, c_iter_->iter_stats().num_range_del_skip);
+  }
+  ASSERT_EQ(expected_actions, iter_->log);
+}
+
+TEST_P(CompactionIteratorTest, RangeDeletionSkipWithSnapshot) {
+  inputs_older_than_ = true;
+  AddSnapshot(3);
+  InitIterators({test::KeyStr("b", 5, kTypeValue),
+                 test::KeyStr("b", 3, kTypeValue),
+                 test::KeyStr("c", 4, kTypeValue),
+                 test::KeyStr("e", 6, kTypeValue)},
+                {"bv5", "bv3", "cv4", "ev6"},
+                {test::KeyStr("b", 8, kTypeRangeDeletion)}, {"d+"}, 10);
+  // Snapshot 3 doesn't see the tombstone, so "b"@3 survives and nothing is
+  // skipped.
+  c_iter_->SeekToFirst();
+  ASSERT_TRUE(c_iter_->Valid());
+  ASSERT_EQ(test::KeyStr("b", 3, kTypeValue), c_iter_->key().ToString());
+  c_iter_->Next();
+  ASSERT_TRUE(c_iter_->Valid());
+  ASSERT_EQ(test::KeyStr("e", 6, kTypeValue), c_iter_->key().ToString());
+  c_iter_->Next();
+  ASSERT_FALSE(c_iter_->Valid());
+  ASSERT_EQ(0, c_iter_->iter_stats().num_range_del_skip);
+}
+
 TEST_P(CompactionIteratorTest, CompactionFilterSkipUntil) {
   class Filter : public CompactionFilter {
     virtual Decision FilterV2(int /*level*/, const Slice& key, ValueType t,
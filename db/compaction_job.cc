@@ -51,6 +51,7 @@
 #include "db/merge_helper.h"
 #include "db/range_del_aggregator.h"
 #include "db/version_set.h"
+#include "monitoring/file_io_stats.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/thread_status_util.h"
 #include "port/port.h"
@@ -131,6 +132,17 @@ const char* GetCompactionReasonString(CompactionReason compaction_reason) {
   }
 }
 
+static IOOriginator CompactionIOOriginator(const Compaction* c) {
+  switch (c->compaction_type()) {
+    case kMapCompaction:
+      return kIOOriginatorMapCompaction;
+    case kGarbageCollection:
+      return kIOOriginatorGarbageCollection;
+    default:
+      return IOOriginatorForCompaction(c->compaction_reason());
+  }
+}
+
 // Maintains state for each sub-compaction
 struct CompactionJob::SubcompactionState {
   const Compaction* compaction;
@@ -204,6 +216,8 @@ struct CompactionJob::SubcompactionState {
   // A flag determine whether the key has been seen in ShouldStopBefore()
   bool seen_key = false;
   std::string compression_dict;
+  // Value separation config of this subcompaction
+  BlobConfig blob_config;
 
   SubcompactionState(Compaction* c, const Slice* _start, const Slice* _end,
                      uint64_t size = 0)
@@ -220,7 +234,8 @@ struct CompactionJob::SubcompactionState {
         grandparent_index(0),
         overlapped_bytes(0),
         seen_key(false),
-        compression_dict() {
+        compression_dict(),
+        blob_config(c->mutable_cf_options()->get_blob_config()) {
     assert(compaction != nullptr);
   }
 
@@ -249,6 +264,7 @@ struct CompactionJob::SubcompactionState {
     overlapped_bytes = std::move(o.overlapped_bytes);
     seen_key = std::move(o.seen_key);
     compression_dict = std::move(o.compression_dict);
+    blob_config = std::move(o.blob_config);
     return *this;
   }
 
@@ -395,7 +411,9 @@ CompactionJob::CompactionJob(
       bottommost_level_(false),
       paranoid_file_checks_(paranoid_file_checks),
       measure_io_stats_(measure_io_stats),
-      write_hint_(Env::WLTH_NOT_SET) {
+      write_hint_(Env::WLTH_NOT_SET),
+      dispatcher_(nullptr),
+      sub_compaction_slots_(0) {
   assert(log_buffer_ != nullptr);
   const auto* cfd = compact_->compaction->column_family_data();
   ThreadStatusUtil::SetColumnFamily(cfd, cfd->ioptions()->env,
@@ -453,6 +471,36 @@ void CompactionJob::ReportStartedCompaction(Compaction* compaction) {
   }
 }
 
+static std::shared_ptr<CompactionDispatcher> GetCmdLineDispatcher() {
+  const char* cmdline = getenv("TerarkDB_compactionWorkerCommandLine");
+  if (cmdline) {
+#ifdef WITH_TERARK_ZIP
+    return NewCommandLineCompactionDispatcher(cmdline);
+#endif
+  }
+  const char* address = getenv("TerarkDB_compactionWorkerAddress");
+  if (address) {
+#ifdef WITH_TERARK_ZIP
+    return NewSocketCompactionDispatcher(address);
+#endif
+  }
+  return {};
+}
+
+static CompactionDispatcher* GetCompactionDispatcher(Compaction* c) {
+  if (c->compaction_type() != kKeyValueCompaction) {
+    return nullptr;
+  }
+  CompactionDispatcher* dispatcher =
+      c->immutable_cf_options()->compaction_dispatcher;
+  if (!dispatcher) {
+    static std::shared_ptr<CompactionDispatcher> command_line_dispatcher(
+        GetCmdLineDispatcher());
+    dispatcher = command_line_dispatcher.get();
+  }
+  return dispatcher;
+}
+
 int CompactionJob::Prepare(int sub_compaction_slots) {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_PREPARE);
@@ -465,6 +513,14 @@ int CompactionJob::Prepare(int sub_compaction_slots) {
       c->column_family_data()->CalculateSSTWriteHint(c->output_level());
   // Is this compaction producing files at the bottommost level?
   bottommost_level_ = c->bottommost_level();
+  // Remote subcompactions only cost a waiting future here, so they are bound
+  // by max_subcompactions instead of the free background threads
+  dispatcher_ = GetCompactionDispatcher(c);
+  sub_compaction_slots_ = sub_compaction_slots;
+  if (dispatcher_ != nullptr) {
+    sub_compaction_slots = std::max<int>(sub_compaction_slots,
+                                         int(c->max_subcompactions()) - 1);
+  }
 
   if (c->compaction_type() != kMapCompaction && !c->input_range().empty()) {
     auto& input_range = c->input_range();
@@ -495,7 +551,7 @@ int CompactionJob::Prepare(int sub_compaction_slots) {
       }
       compact_->sub_compact_states.emplace_back(c, start, end);
     }
-  } else if (c->ShouldFormSubcompactions()) {
+  } else if (c->ShouldFormSubcompactions(dispatcher_ != nullptr)) {
     const uint64_t start_micros = env_->NowMicros();
     GenSubcompactionBoundaries(sub_compaction_slots + 1);
     MeasureTime(stats_, SUBCOMPACTION_SETUP_TIME,
@@ -514,7 +570,12 @@ int CompactionJob::Prepare(int sub_compaction_slots) {
     compact_->sub_compact_states.emplace_back(c, nullptr, nullptr);
   }
   assert(!compact_->sub_compact_states.empty());
-  return static_cast<int>(compact_->sub_compact_states.size() - 1);
+  sub_compaction_slots_ =
+      dispatcher_ != nullptr
+          ? 0
+          : std::min(sub_compaction_slots_,
+                     static_cast<int>(compact_->sub_compact_states.size() - 1));
+  return sub_compaction_slots_;
 }
 
 struct RangeWithSize {
@@ -665,30 +726,15 @@ void CompactionJob::GenSubcompactionBoundaries(int max_usable_threads) {
   }
 }
 
-static std::shared_ptr<CompactionDispatcher> GetCmdLineDispatcher() {
-  const char* cmdline = getenv("TerarkDB_compactionWorkerCommandLine");
-  if (cmdline) {
-#ifdef WITH_TERARK_ZIP
-    return NewCommandLineCompactionDispatcher(cmdline);
-#endif
-  }
-  return {};
-}
-
 Status CompactionJob::Run() {
   TEST_SYNC_POINT("CompactionJob::Run():OuterStart");
 #ifdef WITH_TERARK_ZIP
   assert(!IsCompactionWorkerNode());
 #endif
   ColumnFamilyData* cfd = compact_->compaction->column_family_data();
-  CompactionDispatcher* dispatcher = cfd->ioptions()->compaction_dispatcher;
   Compaction* c = compact_->compaction;
-  if (!dispatcher) {
-    static std::shared_ptr<CompactionDispatcher> command_line_dispatcher(
-        GetCmdLineDispatcher());
-    dispatcher = command_line_dispatcher.get();
-  }
-  if (!dispatcher || c->compaction_type() != kKeyValueCompaction) {
+  IOOriginatorScope io_originator_scope(CompactionIOOriginator(c));
+  if (dispatcher_ == nullptr) {
     return RunSelf();
   }
   Status s;
@@ -741,7 +787,6 @@ Status CompactionJob::Run() {
     }
     context.compaction_filter_factory = factory->Name();
   }
-  context.blob_config = c->mutable_cf_options()->get_blob_config();
   context.table_factory = iopt->table_factory->Name();
   s = iopt->table_factory->GetOptionString(&context.table_factory_options,
                                            "\n");
@@ -802,8 +847,15 @@ Status CompactionJob::Run() {
     context.int_tbl_prop_collector_factories.push_back(
         {collector->Name(), {std::move(param)}});
   }
+  // Every subcompaction is an independent worker request, all of them are
+  // started before waiting for any result so they run concurrently
   std::vector<std::function<CompactionWorkerResult()>> results_fn;
-  for (const auto& state : compact_->sub_compact_states) {
+  for (size_t i = 0; i < compact_->sub_compact_states.size(); ++i) {
+    const auto& state = compact_->sub_compact_states[i];
+    context.blob_config = c->GetBlobConfig(state.start, state.end);
+    char suffix[64];
+    snprintf(suffix, sizeof suffix, ".%d.%zd", job_id_, i);
+    context.output_file_suffix = suffix;
     if (state.start != nullptr) {
       context.has_start = true;
       context.start = *state.start;
@@ -818,9 +870,10 @@ Status CompactionJob::Run() {
       context.has_end = false;
       context.end.clear();
     }
-    results_fn.emplace_back(dispatcher->StartCompaction(context));
+    results_fn.emplace_back(dispatcher_->StartCompaction(context));
   }
-  Status status = Status::Corruption();
+  // Wait for all subcompactions even if some failed, the first error wins
+  Status status;
   for (size_t i = 0; i < compact_->sub_compact_states.size(); ++i) {
     auto& sub_compact = compact_->sub_compact_states[i];
     CompactionWorkerResult result;
@@ -901,16 +954,14 @@ Status CompactionJob::Run() {
           sub_compact.actual_end = std::move(result.actual_end);
         }
       }
-      if (s.ok()) {
-        status = Status::OK();
-      } else {
+      if (!s.ok()) {
         ROCKS_LOG_ERROR(
             db_options_.info_log,
             "[%s] [JOB %d] remote sub_compact failed with status = %s",
             sub_compact.compaction->column_family_data()->GetName().c_str(),
             job_id_, s.ToString().c_str());
         LogFlush(db_options_.info_log);
-        if (!status.ok()) {
+        if (status.ok()) {
           status = s;
         }
       }
@@ -922,7 +973,7 @@ Status CompactionJob::Run() {
           sub_compact.compaction->column_family_data()->GetName().c_str(),
           job_id_, ex.what());
       LogFlush(db_options_.info_log);
-      if (!status.ok()) {
+      if (status.ok()) {
         status = Status::Corruption("remote sub_compact failed with exception",
                                     ex.what());
       }
@@ -946,17 +997,39 @@ Status CompactionJob::RunSelf() {
   assert(num_threads > 0);
   const uint64_t start_micros = env_->NowMicros();
 
+  // Charge the input readahead and output buffers of every subcompaction to
+  // the memory governor for the duration of the compaction.
+  MemoryGovernor* governor =
+      db_options_.write_buffer_manager != nullptr
+          ? db_options_.write_buffer_manager->memory_governor()
+          : nullptr;
+  size_t buffer_charge = 0;
+  if (governor != nullptr) {
+    buffer_charge =
+        num_threads *
+        (env_options_.compaction_readahead_size *
+             compact_->compaction->num_input_levels() +
+         env_options_.writable_file_max_buffer_size);
+    governor->Reserve(MemoryGovernor::kCompaction, buffer_charge);
+  }
+
   if (compact_->compaction->compaction_type() != kMapCompaction) {
     // map compact don't need multithreads
-    std::vector<ProcessArg> vec_process_arg(num_threads - 1);
-    for (size_t i = 0; i < num_threads - 1; i++) {
+    // Subcompactions formed for remote workers may outnumber the reserved
+    // background threads, the rest runs in this thread
+    size_t num_scheduled =
+        std::min(num_threads - 1, size_t(sub_compaction_slots_));
+    std::vector<ProcessArg> vec_process_arg(num_scheduled);
+    for (size_t i = 0; i < num_scheduled; i++) {
       vec_process_arg[i].job = this;
       vec_process_arg[i].task_id = int(i);
       vec_process_arg[i].future = vec_process_arg[i].finished.get_future();
       env_->Schedule(&CompactionJob::CallProcessCompaction, &vec_process_arg[i],
                      TERARKDB_NAMESPACE::Env::LOW, this, nullptr);
     }
-    ProcessCompaction(&compact_->sub_compact_states.back());
+    for (size_t i = num_scheduled; i < num_threads; i++) {
+      ProcessCompaction(&compact_->sub_compact_states[i]);
+    }
     for (auto& arg : vec_process_arg) {
       arg.future.wait();
     }
@@ -964,6 +1037,10 @@ Status CompactionJob::RunSelf() {
     assert(num_threads == 1);
   }
 
+  if (governor != nullptr) {
+    governor->Release(MemoryGovernor::kCompaction, buffer_charge);
+  }
+
   compaction_stats_.micros = env_->NowMicros() - start_micros;
   MeasureTime(stats_, COMPACTION_TIME, compaction_stats_.micros);
   TEST_SYNC_POINT("CompactionJob::Run:BeforeVerify");
@@ -1082,6 +1159,9 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
     cfd->internal_stats()->AddCompactionStats(
         compact_->compaction->output_level(), compaction_stats_);
   }
+  if (status.ok()) {
+    RecordKVSeparationStats();
+  }
 
   if (status.ok()) {
     status = InstallCompactionResults(mutable_cf_options);
@@ -1148,6 +1228,19 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
            << compaction_job_stats_->num_single_del_mismatch;
     stream << "num_single_delete_fallthrough"
            << compaction_job_stats_->num_single_del_fallthru;
+    stream << "num_output_records_separated"
+           << compaction_job_stats_->num_output_records_separated;
+    stream << "num_output_records_inline"
+           << compaction_job_stats_->num_output_records_inline;
+  }
+
+  if (compact_->compaction->mutable_cf_options()->enable_adaptive_blob_size) {
+    stream << "subcompaction_blob_size";
+    stream.StartArray();
+    for (auto& sc : compact_->sub_compact_states) {
+      stream << sc.blob_config.blob_size;
+    }
+    stream.EndArray();
   }
 
   if (measure_io_stats_ && compaction_job_stats_ != nullptr) {
@@ -1177,6 +1270,15 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
 }
 
 void CompactionJob::ProcessCompaction(SubcompactionState* sub_compact) {
+  // Subcompactions may run in threads of their own
+  IOOriginatorScope io_originator_scope(
+      CompactionIOOriginator(sub_compact->compaction));
+  IOSstTypeScope io_sst_type_scope(
+      sub_compact->compaction->compaction_type() == kGarbageCollection
+          ? kIOFileBlobSst
+          : kIOFileKeySst);
+  IOBottommostScope io_bottommost_scope(
+      sub_compact->compaction->bottommost_level());
   // SetThreadSched(kSchedIdle);
   switch (sub_compact->compaction->compaction_type()) {
     case kKeyValueCompaction:
@@ -1351,6 +1453,8 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
 
   const Slice* start = sub_compact->start;
   const Slice* end = sub_compact->end;
+  sub_compact->blob_config =
+      sub_compact->compaction->GetBlobConfig(start, end);
   if (start != nullptr) {
     sub_compact->actual_start.SetMinPossibleForUserKey(*start);
     input->Seek(sub_compact->actual_start.Encode());
@@ -1366,7 +1470,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       versions_->LastSequence(), &existing_snapshots_,
       earliest_write_conflict_snapshot_, snapshot_checker_, env_,
       ShouldReportDetailedTime(env_, stats_), false, &range_del_agg,
-      sub_compact->compaction, mutable_cf_options->get_blob_config(),
+      sub_compact->compaction, sub_compact->blob_config,
       compaction_filter, shutting_down_, preserve_deletes_seqnum_));
   auto c_iter = sub_compact->c_iter.get();
   c_iter->SeekToFirst();
@@ -1419,7 +1523,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
         cfd->user_comparator(), merge_ptr, versions_->LastSequence(),
         &existing_snapshots_, earliest_write_conflict_snapshot_,
         snapshot_checker_, env_, false, false, range_del_agg_ptr,
-        sub_compact->compaction, mutable_cf_options->get_blob_config(),
+        sub_compact->compaction, sub_compact->blob_config,
         second_pass_iter_storage.compaction_filter, shutting_down_,
         preserve_deletes_seqnum_);
   };
@@ -1636,6 +1740,10 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       c_iter_stats.total_input_raw_key_bytes;
   sub_compact->compaction_job_stats.total_input_raw_value_bytes +=
       c_iter_stats.total_input_raw_value_bytes;
+  sub_compact->compaction_job_stats.num_output_records_separated +=
+      c_iter_stats.num_output_value_separated;
+  sub_compact->compaction_job_stats.num_output_records_inline +=
+      c_iter_stats.num_output_value_inline;
 
   RecordTick(stats_, FILTER_OPERATION_TOTAL_TIME,
              c_iter_stats.total_filter_time);
@@ -1953,6 +2061,10 @@ void CompactionJob::RecordDroppedKeys(
     RecordTick(stats_, COMPACTION_KEY_DROP_RANGE_DEL,
                c_iter_stats.num_record_drop_range_del);
   }
+  if (c_iter_stats.num_range_del_skip > 0) {
+    RecordTick(stats_, COMPACTION_RANGE_DEL_SKIP,
+               c_iter_stats.num_range_del_skip);
+  }
   if (c_iter_stats.num_range_del_drop_obsolete > 0) {
     RecordTick(stats_, COMPACTION_RANGE_DEL_DROP_OBSOLETE,
                c_iter_stats.num_range_del_drop_obsolete);
@@ -2320,6 +2432,7 @@ Status CompactionJob::InstallCompactionResults(
   db_mutex_->AssertHeld();
 
   Compaction* compaction = compact_->compaction;
+  IOOriginatorScope io_originator_scope(CompactionIOOriginator(compaction));
   // paranoia: verify that the files that we started with
   // still exist in the current version and in the same original level.
   // This ensures that a concurrent compaction did not erroneously
@@ -2386,6 +2499,8 @@ Status CompactionJob::InstallCompactionResults(
       return s;
     }
     for (auto& o : output) {
+      cfd->internal_stats()->AddCFStats(InternalStats::MAP_BYTES_WRITTEN,
+                                        o.file_meta.fd.GetFileSize());
       compact_->sub_compact_states[0].outputs.emplace_back();
       auto current = compact_->sub_compact_states[0].current_output();
       current->meta = std::move(o.file_meta);
@@ -2461,6 +2576,8 @@ Status CompactionJob::InstallCompactionResults(
       return s;
     }
     if (file_meta.fd.file_size > 0) {
+      cfd->internal_stats()->AddCFStats(InternalStats::MAP_BYTES_WRITTEN,
+                                        file_meta.fd.GetFileSize());
       compact_->sub_compact_states[0].outputs.emplace_back();
       auto current = compact_->sub_compact_states[0].current_output();
       current->meta = std::move(file_meta);
@@ -2594,6 +2711,10 @@ Status CompactionJob::OpenCompactionOutputFile(
   sub_compact->outfile.reset(
       new WritableFileWriter(std::move(writable_file), fname, env_options_,
                              db_options_.statistics.get(), listeners));
+  sub_compact->outfile->set_io_file_type(
+      sub_compact->compaction->compaction_type() == kGarbageCollection
+          ? kIOFileBlobSst
+          : kIOFileKeySst);
 
   // If the Column family flag is to only optimize filters for hits,
   // we can skip creating filters if this is the bottommost_level where
@@ -2689,6 +2810,7 @@ Status CompactionJob::OpenCompactionOutputBlob(
   sub_compact->blob_outfile.reset(
       new WritableFileWriter(std::move(writable_file), fname, env_options_,
                              db_options_.statistics.get(), listeners));
+  sub_compact->blob_outfile->set_io_file_type(kIOFileBlobSst);
 
   uint64_t output_file_creation_time =
       sub_compact->compaction->MaxInputFileCreationTime();
@@ -2816,6 +2938,33 @@ void CompactionJob::UpdateCompactionInputStatsHelper(int* num_files,
   }
 }
 
+void CompactionJob::RecordKVSeparationStats() {
+  db_mutex_->AssertHeld();
+  const Compaction* compaction = compact_->compaction;
+  auto internal_stats = compaction->column_family_data()->internal_stats();
+  bool is_gc = compaction->compaction_type() == kGarbageCollection;
+  for (const auto& sub_compact : compact_->sub_compact_states) {
+    for (const auto& out : sub_compact.outputs) {
+      internal_stats->AddCFStats(InternalStats::COMPACTION_KEY_BYTES_WRITTEN,
+                                 out.meta.fd.GetFileSize());
+    }
+    for (const auto& out : sub_compact.blob_outputs) {
+      internal_stats->AddCFStats(
+          is_gc ? InternalStats::GC_BLOB_BYTES_WRITTEN
+                : InternalStats::COMPACTION_BLOB_BYTES_WRITTEN,
+          out.meta.fd.GetFileSize());
+    }
+  }
+  if (is_gc) {
+    for (auto& level : *compaction->inputs()) {
+      for (auto f : level.files) {
+        internal_stats->AddCFStats(InternalStats::GC_BLOB_BYTES_READ,
+                                   f->fd.GetFileSize());
+      }
+    }
+  }
+}
+
 void CompactionJob::UpdateCompactionJobStats(
     const InternalStats::CompactionStats& stats) const {
 #ifndef ROCKSDB_LITE
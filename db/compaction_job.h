@@ -55,6 +55,7 @@
 namespace TERARKDB_NAMESPACE {
 
 class Arena;
+class CompactionDispatcher;
 class ErrorHandler;
 class MemTable;
 class SnapshotChecker;
@@ -89,6 +90,8 @@ class CompactionJob {
   CompactionJob& operator=(const CompactionJob& job) = delete;
 
   // REQUIRED: mutex held
+  // Returns the number of extra background threads the job will occupy,
+  // subcompactions dispatched to remote workers don't count
   int Prepare(int sub_compaction_slots);
   // REQUIRED mutex not held
   Status Run();
@@ -145,6 +148,9 @@ class CompactionJob {
   void UpdateCompactionStats();
   void UpdateCompactionInputStatsHelper(int* num_files, uint64_t* bytes_read,
                                         int input_level);
+  // Adds the key and blob ssts this job wrote to the KV separation stats of
+  // the column family. Map ssts are added as they are built.
+  void RecordKVSeparationStats();
 
   void LogCompaction();
 
@@ -198,6 +204,13 @@ class CompactionJob {
   // Stores the approx size of keys covered in the range of each subcompaction
   std::vector<uint64_t> sizes_;
   Env::WriteLifeTimeHint write_hint_;
+  // Non null if the compaction will be sent to remote workers
+  CompactionDispatcher* dispatcher_;
+  // Background threads reserved by Prepare() for RunSelf()
+  int sub_compaction_slots_;
 };
 
+extern const char* GetCompactionReasonString(
+    CompactionReason compaction_reason);
+
 }  // namespace TERARKDB_NAMESPACE
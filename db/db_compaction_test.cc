@@ -502,6 +502,173 @@ TEST_P(DBCompactionTestWithParam, CompactionsPreserveDeletes) {
   }
 }
 
+TEST_F(DBCompactionTest, AdaptiveBlobSizeStats) {
+  class SeparationStatsCollector : public EventListener {
+   public:
+    void OnCompactionCompleted(DB* /*db*/,
+                               const CompactionJobInfo& ci) override {
+      num_separated += ci.stats.num_output_records_separated;
+      num_inline += ci.stats.num_output_records_inline;
+    }
+
+    std::atomic<uint64_t> num_separated{0};
+    std::atomic<uint64_t> num_inline{0};
+  };
+  auto collector = std::make_shared<SeparationStatsCollector>();
+
+  Options options = CurrentOptions();
+  options.blob_size = 512;
+  options.enable_adaptive_blob_size = true;
+  options.enable_lazy_compaction = false;
+  options.disable_auto_compactions = true;
+  options.listeners.push_back(collector);
+  DestroyAndReopen(options);
+
+  for (int j = 0; j < 2; ++j) {
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_OK(Put(Key(i), std::string(i % 2 ? 1024 : 64, 'a' + j)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+  // Without sampled reads or blob garbage the adaptive blob_size falls back to
+  // blob_size
+  ASSERT_EQ(50, collector->num_separated.load());
+  ASSERT_EQ(50, collector->num_inline.load());
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(std::string(i % 2 ? 1024 : 64, 'b'), Get(Key(i)));
+  }
+}
+
+TEST_F(DBCompactionTest, AdaptiveBlobSizeHotAndColdRanges) {
+  class SeparationStatsCollector : public EventListener {
+   public:
+    void OnCompactionCompleted(DB* /*db*/,
+                               const CompactionJobInfo& ci) override {
+      std::lock_guard<std::mutex> lock(mutex);
+      stats.emplace_back(ci.stats.num_output_records_separated,
+                         ci.stats.num_output_records_inline);
+    }
+
+    std::mutex mutex;
+    std::vector<std::pair<uint64_t, uint64_t>> stats;
+  };
+  auto collector = std::make_shared<SeparationStatsCollector>();
+
+  Options options = CurrentOptions();
+  options.blob_size = 512;
+  options.enable_adaptive_blob_size = true;
+  options.enable_lazy_compaction = false;
+  options.disable_auto_compactions = true;
+  options.listeners.push_back(collector);
+  DestroyAndReopen(options);
+
+  // Two L0 files over disjoint ranges, the values are below blob_size
+  const std::string value(300, 'v');
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_OK(Put(Key(i), value));
+    if (i % 100 == 99) {
+      ASSERT_OK(Flush());
+    }
+  }
+  ColumnFamilyMetaData cf_meta;
+  db_->GetColumnFamilyMetaData(&cf_meta);
+  ASSERT_EQ(2U, cf_meta.levels[0].files.size());
+  std::string hot_file, cold_file;
+  for (auto& file : cf_meta.levels[0].files) {
+    (file.smallestkey == Key(0) ? hot_file : cold_file) = file.name;
+  }
+
+  // Only the first range is read
+  auto cfd = static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())
+                 ->cfd();
+  for (auto f : cfd->current()->storage_info()->LevelFiles(0)) {
+    if (f->smallest.user_key() == Key(0)) {
+      f->stats.num_reads_sampled.store(1000);
+    }
+  }
+
+  // The cold range scales blob_size down to 128, its values are separated
+  ASSERT_OK(db_->CompactFiles(CompactionOptions(), {cold_file}, 1));
+  // The hot range scales it up to 1024, its values stay inline
+  ASSERT_OK(db_->CompactFiles(CompactionOptions(), {hot_file}, 1));
+
+  ASSERT_EQ(2U, collector->stats.size());
+  ASSERT_EQ(100U, collector->stats[0].first);
+  ASSERT_EQ(0U, collector->stats[0].second);
+  ASSERT_EQ(0U, collector->stats[1].first);
+  ASSERT_EQ(100U, collector->stats[1].second);
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_EQ(value, Get(Key(i)));
+  }
+}
+
+TEST_F(DBCompactionTest, RemoteSubcompactionDispatch) {
+  class RecordingDispatcher : public CompactionDispatcher {
+   public:
+    std::function<CompactionWorkerResult()> StartCompaction(
+        const CompactionWorkerContext& context) override {
+      // The suffix is ".<job id>.<subcompaction index>"
+      const std::string& suffix = context.output_file_suffix;
+      std::lock_guard<std::mutex> lock(mutex);
+      ++subcompactions[suffix.substr(0, suffix.rfind('.'))];
+      return [] {
+        CompactionWorkerResult result;
+        result.status = Status::Aborted("RecordingDispatcher");
+        return result;
+      };
+    }
+
+    const char* Name() const override { return "RecordingDispatcher"; }
+
+    std::mutex mutex;
+    std::map<std::string, int> subcompactions;
+  };
+  auto dispatcher = std::make_shared<RecordingDispatcher>();
+
+  Options options = CurrentOptions();
+  options.enable_lazy_compaction = false;
+  options.disable_auto_compactions = true;
+  options.target_file_size_base = 16 << 10;
+  options.max_bytes_for_level_base = 8 << 10;
+  options.max_bytes_for_level_multiplier = 20;
+  options.max_subcompactions = 4;
+  // The aborted compaction stops background work instead of being retried
+  options.paranoid_checks = true;
+  DestroyAndReopen(options);
+
+  // Four L2 files and one L1 file spanning all of them
+  Random rnd(301);
+  for (int f = 0; f < 4; ++f) {
+    for (int i = 0; i < 25; ++i) {
+      ASSERT_OK(Put(Key(f * 25 + i), RandomString(&rnd, 1000)));
+    }
+    ASSERT_OK(Flush());
+  }
+  MoveFilesToLevel(2);
+  for (int i = 0; i < 100; i += 4) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 1000)));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  ASSERT_EQ("0,1,4", FilesPerLevel());
+
+  // L1 is over its target, so an automatic L1 -> L2 compaction is picked.
+  // Run locally it would not be split, being neither manual nor from L0.
+  // Dispatched, each subcompaction is a separate worker request.
+  options.disable_auto_compactions = false;
+  options.compaction_dispatcher = dispatcher;
+  Reopen(options);
+  dbfull()->TEST_WaitForCompact();
+
+  std::lock_guard<std::mutex> lock(dispatcher->mutex);
+  ASSERT_EQ(1U, dispatcher->subcompactions.size());
+  ASSERT_GT(dispatcher->subcompactions.begin()->second, 1);
+  ASSERT_LE(dispatcher->subcompactions.begin()->second,
+            static_cast<int>(options.max_subcompactions));
+}
+
 TEST_F(DBCompactionTest, SkipStatsUpdateTest) {
   // This test verify UpdateAccumulatedStats is not on
   // if options.skip_stats_update_on_db_open = true
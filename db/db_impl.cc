@@ -45,6 +45,7 @@
 #include "db/table_cache.h"
 #include "db/version_set.h"
 #include "db/write_batch_internal.h"
+#include "monitoring/file_io_stats.h"
 #include "monitoring/in_memory_stats_history.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
@@ -207,6 +208,7 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       write_thread_(immutable_db_options_),
       nonmem_write_thread_(immutable_db_options_),
       write_controller_(mutable_db_options_.delayed_write_rate),
+      op_tracer_(env_, mutable_db_options_.op_trace_sample_rate),
       // Use delayed_write_rate as a base line to determine the initial
       // low pri write rate limit. It may be adjusted later.
       low_pri_write_rate_limiter_(NewGenericRateLimiter(std::min(
@@ -803,15 +805,28 @@ void DBImpl::PersistStats() {
   if (!statistics) {
     return;
   }
+  std::map<std::string, uint64_t> stats_map;
+  if (!statistics->getTickerMap(&stats_map)) {
+    return;
+  }
+
   size_t stats_history_size_limit = 0;
   {
     InstrumentedMutexLock l(&mutex_);
     stats_history_size_limit = mutable_db_options_.stats_history_buffer_size;
-  }
-
-  std::map<std::string, uint64_t> stats_map;
-  if (!statistics->getTickerMap(&stats_map)) {
-    return;
+    // KV separation writes are kept per column family
+    std::map<std::string, uint64_t> cf_stats_map;
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (!cfd->initialized()) {
+        continue;
+      }
+      cf_stats_map.clear();
+      cfd->internal_stats()->GetKVSeparationWriteStats(&cf_stats_map);
+      for (const auto& stat : cf_stats_map) {
+        stats_map["rocksdb." + cfd->GetName() + "." + stat.first] =
+            stat.second;
+      }
+    }
   }
 
   if (immutable_db_options_.persist_stats_to_disk) {
@@ -1042,6 +1057,11 @@ void DBImpl::DumpStats() {
       ROCKS_LOG_WARN(immutable_db_options_.info_log, "%s", stats.c_str());
     }
   }
+  stats.clear();
+  DumpFileIOStats(&stats);
+  ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                 "------- FILE IO STATS -------");
+  ROCKS_LOG_WARN(immutable_db_options_.info_log, "%s", stats.c_str());
 #endif  // !ROCKSDB_LITE
 
   PrintStatistics();
@@ -1206,6 +1226,7 @@ Status DBImpl::SetDBOptions(
       }
       write_controller_.set_max_delayed_write_rate(
           new_options.delayed_write_rate);
+      op_tracer_.SetSampleRate(new_options.op_trace_sample_rate);
       table_cache_.get()->SetCapacity(new_options.max_open_files == -1
                                           ? TableCache::kInfiniteCapacity
                                           : new_options.max_open_files - 10);
@@ -1643,6 +1664,8 @@ Status DBImpl::GetImpl(const ReadOptions& read_options,
                        ReadCallback* callback) {
   LatencyHistGuard guard(&read_latency_reporter_);
   read_qps_reporter_.AddCount(1);
+  OpTraceScope trace_scope(&op_tracer_, OpTraceType::kGet);
+  IOOriginatorScope io_originator_scope(kIOOriginatorUserGet);
 
   assert(lazy_val != nullptr);
   StopWatch sw(env_, stats_, DB_GET);
@@ -1856,6 +1879,7 @@ std::vector<Status> DBImpl::MultiGet(
     const std::vector<Slice>& keys, std::vector<std::string>* values) {
   LatencyHistGuard guard(&read_latency_reporter_);
   read_qps_reporter_.AddCount(keys.size());
+  IOOriginatorScope io_originator_scope(kIOOriginatorUserGet);
   StopWatch sw(env_, stats_, DB_MULTIGET);
   PERF_TIMER_GUARD(get_snapshot_time);
 
@@ -2698,6 +2722,69 @@ bool DBImpl::GetPropertyHandleOptionsStatistics(std::string* value) {
   return true;
 }
 
+bool DBImpl::GetPropertyHandleOpTraces(std::string* value) {
+  assert(value != nullptr);
+  op_tracer_.Dump(value);
+  return true;
+}
+
+bool DBImpl::GetPropertyHandleMemoryBreakdown(std::string* value) {
+  assert(value != nullptr);
+  uint64_t memtables = 0;
+  uint64_t table_readers = 0;
+  uint64_t block_cache_usage = 0;
+  uint64_t block_cache_pinned_usage = 0;
+  bool has_block_cache = false;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto* cfd : *versions_->GetColumnFamilySet()) {
+      if (!cfd->initialized() || cfd->IsDropped()) {
+        continue;
+      }
+      uint64_t tmp = 0;
+      if (GetIntPropertyInternal(
+              cfd,
+              *GetPropertyInfo(DB::Properties::kCurSizeAllMemTables),
+              true /* is_locked */, &tmp)) {
+        memtables += tmp;
+      }
+      if (GetIntPropertyInternal(
+              cfd,
+              *GetPropertyInfo(DB::Properties::kEstimateTableReadersMem),
+              true /* is_locked */, &tmp)) {
+        table_readers += tmp;
+      }
+    }
+    // Column families usually share one block cache, report the default one
+    auto* default_cfd = default_cf_handle_->cfd();
+    has_block_cache =
+        GetIntPropertyInternal(
+            default_cfd, *GetPropertyInfo(DB::Properties::kBlockCacheUsage),
+            true /* is_locked */, &block_cache_usage) &&
+        GetIntPropertyInternal(
+            default_cfd,
+            *GetPropertyInfo(DB::Properties::kBlockCachePinnedUsage),
+            true /* is_locked */, &block_cache_pinned_usage);
+  }
+
+  char buf[128];
+  snprintf(buf, sizeof(buf), "memtables: %" PRIu64 "\n", memtables);
+  value->append(buf);
+  snprintf(buf, sizeof(buf), "table-readers: %" PRIu64 "\n", table_readers);
+  value->append(buf);
+  if (has_block_cache) {
+    snprintf(buf, sizeof(buf),
+             "block-cache: %" PRIu64 "\nblock-cache-pinned: %" PRIu64 "\n",
+             block_cache_usage, block_cache_pinned_usage);
+    value->append(buf);
+  }
+  MemoryGovernor* governor = write_buffer_manager_->memory_governor();
+  if (governor != nullptr) {
+    value->append(governor->GetBreakdown());
+  }
+  return true;
+}
+
 #ifndef ROCKSDB_LITE
 Status DBImpl::ResetStats() {
   InstrumentedMutexLock l(&mutex_);
@@ -41,6 +41,7 @@
 #include "db/write_thread.h"
 #include "memtable_list.h"
 #include "monitoring/instrumented_mutex.h"
+#include "monitoring/op_tracer.h"
 #include "options/db_options.h"
 #include "port/port.h"
 #include "rocksdb/db.h"
@@ -550,6 +551,8 @@ class DBImpl : public DB {
     return immutable_db_options_;
   }
 
+  OpTracer* op_tracer() { return &op_tracer_; }
+
   void CancelAllBackgroundWork(bool wait);
 
   // Find Super version and reference it. Based on options, it might return
@@ -1468,6 +1471,9 @@ class DBImpl : public DB {
 
   WriteController write_controller_;
 
+  // Samples Get, Seek and Write calls for the "rocksdb.op-traces" property
+  OpTracer op_tracer_;
+
   std::unique_ptr<RateLimiter> low_pri_write_rate_limiter_;
 
   // Size of the last batch group. In slowdown mode, next write needs to
@@ -1726,6 +1732,8 @@ class DBImpl : public DB {
                               const DBPropertyInfo& property_info,
                               bool is_locked, uint64_t* value);
   bool GetPropertyHandleOptionsStatistics(std::string* value);
+  bool GetPropertyHandleOpTraces(std::string* value);
+  bool GetPropertyHandleMemoryBreakdown(std::string* value);
 
   bool HasPendingManualCompaction();
   bool HasExclusiveManualCompaction();
@@ -1864,6 +1864,19 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     return;
   }
 
+  MemoryGovernor* governor = write_buffer_manager_->memory_governor();
+  if (governor != nullptr && governor->MemTablesOverBudget() &&
+      unscheduled_flushes_ + bg_flush_scheduled_ > 0 &&
+      !write_controller_.NeedsDelay() && !write_controller_.IsStopped()) {
+    // Memory is over budget because of memtables. Flushes release memtable
+    // memory, while compactions and garbage collections need buffers, so
+    // hold them back until the pending flushes are done. Never do so once
+    // writes are slowed down, e.g. by too many L0 files, as only
+    // compactions can lift that.
+    TEST_SYNC_POINT("DBImpl::MaybeScheduleFlushOrCompaction:MemoryPressure");
+    return;
+  }
+
   while (bg_garbage_collection_scheduled_ <
              bg_job_limits.max_garbage_collections &&
          unscheduled_garbage_collections_ > 0) {
@@ -15,6 +15,7 @@
 
 #include "db/error_handler.h"
 #include "db/event_helpers.h"
+#include "monitoring/file_io_stats.h"
 #include "monitoring/perf_context_imp.h"
 #include "options/options_helper.h"
 #include "rocksdb/metrics_reporter.h"
@@ -80,6 +81,8 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   write_qps_reporter_.AddCount(WriteBatchInternal::Count(my_batch));
   write_throughput_reporter_.AddCount(WriteBatchInternal::ByteSize(my_batch));
   write_batch_size_reporter_.AddRecord(WriteBatchInternal::ByteSize(my_batch));
+  OpTraceScope trace_scope(&op_tracer_, OpTraceType::kWrite);
+  IOOriginatorScope io_originator_scope(kIOOriginatorUserWrite);
 
   assert(!seq_per_batch_ || batch_cnt != 0);
   if (my_batch == nullptr) {
@@ -897,6 +900,7 @@ Status DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
 
   if (status.ok() && need_log_sync) {
     StopWatch sw(env_, stats_, WAL_FILE_SYNC_MICROS);
+    PERF_TIMER_GUARD(write_wal_sync_time);
     // It's safe to access logs_ with unlocked mutex_ here because:
     //  - we've set getting_synced=true for all logs,
     //    so other threads won't pop from logs_ while we're here,
@@ -17,6 +17,7 @@
 #include "db/forward_iterator.h"
 #include "db/merge_context.h"
 #include "db/merge_helper.h"
+#include "monitoring/file_io_stats.h"
 #include "monitoring/perf_context_imp.h"
 #include "rocksdb/env.h"
 #include "rocksdb/iterator.h"
@@ -191,6 +192,7 @@ class DBIter final : public Iterator {
   }
   virtual Slice value() const override {
     assert(valid_);
+    IOOriginatorScope io_originator_scope(kIOOriginatorUserScan);
     auto s = value_.fetch();
     if (!s.ok()) {
       valid_ = false;
@@ -350,6 +352,7 @@ inline bool DBIter::ParseKey(ParsedInternalKey* ikey) {
 static std::string metrics_test_dbname = "metrics_test_dbname";
 
 void DBIter::Next() {
+  IOOriginatorScope io_originator_scope(kIOOriginatorUserScan);
   static const std::string metric_name = "dbiter_next";
   LatencyHistGuard guard(db_impl_ == nullptr
                              ? nullptr
@@ -682,6 +685,7 @@ bool DBIter::MergeValuesNewToOld() {
 }
 
 void DBIter::Prev() {
+  IOOriginatorScope io_originator_scope(kIOOriginatorUserScan);
   static const std::string metric_name = "dbiter_prev";
   LatencyHistGuard guard(db_impl_ == nullptr
                              ? nullptr
@@ -1182,10 +1186,13 @@ SequenceNumber DBIter::MaxVisibleSequenceNumber() {
 
 static const std::string seek_metric_name = "dbiter_seek";
 void DBIter::Seek(const Slice& target) {
+  IOOriginatorScope io_originator_scope(kIOOriginatorUserScan);
   LatencyHistGuard guard(db_impl_ == nullptr
                              ? nullptr
                              : (db_impl_->seek_qps_reporter().AddCount(1),
                                 &db_impl_->seek_latency_reporter()));
+  OpTraceScope trace_scope(
+      db_impl_ == nullptr ? nullptr : db_impl_->op_tracer(), OpTraceType::kSeek);
 
   StopWatch sw(env_, statistics_, DB_SEEK);
   status_ = Status::OK();
@@ -1246,6 +1253,7 @@ void DBIter::Seek(const Slice& target) {
 
 static const std::string seekforprev_metric_name = "dbiter_seekforprev";
 void DBIter::SeekForPrev(const Slice& target) {
+  IOOriginatorScope io_originator_scope(kIOOriginatorUserScan);
   LatencyHistGuard guard(
       db_impl_ == nullptr ? nullptr
                           : (db_impl_->seekforprev_qps_reporter().AddCount(1),
@@ -1308,6 +1316,7 @@ void DBIter::SeekForPrev(const Slice& target) {
 }
 
 void DBIter::SeekToFirst() {
+  IOOriginatorScope io_originator_scope(kIOOriginatorUserScan);
   LatencyHistGuard guard(db_impl_ == nullptr
                              ? nullptr
                              : (db_impl_->seek_qps_reporter().AddCount(1),
@@ -1356,6 +1365,7 @@ void DBIter::SeekToFirst() {
 }
 
 void DBIter::SeekToLast() {
+  IOOriginatorScope io_originator_scope(kIOOriginatorUserScan);
   LatencyHistGuard guard(
       db_impl_ == nullptr ? nullptr
                           : (db_impl_->seekforprev_qps_reporter().AddCount(1),
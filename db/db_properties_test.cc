@@ -13,6 +13,7 @@
 #include <string>
 
 #include "db/db_test_util.h"
+#include "monitoring/file_io_stats.h"
 #include "port/stack_trace.h"
 #include "rocksdb/listener.h"
 #include "rocksdb/options.h"
@@ -1698,6 +1699,171 @@ TEST_F(DBPropertiesTest, BlockCacheProperties) {
   ASSERT_EQ(0, value);
 }
 
+TEST_F(DBPropertiesTest, BlockCacheHotKeys) {
+  Options options = CurrentOptions();
+  std::string value;
+
+  BlockBasedTableOptions table_options;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  ASSERT_FALSE(db_->GetProperty(DB::Properties::kBlockCacheHotKeys, &value));
+
+  table_options.no_block_cache = false;
+  table_options.block_cache = NewLRUCache(8 << 20, 0 /*num_shard_bits*/);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  ASSERT_OK(Put("hot", "value"));
+  ASSERT_OK(Flush());
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(1U, files.size());
+
+  for (int i = 0; i < 10000; ++i) {
+    ASSERT_EQ("value", Get("hot"));
+  }
+  std::vector<CacheHotKey> hot_keys;
+  table_options.block_cache->GetHotKeys(&hot_keys);
+  ASSERT_FALSE(hot_keys.empty());
+  ASSERT_EQ(files[0].name, MakeTableFileName("", hot_keys[0].file_number));
+  ASSERT_STREQ("data", hot_keys[0].block_type);
+  // accesses are sampled
+  ASSERT_GE(hot_keys[0].count, 5000U);
+
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kBlockCacheHotKeys, &value));
+  ASSERT_NE(std::string::npos, value.find("Block Cache Hot Keys"));
+  ASSERT_NE(std::string::npos,
+            value.find(" " + ToString(hot_keys[0].file_number) + "  data "));
+}
+
+TEST_F(DBPropertiesTest, OpTraces) {
+  Options options = CurrentOptions();
+  Reopen(options);
+  SetPerfLevel(kEnableCount);
+  std::string value;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kOpTraces, &value));
+  ASSERT_NE(std::string::npos, value.find("Op Traces"));
+  ASSERT_EQ(std::string::npos, value.find("\nWrite "));
+
+  ASSERT_OK(dbfull()->SetDBOptions({{"op_trace_sample_rate", "1"}}));
+  ASSERT_OK(Put("foo", "bar"));
+  ASSERT_OK(Flush());
+  get_perf_context()->Reset();
+  ASSERT_EQ("bar", Get("foo"));
+  // the caller collects counts only, tracing must not add times
+  ASSERT_EQ(1U, get_perf_context()->get_from_table_count);
+  ASSERT_EQ(0U, get_perf_context()->get_from_output_files_time);
+  {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    iter->Seek("foo");
+    ASSERT_TRUE(iter->Valid());
+  }
+  // tracing must not change the perf level of the caller
+  ASSERT_EQ(kEnableCount, GetPerfLevel());
+
+  value.clear();
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kOpTraces, &value));
+  ASSERT_NE(std::string::npos, value.find("\nWrite "));
+  ASSERT_NE(std::string::npos, value.find("\nGet "));
+  ASSERT_NE(std::string::npos, value.find("\nSeek "));
+
+  std::vector<OpTraceRecord> records;
+  dbfull()->op_tracer()->GetRecords(&records);
+  ASSERT_EQ(3U, records.size());
+  ASSERT_EQ(OpTraceType::kWrite, records[0].type);
+  ASSERT_EQ(OpTraceType::kGet, records[1].type);
+  ASSERT_EQ(1U, records[1].sst_count);
+  ASSERT_EQ(OpTraceType::kSeek, records[2].type);
+  ASSERT_GT(records[2].total_nanos, 0U);
+
+  // the caller collects nothing, its counters are left as they were
+  SetPerfLevel(kDisable);
+  get_perf_context()->Reset();
+  ASSERT_EQ("bar", Get("foo"));
+  ASSERT_EQ(kDisable, GetPerfLevel());
+  ASSERT_EQ(0U, get_perf_context()->get_from_table_count);
+  ASSERT_EQ(0U, get_perf_context()->get_from_output_files_time);
+  records.clear();
+  dbfull()->op_tracer()->GetRecords(&records);
+  ASSERT_EQ(4U, records.size());
+  ASSERT_EQ(OpTraceType::kGet, records[3].type);
+  ASSERT_EQ(1U, records[3].sst_count);
+
+  ASSERT_OK(dbfull()->SetDBOptions({{"op_trace_sample_rate", "0"}}));
+  ASSERT_EQ("bar", Get("foo"));
+  records.clear();
+  dbfull()->op_tracer()->GetRecords(&records);
+  ASSERT_EQ(4U, records.size());
+}
+
+TEST_F(DBPropertiesTest, FileIOStats) {
+  Options options = CurrentOptions();
+  Reopen(options);
+  // the counters are process wide, only look at what this test adds
+  FileIOCounters wal_before, flush_before, get_before;
+  GetFileIOCounters(kIOOriginatorUserWrite, kIOFileWal, &wal_before);
+  GetFileIOCounters(kIOOriginatorFlush, kIOFileKeySst, &flush_before);
+  GetFileIOCounters(kIOOriginatorUserGet, kIOFileKeySst, &get_before);
+
+  ASSERT_OK(Put("foo", "bar"));
+  ASSERT_OK(Flush());
+  // drop the table cache so Get() has to read the table
+  Reopen(options);
+  ASSERT_EQ("bar", Get("foo"));
+
+  FileIOCounters counters;
+  GetFileIOCounters(kIOOriginatorUserWrite, kIOFileWal, &counters);
+  ASSERT_GT(counters.write_bytes, wal_before.write_bytes);
+  ASSERT_GT(counters.writes, wal_before.writes);
+  GetFileIOCounters(kIOOriginatorFlush, kIOFileKeySst, &counters);
+  ASSERT_GT(counters.write_bytes, flush_before.write_bytes);
+  GetFileIOCounters(kIOOriginatorUserGet, kIOFileKeySst, &counters);
+  ASSERT_GT(counters.read_bytes, get_before.read_bytes);
+  ASSERT_GT(counters.reads, get_before.reads);
+
+  std::string value;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kFileIOStats, &value));
+  ASSERT_NE(std::string::npos, value.find("File IO Stats"));
+  ASSERT_NE(std::string::npos, value.find("UserWrite"));
+  ASSERT_NE(std::string::npos, value.find("Flush"));
+}
+
+TEST_F(DBPropertiesTest, KVSeparationStats) {
+  Options options = CurrentOptions();
+  options.blob_size = 64;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+  Random rnd(301);
+  for (int i = 0; i < 16; ++i) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 256)));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 16; ++i) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 256)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+  std::map<std::string, std::string> stats;
+  ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kCFStats, &stats));
+  ASSERT_GT(std::stoull(stats["kv_separation.flush.key.write.bytes"]), 0);
+  ASSERT_GT(std::stoull(stats["kv_separation.flush.blob.write.bytes"]), 0);
+  // lazy compaction may only write a map sst
+  ASSERT_GT(std::stoull(stats["kv_separation.compaction.key.write.bytes"]) +
+                std::stoull(stats["kv_separation.map.write.bytes"]),
+            0);
+  uint64_t blob_bytes = std::stoull(stats["kv_separation.blob.bytes"]);
+  ASSERT_GT(blob_bytes, 0);
+  ASSERT_LE(std::stoull(stats["kv_separation.blob.garbage.bytes"]),
+            blob_bytes);
+  ASSERT_GE(std::stod(stats["kv_separation.space_amp"]), 1.0);
+
+  std::string value;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kCFStats, &value));
+  ASSERT_NE(std::string::npos, value.find("KV separation write(GB)"));
+  ASSERT_NE(std::string::npos, value.find("KV separation space(GB)"));
+}
+
 #endif  // ROCKSDB_LITE
 }  // namespace TERARKDB_NAMESPACE
 
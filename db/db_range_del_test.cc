@@ -676,6 +676,31 @@ TEST_F(DBRangeDelTest, GetCoveredKeyFromSst) {
   } while (ChangeOptions(kRangeDelSkipConfigs | kSkipHashCuckoo));
 }
 
+TEST_F(DBRangeDelTest, GetCoveredKeyFromSstWithSnapshot) {
+  DestroyAndReopen(CurrentOptions());
+  ASSERT_OK(db_->Put(WriteOptions(), "key", "val"));
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(
+      db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a", "z"));
+  ASSERT_OK(db_->Put(WriteOptions(), "other", "val"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  // A file without range deletions doesn't hide anything
+  ASSERT_OK(db_->Put(WriteOptions(), "zz", "val"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+
+  // The tombstone is read from the cached fragments of the table reader, and
+  // must respect the snapshot it is read at
+  ReadOptions read_opts;
+  std::string value;
+  ASSERT_TRUE(db_->Get(read_opts, "key", &value).IsNotFound());
+  ASSERT_OK(db_->Get(read_opts, "other", &value));
+  ASSERT_OK(db_->Get(read_opts, "zz", &value));
+  read_opts.snapshot = snapshot;
+  ASSERT_OK(db_->Get(read_opts, "key", &value));
+  ASSERT_EQ("val", value);
+  db_->ReleaseSnapshot(snapshot);
+}
+
 TEST_F(DBRangeDelTest, GetCoveredMergeOperandFromMemtable) {
   const int kNumMergeOps = 10;
   Options opts = CurrentOptions();
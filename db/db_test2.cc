@@ -471,6 +471,64 @@ TEST_F(DBTest2, TestWriteBufferNoLimitWithCache) {
   ASSERT_GT(cache->GetUsage(), 500000);
 }
 
+TEST_F(DBTest2, TestWriteBufferMemoryGovernor) {
+  Options options = CurrentOptions();
+  options.arena_block_size = 4096;
+  options.write_buffer_size = 10 << 20;  // this is never hit
+  options.disable_auto_compactions = true;
+  std::shared_ptr<Cache> cache = NewLRUCache(1 << 20, 0);
+  // 1MB in total, of which the block cache keeps at least 256KB
+  std::shared_ptr<MemoryGovernor> governor(
+      new MemoryGovernor(1 << 20, cache, 256 << 10));
+  options.write_buffer_manager.reset(
+      new WriteBufferManager(0, nullptr, governor));
+  Reopen(options);
+  Random rnd(301);
+
+  // Table readers alone exceed the budget, flushing memtables can't help
+  governor->Reserve(MemoryGovernor::kTableReader, 2 << 20);
+  ASSERT_TRUE(governor->UnderPressure());
+  ASSERT_FALSE(governor->MemTablesOverBudget());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 100)));
+  }
+  ASSERT_OK(dbfull()->TEST_WaitForFlushMemTable());
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  std::string breakdown;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kMemoryBreakdown, &breakdown));
+  ASSERT_NE(std::string::npos,
+            breakdown.find("governor-table-readers: 2097152"));
+  governor->Release(MemoryGovernor::kTableReader, 2 << 20);
+  ASSERT_FALSE(governor->UnderPressure());
+
+  // Memtables going over budget are flushed early
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 1000)));
+  }
+  ASSERT_OK(dbfull()->TEST_WaitForFlushMemTable());
+  ASSERT_GT(NumTableFilesAtLevel(0), 0);
+  ASSERT_LT(governor->GetUsage(MemoryGovernor::kMemTable), 768 << 10);
+  ASSERT_GT(governor->GetUsage(MemoryGovernor::kTableReader), 0);
+
+  // Table readers are charged while they are in the table cache, those of a
+  // dropped column family go away with its files
+  size_t table_reader_usage =
+      governor->GetUsage(MemoryGovernor::kTableReader);
+  CreateColumnFamilies({"pikachu"}, options);
+  ASSERT_OK(Put(1, "foo", "bar"));
+  ASSERT_OK(Flush(1));
+  ASSERT_GT(governor->GetUsage(MemoryGovernor::kTableReader),
+            table_reader_usage);
+  ASSERT_OK(db_->DropColumnFamily(handles_[1]));
+  ASSERT_OK(db_->DestroyColumnFamilyHandle(handles_[1]));
+  handles_.erase(handles_.begin() + 1);
+  ASSERT_EQ(table_reader_usage,
+            governor->GetUsage(MemoryGovernor::kTableReader));
+
+  Close();
+  ASSERT_EQ(0, governor->GetUsage(MemoryGovernor::kTableReader));
+}
+
 namespace {
 void ValidateKeyExistence(DB* db, const std::vector<Slice>& keys_must_exist,
                           const std::vector<Slice>& keys_must_not_exist) {
@@ -1714,6 +1772,51 @@ TEST_F(DBTest2, PersistentCache) {
     }
   }
 }
+
+TEST_F(DBTest2, PersistentCacheScanBypass) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  auto* cache = new MockPersistentCache(/*is_compressed=*/false,
+                                        /*max_size=*/64 * 1024 * 1024);
+  BlockBasedTableOptions table_options;
+  table_options.persistent_cache.reset(cache);
+  table_options.no_block_cache = true;
+  table_options.block_size = 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  const int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 100)));
+  }
+  ASSERT_OK(Flush());
+
+  auto cached_blocks = [&]() {
+    MutexLock _(&cache->lock_);
+    return cache->data_.size();
+  };
+
+  // a full scan turns on readahead after two data blocks and stops filling
+  // the persistent cache from then on
+  size_t before_scan = cached_blocks();
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys, count);
+  iter.reset();
+  ASSERT_LE(cached_blocks(), before_scan + 2);
+
+  // point lookups still fill it
+  size_t before_get = cached_blocks();
+  for (int i = 0; i < kNumKeys; i += 10) {
+    Get(Key(i));
+  }
+  ASSERT_GT(cached_blocks(), before_get + 50);
+}
 #endif  // !OS_SOLARIS
 
 namespace {
@@ -2695,6 +2798,108 @@ TEST_F(DBTest2, TraceAndReplay) {
   ASSERT_OK(DestroyDB(dbname2, options));
 }
 
+TEST_F(DBTest2, TraceAndMultiThreadReplay) {
+  Options options = CurrentOptions();
+  WriteOptions wo;
+  ReadOptions ro;
+  EnvOptions env_opts;
+  Reopen(options);
+
+  std::string trace_filename = dbname_ + "/rocksdb.trace_mt";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(NewFileTraceWriter(env_, env_opts, trace_filename, &trace_writer));
+  ASSERT_OK(db_->StartTrace(TraceOptions(), std::move(trace_writer)));
+  // Every key is overwritten several times, only the last value must survive
+  for (int round = 0; round < 5; ++round) {
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_OK(Put(Key(i), "v" + ToString(round)));
+      ASSERT_EQ("v" + ToString(round), Get(Key(i)));
+    }
+    // a batch spanning the keys of all shards
+    WriteBatch batch;
+    for (int i = 0; i < 100; i += 7) {
+      ASSERT_OK(batch.Put(Key(i), "b" + ToString(round)));
+    }
+    ASSERT_OK(db_->Write(wo, &batch));
+  }
+  ASSERT_OK(Delete(Key(1)));
+  ASSERT_OK(db_->EndTrace());
+
+  std::string dbname2 = test::TmpDir(env_) + "/db_replay_mt";
+  ASSERT_OK(DestroyDB(dbname2, options));
+  DB* db2 = nullptr;
+  options.create_if_missing = true;
+  ASSERT_OK(DB::Open(options, dbname2, &db2));
+
+  std::unique_ptr<TraceReader> trace_reader;
+  ASSERT_OK(NewFileTraceReader(env_, env_opts, trace_filename, &trace_reader));
+  Replayer replayer(db2, handles_, std::move(trace_reader));
+  ASSERT_OK(replayer.MultiThreadReplay(4, 0 /* fast_forward */));
+
+  std::string value;
+  for (int i = 0; i < 100; ++i) {
+    Status s = db2->Get(ro, Key(i), &value);
+    if (i == 1) {
+      ASSERT_TRUE(s.IsNotFound());
+    } else {
+      ASSERT_OK(s);
+      ASSERT_EQ(i % 7 == 0 ? "b4" : "v4", value);
+    }
+  }
+  ASSERT_EQ(5U * 100 + 5 + 1, replayer.GetLatency(kTraceWrite).num());
+  ASSERT_EQ(5U * 100, replayer.GetLatency(kTraceGet).num());
+  ASSERT_FALSE(replayer.GetLatencyReport().empty());
+
+  delete db2;
+  ASSERT_OK(DestroyDB(dbname2, options));
+}
+
+TEST_F(DBTest2, TraceAndMultiThreadReplayBatchOrder) {
+  Options options = CurrentOptions();
+  WriteOptions wo;
+  ReadOptions ro;
+  EnvOptions env_opts;
+  Reopen(options);
+
+  std::string trace_filename = dbname_ + "/rocksdb.trace_mt_order";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(NewFileTraceWriter(env_, env_opts, trace_filename, &trace_writer));
+  ASSERT_OK(db_->StartTrace(TraceOptions(), std::move(trace_writer)));
+  // Every batch is immediately followed by single key writes to its keys, a
+  // batch replayed late would overwrite them with older values
+  for (int round = 0; round < 200; ++round) {
+    WriteBatch batch;
+    for (int i = 0; i < 16; ++i) {
+      ASSERT_OK(batch.Put(Key(i), "b" + ToString(round)));
+    }
+    ASSERT_OK(db_->Write(wo, &batch));
+    for (int i = 0; i < 16; i += 3) {
+      ASSERT_OK(Put(Key(i), "v" + ToString(round)));
+    }
+  }
+  ASSERT_OK(db_->EndTrace());
+
+  std::string dbname2 = test::TmpDir(env_) + "/db_replay_mt_order";
+  ASSERT_OK(DestroyDB(dbname2, options));
+  DB* db2 = nullptr;
+  options.create_if_missing = true;
+  ASSERT_OK(DB::Open(options, dbname2, &db2));
+
+  std::unique_ptr<TraceReader> trace_reader;
+  ASSERT_OK(NewFileTraceReader(env_, env_opts, trace_filename, &trace_reader));
+  Replayer replayer(db2, handles_, std::move(trace_reader));
+  ASSERT_OK(replayer.MultiThreadReplay(8, 0 /* fast_forward */));
+
+  std::string value;
+  for (int i = 0; i < 16; ++i) {
+    ASSERT_OK(db2->Get(ro, Key(i), &value));
+    ASSERT_EQ(i % 3 == 0 ? "v199" : "b199", value);
+  }
+
+  delete db2;
+  ASSERT_OK(DestroyDB(dbname2, options));
+}
+
 TEST_F(DBTest2, TraceWithLimit) {
   Options options = CurrentOptions();
   options.merge_operator = MergeOperators::CreatePutOperator();
@@ -113,7 +113,7 @@ bool DBTestBase::ShouldSkipOptions(int option_config, int skip_mask) {
       option_config == kUniversalCompactionMultiLevel ||
       option_config == kUniversalSubcompactions ||
       option_config == kFIFOCompaction ||
-      option_config == kConcurrentSkipList) {
+      option_config == kConcurrentSkipList || option_config == kHashSorted) {
     return true;
   }
 #endif
@@ -393,6 +393,9 @@ Options DBTestBase::GetOptions(
           NewHashCuckooRepFactory(options.write_buffer_size));
       options.allow_concurrent_memtable_write = false;
       break;
+    case kHashSorted:
+      options.memtable_factory.reset(NewHashSortedRepFactory(16));
+      break;
     case kDirectIO: {
       options.use_direct_reads = true;
       options.use_direct_io_for_flush_and_compaction = true;
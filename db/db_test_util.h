@@ -687,6 +687,7 @@ class DBTestBase : public testing::Test {
     kPartitionedFilterWithNewTableReaderForCompactions,
     kUniversalSubcompactions,
     kxxHash64Checksum,
+    kHashSorted,
     // This must be the last line
     kEnd,
   };
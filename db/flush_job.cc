@@ -29,6 +29,7 @@
 #include "db/merge_context.h"
 #include "db/range_tombstone_fragmenter.h"
 #include "db/version_set.h"
+#include "monitoring/file_io_stats.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/thread_status_util.h"
@@ -196,6 +197,7 @@ Status FlushJob::Run(LogsWithPrepTracker* prep_tracker) {
   db_mutex_->AssertHeld();
   assert(pick_memtable_called);
   AutoThreadOperationStageUpdater stage_run(ThreadStatus::STAGE_FLUSH_RUN);
+  IOOriginatorScope io_originator_scope(kIOOriginatorFlush);
   if (mems_.empty()) {
     ROCKS_LOG_BUFFER(log_buffer_, "[%s] Nothing in memtable to flush",
                      cfd_->GetName().c_str());
@@ -433,10 +435,16 @@ Status FlushJob::WriteLevel0Table() {
   // Note that here we treat flush as level 0 compaction in internal stats
   InternalStats::CompactionStats stats(CompactionReason::kFlush, 1);
   stats.micros = db_options_.env->NowMicros() - start_micros;
-  for (auto& f : meta_) {
+  for (size_t i = 0; i < meta_.size(); ++i) {
+    auto& f = meta_[i];
     stats.bytes_written += f.fd.GetFileSize();
     cfd_->internal_stats()->AddCFStats(InternalStats::BYTES_FLUSHED,
                                        f.fd.GetFileSize());
+    // the first file is the key sst, the rest hold separated values
+    cfd_->internal_stats()->AddCFStats(
+        i == 0 ? InternalStats::FLUSH_KEY_BYTES_WRITTEN
+               : InternalStats::FLUSH_BLOB_BYTES_WRITTEN,
+        f.fd.GetFileSize());
   }
   MeasureTime(stats_, FLUSH_TIME, stats.micros);
   cfd_->internal_stats()->AddCompactionStats(0 /* level */, stats);
@@ -22,6 +22,7 @@
 
 #include "db/column_family.h"
 #include "db/db_impl.h"
+#include "monitoring/file_io_stats.h"
 #include "rocksdb/terark_namespace.h"
 #include "table/block_based_table_factory.h"
 #include "util/string_util.h"
@@ -188,6 +189,40 @@ std::pair<Slice, Slice> GetPropertyNameAndArg(const Slice& property) {
   arg.remove_prefix(property.size() - sfx_len);
   return {name, arg};
 }
+
+// Sst sizes of a column family with KV separation. The garbage of a blob sst
+// is estimated from its antiquated entries, as GC picks them.
+struct KVSeparationSpace {
+  uint64_t key_bytes = 0;
+  uint64_t blob_bytes = 0;
+  uint64_t blob_garbage_bytes = 0;
+
+  // Bytes on disk per live byte, 1 without garbage
+  double SpaceAmp() const {
+    uint64_t total_bytes = key_bytes + blob_bytes;
+    uint64_t live_bytes = total_bytes - blob_garbage_bytes;
+    return live_bytes == 0 ? 0 : static_cast<double>(total_bytes) / live_bytes;
+  }
+};
+
+void GetKVSeparationSpace(const VersionStorageInfo* vstorage,
+                          KVSeparationSpace* space) {
+  for (int level = -1; level < vstorage->num_levels(); ++level) {
+    for (auto* f : vstorage->LevelFiles(level)) {
+      uint64_t file_size = f->fd.GetFileSize();
+      // key ssts of map ssts live in level -1 too
+      if (level != -1 || f->is_gc_forbidden()) {
+        space->key_bytes += file_size;
+        continue;
+      }
+      space->blob_bytes += file_size;
+      space->blob_garbage_bytes += static_cast<uint64_t>(
+          file_size *
+          std::min(1.0, f->num_antiquation /
+                            std::max<double>(1, f->prop.num_entries)));
+    }
+  }
+}
 }  // anonymous namespace
 
 static const std::string rocksdb_prefix = "rocksdb.";
@@ -253,6 +288,10 @@ static const std::string estimate_oldest_key_time = "estimate-oldest-key-time";
 static const std::string block_cache_capacity = "block-cache-capacity";
 static const std::string block_cache_usage = "block-cache-usage";
 static const std::string block_cache_pinned_usage = "block-cache-pinned-usage";
+static const std::string block_cache_hot_keys = "block-cache-hot-keys";
+static const std::string op_traces = "op-traces";
+static const std::string memory_breakdown = "memory-breakdown";
+static const std::string file_io_stats = "file-io-stats";
 static const std::string options_statistics = "options-statistics";
 
 const std::string DB::Properties::kNumFilesAtLevelPrefix =
@@ -339,6 +378,13 @@ const std::string DB::Properties::kBlockCacheUsage =
     rocksdb_prefix + block_cache_usage;
 const std::string DB::Properties::kBlockCachePinnedUsage =
     rocksdb_prefix + block_cache_pinned_usage;
+const std::string DB::Properties::kBlockCacheHotKeys =
+    rocksdb_prefix + block_cache_hot_keys;
+const std::string DB::Properties::kOpTraces = rocksdb_prefix + op_traces;
+const std::string DB::Properties::kMemoryBreakdown =
+    rocksdb_prefix + memory_breakdown;
+const std::string DB::Properties::kFileIOStats =
+    rocksdb_prefix + file_io_stats;
 const std::string DB::Properties::kOptionsStatistics =
     rocksdb_prefix + options_statistics;
 
@@ -474,6 +520,18 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kBlockCachePinnedUsage,
          {false, nullptr, &InternalStats::HandleBlockCachePinnedUsage, nullptr,
           nullptr}},
+        {DB::Properties::kBlockCacheHotKeys,
+         {false, &InternalStats::HandleBlockCacheHotKeys, nullptr, nullptr,
+          nullptr}},
+        {DB::Properties::kOpTraces,
+         {false, nullptr, nullptr, nullptr,
+          &DBImpl::GetPropertyHandleOpTraces}},
+        {DB::Properties::kMemoryBreakdown,
+         {false, nullptr, nullptr, nullptr,
+          &DBImpl::GetPropertyHandleMemoryBreakdown}},
+        {DB::Properties::kFileIOStats,
+         {false, &InternalStats::HandleFileIOStats, nullptr, nullptr,
+          nullptr}},
         {DB::Properties::kOptionsStatistics,
          {false, nullptr, nullptr, nullptr,
           &DBImpl::GetPropertyHandleOptionsStatistics}},
@@ -943,6 +1001,60 @@ bool InternalStats::HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* /*db*/,
   return true;
 }
 
+bool InternalStats::HandleFileIOStats(std::string* value, Slice /*suffix*/) {
+  DumpFileIOStats(value);
+  return true;
+}
+
+bool InternalStats::HandleBlockCacheHotKeys(std::string* value,
+                                            Slice /*suffix*/) {
+  const size_t kMaxHotKeys = 32;
+  Cache* block_cache;
+  bool ok = HandleBlockCacheStat(&block_cache);
+  if (!ok) {
+    return false;
+  }
+  std::vector<CacheHotKey> hot_keys;
+  block_cache->GetHotKeys(&hot_keys);
+
+  // Files are ranked by the sum of their hot blocks
+  std::map<uint64_t, std::pair<uint64_t, size_t>> files;
+  for (auto& hot_key : hot_keys) {
+    auto& file = files[hot_key.file_number];
+    file.first += hot_key.count;
+    ++file.second;
+  }
+  std::vector<std::pair<uint64_t, uint64_t>> hot_files;
+  for (auto& pair : files) {
+    hot_files.emplace_back(pair.second.first, pair.first);
+  }
+  std::sort(hot_files.rbegin(), hot_files.rend());
+
+  char buf[1000];
+  value->append(
+      "\n** Block Cache Hot Keys **\n"
+      "Sampled, Count overestimates the accesses by at most Error\n"
+      "       Count        Error        File  Type    Key\n");
+  for (size_t i = 0; i < hot_keys.size() && i < kMaxHotKeys; ++i) {
+    auto& hot_key = hot_keys[i];
+    snprintf(buf, sizeof(buf),
+             "%12" PRIu64 " %12" PRIu64 " %11" PRIu64 "  %-6s  %s\n",
+             hot_key.count, hot_key.error, hot_key.file_number,
+             hot_key.block_type, Slice(hot_key.key).ToString(true).c_str());
+    value->append(buf);
+  }
+  value->append(
+      "\n** Block Cache Hot Files **\n"
+      "       Count        File  HotBlocks\n");
+  for (size_t i = 0; i < hot_files.size() && i < kMaxHotKeys; ++i) {
+    snprintf(buf, sizeof(buf), "%12" PRIu64 " %11" PRIu64 "  %9zd\n",
+             hot_files[i].first, hot_files[i].second,
+             files[hot_files[i].second].second);
+    value->append(buf);
+  }
+  return true;
+}
+
 void InternalStats::DumpDBStats(std::string* value) {
   char buf[1000];
   // DB-level stats, only available from default column family
@@ -1081,6 +1193,7 @@ void InternalStats::DumpCFMapStats(
   }
 
   DumpCFMapStatsIOStalls(cf_stats);
+  DumpCFMapStatsKVSeparation(cf_stats);
 }
 
 void InternalStats::DumpCFMapStats(
@@ -1183,6 +1296,36 @@ void InternalStats::DumpCFMapStatsIOStalls(
   (*cf_stats)["io_stalls.total_slowdown"] = std::to_string(total_slowdown);
 }
 
+void InternalStats::GetKVSeparationWriteStats(
+    std::map<std::string, uint64_t>* stats) const {
+  (*stats)["flush.key.write.bytes"] = cf_stats_value_[FLUSH_KEY_BYTES_WRITTEN];
+  (*stats)["flush.blob.write.bytes"] =
+      cf_stats_value_[FLUSH_BLOB_BYTES_WRITTEN];
+  (*stats)["compaction.key.write.bytes"] =
+      cf_stats_value_[COMPACTION_KEY_BYTES_WRITTEN];
+  (*stats)["compaction.blob.write.bytes"] =
+      cf_stats_value_[COMPACTION_BLOB_BYTES_WRITTEN];
+  (*stats)["map.write.bytes"] = cf_stats_value_[MAP_BYTES_WRITTEN];
+  (*stats)["gc.blob.read.bytes"] = cf_stats_value_[GC_BLOB_BYTES_READ];
+  (*stats)["gc.blob.write.bytes"] = cf_stats_value_[GC_BLOB_BYTES_WRITTEN];
+}
+
+void InternalStats::DumpCFMapStatsKVSeparation(
+    std::map<std::string, std::string>* cf_stats) {
+  std::map<std::string, uint64_t> write_stats;
+  GetKVSeparationWriteStats(&write_stats);
+  for (auto& pair : write_stats) {
+    (*cf_stats)["kv_separation." + pair.first] = std::to_string(pair.second);
+  }
+  KVSeparationSpace space;
+  GetKVSeparationSpace(cfd_->current()->storage_info(), &space);
+  (*cf_stats)["kv_separation.key.bytes"] = std::to_string(space.key_bytes);
+  (*cf_stats)["kv_separation.blob.bytes"] = std::to_string(space.blob_bytes);
+  (*cf_stats)["kv_separation.blob.garbage.bytes"] =
+      std::to_string(space.blob_garbage_bytes);
+  (*cf_stats)["kv_separation.space_amp"] = std::to_string(space.SpaceAmp());
+}
+
 void InternalStats::DumpCFStats(std::string* value) {
   DumpCFStatsNoFileHistogram(value);
   DumpCFFileHistogram(value);
@@ -1312,6 +1455,48 @@ void InternalStats::DumpCFStatsNoFileHistogram(std::string* value) {
   cf_stats_snapshot_.compact_bytes_read = compact_bytes_read;
   cf_stats_snapshot_.compact_micros = compact_micros;
 
+  // KV separation, write amp is against what flush and AddFile took in
+  uint64_t kv_separation_bytes_write =
+      cf_stats_value_[FLUSH_KEY_BYTES_WRITTEN] +
+      cf_stats_value_[FLUSH_BLOB_BYTES_WRITTEN] +
+      cf_stats_value_[COMPACTION_KEY_BYTES_WRITTEN] +
+      cf_stats_value_[COMPACTION_BLOB_BYTES_WRITTEN] +
+      cf_stats_value_[MAP_BYTES_WRITTEN] +
+      cf_stats_value_[GC_BLOB_BYTES_WRITTEN];
+  uint64_t interval_kv_separation_bytes_write =
+      kv_separation_bytes_write - cf_stats_snapshot_.kv_separation_bytes_write;
+  snprintf(buf, sizeof(buf),
+           "KV separation write(GB): flush %.3f key %.3f blob, "
+           "compaction %.3f key %.3f blob, map %.3f, "
+           "GC %.3f blob read %.3f blob write, "
+           "W-Amp %.2f cumulative %.2f interval\n",
+           cf_stats_value_[FLUSH_KEY_BYTES_WRITTEN] / kGB,
+           cf_stats_value_[FLUSH_BLOB_BYTES_WRITTEN] / kGB,
+           cf_stats_value_[COMPACTION_KEY_BYTES_WRITTEN] / kGB,
+           cf_stats_value_[COMPACTION_BLOB_BYTES_WRITTEN] / kGB,
+           cf_stats_value_[MAP_BYTES_WRITTEN] / kGB,
+           cf_stats_value_[GC_BLOB_BYTES_READ] / kGB,
+           cf_stats_value_[GC_BLOB_BYTES_WRITTEN] / kGB,
+           kv_separation_bytes_write /
+               static_cast<double>(flush_ingest + add_file_ingest + 1),
+           interval_kv_separation_bytes_write /
+               static_cast<double>(interval_ingest));
+  value->append(buf);
+  cf_stats_snapshot_.kv_separation_bytes_write = kv_separation_bytes_write;
+
+  KVSeparationSpace space;
+  GetKVSeparationSpace(cfd_->current()->storage_info(), &space);
+  snprintf(buf, sizeof(buf),
+           "KV separation space(GB): %.3f key, %.3f blob, "
+           "%.3f blob garbage (%.1f%%), S-Amp %.2f\n",
+           space.key_bytes / kGB, space.blob_bytes / kGB,
+           space.blob_garbage_bytes / kGB,
+           space.blob_bytes == 0
+               ? 0.0
+               : space.blob_garbage_bytes * 100.0 / space.blob_bytes,
+           space.SpaceAmp());
+  value->append(buf);
+
   snprintf(buf, sizeof(buf),
            "Stalls(count): %" PRIu64
            " level0_slowdown, "
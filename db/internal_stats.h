@@ -106,6 +106,15 @@ class InternalStats {
     INGESTED_NUM_KEYS_TOTAL,
     READ_AMP_LIMIT_SLOWDOWNS,
     READ_AMP_LIMIT_STOPS,
+    // Bytes written with KV separation, split by writer and sst kind
+    FLUSH_KEY_BYTES_WRITTEN,
+    FLUSH_BLOB_BYTES_WRITTEN,
+    COMPACTION_KEY_BYTES_WRITTEN,
+    COMPACTION_BLOB_BYTES_WRITTEN,
+    // Map ssts written by map compactions and lazy compactions
+    MAP_BYTES_WRITTEN,
+    GC_BLOB_BYTES_READ,
+    GC_BLOB_BYTES_WRITTEN,
     INTERNAL_CF_STATS_ENUM_MAX,
   };
 
@@ -365,6 +374,10 @@ class InternalStats {
     return comp_stats_;
   }
 
+  // Cumulative bytes written with KV separation, keyed by their stats names.
+  // REQUIRES: DB mutex held
+  void GetKVSeparationWriteStats(std::map<std::string, uint64_t>* stats) const;
+
   // Store a mapping from the user-facing DB::Properties string to our
   // DBPropertyInfo struct used internally for retrieving properties.
   static const std::unordered_map<std::string, DBPropertyInfo> ppt_name_to_info;
@@ -376,6 +389,8 @@ class InternalStats {
       std::map<int, std::map<LevelStatType, double>>* level_stats,
       CompactionStats* compaction_stats_sum);
   void DumpCFMapStatsIOStalls(std::map<std::string, std::string>* cf_stats);
+  void DumpCFMapStatsKVSeparation(
+      std::map<std::string, std::string>* cf_stats);
   void DumpCFStats(std::string* value);
   void DumpCFStatsNoFileHistogram(std::string* value);
   void DumpCFFileHistogram(std::string* value);
@@ -409,6 +424,9 @@ class InternalStats {
     uint64_t ingest_l0_files_addfile;  // Total number of files ingested to L0
     uint64_t ingest_keys_addfile;      // Total number of keys ingested
 
+    // KV separation stats
+    uint64_t kv_separation_bytes_write;
+
     CFStatsSnapshot()
         : ingest_bytes_flush(0),
           stall_count(0),
@@ -419,7 +437,8 @@ class InternalStats {
           ingest_bytes_addfile(0),
           ingest_files_addfile(0),
           ingest_l0_files_addfile(0),
-          ingest_keys_addfile(0) {}
+          ingest_keys_addfile(0),
+          kv_separation_bytes_write(0) {}
 
     void Clear() {
       comp_stats.Clear();
@@ -433,6 +452,7 @@ class InternalStats {
       ingest_files_addfile = 0;
       ingest_l0_files_addfile = 0;
       ingest_keys_addfile = 0;
+      kv_separation_bytes_write = 0;
     }
   } cf_stats_snapshot_;
 
@@ -545,6 +565,8 @@ class InternalStats {
   bool HandleBlockCacheUsage(uint64_t* value, DBImpl* db, Version* version);
   bool HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* db,
                                    Version* version);
+  bool HandleBlockCacheHotKeys(std::string* value, Slice suffix);
+  bool HandleFileIOStats(std::string* value, Slice suffix);
   // Total number of background errors encountered. Every time a flush task
   // or compaction task fails, this counter is incremented. The failure can
   // be caused by any possible reason, including file system errors, out of
@@ -577,6 +599,13 @@ class InternalStats {
     INGESTED_NUM_FILES_TOTAL,
     INGESTED_LEVEL0_NUM_FILES_TOTAL,
     INGESTED_NUM_KEYS_TOTAL,
+    FLUSH_KEY_BYTES_WRITTEN,
+    FLUSH_BLOB_BYTES_WRITTEN,
+    COMPACTION_KEY_BYTES_WRITTEN,
+    COMPACTION_BLOB_BYTES_WRITTEN,
+    MAP_BYTES_WRITTEN,
+    GC_BLOB_BYTES_READ,
+    GC_BLOB_BYTES_WRITTEN,
     INTERNAL_CF_STATS_ENUM_MAX,
   };
 
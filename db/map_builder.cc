@@ -25,6 +25,7 @@
 #include "db/dbformat.h"
 #include "db/event_helpers.h"
 #include "db/range_del_aggregator.h"
+#include "monitoring/file_io_stats.h"
 #include "monitoring/thread_status_util.h"
 #include "rocksdb/terark_namespace.h"
 #include "table/merging_iterator.h"
@@ -1612,6 +1613,7 @@ Status MapBuilder::WriteOutputFile(
   writable_file->SetPreallocationBlockSize(4ULL << 20);
   std::unique_ptr<WritableFileWriter> outfile(new WritableFileWriter(
       std::move(writable_file), fname, env_options_, stats_));
+  outfile->set_io_file_type(kIOFileMapSst);
 
   uint64_t output_file_creation_time;
   {
@@ -71,8 +71,7 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
       mem_tracker_(write_buffer_manager),
       arena_(moptions_.arena_block_size,
              (write_buffer_manager != nullptr &&
-              (write_buffer_manager->enabled() ||
-               write_buffer_manager->cost_to_cache()))
+              write_buffer_manager->tracks_memory())
                  ? &mem_tracker_
                  : nullptr,
              mutable_cf_options.memtable_huge_page_size),
@@ -87,6 +86,7 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
       num_entries_(0),
       num_deletes_(0),
       num_range_del_(0),
+      table_memory_reserved_(0),
       write_buffer_size_(mutable_cf_options.write_buffer_size),
       flush_in_progress_(false),
       flush_completed_(false),
@@ -213,7 +213,24 @@ bool MemTable::ShouldFlushNow() const {
   return arena_.AllocatedAndUnused() < kArenaBlockSize / 4;
 }
 
+void MemTable::UpdateTableMemoryReservation() {
+  if (mem_tracker_.is_freed()) {
+    return;
+  }
+  size_t usage = table_->ApproximateMemoryUsage();
+  size_t reserved = table_memory_reserved_.load(std::memory_order_relaxed);
+  while (usage > reserved) {
+    if (table_memory_reserved_.compare_exchange_weak(
+            reserved, usage, std::memory_order_relaxed,
+            std::memory_order_relaxed)) {
+      mem_tracker_.Allocate(usage - reserved);
+      break;
+    }
+  }
+}
+
 void MemTable::UpdateFlushState() {
+  UpdateTableMemoryReservation();
   auto state = flush_state_.load(std::memory_order_relaxed);
   if (state == FLUSH_NOT_REQUESTED && ShouldFlushNow()) {
     // ignore CAS failure, because that means somebody else requested
@@ -336,6 +336,9 @@ class MemTable {
   void MarkImmutable() {
     is_immutable_ = true;
     table_->MarkReadOnly();
+    // MarkReadOnly() may account the last few KB of table memory, reserve
+    // them while the tracker still accepts allocations
+    UpdateTableMemoryReservation();
     mem_tracker_.DoneAllocating();
   }
   bool IsImmutable() { return is_immutable_; };
@@ -420,6 +423,9 @@ class MemTable {
   std::atomic<uint64_t> num_entries_;
   std::atomic<uint64_t> num_deletes_;
   std::atomic<uint64_t> num_range_del_;
+  // Memory of table_ allocated outside arena_ and reserved in the write
+  // buffer manager through mem_tracker_
+  std::atomic<size_t> table_memory_reserved_;
 
   // Dynamically changeable memtable option
   std::atomic<size_t> write_buffer_size_;
@@ -488,6 +494,10 @@ class MemTable {
   // Updates flush_state_ using ShouldFlushNow()
   void UpdateFlushState();
 
+  // Reserves the growth of table_->ApproximateMemoryUsage() in the write
+  // buffer manager, which otherwise only sees arena_ allocations
+  void UpdateTableMemoryReservation();
+
   void UpdateOldestKeyTime();
 
   // No copying allowed
@@ -369,6 +369,29 @@ bool CompactionRangeDelAggregator::ShouldDelete(const ParsedInternalKey& parsed,
   return it->second.ShouldDelete(parsed, mode);
 }
 
+bool CompactionRangeDelAggregator::GetCoveringTombstone(
+    const ParsedInternalKey& parsed, SequenceNumber* seq,
+    std::string* end_user_key) {
+  const Comparator* user_cmp = icmp_->user_comparator();
+  bool found = false;
+  for (auto& iter : parent_iters_) {
+    iter->Seek(parsed.user_key);
+    if (!iter->Valid() || iter->seq() <= parsed.sequence ||
+        (found && iter->seq() <= *seq) ||
+        icmp_->Compare(iter->start_key(), parsed) > 0) {
+      continue;
+    }
+    ParsedInternalKey end = iter->end_key();
+    if (user_cmp->Compare(parsed.user_key, end.user_key) >= 0) {
+      continue;
+    }
+    *seq = iter->seq();
+    end_user_key->assign(end.user_key.data(), end.user_key.size());
+    found = true;
+  }
+  return found;
+}
+
 namespace {
 
 class TruncatedRangeDelMergingIter : public InternalIteratorBase<Slice> {
@@ -394,6 +394,13 @@ class CompactionRangeDelAggregator : public RangeDelAggregator {
 
   bool IsRangeOverlapped(const Slice& start, const Slice& end);
 
+  // Finds the tombstone with the highest sequence number that covers parsed.
+  // Returns false if there is none, otherwise the tombstone covers the user
+  // keys in [parsed.user_key, *end_user_key) up to *seq. Snapshots are not
+  // considered, the caller has to check *seq against them.
+  bool GetCoveringTombstone(const ParsedInternalKey& parsed,
+                            SequenceNumber* seq, std::string* end_user_key);
+
   void InvalidateRangeDelMapPositions() override {
     for (auto& rep : reps_) {
       rep.second.Invalidate();
@@ -12,7 +12,9 @@
 #include "db/dbformat.h"
 #include "db/range_tombstone_fragmenter.h"
 #include "db/version_edit.h"
+#include "monitoring/file_io_stats.h"
 #include "monitoring/perf_context_imp.h"
+#include "rocksdb/memory_governor.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/terark_namespace.h"
 #include "table/get_context.h"
@@ -32,10 +34,21 @@ namespace TERARKDB_NAMESPACE {
 
 namespace {
 
-template <class T>
-static void DeleteEntry(const Slice& /*key*/, void* value) {
-  T* typed_value = reinterpret_cast<T*>(value);
-  delete typed_value;
+// Value of the table cache entries. The memory of the table reader, as of
+// opening it, is charged to the governor until the entry is deleted.
+struct TableCacheEntry {
+  TableReader* table_reader;
+  MemoryGovernor* governor;
+  size_t charge;
+};
+
+static void DeleteTableCacheEntry(const Slice& /*key*/, void* value) {
+  TableCacheEntry* entry = reinterpret_cast<TableCacheEntry*>(value);
+  if (entry->governor != nullptr) {
+    entry->governor->Release(MemoryGovernor::kTableReader, entry->charge);
+  }
+  delete entry->table_reader;
+  delete entry;
 }
 
 static void UnrefEntry(void* arg1, void* arg2) {
@@ -112,10 +125,12 @@ class LazyCreateIterator : public Snapshot {
 }  // namespace
 
 TableCache::TableCache(const ImmutableCFOptions& ioptions,
-                       const EnvOptions& env_options, Cache* const cache)
+                       const EnvOptions& env_options, Cache* const cache,
+                       MemoryGovernor* governor)
     : ioptions_(ioptions),
       env_options_(env_options),
       cache_(cache),
+      governor_(governor),
       immortal_tables_(false) {
   if (ioptions_.row_cache) {
     // If the same cache is shared by multiple instances, we need to
@@ -127,7 +142,8 @@ TableCache::TableCache(const ImmutableCFOptions& ioptions,
 TableCache::~TableCache() {}
 
 TableReader* TableCache::GetTableReaderFromHandle(Cache::Handle* handle) {
-  return reinterpret_cast<TableReader*>(cache_->Value(handle));
+  return reinterpret_cast<TableCacheEntry*>(cache_->Value(handle))
+      ->table_reader;
 }
 
 void TableCache::ReleaseHandle(Cache::Handle* handle) {
@@ -180,6 +196,8 @@ Status TableCache::GetTableReaderImpl(
   if (s.ok()) {
     if (force_memory) {
       file = NewMemoryRandomAccessFile(std::move(file), fd.GetFileSize());
+      // map ssts are loaded into memory, this is their only read
+      RecordFileIO(kIOFileMapSst, false /* is_write */, fd.GetFileSize());
     } else if (readahead > 0 && !env_options.use_mmap_reads) {
       // Not compatible with mmap files since ReadaheadRandomAccessFile requires
       // its wrapped file's Read() to copy data into the provided scratch
@@ -197,6 +215,9 @@ Status TableCache::GetTableReaderImpl(
             record_read_stats ? ioptions_.statistics : nullptr, SST_READ_MICROS,
             file_read_hist, ioptions_.rate_limiter, for_compaction,
             ioptions_.listeners));
+    if (force_memory) {
+      file_reader->set_io_file_type(kIOFileUncounted);
+    }
     s = ioptions_.table_factory->NewTableReader(
         TableReaderOptions(ioptions_, prefix_extractor, env_options,
                            internal_comparator, skip_filters, immortal_tables_,
@@ -248,12 +269,19 @@ Status TableCache::FindTable(const EnvOptions& env_options,
       // We do not cache error results so that if the error is transient,
       // or somebody repairs the file, we recover automatically.
     } else {
-      s = cache_->Insert(key, table_reader.get(), 1, &DeleteEntry<TableReader>,
-                         handle);
+      TableCacheEntry* entry =
+          new TableCacheEntry{table_reader.get(), governor_, 0};
+      if (governor_ != nullptr) {
+        entry->charge = table_reader->ApproximateMemoryUsage();
+        governor_->Reserve(MemoryGovernor::kTableReader, entry->charge);
+      }
+      // Release ownership of table reader, the entry owns it now
+      table_reader.release();
+      s = cache_->Insert(key, entry, 1, &DeleteTableCacheEntry, handle);
       if (s.ok()) {
-        table_reader->SetTableCacheHandle(cache_, *handle);
-        // Release ownership of table reader.
-        table_reader.release();
+        entry->table_reader->SetTableCacheHandle(cache_, *handle);
+      } else {
+        DeleteTableCacheEntry(key, entry);
       }
     }
   }
@@ -397,7 +425,10 @@ InternalIterator* TableCache::NewIterator(
       *table_reader_ptr = table_reader;
     }
   }
-  if (s.ok() && range_del_agg != nullptr && !options.ignore_range_deletions) {
+  // Readers keep their tombstones fragmented, adding them only costs an
+  // iterator. Files known to have none are skipped.
+  if (s.ok() && range_del_agg != nullptr && !options.ignore_range_deletions &&
+      file_meta.prop.has_range_deletions()) {
     if (range_del_agg->AddFile(fd.GetNumber())) {
       std::unique_ptr<FragmentedRangeTombstoneIterator> range_del_iter(
           static_cast<FragmentedRangeTombstoneIterator*>(
@@ -430,6 +461,7 @@ Status TableCache::Get(const ReadOptions& options,
                        const SliceTransform* prefix_extractor,
                        HistogramImpl* file_read_hist, bool skip_filters,
                        int level) {
+  PERF_COUNTER_ADD(get_from_table_count, 1);
   auto& fd = file_meta.fd;
   IterKey key_buffer;
   Status s;
@@ -447,8 +479,11 @@ Status TableCache::Get(const ReadOptions& options,
     }
   }
   if (s.ok()) {
-    t->UpdateMaxCoveringTombstoneSeq(options, ExtractUserKey(k),
-                                     get_context->max_covering_tombstone_seq());
+    if (file_meta.prop.has_range_deletions()) {
+      t->UpdateMaxCoveringTombstoneSeq(
+          options, ExtractUserKey(k),
+          get_context->max_covering_tombstone_seq());
+    }
     if (!file_meta.prop.is_map_sst()) {
       s = t->Get(options, k, get_context, prefix_extractor, skip_filters);
     } else if (dependence_map.empty()) {
@@ -635,7 +670,8 @@ void TableCache::TEST_AddMockTableReader(TableReader* table_reader,
   Status s;
   uint64_t number = fd.GetNumber();
   Slice key = GetSliceForFileNumber(&number);
-  s = cache_->Insert(key, table_reader, 1, &DeleteEntry<TableReader>);
+  s = cache_->Insert(key, new TableCacheEntry{table_reader, nullptr, 0}, 1,
+                     &DeleteTableCacheEntry);
 }
 
 }  // namespace TERARKDB_NAMESPACE
\ No newline at end of file
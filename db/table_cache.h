@@ -34,11 +34,15 @@ class Arena;
 struct FileDescriptor;
 class GetContext;
 class HistogramImpl;
+class MemoryGovernor;
 
 class TableCache {
  public:
+  // If governor is not nullptr, the memory of the table readers is charged
+  // to it while they are in the cache.
   TableCache(const ImmutableCFOptions& ioptions,
-             const EnvOptions& storage_options, Cache* cache);
+             const EnvOptions& storage_options, Cache* cache,
+             MemoryGovernor* governor = nullptr);
   ~TableCache();
 
   // Return an iterator for the specified file number (the corresponding
@@ -165,6 +169,7 @@ class TableCache {
   const ImmutableCFOptions& ioptions_;
   const EnvOptions& env_options_;
   Cache* const cache_;
+  MemoryGovernor* const governor_;
   std::string row_cache_id_;
   bool immortal_tables_;
 };
@@ -31,6 +31,7 @@
 #include "db/merge_helper.h"
 #include "db/table_cache.h"
 #include "db/version_builder.h"
+#include "monitoring/file_io_stats.h"
 #include "monitoring/file_read_sample.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/persistent_stats_history.h"
@@ -42,6 +43,7 @@
 #include "table/get_context.h"
 #include "table/internal_iterator.h"
 #include "table/merging_iterator.h"
+#include "table/persistent_cache_helper.h"
 #include "table/meta_blocks.h"
 #include "table/plain_table_factory.h"
 #include "table/table_reader.h"
@@ -1229,40 +1231,78 @@ Version::Version(ColumnFamilyData* column_family_data, VersionSet* vset,
       version_number_(version_number) {}
 
 Status Version::fetch_buffer(LazyBuffer* buffer) const {
+  PERF_TIMER_GUARD(blob_fetch_time);
+  PERF_COUNTER_ADD(blob_fetch_count, 1);
+  IOSstTypeScope io_sst_type_scope(kIOFileBlobSst);
   auto context = get_context(buffer);
   Slice user_key(reinterpret_cast<const char*>(context->data[0]),
                  context->data[1]);
   uint64_t sequence = context->data[2];
   auto pair = *reinterpret_cast<DependenceMap::value_type*>(context->data[3]);
-  bool value_found = false;
-  SequenceNumber context_seq;
-  GetContext get_context(cfd_->internal_comparator().user_comparator(), nullptr,
-                         cfd_->ioptions()->info_log, db_statistics_,
-                         GetContext::kNotFound, user_key, buffer, &value_found,
-                         nullptr, nullptr, nullptr, env_, &context_seq);
+  uint64_t file_number = pair.second->fd.GetNumber();
   IterKey iter_key;
   iter_key.SetInternalKey(user_key, sequence, kValueTypeForSeek);
-  auto s = table_cache_->Get(
-      ReadOptions(), cfd_->internal_comparator(), *pair.second,
-      storage_info_.dependence_map(), iter_key.GetInternalKey(), &get_context,
-      mutable_cf_options_.prefix_extractor.get(), nullptr, true);
-  if (!s.ok()) {
+  // Returns Incomplete if read_options forbids the IO the value needs
+  auto get_from_table = [&](const ReadOptions& read_options) {
+    bool value_found = true;
+    SequenceNumber context_seq;
+    GetContext get_context(cfd_->internal_comparator().user_comparator(),
+                           nullptr, cfd_->ioptions()->info_log,
+                           db_statistics_, GetContext::kNotFound, user_key,
+                           buffer, &value_found, nullptr, nullptr, nullptr,
+                           env_, &context_seq);
+    auto s = table_cache_->Get(
+        read_options, cfd_->internal_comparator(), *pair.second,
+        storage_info_.dependence_map(), iter_key.GetInternalKey(),
+        &get_context, mutable_cf_options_.prefix_extractor.get(), nullptr,
+        true);
+    if (!s.ok()) {
+      return s;
+    }
+    if (!value_found) {
+      return Status::Incomplete("Separate value not in block cache");
+    }
+    if (context_seq != sequence ||
+        (get_context.State() != GetContext::kFound &&
+         get_context.State() != GetContext::kMerge)) {
+      if (get_context.State() == GetContext::kCorrupt) {
+        return std::move(get_context).CorruptReason();
+      } else {
+        char buf[128];
+        snprintf(buf, sizeof buf,
+                 "file number = %" PRIu64 "(%" PRIu64 "), sequence = %" PRIu64,
+                 file_number, pair.first, sequence);
+        return Status::Corruption("Separate value missing", buf);
+      }
+    }
+    assert(buffer->file_number() == file_number);
+    return Status::OK();
+  };
+  PersistentCache* value_cache = cfd_->ioptions()->value_persistent_cache.get();
+  if (value_cache == nullptr) {
+    return get_from_table(ReadOptions());
+  }
+  // The block cache is cheaper than the secondary cache, try it first
+  ReadOptions no_io_options;
+  no_io_options.read_tier = kBlockCacheTier;
+  auto s = get_from_table(no_io_options);
+  if (!s.IsIncomplete()) {
     return s;
   }
-  if (context_seq != sequence || (get_context.State() != GetContext::kFound &&
-                                  get_context.State() != GetContext::kMerge)) {
-    if (get_context.State() == GetContext::kCorrupt) {
-      return std::move(get_context).CorruptReason();
-    } else {
-      char buf[128];
-      snprintf(buf, sizeof buf,
-               "file number = %" PRIu64 "(%" PRIu64 "), sequence = %" PRIu64,
-               pair.second->fd.GetNumber(), pair.first, sequence);
-      return Status::Corruption("Separate value missing", buf);
-    }
+  std::string record_id(user_key.data(), user_key.size());
+  PutFixed64(&record_id, sequence);
+  std::string value;
+  if (PersistentCacheHelper::LookupRecord(value_cache, file_number, record_id,
+                                          &value, db_statistics_)) {
+    buffer->reset(value, true, file_number);
+    return Status::OK();
   }
-  assert(buffer->file_number() == pair.second->fd.GetNumber());
-  return Status::OK();
+  s = get_from_table(ReadOptions());
+  if (s.ok() && (s = buffer->fetch()).ok()) {
+    PersistentCacheHelper::InsertRecord(value_cache, file_number, record_id,
+                                        buffer->slice());
+  }
+  return s;
 }
 
 LazyBuffer Version::TransToCombined(const Slice& user_key, uint64_t sequence,
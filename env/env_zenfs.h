@@ -330,6 +330,10 @@ class ZenEnv : public EnvWrapper {
                                 const std::string& /*second*/, bool* /*res*/) {
     return Status::NotSupported("AreFilesSame is not supported in ZenEnv");
   }
+
+  // Deleting a file only drops its extents from the zone usage, the zones
+  // are reset when they get reallocated
+  bool NeedsThrottledDeletion() const override { return false; }
 };
 #endif  // !defined(ROCKSDB_LITE) && defined(OS_LINUX) && defined(LIBZBD)
 
@@ -979,6 +979,26 @@ Status PosixWritableFile::Allocate(uint64_t offset, uint64_t len) {
         filename_, errno);
   }
 }
+
+Status PosixWritableFile::PunchHole(uint64_t offset, uint64_t len) {
+  assert(offset <= std::numeric_limits<off_t>::max());
+  assert(len <= std::numeric_limits<off_t>::max());
+  if (!allow_fallocate_) {
+    return Status::NotSupported("fallocate is disabled");
+  }
+  IOSTATS_TIMER_GUARD(allocate_nanos);
+  if (fallocate(fd_, FALLOC_FL_KEEP_SIZE | FALLOC_FL_PUNCH_HOLE,
+                static_cast<off_t>(offset), static_cast<off_t>(len)) == 0) {
+    return Status::OK();
+  }
+  if (errno == EOPNOTSUPP) {
+    return Status::NotSupported("Punching holes is not supported",
+                                filename_);
+  }
+  return IOError(
+      "While punching hole offset " + ToString(offset) + " len " + ToString(len),
+      filename_, errno);
+}
 #endif
 
 #ifdef ROCKSDB_RANGESYNC_PRESENT
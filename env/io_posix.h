@@ -145,6 +145,7 @@ class PosixWritableFile : public WritableFile {
   }
 #ifdef ROCKSDB_FALLOCATE_PRESENT
   virtual Status Allocate(uint64_t offset, uint64_t len) override;
+  virtual Status PunchHole(uint64_t offset, uint64_t len) override;
 #endif
 #ifdef ROCKSDB_RANGESYNC_PRESENT
   virtual Status RangeSync(uint64_t offset, uint64_t nbytes) override;
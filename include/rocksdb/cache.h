@@ -26,6 +26,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "rocksdb/memory_allocator.h"
 #include "rocksdb/slice.h"
@@ -133,8 +134,40 @@ extern std::shared_ptr<Cache> NewLIRSCache(
 
 extern std::shared_ptr<Cache> NewLIRSCache(const LIRSCacheOptions& cache_opts);
 
+// How a block read by a request competes for a cache with an admission
+// policy, see ReadOptions::cache_admission and NewAdmissionCache.
+enum class CacheAdmission : unsigned char {
+  // Let the admission policy of the cache decide
+  kAdmitDefault,
+  // Always cache the block, e.g. for latency critical point lookups
+  kAdmitAlways,
+  // Only cache the block if it was accessed recently, even if the cache has
+  // room left, e.g. for bulk scans and warm up reads
+  kAdmitIfFrequent,
+};
+
+struct AdmissionCacheOptions {
+  // Width of each row of the frequency sketch, rounded up to a power of two.
+  // 0 means capacity / 4KB, i.e. about one counter per cached block.
+  size_t sketch_width = 0;
+
+  // A block is admitted into a full cache if its estimated access frequency
+  // (the miss that leads to the insert included) reaches this threshold.
+  uint32_t frequency_threshold = 2;
+};
+
+// Wraps cache (e.g. from NewLRUCache or NewLIRSCache) with a TinyLFU style
+// admission filter: a count-min sketch records the frequency of every lookup,
+// and once the cache is full only blocks seen often enough are inserted, so
+// one pass scans don't flush out the hot blocks. Entries with high priority
+// (index and filter blocks) and entries inserted with Insert() and a handle
+// are always admitted.
+extern std::shared_ptr<Cache> NewAdmissionCache(
+    std::shared_ptr<Cache> cache,
+    const AdmissionCacheOptions& options = AdmissionCacheOptions());
+
 // Similar to NewLRUCache, but create a cache based on CLOCK algorithm with
-// better concurrent performance in some cases. See util/clock_cache.cc for
+// better concurrent performance in some cases. See cache/clock_cache.cc for
 // more detail.
 //
 // Return nullptr if it is not supported.
@@ -142,6 +175,18 @@ extern std::shared_ptr<Cache> NewClockCache(size_t capacity,
                                             int num_shard_bits = -1,
                                             bool strict_capacity_limit = false);
 
+// A frequently accessed cache entry, see Cache::GetHotKeys()
+struct CacheHotKey {
+  std::string key;
+  // Estimated number of accesses, it overestimates by at most `error`
+  uint64_t count = 0;
+  uint64_t error = 0;
+  // Owner of the block as recorded by the reader, e.g. the number of the SST
+  // or blob file and "data", "index" or "filter"
+  uint64_t file_number = 0;
+  const char* block_type = "";
+};
+
 class Cache {
  public:
   // Depending on implementation, cache entries with high priority could be less
@@ -183,6 +228,18 @@ class Cache {
                         Handle** handle = nullptr,
                         Priority priority = Priority::LOW) = 0;
 
+  // Same as Insert, caches with an admission policy may drop the entry
+  // according to admission and still return Status::OK(). If handle is
+  // nullptr the entry is deleted right away, as if it was inserted and
+  // evicted at once. Otherwise *handle is set to nullptr and the caller keeps
+  // owning the value, which was not passed to "deleter".
+  virtual Status InsertWithAdmission(
+      const Slice& key, void* value, size_t charge,
+      void (*deleter)(const Slice& key, void* value), Handle** handle,
+      Priority priority, CacheAdmission /*admission*/) {
+    return Insert(key, value, charge, deleter, handle, priority);
+  }
+
   // If the cache has no mapping for "key", returns nullptr.
   //
   // Else return a handle that corresponds to the mapping.  The caller
@@ -275,6 +332,19 @@ class Cache {
 
   virtual std::string GetPrintableOptions() const { return ""; }
 
+  // Counts an access of key in a heavy hitter sketch, tagged with the file
+  // and the type of the block. The sketch is sampled and always on, readers
+  // call it after Lookup(). block_type must be a string literal. The default
+  // implementation does nothing.
+  virtual void RecordHotKey(const Slice& /*key*/, uint64_t /*file_number*/,
+                            const char* /*block_type*/) {}
+
+  // Returns the heavy hitters recorded by RecordHotKey(), the most
+  // frequently accessed first
+  virtual void GetHotKeys(std::vector<CacheHotKey>* hot_keys) const {
+    hot_keys->clear();
+  }
+
   // Mark the last inserted object as being a raw data block. This will be used
   // in tests. The default implementation does nothing.
   virtual void TEST_mark_as_data_block(const Slice& /*key*/,
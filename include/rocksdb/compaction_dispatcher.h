@@ -41,12 +41,28 @@ class RemoteCompactionDispatcher : public CompactionDispatcher {
   virtual std::future<std::string> DoCompaction(std::string data) = 0;
   class Worker : boost::noncopyable {
    public:
+    // Called periodically while a compaction is running
+    using ProgressCallback = std::function<void(
+        uint64_t num_input_records, uint64_t current_output_file_size)>;
+
     Worker(EnvOptions env_options, Env* env);
     virtual ~Worker();
     virtual std::string GenerateOutputFileName(size_t file_index) = 0;
-    std::string DoCompaction(Slice data);
+    std::string DoCompaction(Slice data,
+                             const ProgressCallback& progress = nullptr);
     static void DebugSerializeCheckResult(Slice data);
 
+    // Serve compactions on address until Shutdown() is called. address is
+    // "unix:<path>" or "tcp:<host>:<port>", each connection carries one
+    // serialized CompactionWorkerContext, progress and the result are
+    // streamed back on the same connection. At most max_jobs compactions
+    // run concurrently, comparator and factory objects are shared by jobs
+    // with the same options.
+    // GenerateOutputFileName must be thread safe when max_jobs > 1
+    Status Serve(const std::string& address, size_t max_jobs);
+    // Not async-signal-safe, signal handlers must defer the call to a thread
+    void Shutdown();
+
    protected:
     struct Rep;
     Rep* rep_;
@@ -56,4 +72,9 @@ class RemoteCompactionDispatcher : public CompactionDispatcher {
 extern std::shared_ptr<CompactionDispatcher> NewCommandLineCompactionDispatcher(
     std::string cmd);
 
+// Dispatch compactions to a RemoteCompactionDispatcher::Worker::Serve()
+// daemon listening on address, see Worker::Serve for the address format
+extern std::shared_ptr<CompactionDispatcher> NewSocketCompactionDispatcher(
+    std::string address);
+
 }  // namespace TERARKDB_NAMESPACE
@@ -90,5 +90,10 @@ struct CompactionJobStats {
 
   // number of single-deletes which meet something other than a put
   uint64_t num_single_del_mismatch;
+
+  // number of output values stored in blob SSTs
+  uint64_t num_output_records_separated;
+  // number of output values kept inline while key value separation enabled
+  uint64_t num_output_records_inline;
 };
 }  // namespace TERARKDB_NAMESPACE
@@ -698,6 +698,28 @@ class DB {
     //      entries being pinned.
     static const std::string kBlockCachePinnedUsage;
 
+    //  "rocksdb.block-cache-hot-keys" - returns a multi-line string of the
+    //      most accessed blocks in block cache, with the files owning them
+    //      and their types, and of the files with the most accessed blocks.
+    static const std::string kBlockCacheHotKeys;
+
+    //  "rocksdb.op-traces" - returns a multi-line string of the latency
+    //      breakdown of the most recent sampled Get, Seek and Write calls,
+    //      see DBOptions::op_trace_sample_rate.
+    static const std::string kOpTraces;
+
+    //  "rocksdb.memory-breakdown" - returns a multi-line string of the memory
+    //      used by memtables, table readers and the block cache, followed by
+    //      the reservations of the memory governor if one is attached to the
+    //      write buffer manager.
+    static const std::string kMemoryBreakdown;
+
+    //  "rocksdb.file-io-stats" - returns a multi-line string of the bytes
+    //      and calls of file reads and writes, by what they were done for
+    //      and by file type. The counters are shared by all DBs of the
+    //      process.
+    static const std::string kFileIOStats;
+
     // "rocksdb.options-statistics" - returns multi-line string
     //      of options.statistics
     static const std::string kOptionsStatistics;
@@ -303,6 +303,13 @@ class Env {
     return Status::NotSupported("AreFilesSame is not supported for this Env");
   }
 
+  // Whether deleting a file frees its space on the device right away, so
+  // deleting many large files at once may stall foreground IO and
+  // SstFileManager should spread the deletion out. File systems reclaiming
+  // space later on their own return false, their files are deleted without
+  // going through the trash.
+  virtual bool NeedsThrottledDeletion() const { return true; }
+
   // Lock the specified file.  Used to prevent concurrent access to
   // the same db by multiple processes.  On failure, stores nullptr in
   // *lock and returns non-OK.
@@ -859,6 +866,12 @@ class WritableFile {
     return Status::OK();
   }
 
+  // Frees the space of [offset, offset + len) without changing the file
+  // size, the range reads as zeros afterwards.
+  virtual Status PunchHole(uint64_t /*offset*/, uint64_t /*len*/) {
+    return Status::NotSupported("PunchHole is not supported for this file");
+  }
+
  protected:
   size_t preallocation_block_size() { return preallocation_block_size_; }
 
@@ -948,6 +961,10 @@ class WritableFileWrapper : public WritableFile {
     return target_->Allocate(offset, len);
   }
 
+  Status PunchHole(uint64_t offset, uint64_t len) override {
+    return target_->PunchHole(offset, len);
+  }
+
  private:
   WritableFile* target_;
 };
@@ -1288,6 +1305,10 @@ class EnvWrapper : public Env {
     return target_->AreFilesSame(first, second, res);
   }
 
+  bool NeedsThrottledDeletion() const override {
+    return target_->NeedsThrottledDeletion();
+  }
+
   Status LockFile(const std::string& f, FileLock** l) override {
     return target_->LockFile(f, l);
   }
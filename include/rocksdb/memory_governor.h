@@ -0,0 +1,107 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// MemoryGovernor enforces one memory budget across the memory consumers of
+// one or more DBs: memtables, table readers (including TerarkZip indexes),
+// compaction buffers and the block cache.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/terark_namespace.h"
+
+namespace TERARKDB_NAMESPACE {
+
+class MemoryGovernor {
+ public:
+  // Consumers are listed by priority, the most important first. Memory of
+  // higher priority consumers is always granted; lower priority consumers
+  // are expected to back off when the budget is exhausted.
+  enum Consumer {
+    kMemTable = 0,
+    kTableReader,
+    kCompaction,
+    kNumConsumers,
+  };
+
+  // `limit` is the total budget in bytes. If `cache` is provided it takes
+  // whatever the other consumers leave, but never less than
+  // `min_cache_capacity`: the cache is shrunk as reservations grow and
+  // expanded back as they are released.
+  explicit MemoryGovernor(size_t limit, std::shared_ptr<Cache> cache = {},
+                          size_t min_cache_capacity = 0);
+
+  size_t limit() const { return limit_; }
+
+  // Charge `mem` bytes to `consumer`. Reservations always succeed, callers
+  // check UnderPressure() before starting work that can be postponed.
+  void Reserve(Consumer consumer, size_t mem);
+
+  void Release(Consumer consumer, size_t mem);
+
+  size_t GetUsage(Consumer consumer) const {
+    return usage_[consumer].load(std::memory_order_relaxed);
+  }
+
+  // Sum of all reservations, excluding the block cache.
+  size_t GetReservedUsage() const {
+    return reserved_.load(std::memory_order_relaxed);
+  }
+
+  // Reservations plus the current usage of the block cache.
+  size_t GetTotalUsage() const;
+
+  // True if the reservations leave the block cache less than its minimum
+  // capacity.
+  bool UnderPressure() const {
+    return GetReservedUsage() + min_cache_capacity_ > limit_;
+  }
+
+  // How far the reservations exceed what the budget leaves after the
+  // minimum block cache capacity, 0 if not under pressure.
+  size_t GetOverage() const {
+    size_t reserved = GetReservedUsage();
+    return reserved + min_cache_capacity_ > limit_
+               ? reserved + min_cache_capacity_ - limit_
+               : 0;
+  }
+
+  // True if under pressure and flushing memtables would end it. Memtables
+  // should then be flushed early, and background work that only adds
+  // memory deferred until the flushes are done. Pressure caused by other
+  // consumers, e.g. table readers alone, isn't relieved by flushing.
+  bool MemTablesOverBudget() const {
+    size_t overage = GetOverage();
+    return overage > 0 && GetUsage(kMemTable) >= overage;
+  }
+
+  // Human readable per-consumer breakdown.
+  std::string GetBreakdown() const;
+
+  static const char* ConsumerName(Consumer consumer);
+
+ private:
+  void AdjustCacheCapacity();
+
+  const size_t limit_;
+  const size_t min_cache_capacity_;
+  std::shared_ptr<Cache> cache_;
+  std::atomic<size_t> reserved_;
+  std::atomic<size_t> usage_[kNumConsumers];
+  std::mutex cache_mutex_;
+  size_t cache_capacity_;
+
+  // No copying allowed
+  MemoryGovernor(const MemoryGovernor&) = delete;
+  MemoryGovernor& operator=(const MemoryGovernor&) = delete;
+};
+
+}  // namespace TERARKDB_NAMESPACE
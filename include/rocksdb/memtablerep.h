@@ -458,6 +458,16 @@ extern MemTableRepFactory* NewConcurrentHashDualListReqFactory(
     size_t num_hash_buckets_preallocated = 0,
     bool if_log_bucket_dist_when_flush = true);
 
+// This factory creates memtables that keep a lock-free hash table for point
+// lookups and a skip list for ordered iteration. Inserts only touch the hash
+// table; a background thread shared by the factory's memtables moves new
+// entries into the skip list, and the remainder is sorted when an iterator
+// seeks or the memtable becomes immutable. If the comparator may consider
+// keys with different bytes equal, a skip list memtable is created instead.
+//
+// @bucket_count: number of fixed array buckets
+extern MemTableRepFactory* NewHashSortedRepFactory(size_t bucket_count = 50000);
+
 #endif  // ROCKSDB_LITE
 
 struct MemTableRegister {
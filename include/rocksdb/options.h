@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "rocksdb/advanced_options.h"
+#include "rocksdb/cache.h"
 #include "rocksdb/compaction_dispatcher.h"
 #include "rocksdb/comparator.h"
 #include "rocksdb/env.h"
@@ -46,6 +47,7 @@ class SstFileManager;
 class FilterPolicy;
 class Logger;
 class MergeOperator;
+class PersistentCache;
 class Snapshot;
 class MemTableRepFactory;
 class RateLimiter;
@@ -311,6 +313,14 @@ struct ColumnFamilyOptions : public AdvancedColumnFamilyOptions {
   // valid [0 , 1]
   double blob_large_key_ratio = 0.25;
 
+  // Adapt blob_size per compaction output range. Ranges read more often than
+  // the column family average keep more values inline, ranges whose blobs
+  // turn into garbage quickly separate more values.
+  // The effective blob_size stays in [blob_size / 4 , blob_size * 4]
+  //
+  // Dynamically changeable through SetOptions() API
+  bool enable_adaptive_blob_size = false;
+
   // Key Value separation gc ratio
   // Startup GC when garbage ratio larger than blob_gc_ratio
   // valid [0 , 0.5]
@@ -752,6 +762,15 @@ struct DBOptions {
   // Default: 1MB
   size_t stats_history_buffer_size = 1024 * 1024;
 
+  // if not zero, one in op_trace_sample_rate Get, Seek and Write calls records
+  // its latency breakdown (memtable, sst, blob, block IO, write group, WAL)
+  // into an in-memory ring of the most recent traces, which can be read
+  // through the "rocksdb.op-traces" property.
+  // Default: 0
+  //
+  // Dynamically changeable through SetDBOptions() API.
+  uint32_t op_trace_sample_rate = 0;
+
   // If set true, will hint the underlying file system that the file
   // access pattern is random, when a sst file is opened.
   // Default: true
@@ -982,6 +1001,15 @@ struct DBOptions {
   // Not supported in ROCKSDB_LITE mode!
   std::shared_ptr<Cache> row_cache = nullptr;
 
+  // A secondary cache on a faster local device (e.g. NVMe) for values read
+  // one at a time: separated blob values and TerarkZip records. Lookups go
+  // to it after the in-memory caches miss and before the table file is
+  // read, values read from the table file are inserted into it. Entries are
+  // keyed by file number, so the cache must not be shared between DBs.
+  // Default: nullptr (disabled)
+  // Not supported in ROCKSDB_LITE mode!
+  std::shared_ptr<PersistentCache> value_persistent_cache = nullptr;
+
   std::shared_ptr<MetricsReporterFactory> metrics_reporter_factory = nullptr;
 
 #ifndef ROCKSDB_LITE
@@ -1194,6 +1222,20 @@ struct ReadOptions {
   // block cache. Default: true
   bool fill_cache;
 
+  // Should the blocks read for this iteration be placed in the persistent
+  // cache (BlockBasedTableOptions::persistent_cache)? Only has effect when
+  // fill_cache is true. Table iterators stop filling the persistent cache by
+  // themselves once they detect a sequential scan and start readahead.
+  // Default: true
+  bool fill_persistent_cache;
+
+  // How the blocks read by this request compete for the block cache when it
+  // has an admission policy (see NewAdmissionCache), ignored otherwise.
+  // Bulk scans may use kAdmitIfFrequent so the blocks they touch only once
+  // don't evict the hot ones.
+  // Default: kAdmitDefault
+  CacheAdmission cache_admission;
+
   // Specify to create a tailing iterator -- a special iterator that has a
   // view of the complete database (i.e. it can also be used to read newly
   // added data) and is optimized for sequential reads. It will return records
@@ -108,6 +108,11 @@ struct PerfContext {
   // total nanos spent after Get() finds a key
   uint64_t get_post_process_time;
   uint64_t get_from_output_files_time;  // total nanos reading from output files
+  // number of tables queried, including the files behind map sst links and
+  // the blob files of separated values
+  uint64_t get_from_table_count;
+  uint64_t blob_fetch_time;   // total nanos spent on fetching separated values
+  uint64_t blob_fetch_count;  // number of separated values fetched
   // total nanos spent on seeking memtable
   uint64_t seek_on_memtable_time;
   // number of seeks issued on memtable
@@ -134,6 +139,8 @@ struct PerfContext {
   //
   // total nanos spent on writing to WAL
   uint64_t write_wal_time;
+  // total nanos spent on syncing WAL, included in write_wal_time
+  uint64_t write_wal_sync_time;
   // total nanos spent on writing to mem tables
   uint64_t write_memtable_time;
   // total nanos spent on delaying or throttling write
@@ -102,6 +102,12 @@ class RateLimiter {
     return true;
   }
 
+  // Whether RecordIOLatency() should be called after rate limited IO.
+  virtual bool IsIOLatencyTracked() const { return false; }
+
+  // Reports that a rate limited IO took micros to complete.
+  virtual void RecordIOLatency(uint64_t /*micros*/) {}
+
  protected:
   Mode GetMode() { return mode_; }
 
@@ -137,4 +143,56 @@ extern RateLimiter* NewGenericRateLimiter(
     RateLimiter::Mode mode = RateLimiter::Mode::kWritesOnly,
     bool auto_tuned = false);
 
+// Classes of background IO told apart by the rate limiter returned from
+// NewIOClassRateLimiter(), from the most to the least urgent. The class is
+// taken from what the requesting thread works on, IO of other threads is
+// kFlush when requested with Env::IO_HIGH and kCompaction otherwise.
+enum class RateLimiterIOClass : int {
+  kFlush = 0,
+  // L0 -> L1 and universal sorted run compactions
+  kL0Compaction,
+  // Other compactions not writing the bottommost level
+  kCompaction,
+  // KV separation garbage collection
+  kGarbageCollection,
+  // Compactions writing the bottommost level
+  kBottommostCompaction,
+  // Map sst building
+  kMapCompaction,
+  kNumClasses,
+};
+
+struct IOClassRateLimiterOptions {
+  // Total rate of all classes, must be positive.
+  int64_t rate_bytes_per_sec = 0;
+
+  // How often tokens are refilled, see NewGenericRateLimiter().
+  int64_t refill_period_us = 100 * 1000;
+
+  // Each refill is shared among the classes with waiting requests in
+  // proportion to their weights, bytes a class does not use are carried
+  // over to the next refill. Classes without waiting requests get no share,
+  // so a class alone can use the whole rate. A class of weight 0 only gets
+  // bytes while no other class is waiting.
+  int32_t class_weights[static_cast<int>(RateLimiterIOClass::kNumClasses)] = {
+      32, 16, 8, 4, 2, 1};
+
+  RateLimiter::Mode mode = RateLimiter::Mode::kWritesOnly;
+
+  // If positive, the rate is tuned within
+  // `[rate_bytes_per_sec / 20, rate_bytes_per_sec]` to keep the average
+  // latency of rate limited IO below this many microseconds: it is lowered
+  // while IO is slower and raised while IO is faster and requests had to
+  // wait for tokens. Direct writes and the syncs of buffered files are
+  // timed.
+  uint64_t target_io_latency_us = 0;
+};
+
+// Create a RateLimiter keeping a share of the rate for each
+// RateLimiterIOClass, so that e.g. garbage collection and bottommost
+// compactions can not starve flushes on a shared disk. Requests get through
+// without taking a lock while nobody is waiting for tokens.
+extern RateLimiter* NewIOClassRateLimiter(
+    const IOClassRateLimiterOptions& options);
+
 }  // namespace TERARKDB_NAMESPACE
@@ -253,6 +253,9 @@ enum Tickers : uint32_t {
 
   NO_ITERATOR_CREATED,  // number of iterators created
   NO_ITERATOR_DELETED,  // number of iterators deleted
+  // Number of times compaction seeked past keys covered by a range tombstone
+  // instead of dropping them one by one
+  COMPACTION_RANGE_DEL_SKIP,
   TICKER_ENUM_MAX
 };
 
@@ -260,6 +260,26 @@ class Transaction {
   virtual Status GetForUpdate(const ReadOptions& options, const Slice& key,
                               std::string* value, bool exclusive = true) = 0;
 
+  // Lock every key in [begin_key, end_key], both ends inclusive and ordered
+  // by the column family's comparator, including keys that do not exist yet.
+  // Unlike GetForUpdate(), no key is read or conflict checked against the
+  // snapshot.  Range locks are held until the transaction commits or rolls
+  // back, RollbackToSavePoint() and UndoGetForUpdate() do not release them.
+  // Keys later locked by this transaction inside the range do not take a
+  // lock table entry of their own.
+  //
+  // If this transaction was created by a TransactionDB, it can return
+  // Status::OK() on success,
+  // Status::TimedOut() if the range could not be locked,
+  // Status::InvalidArgument() if begin_key is after end_key.
+  // Other transaction types return Status::NotSupported().
+  virtual Status GetRangeLock(ColumnFamilyHandle* /*column_family*/,
+                              const Slice& /*begin_key*/,
+                              const Slice& /*end_key*/,
+                              bool /*exclusive*/ = true) {
+    return Status::NotSupported("Range locks are not supported");
+  }
+
   virtual std::vector<Status> MultiGetForUpdate(
       const ReadOptions& options,
       const std::vector<ColumnFamilyHandle*>& column_family,
@@ -52,6 +52,16 @@ struct TransactionDBOptions {
   // mutex.
   size_t num_stripes = 16;
 
+  // If positive, deadlock detection for transactions with
+  // TransactionOptions::deadlock_detect set is done by a background thread
+  // every deadlock_detect_interval milliseconds instead of by each waiter
+  // before it blocks. Waiters then only publish who they wait for, which
+  // keeps the wait-for graph walk off the lock acquisition path. One
+  // transaction of each detected cycle fails with Status::Busy.
+  //
+  // If 0, each waiter walks the wait-for graph itself before blocking.
+  uint64_t deadlock_detect_interval = 0;
+
   // If positive, specifies the default wait timeout in milliseconds when
   // a transaction attempts to lock a key if not specified by
   // TransactionOptions::lock_timeout.
@@ -139,6 +149,15 @@ struct TransactionOptions {
   // The maximum number of bytes used for the write batch. 0 means no limit.
   size_t max_write_batch_size = 0;
 
+  // If positive, every time this transaction has locked this many more keys
+  // of a column family, it tries to replace them with a single range lock
+  // from its smallest to its largest locked key of that column family,
+  // without waiting.  The range lock is exclusive if any of the keys is, and
+  // may block other transactions from keys this transaction never touched.
+  // Keys inside the range do not take lock table entries afterwards.
+  // If 0, point locks are never escalated.
+  size_t lock_escalation_threshold = 0;
+
   // Set index factory for WriteBatchWithIndex
   const TERARKDB_NAMESPACE::WriteBatchEntryIndexFactory* index_type = nullptr;
 
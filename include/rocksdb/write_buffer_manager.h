@@ -16,6 +16,7 @@
 #include <cstddef>
 
 #include "rocksdb/cache.h"
+#include "rocksdb/memory_governor.h"
 #include "rocksdb/terark_namespace.h"
 
 namespace TERARKDB_NAMESPACE {
@@ -26,14 +27,25 @@ class WriteBufferManager {
   // memory_usage() won't be valid and ShouldFlush() will always return true.
   // if `cache` is provided, we'll put dummy entries in the cache and cost
   // the memory allocated to the cache. It can be used even if _buffer_size = 0.
+  // if `governor` is provided, memtable memory is charged to it, and memtables
+  // are flushed early while the governor is under pressure. DBs sharing this
+  // manager also charge their table readers and compactions to it.
   explicit WriteBufferManager(size_t _buffer_size,
-                              std::shared_ptr<Cache> cache = {});
+                              std::shared_ptr<Cache> cache = {},
+                              std::shared_ptr<MemoryGovernor> governor = {});
   ~WriteBufferManager();
 
   bool enabled() const { return buffer_size_ != 0; }
 
   bool cost_to_cache() const { return cache_rep_ != nullptr; }
 
+  MemoryGovernor* memory_governor() const { return governor_.get(); }
+
+  // Whether memtables have to report their allocations to this manager.
+  bool tracks_memory() const {
+    return enabled() || cost_to_cache() || governor_ != nullptr;
+  }
+
   // Only valid if enabled()
   size_t memory_usage() const {
     return memory_used_.load(std::memory_order_relaxed);
@@ -57,6 +69,16 @@ class WriteBufferManager {
         return true;
       }
     }
+    if (governor_ != nullptr && governor_->MemTablesOverBudget()) {
+      // Memtables are the cheapest consumer to shrink. Flush the mutable
+      // ones unless most memtable memory is already being flushed, or they
+      // are too small for a flush to be worth an L0 file.
+      size_t active = mutable_memtable_memory_usage();
+      if (active >= governor_->limit() / kMinEarlyFlushRatio &&
+          active >= governor_->GetUsage(MemoryGovernor::kMemTable) / 2) {
+        return true;
+      }
+    }
     return false;
   }
 
@@ -66,14 +88,17 @@ class WriteBufferManager {
     } else if (enabled()) {
       memory_used_.fetch_add(mem, std::memory_order_relaxed);
     }
-    if (enabled()) {
+    if (enabled() || governor_ != nullptr) {
       memory_active_.fetch_add(mem, std::memory_order_relaxed);
     }
+    if (governor_ != nullptr) {
+      governor_->Reserve(MemoryGovernor::kMemTable, mem);
+    }
   }
   // We are in the process of freeing `mem` bytes, so it is not considered
   // when checking the soft limit.
   void ScheduleFreeMem(size_t mem) {
-    if (enabled()) {
+    if (enabled() || governor_ != nullptr) {
       memory_active_.fetch_sub(mem, std::memory_order_relaxed);
     }
   }
@@ -83,9 +108,16 @@ class WriteBufferManager {
     } else if (enabled()) {
       memory_used_.fetch_sub(mem, std::memory_order_relaxed);
     }
+    if (governor_ != nullptr) {
+      governor_->Release(MemoryGovernor::kMemTable, mem);
+    }
   }
 
  private:
+  // Memtables are flushed early for the governor only once the mutable ones
+  // hold at least 1/kMinEarlyFlushRatio of its limit.
+  static const size_t kMinEarlyFlushRatio = 64;
+
   const size_t buffer_size_;
   const size_t mutable_limit_;
   std::atomic<size_t> memory_used_;
@@ -93,6 +125,7 @@ class WriteBufferManager {
   std::atomic<size_t> memory_active_;
   struct CacheRep;
   std::unique_ptr<CacheRep> cache_rep_;
+  std::shared_ptr<MemoryGovernor> governor_;
 
   void ReserveMemWithCache(size_t mem);
   void FreeMemWithCache(size_t mem);
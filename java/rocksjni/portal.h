@@ -3468,8 +3468,10 @@ class TickerTypeJni {
         return 0x5F;
       case TERARKDB_NAMESPACE::Tickers::NO_ITERATOR_DELETED:
         return 0x60;
-      case TERARKDB_NAMESPACE::Tickers::TICKER_ENUM_MAX:
+      case TERARKDB_NAMESPACE::Tickers::COMPACTION_RANGE_DEL_SKIP:
         return 0x61;
+      case TERARKDB_NAMESPACE::Tickers::TICKER_ENUM_MAX:
+        return 0x62;
 
       default:
         // undefined/default
@@ -3676,6 +3678,8 @@ class TickerTypeJni {
       case 0x60:
         return TERARKDB_NAMESPACE::Tickers::NO_ITERATOR_DELETED;
       case 0x61:
+        return TERARKDB_NAMESPACE::Tickers::COMPACTION_RANGE_DEL_SKIP;
+      case 0x62:
         return TERARKDB_NAMESPACE::Tickers::TICKER_ENUM_MAX;
 
       default:
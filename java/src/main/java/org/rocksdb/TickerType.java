@@ -484,7 +484,13 @@ public enum TickerType {
      */
     NO_ITERATOR_DELETED((byte) 0x60),
 
-    TICKER_ENUM_MAX((byte) 0x61);
+    /**
+     * Number of times compaction seeked past keys covered by a range
+     * tombstone instead of dropping them one by one.
+     */
+    COMPACTION_RANGE_DEL_SKIP((byte) 0x61),
+
+    TICKER_ENUM_MAX((byte) 0x62);
 
 
     private final byte value;
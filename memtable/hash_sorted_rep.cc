@@ -0,0 +1,445 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+
+#ifndef ROCKSDB_LITE
+#include "memtable/hash_sorted_rep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+
+#include "db/memtable.h"
+#include "memtable/inlineskiplist.h"
+#include "port/port.h"
+#include "rocksdb/memtablerep.h"
+#include "util/arena.h"
+#include "util/hash.h"
+#include "util/string_util.h"
+
+namespace TERARKDB_NAMESPACE {
+
+class HashSortedRep;
+
+// Background thread that moves freshly inserted entries of HashSortedRep
+// memtables into their skip lists.
+class HashSortedRepSorter {
+ public:
+  HashSortedRepSorter();
+  ~HashSortedRepSorter();
+
+  // Queue rep for sorting unless it is queued already.
+  void Schedule(HashSortedRep* rep);
+
+  // Drop rep from the queue. Called before rep is destroyed.
+  void Unschedule(HashSortedRep* rep);
+
+ private:
+  void BackgroundSort();
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<HashSortedRep*> queue_;
+  bool closing_;
+  port::Thread bg_thread_;
+};
+
+class HashSortedRep : public MemTableRep {
+ public:
+  HashSortedRep(const MemTableRep::KeyComparator& compare,
+                Allocator* allocator, size_t bucket_count,
+                std::shared_ptr<HashSortedRepSorter> sorter);
+
+  virtual ~HashSortedRep() override;
+
+  virtual KeyHandle Allocate(const size_t len, char** buf) override {
+    *buf = skip_list_.AllocateKey(len);
+    return static_cast<KeyHandle>(*buf);
+  }
+
+  virtual bool InsertKeyValue(const Slice& internal_key,
+                              const Slice& value) override {
+    return InsertKeyValueConcurrently(internal_key, value);
+  }
+
+  virtual bool InsertKeyValueWithHint(const Slice& internal_key,
+                                      const Slice& value,
+                                      void** /*hint*/) override {
+    return InsertKeyValueConcurrently(internal_key, value);
+  }
+
+  virtual bool InsertKeyValueConcurrently(const Slice& internal_key,
+                                          const Slice& value) override {
+    size_t buf_size = EncodeKeyValueSize(internal_key, value);
+    char* buf;
+    Allocate(buf_size, &buf);
+    EncodeKeyValue(internal_key, value, buf);
+    return InsertEntry(buf);
+  }
+
+  virtual void Insert(KeyHandle handle) override {
+    InsertEntry(static_cast<char*>(handle));
+  }
+
+  virtual void InsertConcurrently(KeyHandle handle) override {
+    InsertEntry(static_cast<char*>(handle));
+  }
+
+  virtual bool Contains(const Slice& internal_key) const override;
+
+  virtual void MarkReadOnly() override { SortPending(); }
+
+  virtual void Get(const LookupKey& k, void* callback_args,
+                   bool (*callback_func)(void* arg, const Slice& key,
+                                         const char* value)) override;
+
+  virtual uint64_t ApproximateNumEntries(const Slice& start_ikey,
+                                         const Slice& end_ikey) override {
+    std::string tmp;
+    uint64_t start_count =
+        skip_list_.EstimateCount(EncodeKey(&tmp, start_ikey));
+    uint64_t end_count = skip_list_.EstimateCount(EncodeKey(&tmp, end_ikey));
+    return (end_count >= start_count) ? (end_count - start_count) : 0;
+  }
+
+  virtual size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  virtual MemTableRep::Iterator* GetIterator(Arena* arena) override;
+
+ private:
+  friend class HashSortedRepSorter;
+
+  // Number of inserts between two background sorting passes.
+  static const uint64_t kSortBatchSize = 1024;
+
+  // Hash chains and the pending list both live in the allocator next to the
+  // key they reference, so neither needs to be freed separately.
+  struct Entry {
+    explicit Entry(const char* _key)
+        : key(_key), next(nullptr), pending_next(nullptr) {}
+
+    const char* key;
+    std::atomic<Entry*> next;
+    Entry* pending_next;
+  };
+
+  // Seeks first move the pending entries into the skip list, so a long lived
+  // iterator, e.g. a tailing one, sees the entries inserted before each seek.
+  // Next() and Prev() only see entries already in the skip list.
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    explicit Iterator(HashSortedRep* rep)
+        : rep_(rep), iter_(&rep->skip_list_) {}
+
+    virtual ~Iterator() override {}
+
+    virtual bool Valid() const override { return iter_.Valid(); }
+
+    virtual const char* EncodedKey() const override { return iter_.key(); }
+
+    virtual void Next() override { iter_.Next(); }
+
+    virtual void Prev() override { iter_.Prev(); }
+
+    virtual void Seek(const Slice& user_key,
+                      const char* memtable_key) override {
+      rep_->MaybeSortPending();
+      if (memtable_key != nullptr) {
+        iter_.Seek(memtable_key);
+      } else {
+        iter_.Seek(EncodeKey(&tmp_, user_key));
+      }
+    }
+
+    virtual void SeekForPrev(const Slice& user_key,
+                             const char* memtable_key) override {
+      rep_->MaybeSortPending();
+      if (memtable_key != nullptr) {
+        iter_.SeekForPrev(memtable_key);
+      } else {
+        iter_.SeekForPrev(EncodeKey(&tmp_, user_key));
+      }
+    }
+
+    virtual void SeekToFirst() override {
+      rep_->MaybeSortPending();
+      iter_.SeekToFirst();
+    }
+
+    virtual void SeekToLast() override {
+      rep_->MaybeSortPending();
+      iter_.SeekToLast();
+    }
+
+    virtual bool IsSeekForPrevSupported() const override { return true; }
+
+   private:
+    HashSortedRep* rep_;
+    InlineSkipList<const MemTableRep::KeyComparator&>::Iterator iter_;
+    std::string tmp_;  // For passing to EncodeKey
+  };
+
+  std::atomic<Entry*>* GetBucket(const Slice& user_key) const {
+    return &buckets_[GetSliceHash(user_key) % bucket_count_];
+  }
+
+  // Returns the first entry of the chain that is not less than key.
+  Entry* FindGreaterOrEqual(const std::atomic<Entry*>* bucket,
+                            const char* key) const {
+    Entry* entry = bucket->load(std::memory_order_acquire);
+    while (entry != nullptr && cmp_(entry->key, key) < 0) {
+      entry = entry->next.load(std::memory_order_acquire);
+    }
+    return entry;
+  }
+
+  // Links key into its hash chain and the pending list. Returns false if an
+  // entry with the same <key, seq> already exists.
+  bool InsertEntry(const char* key);
+
+  // Move every pending entry into the skip list, so that it covers all
+  // entries inserted so far.
+  void SortPending() {
+    std::lock_guard<std::mutex> lock(sort_mutex_);
+    SortPendingLocked();
+  }
+
+  void MaybeSortPending() {
+    if (pending_.load(std::memory_order_acquire) != nullptr) {
+      SortPending();
+    }
+  }
+
+  // REQUIRES: sort_mutex_ held
+  void SortPendingLocked();
+
+  InlineSkipList<const MemTableRep::KeyComparator&> skip_list_;
+  const MemTableRep::KeyComparator& cmp_;
+  const size_t bucket_count_;
+  std::atomic<Entry*>* buckets_;
+
+  // Entries not yet in skip_list_, newest first.
+  std::atomic<Entry*> pending_;
+  std::atomic<uint64_t> num_inserted_;
+
+  // Serializes writers of skip_list_.
+  std::mutex sort_mutex_;
+
+  std::shared_ptr<HashSortedRepSorter> sorter_;
+  // Protected by the mutex of sorter_.
+  bool scheduled_;
+};
+
+HashSortedRep::HashSortedRep(const MemTableRep::KeyComparator& compare,
+                             Allocator* allocator, size_t bucket_count,
+                             std::shared_ptr<HashSortedRepSorter> sorter)
+    : MemTableRep(allocator),
+      skip_list_(compare, allocator),
+      cmp_(compare),
+      bucket_count_(bucket_count),
+      pending_(nullptr),
+      num_inserted_(0),
+      sorter_(std::move(sorter)),
+      scheduled_(false) {
+  auto mem =
+      allocator->AllocateAligned(sizeof(std::atomic<Entry*>) * bucket_count_);
+  buckets_ = reinterpret_cast<std::atomic<Entry*>*>(mem);
+  for (size_t i = 0; i < bucket_count_; ++i) {
+    new (&buckets_[i]) std::atomic<Entry*>(nullptr);
+  }
+}
+
+HashSortedRep::~HashSortedRep() {
+  sorter_->Unschedule(this);
+  // Wait for a sorting pass that is still running on this rep
+  std::lock_guard<std::mutex> lock(sort_mutex_);
+}
+
+bool HashSortedRep::InsertEntry(const char* key) {
+  Entry* entry = nullptr;
+
+  // Link into the hash chain, which is kept sorted so that Get() sees the
+  // versions of a user key in the same order as the skip list would.
+  std::atomic<Entry*>* bucket = GetBucket(UserKey(key));
+  while (true) {
+    std::atomic<Entry*>* prev = bucket;
+    Entry* next = prev->load(std::memory_order_acquire);
+    int cmp = 1;
+    while (next != nullptr && (cmp = cmp_(next->key, key)) < 0) {
+      prev = &next->next;
+      next = prev->load(std::memory_order_acquire);
+    }
+    if (next != nullptr && cmp == 0) {
+      // The skip list would drop the duplicate, keep Get() consistent
+      return false;
+    }
+    if (entry == nullptr) {
+      auto mem = allocator_->AllocateAligned(sizeof(Entry));
+      entry = new (mem) Entry(key);
+    }
+    entry->next.store(next, std::memory_order_relaxed);
+    if (prev->compare_exchange_strong(next, entry, std::memory_order_release,
+                                      std::memory_order_relaxed)) {
+      break;
+    }
+  }
+
+  Entry* head = pending_.load(std::memory_order_relaxed);
+  do {
+    entry->pending_next = head;
+  } while (!pending_.compare_exchange_weak(head, entry,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed));
+
+  if ((num_inserted_.fetch_add(1, std::memory_order_relaxed) + 1) %
+          kSortBatchSize ==
+      0) {
+    sorter_->Schedule(this);
+  }
+  return true;
+}
+
+bool HashSortedRep::Contains(const Slice& internal_key) const {
+  std::string memtable_key;
+  const char* key = EncodeKey(&memtable_key, internal_key);
+  Entry* entry = FindGreaterOrEqual(GetBucket(ExtractUserKey(internal_key)),
+                                    key);
+  return entry != nullptr && cmp_(entry->key, key) == 0;
+}
+
+void HashSortedRep::Get(const LookupKey& k, void* callback_args,
+                        bool (*callback_func)(void* arg, const Slice& key,
+                                              const char* value)) {
+  for (Entry* entry = FindGreaterOrEqual(GetBucket(k.user_key()),
+                                         k.memtable_key().data());
+       entry != nullptr &&
+       callback_func(callback_args, GetLengthPrefixedSlice(entry->key),
+                     LengthPrefixedValue(entry->key));
+       entry = entry->next.load(std::memory_order_acquire)) {
+  }
+}
+
+MemTableRep::Iterator* HashSortedRep::GetIterator(Arena* arena) {
+  SortPending();
+  void* mem = arena ? arena->AllocateAligned(sizeof(HashSortedRep::Iterator))
+                    : operator new(sizeof(HashSortedRep::Iterator));
+  return new (mem) HashSortedRep::Iterator(this);
+}
+
+void HashSortedRep::SortPendingLocked() {
+  Entry* entry = pending_.exchange(nullptr, std::memory_order_acquire);
+  // Restore arrival order, sequential keys are cheaper to insert
+  Entry* list = nullptr;
+  while (entry != nullptr) {
+    Entry* next = entry->pending_next;
+    entry->pending_next = list;
+    list = entry;
+    entry = next;
+  }
+  for (; list != nullptr; list = list->pending_next) {
+    skip_list_.Insert(list->key);
+  }
+}
+
+HashSortedRepSorter::HashSortedRepSorter()
+    : closing_(false), bg_thread_(&HashSortedRepSorter::BackgroundSort, this) {}
+
+HashSortedRepSorter::~HashSortedRepSorter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    assert(queue_.empty());
+    closing_ = true;
+  }
+  cv_.notify_one();
+  bg_thread_.join();
+}
+
+void HashSortedRepSorter::Schedule(HashSortedRep* rep) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!rep->scheduled_) {
+    rep->scheduled_ = true;
+    queue_.push_back(rep);
+    cv_.notify_one();
+  }
+}
+
+void HashSortedRepSorter::Unschedule(HashSortedRep* rep) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (rep->scheduled_) {
+    rep->scheduled_ = false;
+    queue_.erase(std::find(queue_.begin(), queue_.end(), rep));
+  }
+}
+
+void HashSortedRepSorter::BackgroundSort() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return closing_ || !queue_.empty(); });
+    if (closing_) {
+      break;
+    }
+    HashSortedRep* rep = queue_.front();
+    queue_.pop_front();
+    rep->scheduled_ = false;
+    // A reader is already sorting this rep, it will catch up for us. Taking
+    // sort_mutex_ while still holding mutex_ keeps Unschedule() from
+    // returning before we own the rep.
+    if (!rep->sort_mutex_.try_lock()) {
+      continue;
+    }
+    lock.unlock();
+    rep->SortPendingLocked();
+    rep->sort_mutex_.unlock();
+    lock.lock();
+  }
+}
+
+HashSortedRepFactory::~HashSortedRepFactory() {}
+
+MemTableRep* HashSortedRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, bool needs_dup_key_check,
+    Allocator* allocator, const SliceTransform* transform, Logger* logger) {
+  if (compare.icomparator()
+          ->user_comparator()
+          ->CanKeysWithDifferentByteContentsBeEqual()) {
+    // Equal keys must hash to the same bucket
+    return fallback_.CreateMemTableRep(compare, needs_dup_key_check,
+                                       allocator, transform, logger);
+  }
+  std::shared_ptr<HashSortedRepSorter> sorter;
+  {
+    std::lock_guard<std::mutex> lock(sorter_mutex_);
+    if (!sorter_) {
+      sorter_ = std::make_shared<HashSortedRepSorter>();
+    }
+    sorter = sorter_;
+  }
+  return new HashSortedRep(compare, allocator, bucket_count_,
+                           std::move(sorter));
+}
+
+MemTableRepFactory* NewHashSortedRepFactory(size_t bucket_count) {
+  return new HashSortedRepFactory(bucket_count);
+}
+
+static MemTableRepFactory* NewHashSortedRepFactory(
+    const std::unordered_map<std::string, std::string>& options,
+    Status* /*s*/) {
+  size_t bucket_count = 50000;  // default
+  auto f = options.find("bucket_count");
+  if (options.end() != f) {
+    bucket_count = ParseSizeT(f->second);
+  }
+  return new HashSortedRepFactory(bucket_count);
+}
+
+ROCKSDB_REGISTER_MEM_TABLE("hash_sorted", HashSortedRepFactory);
+
+}  // namespace TERARKDB_NAMESPACE
+#endif  // ROCKSDB_LITE
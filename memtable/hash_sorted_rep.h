@@ -0,0 +1,51 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+#ifndef ROCKSDB_LITE
+#include <memory>
+#include <mutex>
+
+#include "rocksdb/memtablerep.h"
+#include "rocksdb/terark_namespace.h"
+
+namespace TERARKDB_NAMESPACE {
+
+class HashSortedRepSorter;
+
+// Memtables created by this factory index every entry twice: a lock-free
+// hash table keyed by user key serves point lookups, while a skip list that
+// provides ordered iteration is filled in the background. All memtables of a
+// factory share one sorting thread, which is started with the first memtable.
+// Comparators that may consider keys with different bytes equal get skip list
+// memtables instead.
+class HashSortedRepFactory : public MemTableRepFactory {
+ public:
+  explicit HashSortedRepFactory(size_t bucket_count)
+      : bucket_count_(bucket_count) {}
+
+  virtual ~HashSortedRepFactory();
+
+  using MemTableRepFactory::CreateMemTableRep;
+  virtual MemTableRep* CreateMemTableRep(
+      const MemTableRep::KeyComparator& compare, bool needs_dup_key_check,
+      Allocator* allocator, const SliceTransform* transform,
+      Logger* logger) override;
+
+  virtual const char* Name() const override { return "HashSortedRepFactory"; }
+
+  virtual bool IsInsertConcurrentlySupported() const override { return true; }
+
+  virtual bool CanHandleDuplicatedKey() const override { return true; }
+
+ private:
+  const size_t bucket_count_;
+  SkipListFactory fallback_;
+  std::mutex sorter_mutex_;
+  std::shared_ptr<HashSortedRepSorter> sorter_;
+};
+
+}  // namespace TERARKDB_NAMESPACE
+#endif  // ROCKSDB_LITE
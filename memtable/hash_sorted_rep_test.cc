@@ -0,0 +1,203 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+#include "memtable/hash_sorted_rep.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "db/memtable.h"
+#include "db/merge_context.h"
+#include "rocksdb/memtablerep.h"
+#include "rocksdb/options.h"
+#include "rocksdb/terark_namespace.h"
+#include "rocksdb/write_buffer_manager.h"
+#include "table/scoped_arena_iterator.h"
+#include "util/arena.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+
+namespace TERARKDB_NAMESPACE {
+
+class HashSortedRepTest : public testing::Test {
+ public:
+  HashSortedRepTest()
+      : cmp_(BytewiseComparator()), wb_(options_.db_write_buffer_size) {
+    options_.memtable_factory.reset(NewHashSortedRepFactory(16));
+    ioptions_.reset(new ImmutableCFOptions(options_));
+    mem_.reset(new MemTable(cmp_, *ioptions_, MutableCFOptions(options_),
+                            /* needs_dup_key_check */ true, &wb_,
+                            kMaxSequenceNumber, 0 /* column_family_id */));
+  }
+
+  static std::string Key(int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    return buf;
+  }
+
+  bool Get(const std::string& key, SequenceNumber seq, std::string* value) {
+    LookupKey lkey(key, seq);
+    LazyBuffer buf;
+    Status s;
+    MergeContext merge_context;
+    SequenceNumber max_covering_tombstone_seq = 0;
+    bool found = mem_->Get(lkey, &buf, &s, &merge_context,
+                           &max_covering_tombstone_seq, ReadOptions());
+    if (found && s.ok()) {
+      EXPECT_OK(buf.fetch());
+      *value = buf.ToString();
+    }
+    return found && s.ok();
+  }
+
+  static std::string Value(InternalIterator* iter) {
+    LazyBuffer value = iter->value();
+    EXPECT_OK(value.fetch());
+    return value.ToString();
+  }
+
+  // Returns the number of entries, checking they are in order.
+  size_t CountSorted(InternalIterator* iter) {
+    size_t count = 0;
+    std::string prev;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      if (count > 0) {
+        EXPECT_LT(cmp_.Compare(prev, iter->key()), 0);
+      }
+      prev = iter->key().ToString();
+      ++count;
+    }
+    return count;
+  }
+
+  Options options_;
+  InternalKeyComparator cmp_;
+  WriteBufferManager wb_;
+  std::unique_ptr<ImmutableCFOptions> ioptions_;
+  std::unique_ptr<MemTable> mem_;
+};
+
+TEST_F(HashSortedRepTest, DuplicateSeq) {
+  SequenceNumber seq = 123;
+  ASSERT_TRUE(mem_->Add(seq, kTypeValue, "key", "value"));
+  ASSERT_FALSE(mem_->Add(seq, kTypeValue, "key", "value"));
+  // Changing the type should still cause the duplicate key
+  ASSERT_FALSE(mem_->Add(seq, kTypeMerge, "key", "value"));
+  ASSERT_FALSE(mem_->Add(seq, kTypeDeletion, "key", ""));
+  ASSERT_TRUE(mem_->Add(seq + 1, kTypeMerge, "key", "value"));
+
+  MemTablePostProcessInfo post_process_info;
+  ASSERT_FALSE(mem_->Add(seq + 1, kTypeValue, "key", "value",
+                         true /* allow_concurrent */, &post_process_info));
+  ASSERT_TRUE(mem_->Add(seq + 2, kTypeValue, "key", "value",
+                        true /* allow_concurrent */, &post_process_info));
+
+  Arena arena;
+  ScopedArenaIterator iter(mem_->NewIterator(ReadOptions(), &arena));
+  ASSERT_EQ(3u, CountSorted(iter.get()));
+}
+
+TEST_F(HashSortedRepTest, ConcurrentInsert) {
+  const int kThreads = 4;
+  const int kKeysPerThread = 5000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      MemTablePostProcessInfo post_process_info;
+      for (int i = 0; i < kKeysPerThread; ++i) {
+        int k = i * kThreads + t;
+        ASSERT_TRUE(mem_->Add(k + 1, kTypeValue, Key(k), "v" + ToString(k),
+                              true /* allow_concurrent */,
+                              &post_process_info));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::string value;
+  for (int k = 0; k < kThreads * kKeysPerThread; ++k) {
+    ASSERT_TRUE(Get(Key(k), kMaxSequenceNumber, &value));
+    ASSERT_EQ("v" + ToString(k), value);
+  }
+  Arena arena;
+  ScopedArenaIterator iter(mem_->NewIterator(ReadOptions(), &arena));
+  ASSERT_EQ(static_cast<size_t>(kThreads * kKeysPerThread),
+            CountSorted(iter.get()));
+}
+
+TEST_F(HashSortedRepTest, GetMatchesIteration) {
+  const int kKeys = 500;
+  const int kVersions = 5;
+  SequenceNumber seq = 0;
+  for (int v = 0; v < kVersions; ++v) {
+    for (int k = 0; k < kKeys; ++k) {
+      ASSERT_TRUE(mem_->Add(++seq, kTypeValue, Key(k),
+                            ToString(k) + "." + ToString(v)));
+    }
+  }
+
+  Arena arena;
+  ScopedArenaIterator iter(mem_->NewIterator(ReadOptions(), &arena));
+  size_t count = 0;
+  std::string value;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++count) {
+    ParsedInternalKey ikey;
+    ASSERT_TRUE(ParseInternalKey(iter->key(), &ikey));
+    // Reading at the version's sequence must return that version
+    ASSERT_TRUE(Get(ikey.user_key.ToString(), ikey.sequence, &value));
+    ASSERT_EQ(Value(iter.get()), value);
+  }
+  ASSERT_EQ(static_cast<size_t>(kKeys * kVersions), count);
+}
+
+TEST_F(HashSortedRepTest, PendingEntriesSortedOnSeek) {
+  SequenceNumber seq = 0;
+  for (int k = 0; k < 10; ++k) {
+    ASSERT_TRUE(mem_->Add(++seq, kTypeValue, Key(k), "v"));
+  }
+  Arena arena;
+  ScopedArenaIterator iter(mem_->NewIterator(ReadOptions(), &arena));
+  ASSERT_EQ(10u, CountSorted(iter.get()));
+
+  // Entries inserted after the iterator was created are found once it seeks
+  // again, whether or not a full batch was handed to the sorting thread.
+  const int kKeys = 3000;
+  for (int k = 10; k < kKeys; ++k) {
+    ASSERT_TRUE(mem_->Add(++seq, kTypeValue, Key(k), "v"));
+  }
+  ASSERT_EQ(static_cast<size_t>(kKeys), CountSorted(iter.get()));
+
+  ASSERT_TRUE(mem_->Add(++seq, kTypeValue, Key(kKeys), "last"));
+  InternalKey target(Key(kKeys), kMaxSequenceNumber, kValueTypeForSeek);
+  iter->Seek(target.Encode());
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(Key(kKeys), ExtractUserKey(iter->key()).ToString());
+  ASSERT_EQ("last", Value(iter.get()));
+}
+
+}  // namespace TERARKDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as HashSortedRep is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // !ROCKSDB_LITE
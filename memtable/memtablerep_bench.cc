@@ -66,12 +66,14 @@ DEFINE_string(memtablerep, "skiplist",
               "\tvector              -- backed by an std::vector\n"
               "\thashskiplist        -- backed by a hash skip list\n"
               "\thashlinklist        -- backed by a hash linked list\n"
+              "\thashsorted          -- backed by a hash table and a skiplist "
+              "sorted in background\n"
               "\tcuckoo              -- backed by a cuckoo hash table\n"
               "\tpatricia_trie       -- backed by a patricia trie\n");
 
 DEFINE_int64(bucket_count, 1000000,
-             "bucket_count parameter to pass into NewHashSkiplistRepFactory or "
-             "NewHashLinkListRepFactory");
+             "bucket_count parameter to pass into NewHashSkiplistRepFactory, "
+             "NewHashLinkListRepFactory or NewHashSortedRepFactory");
 
 DEFINE_int32(
     hashskiplist_height, 4,
@@ -604,6 +606,9 @@ int main(int argc, char** argv) {
         FLAGS_if_log_bucket_dist_when_flash, FLAGS_threshold_use_skiplist));
     options.prefix_extractor.reset(
         TERARKDB_NAMESPACE::NewFixedPrefixTransform(FLAGS_prefix_length));
+  } else if (FLAGS_memtablerep == "hashsorted") {
+    factory.reset(
+        TERARKDB_NAMESPACE::NewHashSortedRepFactory(FLAGS_bucket_count));
   } else if (FLAGS_memtablerep == "cuckoo") {
     factory.reset(TERARKDB_NAMESPACE::NewHashCuckooRepFactory(
         FLAGS_write_buffer_size, FLAGS_average_data_size,
@@ -183,11 +183,33 @@ struct IteratorImplWithOffset : public IteratorImplBase {
 };
 
 static thread_local IteratorImplBase tls_impl;
+
+// Lives as long as the WriteBatchWithIndex, so it outlives the indexes that
+// are rebuilt after each Clear()
+class PTrieIndexContext : public WriteBatchEntryIndexContext {
+ public:
+  WriteBatchEntryIndexContext* fallback_context;
+  // Recent trie memory, new tries start with it instead of growing through
+  // the same sizes again when a transaction is reused. The context is shared
+  // by the indexes of all column families, so the hint halves with every
+  // index that used less, and one large batch doesn't stick forever.
+  size_t trie_mem_size;
+  PTrieIndexContext() : fallback_context(nullptr), trie_mem_size(0) {}
+
+  ~PTrieIndexContext() {
+    if (fallback_context != nullptr) {
+      fallback_context->~WriteBatchEntryIndexContext();
+    }
+  }
+};
+
+static constexpr size_t kMinTrieMemSize = 512ull << 10;
 }  // namespace WriteBatchEntryPTrieIndexDetail
 
 template <bool OverwriteKey>
 class WriteBatchEntryPTrieIndex : public WriteBatchEntryIndex {
  protected:
+  WriteBatchEntryPTrieIndexDetail::PTrieIndexContext* ctx_;
   terark::MainPatricia index_;
   WriteBatchKeyExtractor extractor_;
 
@@ -242,9 +264,19 @@ class WriteBatchEntryPTrieIndex : public WriteBatchEntryIndex {
   };
 
  public:
-  WriteBatchEntryPTrieIndex(WriteBatchKeyExtractor e)
-      : index_(trie_value_size, 512ull << 10, Patricia::SingleThreadShared),
+  WriteBatchEntryPTrieIndex(
+      WriteBatchEntryPTrieIndexDetail::PTrieIndexContext* ctx,
+      WriteBatchKeyExtractor e)
+      : ctx_(ctx),
+        index_(trie_value_size,
+               std::max(WriteBatchEntryPTrieIndexDetail::kMinTrieMemSize,
+                        ctx->trie_mem_size),
+               Patricia::SingleThreadShared),
         extractor_(e) {}
+  ~WriteBatchEntryPTrieIndex() {
+    ctx_->trie_mem_size =
+        std::max(ctx_->trie_mem_size / 2, index_.mem_size());
+  }
 
   static constexpr size_t trie_value_size =
       OverwriteKey ? sizeof(void*) : sizeof(uint32_t);
@@ -338,17 +370,8 @@ class WriteBatchEntryPTrieIndex : public WriteBatchEntryIndex {
 
 const WriteBatchEntryIndexFactory* patricia_WriteBatchEntryIndexFactory(
     const WriteBatchEntryIndexFactory* fallback) {
-  class WriteBatchEntryPTrieIndexContext : public WriteBatchEntryIndexContext {
-   public:
-    WriteBatchEntryIndexContext* fallback_context;
-    WriteBatchEntryPTrieIndexContext() : fallback_context(nullptr) {}
-
-    ~WriteBatchEntryPTrieIndexContext() {
-      if (fallback_context != nullptr) {
-        fallback_context->~WriteBatchEntryIndexContext();
-      }
-    }
-  };
+  using WriteBatchEntryPTrieIndexContext =
+      WriteBatchEntryPTrieIndexDetail::PTrieIndexContext;
   class PTrieIndexFactory : public WriteBatchEntryIndexFactory {
    public:
     WriteBatchEntryIndexContext* NewContext(Arena* a) const override {
@@ -366,15 +389,15 @@ const WriteBatchEntryIndexFactory* patricia_WriteBatchEntryIndexFactory(
                              overwrite_key);
       } else if (overwrite_key) {
         typedef WriteBatchEntryPTrieIndex<true> index_t;
-        return new (a->AllocateAligned(sizeof(index_t))) index_t(e);
+        return new (a->AllocateAligned(sizeof(index_t))) index_t(ptrie_ctx, e);
       } else {
         typedef WriteBatchEntryPTrieIndex<false> index_t;
-        return new (a->AllocateAligned(sizeof(index_t))) index_t(e);
+        return new (a->AllocateAligned(sizeof(index_t))) index_t(ptrie_ctx, e);
       }
     }
     PTrieIndexFactory(const WriteBatchEntryIndexFactory* _fallback)
         : fallback(_fallback) {}
-    const char* Name() const override { return "WriteBatchEntryIndexFactory"; }
+    const char* Name() const override { return "patricia"; }
 
    private:
     const WriteBatchEntryIndexFactory* fallback;
@@ -1,6 +1,7 @@
 #include "terark_zip_memtable.h"
 
 #include "rocksdb/terark_namespace.h"
+#include "util/string_util.h"
 
 #if defined(_MSC_VER)
 //#include <windows.h>
@@ -37,6 +38,16 @@ inline const char* build_key(terark::fstring user_key, uint64_t tag,
   return buffer->data();
 }
 
+// Map the 8 bytes of key following its first skip bytes onto a number that
+// preserves the lexicographical order, for interpolating the key density.
+inline double key_position(terark::fstring key, size_t skip) {
+  uint64_t pos = 0;
+  for (size_t i = skip; i < skip + 8; ++i) {
+    pos = (pos << 8) | (i < key.size() ? (unsigned char)key.data()[i] : 0);
+  }
+  return double(pos);
+}
+
 }  // namespace
 
 namespace TERARKDB_NAMESPACE {
@@ -45,6 +56,10 @@ namespace details = terark_memtable_details;
 
 static const uint64_t LOCK_FLAG = 1ULL << 63;
 static const uint32_t SIZE_MASK = INT32_MAX;
+// Growth of a trie that is accounted at once on the write path
+static const size_t MEMORY_USAGE_STEP = 4096;
+// User keys visited per trie by ApproximateNumEntries before extrapolating
+static const size_t NUM_ENTRIES_SCAN_LIMIT = 1024;
 
 bool MemWriterToken::init_value(void* valptr, size_t valsize) noexcept {
   assert(valsize == sizeof(uint32_t));
@@ -86,12 +101,13 @@ PatriciaTrieRep::PatriciaTrieRep(details::ConcurrentType concurrent_type,
                                  details::PatriciaKeyType patricia_key_type,
                                  bool handle_duplicate,
                                  intptr_t write_buffer_size,
-                                 Allocator* allocator)
-    : MemTableRep(allocator) {
+                                 int64_t seal_size, Allocator* allocator)
+    : MemTableRep(allocator), memory_usage_(0), num_entries_(0) {
   immutable_ = false;
   patricia_key_type_ = patricia_key_type;
   handle_duplicate_ = handle_duplicate;
   write_buffer_size_ = write_buffer_size;
+  seal_size_ = seal_size;
   if (concurrent_type == details::ConcurrentType::Native)
     concurrent_level_ = terark::Patricia::MultiWriteMultiRead;
   else
@@ -99,7 +115,10 @@ PatriciaTrieRep::PatriciaTrieRep(details::ConcurrentType concurrent_type,
   trie_vec_[0] =
       new MainPatricia(sizeof(uint32_t), write_buffer_size_, concurrent_level_);
   trie_vec_size_ = 1;
-  overhead_ = trie_vec_[0]->mem_size_inline();
+  trie_usage_[0].store(trie_vec_[0]->mem_size_inline(),
+                       std::memory_order_relaxed);
+  trie_reserved_[0].store(std::max<int64_t>(write_buffer_size_, 0),
+                          std::memory_order_relaxed);
 }
 
 PatriciaTrieRep::~PatriciaTrieRep() {
@@ -124,6 +143,10 @@ void PatriciaTrieRep::MarkReadOnly() {
 #endif
   static std::atomic<int> file_seq(0);
 
+  for (size_t i = 0; i < trie_vec_size_; ++i) {
+    UpdateMemoryUsage(i, 0);
+  }
+
   if (terark::getEnvBool("TerarkDB_csppMemTabDump")) {
     int curr_seq = file_seq++;
     for (size_t i = 0; i < trie_vec_size_; ++i) {
@@ -147,12 +170,105 @@ void PatriciaTrieRep::MarkReadOnly() {
 }
 
 size_t PatriciaTrieRep::ApproximateMemoryUsage() {
-  size_t sum = 0;
+  return memory_usage_.load(std::memory_order_relaxed);
+}
+
+void PatriciaTrieRep::UpdateMemoryUsage(size_t idx, size_t step) {
+  size_t curr = trie_vec_[idx]->mem_size_inline();
+  size_t prev = trie_usage_[idx].load(std::memory_order_relaxed);
+  while (curr > prev && curr - prev >= step) {
+    if (trie_usage_[idx].compare_exchange_weak(prev, curr,
+                                               std::memory_order_relaxed,
+                                               std::memory_order_relaxed)) {
+      memory_usage_.fetch_add(curr - prev, std::memory_order_relaxed);
+      break;
+    }
+  }
+}
+
+bool PatriciaTrieRep::ShouldSeal(size_t idx, bool* grow) const {
+  // The last slot is left for tries created on allocation failure
+  if (idx + 2 >= trie_vec_.size()) {
+    return false;
+  }
+  int64_t used = int64_t(trie_vec_[idx]->mem_size_inline());
+  if (seal_size_ > 0 && used >= seal_size_) {
+    *grow = false;
+    return true;
+  }
+  // Rotate shortly before the reserved memory runs out, so that inserts
+  // don't have to fail and roll back their allocations first.
+  *grow = true;
+  size_t reserved = trie_reserved_[idx].load(std::memory_order_relaxed);
+  return reserved > 0 && size_t(used) >= reserved / 8 * 7;
+}
+
+void PatriciaTrieRep::CreateNewTrie(size_t bound, bool grow) {
+  TERARK_VERIFY(trie_vec_size_ < trie_vec_.size());
+  if (write_buffer_size_ > 0) {
+    if (grow) {
+      if (write_buffer_size_ < size_limit_) write_buffer_size_ *= 2;
+      if (write_buffer_size_ > size_limit_) write_buffer_size_ = size_limit_;
+    }
+    if (size_t(write_buffer_size_) < bound)
+      write_buffer_size_ = std::min(bound + (16 << 20), size_t(-1) >> 1);
+  }
+  auto trie =
+      new MainPatricia(sizeof(uint32_t), write_buffer_size_, concurrent_level_);
+  UpdateMemoryUsage(trie_vec_size_ - 1, 0);
+  trie_usage_[trie_vec_size_].store(trie->mem_size_inline(),
+                                    std::memory_order_relaxed);
+  trie_reserved_[trie_vec_size_].store(std::max<int64_t>(write_buffer_size_, 0),
+                                       std::memory_order_relaxed);
+  trie_vec_[trie_vec_size_] = trie;
+  trie_vec_size_++;
+}
+
+uint64_t PatriciaTrieRep::ApproximateNumEntries(const Slice& start_ikey,
+                                                const Slice& end_ikey) {
+  terark::fstring start_key(start_ikey.data(), start_ikey.size() - 8);
+  terark::fstring end_key(end_ikey.data(), end_ikey.size() - 8);
+  if (!(start_key < end_key)) {
+    return 0;
+  }
+  size_t prefix = 0;
+  while (prefix < start_key.size() &&
+         start_key.data()[prefix] == end_key.data()[prefix]) {
+    ++prefix;
+  }
+  double range_span =
+      key_position(end_key, prefix) - key_position(start_key, prefix);
+  double count = 0;
   for (size_t i = 0; i < trie_vec_size_; ++i) {
-    sum += trie_vec_[i]->mem_size_inline();
+    auto trie = trie_vec_[i];
+    terark::Patricia::IteratorPtr iter;
+    iter.reset(trie->new_iter());
+    uint64_t trie_count = 0;
+    size_t scanned = 0;
+    bool valid = iter->seek_lower_bound(start_key);
+    while (valid && iter->word() < end_key) {
+      if (scanned++ == NUM_ENTRIES_SCAN_LIMIT) {
+        break;
+      }
+      auto vector =
+          (details::tag_vector_t*)trie->mem_get(iter->value_of<uint32_t>());
+      uint64_t size_loc = vector->size_loc.load(std::memory_order_relaxed);
+      trie_count += (size_loc >> 32) & SIZE_MASK;
+      valid = iter->incr();
+    }
+    if (scanned > NUM_ENTRIES_SCAN_LIMIT) {
+      // Assume the rest of the range is as dense as the part we visited
+      double scanned_span =
+          key_position(iter->word(), prefix) - key_position(start_key, prefix);
+      if (scanned_span > 0) {
+        count += trie_count * std::max(1.0, range_span / scanned_span);
+        continue;
+      }
+    }
+    count += trie_count;
   }
-  assert(sum >= overhead_);
-  return sum - overhead_;
+  return std::min(uint64_t(count),
+                  num_entries_.load(std::memory_order_relaxed));
 }
 
 bool PatriciaTrieRep::Contains(const Slice& internal_key) const {
@@ -378,20 +494,9 @@ bool PatriciaTrieRep::InsertKeyValue(const Slice& internal_key,
       return details::InsertResult::Fail;
   };
 
-  auto fn_create_new_trie = [&]() {
-    if (write_buffer_size_ > 0) {
-      if (write_buffer_size_ < size_limit_) write_buffer_size_ *= 2;
-      if (write_buffer_size_ > size_limit_) write_buffer_size_ = size_limit_;
-      size_t bound = key.size() + VarintLength(value.size()) + value.size();
-      if (size_t(write_buffer_size_) < bound)
-        write_buffer_size_ = std::min(bound + (16 << 20), size_t(-1) >> 1);
-    }
-    trie_vec_[trie_vec_size_] = new MainPatricia(
-        sizeof(uint32_t), write_buffer_size_, concurrent_level_);
-    trie_vec_size_++;
-  };
   // tool lambda fn end
   // function start
+  size_t bound = key.size() + VarintLength(value.size()) + value.size();
   if (handle_duplicate_) {
     for (size_t i = 0; i < trie_vec_size_; ++i) {
       auto* trie = trie_vec_[i];
@@ -411,8 +516,9 @@ bool PatriciaTrieRep::InsertKeyValue(const Slice& internal_key,
     }
   }
   details::InsertResult insert_result = details::InsertResult::Fail;
+  size_t curr_trie_vec_size;
   for (;;) {
-    size_t curr_trie_vec_size = trie_vec_size_;
+    curr_trie_vec_size = trie_vec_size_;
     insert_result = fn_insert_impl(trie_vec_[curr_trie_vec_size - 1]);
     if (insert_result == details::InsertResult::Duplicated) {
       return !handle_duplicate_;
@@ -423,11 +529,20 @@ bool PatriciaTrieRep::InsertKeyValue(const Slice& internal_key,
       assert(insert_result == details::InsertResult::Fail);
       std::unique_lock<std::mutex> lock(mutex_);
       if (curr_trie_vec_size == trie_vec_size_) {
-        fn_create_new_trie();
+        CreateNewTrie(bound, true);
       }
     }
   }
   assert(insert_result == details::InsertResult::Success);
+  num_entries_.fetch_add(1, std::memory_order_relaxed);
+  UpdateMemoryUsage(curr_trie_vec_size - 1, MEMORY_USAGE_STEP);
+  bool grow;
+  if (ShouldSeal(curr_trie_vec_size - 1, &grow)) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (curr_trie_vec_size == trie_vec_size_) {
+      CreateNewTrie(bound, grow);
+    }
+  }
   return true;
 }
 
@@ -817,7 +932,7 @@ MemTableRep* PatriciaTrieRepFactory::CreateMemTableRep(
   if (IsForwardBytewiseComparator(key_cmp.icomparator()->user_comparator())) {
     return new PatriciaTrieRep(concurrent_type_, patricia_key_type_,
                                needs_dup_key_check, write_buffer_size_,
-                               allocator);
+                               seal_size_, allocator);
   } else {
     return fallback_->CreateMemTableRep(key_cmp, needs_dup_key_check, allocator,
                                         transform, logger);
@@ -831,7 +946,7 @@ MemTableRep* PatriciaTrieRepFactory::CreateMemTableRep(
   if (IsForwardBytewiseComparator(key_cmp.icomparator()->user_comparator())) {
     return new PatriciaTrieRep(concurrent_type_, patricia_key_type_,
                                needs_dup_key_check, write_buffer_size_,
-                               allocator);
+                               seal_size_, allocator);
   } else {
     return fallback_->CreateMemTableRep(key_cmp, needs_dup_key_check, allocator,
                                         ioptions, mutable_cf_options,
@@ -842,23 +957,26 @@ MemTableRep* PatriciaTrieRepFactory::CreateMemTableRep(
 static MemTableRepFactory* CreatePatriciaTrieRepFactory(
     std::shared_ptr<class MemTableRepFactory>& fallback,
     details::ConcurrentType concurrent_type,
-    details::PatriciaKeyType patricia_key_type, int64_t write_buffer_size) {
+    details::PatriciaKeyType patricia_key_type, int64_t write_buffer_size,
+    int64_t seal_size) {
   if (!fallback) fallback.reset(new SkipListFactory());
   return new PatriciaTrieRepFactory(fallback, concurrent_type,
-                                    patricia_key_type, write_buffer_size);
+                                    patricia_key_type, write_buffer_size,
+                                    seal_size);
 }
 
 MemTableRepFactory* NewPatriciaTrieRepFactory(
     std::shared_ptr<class MemTableRepFactory> fallback) {
   return CreatePatriciaTrieRepFactory(fallback, details::ConcurrentType::Native,
                                       details::PatriciaKeyType::UserKey,
-                                      64ull << 20);
+                                      64ull << 20, 0);
 }
 
 MemTableRepFactory* NewPatriciaTrieRepFactory(
     const std::unordered_map<std::string, std::string>& options, Status* s) {
   details::ConcurrentType concurrent_type = details::ConcurrentType::Native;
   int64_t write_buffer_size = 64 * 1024 * 1024;
+  int64_t seal_size = 0;
   std::shared_ptr<class MemTableRepFactory> fallback;
   details::PatriciaKeyType patricia_key_type =
       details::PatriciaKeyType::UserKey;
@@ -877,6 +995,11 @@ MemTableRepFactory* NewPatriciaTrieRepFactory(
 #endif
   }
 
+  auto z = options.find("seal_size");
+  if (z != options.end()) {
+    seal_size = ParseInt64(z->second);
+  }
+
   auto f = options.find("fallback");
   if (f != options.end() && f->second != "patricia") {
     fallback.reset(CreateMemTableRepFactory(f->second, options, s));
@@ -892,7 +1015,8 @@ MemTableRepFactory* NewPatriciaTrieRepFactory(
   }
 
   return CreatePatriciaTrieRepFactory(fallback, concurrent_type,
-                                      patricia_key_type, write_buffer_size);
+                                      patricia_key_type, write_buffer_size,
+                                      seal_size);
 }
 
 }  // namespace TERARKDB_NAMESPACE
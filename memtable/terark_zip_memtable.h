@@ -47,6 +47,9 @@ namespace terark_memtable_details {
 
 typedef std::array<terark::MainPatricia*, 32> tries_t;
 
+// Accounted memory size of each trie, indexed like tries_t
+typedef std::array<std::atomic<size_t>, 32> usages_t;
+
 enum class ConcurrentType { Native, None };
 
 enum class PatriciaKeyType { UserKey, FullKey };
@@ -76,29 +79,51 @@ class PatriciaTrieRep : public MemTableRep {
   std::atomic_bool immutable_;
   terark_memtable_details::tries_t trie_vec_;
   size_t trie_vec_size_;
-  size_t overhead_;  // this overhead is for new memtable size check
+  // mem_size_inline() of each trie when it was last accounted, starting from
+  // the size of the empty trie so that a new memtable reports no usage.
+  terark_memtable_details::usages_t trie_usage_;
+  // Memory each trie reserved when it was created, 0 if unlimited. Read by
+  // ShouldSeal() without mutex_, unlike write_buffer_size_.
+  terark_memtable_details::usages_t trie_reserved_;
+  std::atomic<size_t> memory_usage_;
+  std::atomic<uint64_t> num_entries_;
+  // Reservation of the next trie. REQUIRES: mutex_ held after construction
   int64_t write_buffer_size_;
+  // Seal the active trie and start a new one once it uses this many bytes,
+  // 0 disables it.
+  int64_t seal_size_;
   static const int64_t size_limit_ = 1LL << 30;
   std::mutex mutex_;
 
+  // Account the growth of trie_vec_[idx] once it reaches step bytes.
+  void UpdateMemoryUsage(size_t idx, size_t step);
+
+  // Returns true if the active trie should be sealed before it runs out of
+  // memory, *grow tells whether the next trie should reserve more memory.
+  bool ShouldSeal(size_t idx, bool* grow) const;
+
+  // Append a new active trie, doubling the reserved memory if grow is set.
+  // REQUIRES: mutex_ held
+  void CreateNewTrie(size_t bound, bool grow);
+
  public:
   // Create a new patricia trie memtable rep with following options
   PatriciaTrieRep(terark_memtable_details::ConcurrentType concurrent_type,
                   terark_memtable_details::PatriciaKeyType patricia_key_type,
                   bool handle_duplicate, intptr_t write_buffer_size,
-                  Allocator* allocator);
+                  int64_t seal_size, Allocator* allocator);
 
   ~PatriciaTrieRep();
 
   // Return approximate memory usage which is sum of memory usage from
-  // all patricia trie handled by this rep.
+  // all patricia trie handled by this rep. It is maintained incrementally
+  // on insert, so it's cheap to call from the write path.
   virtual size_t ApproximateMemoryUsage() override;
 
-  // This approximition is not supported, return 0 instead.
-  virtual uint64_t ApproximateNumEntries(const Slice& /*start_ikey*/,
-                                         const Slice& /*end_ikey*/) override {
-    return 0;
-  }
+  // Count the entries of each trie within [start_ikey, end_ikey). Long
+  // ranges are extrapolated from the first keys by key distance.
+  virtual uint64_t ApproximateNumEntries(const Slice& start_ikey,
+                                         const Slice& end_ikey) override;
 
   // Return true if this rep contains querying key.
   virtual bool Contains(const Slice& internal_key) const override;
@@ -267,6 +292,7 @@ class PatriciaTrieRepFactory : public MemTableRepFactory {
   terark_memtable_details::ConcurrentType concurrent_type_;
   terark_memtable_details::PatriciaKeyType patricia_key_type_;
   int64_t write_buffer_size_;
+  int64_t seal_size_;
 
  public:
   PatriciaTrieRepFactory(
@@ -275,11 +301,12 @@ class PatriciaTrieRepFactory : public MemTableRepFactory {
           terark_memtable_details::ConcurrentType::Native,
       terark_memtable_details::PatriciaKeyType patricia_key_type =
           terark_memtable_details::PatriciaKeyType::UserKey,
-      int64_t write_buffer_size = 512LL * 1048576)
+      int64_t write_buffer_size = 512LL * 1048576, int64_t seal_size = 0)
       : fallback_(fallback),
         concurrent_type_(concurrent_type),
         patricia_key_type_(patricia_key_type),
-        write_buffer_size_(write_buffer_size) {}
+        write_buffer_size_(write_buffer_size),
+        seal_size_(seal_size) {}
 
   virtual ~PatriciaTrieRepFactory() {}
 
@@ -13,6 +13,8 @@
 #include "db/dbformat.h"
 #include "gtest/gtest.h"
 #include "rocksdb/terark_namespace.h"
+#include "table/scoped_arena_iterator.h"
+#include "util/testharness.h"
 
 namespace TERARKDB_NAMESPACE {
 
@@ -209,6 +211,58 @@ TEST_F(TerarkZipMemtableTest, MultiThreadingTest) {
          dur, total_size);
   delete mem_;
 }
+
+TEST_F(TerarkZipMemtableTest, MemoryAccountingAndSealTest) {
+  Options options;
+  Status s;
+  std::unordered_map<std::string, std::string> factory_options = {
+      {"seal_size", "1048576"}};
+  options.memtable_factory = std::shared_ptr<MemTableRepFactory>(
+      NewPatriciaTrieRepFactory(factory_options, &s));
+  ASSERT_OK(s);
+
+  InternalKeyComparator cmp(BytewiseComparator());
+  ImmutableCFOptions ioptions(options);
+  WriteBufferManager wb(1 << 30);
+
+  std::unique_ptr<MemTable> mem(
+      new MemTable(cmp, ioptions, MutableCFOptions(options), true, &wb,
+                   kMaxSequenceNumber, 0));
+
+  const int kNumKeys = 100000;
+  std::string value(100, 'v');
+  char key[16];
+  for (int i = 0; i < kNumKeys; ++i) {
+    snprintf(key, sizeof(key), "key%08d", i);
+    ASSERT_TRUE(mem->Add(i + 1, kTypeValue, key, value));
+  }
+
+  // Trie memory is accounted and reserved in the write buffer manager
+  ASSERT_GT(mem->ApproximateMemoryUsage(), kNumKeys * value.size());
+  ASSERT_GE(wb.memory_usage(), kNumKeys * value.size());
+
+  // Short ranges are counted exactly, across the sealed tries
+  InternalKey start("key00001000", kMaxSequenceNumber, kValueTypeForSeek);
+  InternalKey end("key00002000", kMaxSequenceNumber, kValueTypeForSeek);
+  ASSERT_EQ(1000U, mem->ApproximateStats(start.Encode(), end.Encode()).count);
+
+  // Long ranges are extrapolated and capped by the number of entries
+  InternalKey last("key00050000", kMaxSequenceNumber, kValueTypeForSeek);
+  auto count = mem->ApproximateStats(start.Encode(), last.Encode()).count;
+  ASSERT_GT(count, 1024U);
+  ASSERT_LE(count, static_cast<uint64_t>(kNumKeys));
+
+  // Sealing keeps every entry visible in order
+  Arena arena;
+  ReadOptions ro;
+  ScopedArenaIterator iter(mem->NewIterator(ro, &arena));
+  int n = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++n) {
+    snprintf(key, sizeof(key), "key%08d", n);
+    ASSERT_EQ(key, ExtractUserKey(iter->key()).ToString());
+  }
+  ASSERT_EQ(kNumKeys, n);
+}
 }  // namespace TERARKDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -144,6 +144,58 @@ TEST_F(WriteBufferManagerTest, NoCapCacheCost) {
   ASSERT_GE(cache->GetPinnedUsage(), 1024 * 1024);
   ASSERT_LT(cache->GetPinnedUsage(), 1024 * 1024 + 10000);
 }
+
+TEST_F(WriteBufferManagerTest, MemoryGovernor) {
+  const size_t kMB = 1024 * 1024;
+  std::shared_ptr<Cache> cache = NewLRUCache(200 * kMB, 4);
+  // A 100MB budget, of which the block cache keeps at least 20MB
+  std::shared_ptr<MemoryGovernor> governor(
+      new MemoryGovernor(100 * kMB, cache, 20 * kMB));
+  ASSERT_EQ(100 * kMB, cache->GetCapacity());
+  std::unique_ptr<WriteBufferManager> wbf(
+      new WriteBufferManager(0, nullptr, governor));
+  ASSERT_TRUE(wbf->tracks_memory());
+
+  governor->Reserve(MemoryGovernor::kTableReader, 50 * kMB);
+  ASSERT_EQ(50 * kMB, cache->GetCapacity());
+
+  wbf->ReserveMem(20 * kMB);
+  ASSERT_EQ(20 * kMB, governor->GetUsage(MemoryGovernor::kMemTable));
+  ASSERT_FALSE(governor->UnderPressure());
+  ASSERT_FALSE(wbf->ShouldFlush());
+
+  // 90MB reserved leaves the cache less than its minimum
+  wbf->ReserveMem(20 * kMB);
+  ASSERT_TRUE(governor->UnderPressure());
+  ASSERT_TRUE(wbf->ShouldFlush());
+  ASSERT_EQ(20 * kMB, cache->GetCapacity());
+
+  // Most memtable memory is being flushed already
+  wbf->ScheduleFreeMem(30 * kMB);
+  ASSERT_TRUE(governor->UnderPressure());
+  ASSERT_FALSE(wbf->ShouldFlush());
+
+  wbf->FreeMem(30 * kMB);
+  ASSERT_FALSE(governor->UnderPressure());
+  ASSERT_EQ(40 * kMB, cache->GetCapacity());
+
+  governor->Release(MemoryGovernor::kTableReader, 50 * kMB);
+  ASSERT_EQ(90 * kMB, cache->GetCapacity());
+  ASSERT_NE(std::string::npos,
+            governor->GetBreakdown().find("governor-memtables: 10485760"));
+
+  // Table readers alone over budget don't make small memtables flush
+  governor->Reserve(MemoryGovernor::kTableReader, 200 * kMB);
+  ASSERT_TRUE(governor->UnderPressure());
+  ASSERT_FALSE(governor->MemTablesOverBudget());
+  ASSERT_FALSE(wbf->ShouldFlush());
+  governor->Release(MemoryGovernor::kTableReader, 200 * kMB);
+
+  wbf->ScheduleFreeMem(10 * kMB);
+  wbf->FreeMem(10 * kMB);
+  ASSERT_EQ(0, governor->GetReservedUsage());
+  ASSERT_EQ(100 * kMB, cache->GetCapacity());
+}
 #endif  // ROCKSDB_LITE
 }  // namespace TERARKDB_NAMESPACE
 
@@ -0,0 +1,173 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include "monitoring/file_io_stats.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <atomic>
+
+#include "db/compaction_job.h"
+#include "port/port.h"
+#include "rocksdb/terark_namespace.h"
+#include "util/core_local.h"
+#include "util/filename.h"
+
+namespace TERARKDB_NAMESPACE {
+
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+__thread IOContext io_context = {kIOOriginatorOther, kIOFileKeySst, false};
+#endif
+
+IOContext* get_io_context() {
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+  return &io_context;
+#else
+  return nullptr;
+#endif
+}
+
+IOFileType IOFileTypeFromName(const std::string& fname) {
+  size_t pos = fname.find_last_of('/');
+  std::string base = pos == std::string::npos ? fname : fname.substr(pos + 1);
+  uint64_t number;
+  FileType type;
+  if (!ParseFileName(base, &number, &type)) {
+    return kIOFileOther;
+  }
+  switch (type) {
+    case kLogFile:
+      return kIOFileWal;
+    case kDescriptorFile:
+      return kIOFileManifest;
+    case kTableFile:
+      return kIOFileSst;
+    default:
+      return kIOFileOther;
+  }
+}
+
+namespace {
+
+struct ALIGN_AS(CACHE_LINE_SIZE) CoreFileIOCounters {
+  struct Entry {
+    std::atomic<uint64_t> read_bytes{0};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> write_bytes{0};
+    std::atomic<uint64_t> writes{0};
+  };
+  Entry entries[kIOOriginatorCount][kIOFileTypeCount];
+
+  void* operator new(size_t s) { return port::cacheline_aligned_alloc(s); }
+  void* operator new[](size_t s) { return port::cacheline_aligned_alloc(s); }
+  void operator delete(void* p) { port::cacheline_aligned_free(p); }
+  void operator delete[](void* p) { port::cacheline_aligned_free(p); }
+};
+
+CoreLocalArray<CoreFileIOCounters>* GetCoreCounters() {
+  // Leaked on purpose, files may still be closed by static destructors
+  static auto* counters = new CoreLocalArray<CoreFileIOCounters>();
+  return counters;
+}
+
+std::string OriginatorName(uint32_t originator) {
+  switch (originator) {
+    case kIOOriginatorOther:
+      return "Other";
+    case kIOOriginatorUserGet:
+      return "UserGet";
+    case kIOOriginatorUserScan:
+      return "UserScan";
+    case kIOOriginatorUserWrite:
+      return "UserWrite";
+    case kIOOriginatorFlush:
+      return "Flush";
+    case kIOOriginatorGarbageCollection:
+      return "GarbageCollection";
+    case kIOOriginatorMapCompaction:
+      return "MapCompaction";
+    default:
+      return std::string("Compaction(") +
+             GetCompactionReasonString(static_cast<CompactionReason>(
+                 originator - kIOOriginatorCompaction)) +
+             ")";
+  }
+}
+
+const char* kFileTypeNames[kIOFileTypeCount] = {
+    "Other", "WAL", "MANIFEST", "SST", "KeySST", "BlobSST", "MapSST",
+};
+
+}  // namespace
+
+void RecordFileIO(IOFileType file_type, bool is_write, uint64_t bytes) {
+  if (file_type == kIOFileUncounted) {
+    return;
+  }
+  IOOriginator originator = kIOOriginatorOther;
+  IOContext* context = get_io_context();
+  if (context != nullptr) {
+    originator = context->originator;
+    if (file_type == kIOFileSst) {
+      file_type = context->sst_type;
+    }
+  } else if (file_type == kIOFileSst) {
+    file_type = kIOFileKeySst;
+  }
+  auto& entry = GetCoreCounters()->Access()->entries[originator][file_type];
+  if (is_write) {
+    entry.write_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    entry.writes.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    entry.read_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    entry.reads.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void GetFileIOCounters(IOOriginator originator, IOFileType file_type,
+                       FileIOCounters* counters) {
+  *counters = FileIOCounters();
+  auto* core_counters = GetCoreCounters();
+  for (size_t i = 0; i < core_counters->Size(); ++i) {
+    auto& entry =
+        core_counters->AccessAtCore(i)->entries[originator][file_type];
+    counters->read_bytes += entry.read_bytes.load(std::memory_order_relaxed);
+    counters->reads += entry.reads.load(std::memory_order_relaxed);
+    counters->write_bytes += entry.write_bytes.load(std::memory_order_relaxed);
+    counters->writes += entry.writes.load(std::memory_order_relaxed);
+  }
+}
+
+void DumpFileIOStats(std::string* value) {
+  char buf[500];
+  snprintf(buf, sizeof(buf),
+           "\n** File IO Stats (process wide) **\n"
+           "%-40s %-8s %12s %12s %12s %12s\n",
+           "Originator", "File", "Read(MB)", "Reads", "Write(MB)", "Writes");
+  value->append(buf);
+  FileIOCounters counters;
+  for (uint32_t o = 0; o < kIOOriginatorCount; ++o) {
+    for (int t = 0; t < kIOFileTypeCount; ++t) {
+      GetFileIOCounters(static_cast<IOOriginator>(o),
+                        static_cast<IOFileType>(t), &counters);
+      if (counters.reads == 0 && counters.writes == 0) {
+        continue;
+      }
+      snprintf(buf, sizeof(buf),
+               "%-40s %-8s %12.1f %12" PRIu64 " %12.1f %12" PRIu64 "\n",
+               OriginatorName(o).c_str(), kFileTypeNames[t],
+               counters.read_bytes / 1048576.0, counters.reads,
+               counters.write_bytes / 1048576.0, counters.writes);
+      value->append(buf);
+    }
+  }
+}
+
+}  // namespace TERARKDB_NAMESPACE
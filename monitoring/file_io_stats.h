@@ -0,0 +1,150 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+
+#include "rocksdb/listener.h"
+#include "rocksdb/terark_namespace.h"
+
+namespace TERARKDB_NAMESPACE {
+
+// The kind of file an IO goes to. Readers and writers get it from the file
+// name, kIOFileSst is then resolved to the kind of sst the thread is working
+// on, see IOSstTypeScope, unless the writer of an output was told its kind.
+enum IOFileType : uint8_t {
+  kIOFileOther,
+  kIOFileWal,
+  kIOFileManifest,
+  kIOFileSst,
+  kIOFileKeySst,
+  kIOFileBlobSst,
+  kIOFileMapSst,
+  kIOFileTypeCount,
+  // IO to files of this type is not counted, e.g. reads of a file that was
+  // loaded into memory
+  kIOFileUncounted = kIOFileTypeCount,
+};
+
+// What an IO is done for. Compactions are split by CompactionReason.
+enum IOOriginator : uint32_t {
+  kIOOriginatorOther,
+  kIOOriginatorUserGet,
+  kIOOriginatorUserScan,
+  kIOOriginatorUserWrite,
+  kIOOriginatorFlush,
+  kIOOriginatorGarbageCollection,
+  kIOOriginatorMapCompaction,
+  kIOOriginatorCompaction,
+  kIOOriginatorCount = kIOOriginatorCompaction +
+                       static_cast<uint32_t>(CompactionReason::kNumOfReasons),
+};
+
+inline IOOriginator IOOriginatorForCompaction(CompactionReason reason) {
+  return static_cast<IOOriginator>(kIOOriginatorCompaction +
+                                   static_cast<uint32_t>(reason));
+}
+
+IOFileType IOFileTypeFromName(const std::string& fname);
+
+// The IO context of a thread, set by the scopes below
+struct IOContext {
+  IOOriginator originator;
+  IOFileType sst_type;
+  // Output goes to the bottommost level
+  bool bottommost;
+};
+
+// nullptr without thread local support, IO is then counted as kIOFileKeySst
+// done by kIOOriginatorOther
+IOContext* get_io_context();
+
+// Tags the IO of this thread with originator until the scope ends. Nested
+// scopes win, so a user Get() running inside a compaction filter counts as
+// a Get().
+class IOOriginatorScope {
+ public:
+  explicit IOOriginatorScope(IOOriginator originator)
+      : context_(get_io_context()) {
+    if (context_ != nullptr) {
+      saved_ = context_->originator;
+      context_->originator = originator;
+    }
+  }
+  ~IOOriginatorScope() {
+    if (context_ != nullptr) {
+      context_->originator = saved_;
+    }
+  }
+
+ private:
+  IOContext* context_;
+  IOOriginator saved_ = kIOOriginatorOther;
+};
+
+// Sst reads of this thread go to sst_type until the scope ends
+class IOSstTypeScope {
+ public:
+  explicit IOSstTypeScope(IOFileType sst_type)
+      : context_(get_io_context()) {
+    if (context_ != nullptr) {
+      saved_ = context_->sst_type;
+      context_->sst_type = sst_type;
+    }
+  }
+  ~IOSstTypeScope() {
+    if (context_ != nullptr) {
+      context_->sst_type = saved_;
+    }
+  }
+
+ private:
+  IOContext* context_;
+  IOFileType saved_ = kIOFileKeySst;
+};
+
+// Marks the compaction of this thread as writing the bottommost level until
+// the scope ends, so the rate limiter can tell it apart
+class IOBottommostScope {
+ public:
+  explicit IOBottommostScope(bool bottommost) : context_(get_io_context()) {
+    if (context_ != nullptr) {
+      saved_ = context_->bottommost;
+      context_->bottommost = bottommost;
+    }
+  }
+  ~IOBottommostScope() {
+    if (context_ != nullptr) {
+      context_->bottommost = saved_;
+    }
+  }
+
+ private:
+  IOContext* context_;
+  bool saved_ = false;
+};
+
+struct FileIOCounters {
+  uint64_t read_bytes = 0;
+  uint64_t reads = 0;
+  uint64_t write_bytes = 0;
+  uint64_t writes = 0;
+};
+
+// Counts one read or write of bytes to a file of file_type, done for the
+// originator of this thread. The counters are process wide, they are kept
+// per core and summed on read.
+void RecordFileIO(IOFileType file_type, bool is_write, uint64_t bytes);
+
+void GetFileIOCounters(IOOriginator originator, IOFileType file_type,
+                       FileIOCounters* counters);
+
+// Appends a table of the non-zero counters
+void DumpFileIOStats(std::string* value);
+
+}  // namespace TERARKDB_NAMESPACE
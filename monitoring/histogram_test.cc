@@ -6,8 +6,11 @@
 #include "monitoring/histogram.h"
 
 #include <cmath>
+#include <thread>
+#include <vector>
 
 #include "monitoring/histogram_windowing.h"
+#include "monitoring/thread_local_histogram.h"
 #include "rocksdb/terark_namespace.h"
 #include "util/testharness.h"
 
@@ -215,6 +218,58 @@ TEST_F(HistogramTest, HistogramWindowingMerge) {
   ASSERT_EQ(histogramWindowing.max(), 5);
 }
 
+TEST_F(HistogramTest, LogLinearBuckets) {
+  size_t last_index = 0;
+  for (uint64_t value = 0; value < (1U << 20); ++value) {
+    size_t index = LogLinearBuckets::IndexForValue(value);
+    ASSERT_LE(LogLinearBuckets::LowerBound(index), value);
+    ASSERT_GE(LogLinearBuckets::UpperBound(index), value);
+    ASSERT_LE(last_index, index);
+    last_index = index;
+  }
+  ASSERT_EQ(LogLinearBuckets::kBucketCount - 1,
+            LogLinearBuckets::IndexForValue(port::kMaxUint64));
+}
+
+TEST_F(HistogramTest, ThreadLocalHistogram) {
+  ThreadLocalHistogram histogram;
+  HistogramSnapshot snapshot;
+  histogram.GetSnapshot(&snapshot);
+  ASSERT_EQ(0, snapshot.count);
+  ASSERT_EQ(0, snapshot.Percentile(50));
+
+  const int kThreads = 8;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&histogram] {
+      for (uint64_t value = 1; value <= 10000; ++value) {
+        histogram.Add(value);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  // the shards of exited threads are kept
+  histogram.GetSnapshot(&snapshot);
+  ASSERT_EQ(kThreads * 10000, snapshot.count);
+  ASSERT_EQ(10000, snapshot.max);
+  ASSERT_EQ(5000.5, snapshot.Average());
+  ASSERT_LE(fabs(snapshot.Percentile(50) - 5000), 5000 / 16);
+  ASSERT_LE(fabs(snapshot.Percentile(99) - 9900), 9900 / 16);
+  ASSERT_EQ(10000, snapshot.Percentile(100));
+
+  // a live shard is counted once, next to the retired ones
+  HistogramSnapshot older = snapshot;
+  histogram.Add(3);
+  histogram.Add(3);
+  histogram.GetSnapshot(&snapshot);
+  snapshot.Subtract(older);
+  ASSERT_EQ(2, snapshot.count);
+  ASSERT_EQ(6, snapshot.sum);
+  ASSERT_EQ(3, snapshot.Percentile(50));
+}
+
 }  // namespace TERARKDB_NAMESPACE
 
 int main(int argc, char** argv) {
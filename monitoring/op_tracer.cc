@@ -0,0 +1,213 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include "monitoring/op_tracer.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "monitoring/perf_context_imp.h"
+#include "rocksdb/terark_namespace.h"
+#include "util/random.h"
+
+namespace TERARKDB_NAMESPACE {
+
+const size_t OpTraceRecord::kWords = sizeof(OpTraceRecord) / sizeof(uint64_t);
+static_assert(sizeof(OpTraceRecord) % sizeof(uint64_t) == 0,
+              "OpTraceRecord must be made of uint64_t");
+
+// The sequence is odd while a writer fills the slot, and 2 * (pos + 1) once
+// the record written at position pos is complete.
+struct OpTracer::Slot {
+  std::atomic<uint64_t> seq{0};
+  std::atomic<uint64_t> words[sizeof(OpTraceRecord) / sizeof(uint64_t)];
+};
+
+OpTracer::OpTracer(Env* env, uint32_t sample_rate)
+    : env_(env),
+      sample_rate_(sample_rate),
+      head_(0),
+      slots_(new Slot[kCapacity]) {}
+
+OpTracer::~OpTracer() {}
+
+bool OpTracer::ShouldSample() const {
+  uint32_t sample_rate = sample_rate_.load(std::memory_order_relaxed);
+  return sample_rate != 0 &&
+         (sample_rate == 1 || Random::GetTLSInstance()->OneIn(sample_rate));
+}
+
+void OpTracer::Record(const OpTraceRecord& record) {
+  uint64_t pos = head_.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = slots_[pos % kCapacity];
+  uint64_t seq = slot.seq.load(std::memory_order_relaxed);
+  if ((seq & 1) != 0 || seq > 2 * pos ||
+      !slot.seq.compare_exchange_strong(seq, 2 * pos + 1,
+                                        std::memory_order_relaxed)) {
+    // a lapped writer still owns the slot, or a newer record is already there
+    return;
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  uint64_t words[sizeof(OpTraceRecord) / sizeof(uint64_t)];
+  memcpy(words, &record, sizeof words);
+  for (size_t i = 0; i < OpTraceRecord::kWords; ++i) {
+    slot.words[i].store(words[i], std::memory_order_relaxed);
+  }
+  slot.seq.store(2 * pos + 2, std::memory_order_release);
+}
+
+void OpTracer::GetRecords(std::vector<OpTraceRecord>* records) const {
+  std::vector<std::pair<uint64_t, OpTraceRecord>> sorted;
+  sorted.reserve(kCapacity);
+  uint64_t words[sizeof(OpTraceRecord) / sizeof(uint64_t)];
+  for (size_t i = 0; i < kCapacity; ++i) {
+    const Slot& slot = slots_[i];
+    uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq == 0 || (seq & 1) != 0) {
+      continue;
+    }
+    for (size_t j = 0; j < OpTraceRecord::kWords; ++j) {
+      words[j] = slot.words[j].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != seq) {
+      // overwritten while we were reading it
+      continue;
+    }
+    sorted.emplace_back();
+    sorted.back().first = seq;
+    memcpy(&sorted.back().second, words, sizeof words);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](const std::pair<uint64_t, OpTraceRecord>& a,
+               const std::pair<uint64_t, OpTraceRecord>& b) {
+              return a.first < b.first;
+            });
+  for (auto& pair : sorted) {
+    records->push_back(pair.second);
+  }
+}
+
+void OpTracer::Dump(std::string* value) const {
+  static const char* kTypeNames[] = {"Get", "Seek", "Write"};
+  std::vector<OpTraceRecord> records;
+  GetRecords(&records);
+
+  char buf[1000];
+  snprintf(buf, sizeof(buf),
+           "\n** Op Traces **\n"
+           "Sampled 1 in %" PRIu32 ", times in micros, (n) is the count\n"
+           "Type          StartMicros    Total   Memtable(n)        SST(n)"
+           "       Blob(n)  CacheHit  BlockRead  IOWait  GroupWait      WAL"
+           "  WALSync  WriteMem    Delay\n",
+           GetSampleRate());
+  value->append(buf);
+  for (auto& r : records) {
+    snprintf(buf, sizeof(buf),
+             "%-5s %19" PRIu64 " %8" PRIu64 " %8" PRIu64 "(%3" PRIu64
+             ") %8" PRIu64 "(%3" PRIu64 ") %8" PRIu64 "(%3" PRIu64
+             ") %9" PRIu64 " %10" PRIu64 " %7" PRIu64 " %10" PRIu64
+             " %8" PRIu64 " %8" PRIu64 " %9" PRIu64 " %8" PRIu64 "\n",
+             kTypeNames[static_cast<size_t>(r.type)], r.start_micros,
+             r.total_nanos / 1000, r.memtable_nanos / 1000, r.memtable_count,
+             r.sst_nanos / 1000, r.sst_count, r.blob_nanos / 1000,
+             r.blob_count, r.block_cache_hit_count, r.block_read_count,
+             r.block_read_nanos / 1000, r.write_group_wait_nanos / 1000,
+             r.wal_nanos / 1000, r.wal_sync_nanos / 1000,
+             r.write_memtable_nanos / 1000, r.write_delay_nanos / 1000);
+    value->append(buf);
+  }
+}
+
+namespace {
+// Reads the PerfContext counters of this thread. The fields are linear in the
+// counters, so subtracting two readings gives what happened in between.
+void ReadPerfContext(OpTraceRecord* r) {
+#ifndef NPERF_CONTEXT
+  const PerfContext& ctx = *get_perf_context();
+  r->memtable_nanos = ctx.get_from_memtable_time + ctx.seek_on_memtable_time;
+  r->memtable_count = ctx.get_from_memtable_count + ctx.seek_on_memtable_count;
+  // memtable iterators are children of the merging iterator too
+  uint64_t child_nanos =
+      ctx.get_from_output_files_time + ctx.seek_child_seek_time;
+  uint64_t child_count = ctx.get_from_table_count + ctx.seek_child_seek_count;
+  r->sst_nanos = child_nanos > ctx.seek_on_memtable_time
+                     ? child_nanos - ctx.seek_on_memtable_time
+                     : 0;
+  r->sst_count = child_count > ctx.seek_on_memtable_count
+                     ? child_count - ctx.seek_on_memtable_count
+                     : 0;
+  r->blob_nanos = ctx.blob_fetch_time;
+  r->blob_count = ctx.blob_fetch_count;
+  r->block_cache_hit_count = ctx.block_cache_hit_count;
+  r->block_read_count = ctx.block_read_count;
+  r->block_read_nanos = ctx.block_read_time;
+  r->write_group_wait_nanos = ctx.write_thread_wait_nanos;
+  r->wal_nanos = ctx.write_wal_time;
+  r->wal_sync_nanos = ctx.write_wal_sync_time;
+  r->write_memtable_nanos = ctx.write_memtable_time;
+  r->write_delay_nanos = ctx.write_delay_time;
+#else
+  (void)r;
+#endif
+}
+
+#ifndef NPERF_CONTEXT
+// The counters of PerfContext, the per level contexts that follow them are
+// only collected when the caller enables them.
+const size_t kPerfCountersSize = offsetof(PerfContext, level_to_perf_context);
+#endif
+}  // namespace
+
+void OpTraceScope::Start(OpTracer* tracer, OpTraceType type) {
+  tracer_ = tracer;
+  saved_perf_level_ = GetPerfLevel();
+  if (saved_perf_level_ < PerfLevel::kEnableCount) {
+#ifndef NPERF_CONTEXT
+    saved_perf_context_.reset(new char[kPerfCountersSize]);
+    memcpy(saved_perf_context_.get(),
+           static_cast<const void*>(get_perf_context()), kPerfCountersSize);
+#endif
+    SetPerfLevel(PerfLevel::kEnableTimeExceptForMutex);
+  }
+  memset(&start_, 0, sizeof start_);
+  start_.type = type;
+  start_.start_micros = tracer->env()->NowMicros();
+  ReadPerfContext(&start_);
+  start_nanos_ = tracer->env()->NowNanos();
+}
+
+void OpTraceScope::Finish() {
+  OpTraceRecord record;
+  memset(&record, 0, sizeof record);
+  ReadPerfContext(&record);
+  uint64_t* words = reinterpret_cast<uint64_t*>(&record);
+  const uint64_t* start_words = reinterpret_cast<const uint64_t*>(&start_);
+  for (size_t i = 0; i < OpTraceRecord::kWords; ++i) {
+    words[i] = words[i] > start_words[i] ? words[i] - start_words[i] : 0;
+  }
+  record.type = start_.type;
+  record.start_micros = start_.start_micros;
+  record.total_nanos = tracer_->env()->NowNanos() - start_nanos_;
+  if (saved_perf_level_ < PerfLevel::kEnableCount) {
+    SetPerfLevel(saved_perf_level_);
+#ifndef NPERF_CONTEXT
+    memcpy(static_cast<void*>(get_perf_context()), saved_perf_context_.get(),
+           kPerfCountersSize);
+    saved_perf_context_.reset();
+#endif
+  }
+  tracer_->Record(record);
+}
+
+}  // namespace TERARKDB_NAMESPACE
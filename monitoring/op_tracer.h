@@ -0,0 +1,124 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "rocksdb/perf_level.h"
+#include "rocksdb/terark_namespace.h"
+
+namespace TERARKDB_NAMESPACE {
+
+enum class OpTraceType : uint64_t {
+  kGet,
+  kSeek,
+  kWrite,
+};
+
+// Latency breakdown of one sampled operation, taken from the PerfContext
+// counters the operation moved. Every field is a uint64_t so a record can be
+// stored as an array of words.
+struct OpTraceRecord {
+  OpTraceType type;
+  uint64_t start_micros;
+  uint64_t total_nanos;
+  // read path
+  uint64_t memtable_nanos;
+  uint64_t memtable_count;
+  uint64_t sst_nanos;
+  uint64_t sst_count;  // tables probed, map sst links included
+  uint64_t blob_nanos;
+  uint64_t blob_count;
+  uint64_t block_cache_hit_count;
+  uint64_t block_read_count;
+  uint64_t block_read_nanos;  // IO wait
+  // write path
+  uint64_t write_group_wait_nanos;
+  uint64_t wal_nanos;
+  uint64_t wal_sync_nanos;  // part of wal_nanos
+  uint64_t write_memtable_nanos;
+  uint64_t write_delay_nanos;
+
+  static const size_t kWords;
+};
+
+// OpTracer samples one in sample_rate operations and keeps the breakdown of
+// the last kCapacity of them in a ring buffer. Writers claim a slot with a
+// fetch_add and publish it with a per slot sequence, a writer that finds its
+// slot still being written by a lapped writer drops its record. Readers
+// never block writers.
+class OpTracer {
+ public:
+  static const size_t kCapacity = 1024;
+
+  explicit OpTracer(Env* env, uint32_t sample_rate = 0);
+  ~OpTracer();
+
+  Env* env() const { return env_; }
+
+  // 0 disables tracing
+  void SetSampleRate(uint32_t sample_rate) {
+    sample_rate_.store(sample_rate, std::memory_order_relaxed);
+  }
+  uint32_t GetSampleRate() const {
+    return sample_rate_.load(std::memory_order_relaxed);
+  }
+
+  bool ShouldSample() const;
+
+  void Record(const OpTraceRecord& record);
+
+  // Appends the buffered records to records, oldest first
+  void GetRecords(std::vector<OpTraceRecord>* records) const;
+
+  // Appends a human readable table of the buffered records
+  void Dump(std::string* value) const;
+
+ private:
+  struct Slot;
+
+  Env* env_;
+  std::atomic<uint32_t> sample_rate_;
+  std::atomic<uint64_t> head_;
+  std::unique_ptr<Slot[]> slots_;
+};
+
+// Traces the operation in its scope if the tracer samples it. If the thread
+// collects no perf stats, its PerfContext is switched to
+// kEnableTimeExceptForMutex while the operation runs and its counters are
+// restored afterwards. A thread collecting counts only is left at that level,
+// its records then carry the counts and the total time without the time
+// breakdown.
+class OpTraceScope {
+ public:
+  OpTraceScope(OpTracer* tracer, OpTraceType type) : tracer_(nullptr) {
+    if (tracer != nullptr && tracer->ShouldSample()) {
+      Start(tracer, type);
+    }
+  }
+  ~OpTraceScope() {
+    if (tracer_ != nullptr) {
+      Finish();
+    }
+  }
+
+ private:
+  void Start(OpTracer* tracer, OpTraceType type);
+  void Finish();
+
+  OpTracer* tracer_;
+  PerfLevel saved_perf_level_;
+  // the caller's PerfContext counters, only set if the level was raised
+  std::unique_ptr<char[]> saved_perf_context_;
+  uint64_t start_nanos_;
+  OpTraceRecord start_;
+};
+
+}  // namespace TERARKDB_NAMESPACE
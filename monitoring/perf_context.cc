@@ -57,12 +57,16 @@ void PerfContext::Reset() {
   internal_recent_skipped_count = 0;
   internal_merge_count = 0;
   write_wal_time = 0;
+  write_wal_sync_time = 0;
 
   get_snapshot_time = 0;
   get_from_memtable_time = 0;
   get_from_memtable_count = 0;
   get_post_process_time = 0;
   get_from_output_files_time = 0;
+  get_from_table_count = 0;
+  blob_fetch_time = 0;
+  blob_fetch_count = 0;
   seek_on_memtable_time = 0;
   seek_on_memtable_count = 0;
   next_on_memtable_count = 0;
@@ -164,11 +168,15 @@ std::string PerfContext::ToString(bool exclude_zero_counters) const {
   PERF_CONTEXT_OUTPUT(internal_recent_skipped_count);
   PERF_CONTEXT_OUTPUT(internal_merge_count);
   PERF_CONTEXT_OUTPUT(write_wal_time);
+  PERF_CONTEXT_OUTPUT(write_wal_sync_time);
   PERF_CONTEXT_OUTPUT(get_snapshot_time);
   PERF_CONTEXT_OUTPUT(get_from_memtable_time);
   PERF_CONTEXT_OUTPUT(get_from_memtable_count);
   PERF_CONTEXT_OUTPUT(get_post_process_time);
   PERF_CONTEXT_OUTPUT(get_from_output_files_time);
+  PERF_CONTEXT_OUTPUT(get_from_table_count);
+  PERF_CONTEXT_OUTPUT(blob_fetch_time);
+  PERF_CONTEXT_OUTPUT(blob_fetch_count);
   PERF_CONTEXT_OUTPUT(seek_on_memtable_time);
   PERF_CONTEXT_OUTPUT(seek_on_memtable_count);
   PERF_CONTEXT_OUTPUT(next_on_memtable_count);
@@ -135,6 +135,7 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {NUMBER_MULTIGET_KEYS_FOUND, "rocksdb.number.multiget.keys.found"},
     {NO_ITERATOR_CREATED, "rocksdb.num.iterator.created"},
     {NO_ITERATOR_DELETED, "rocksdb.num.iterator.deleted"},
+    {COMPACTION_RANGE_DEL_SKIP, "rocksdb.compaction.range_del.skip"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
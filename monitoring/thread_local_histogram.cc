@@ -0,0 +1,153 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include "monitoring/thread_local_histogram.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include "rocksdb/terark_namespace.h"
+
+namespace TERARKDB_NAMESPACE {
+
+const size_t LogLinearBuckets::kBucketCount;
+
+void HistogramSnapshot::Clear() {
+  count = 0;
+  sum = 0;
+  max = 0;
+  memset(buckets, 0, sizeof buckets);
+}
+
+void HistogramSnapshot::Merge(const HistogramSnapshot& other) {
+  count += other.count;
+  sum += other.sum;
+  max = std::max(max, other.max);
+  for (size_t i = 0; i < LogLinearBuckets::kBucketCount; ++i) {
+    buckets[i] += other.buckets[i];
+  }
+}
+
+void HistogramSnapshot::Subtract(const HistogramSnapshot& older) {
+  count -= older.count;
+  sum -= older.sum;
+  for (size_t i = 0; i < LogLinearBuckets::kBucketCount; ++i) {
+    buckets[i] -= older.buckets[i];
+  }
+}
+
+double HistogramSnapshot::Percentile(double p) const {
+  if (count == 0) {
+    return 0;
+  }
+  double threshold = count * (p / 100.0);
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < LogLinearBuckets::kBucketCount; ++i) {
+    uint64_t bucket = buckets[i];
+    if (bucket == 0) {
+      continue;
+    }
+    cumulative += bucket;
+    if (cumulative >= threshold) {
+      // interpolate inside the bucket, the last one is capped at max
+      uint64_t lower = LogLinearBuckets::LowerBound(i);
+      uint64_t upper =
+          std::min(std::max(max, lower), LogLinearBuckets::UpperBound(i));
+      double pos = (threshold - (cumulative - bucket)) / bucket;
+      return lower + (upper - lower) * pos;
+    }
+  }
+  return static_cast<double>(max);
+}
+
+double HistogramSnapshot::Average() const {
+  return count == 0 ? 0 : static_cast<double>(sum) / count;
+}
+
+std::string HistogramSnapshot::ToString() const {
+  char buf[200];
+  snprintf(buf, sizeof(buf),
+           "Count: %" PRIu64 " Average: %.4f P50: %.2f P99: %.2f P99.9: %.2f"
+           " Max: %" PRIu64,
+           count, Average(), Percentile(50), Percentile(99), Percentile(99.9),
+           max);
+  return buf;
+}
+
+ThreadLocalHistogram::Shard::Shard(ThreadLocalHistogram* _owner)
+    : owner(_owner), count(0), sum(0), max(0) {
+  for (auto& bucket : buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+void ThreadLocalHistogram::Shard::AppendTo(HistogramSnapshot* snapshot) const {
+  snapshot->count += count.load(std::memory_order_relaxed);
+  snapshot->sum += sum.load(std::memory_order_relaxed);
+  snapshot->max = std::max(snapshot->max, max.load(std::memory_order_relaxed));
+  for (size_t i = 0; i < LogLinearBuckets::kBucketCount; ++i) {
+    snapshot->buckets[i] += buckets[i].load(std::memory_order_relaxed);
+  }
+}
+
+ThreadLocalHistogram::ThreadLocalHistogram() : tls_(&RetireShard) {}
+
+ThreadLocalHistogram::~ThreadLocalHistogram() {}
+
+ThreadLocalHistogram::Shard* ThreadLocalHistogram::NewShard() {
+  Shard* shard = new Shard(this);
+  tls_.Reset(shard);
+  return shard;
+}
+
+void ThreadLocalHistogram::RetireShard(void* ptr) {
+  Shard* shard = static_cast<Shard*>(ptr);
+  ThreadLocalHistogram* owner = shard->owner;
+  {
+    std::lock_guard<SpinMutex> lock(owner->retired_mutex_);
+    shard->AppendTo(&owner->retired_);
+  }
+  delete shard;
+}
+
+namespace {
+struct FoldContext {
+  HistogramSnapshot* snapshot;
+  bool retired_added;
+};
+}  // namespace
+
+void ThreadLocalHistogram::GetSnapshot(HistogramSnapshot* snapshot) const {
+  snapshot->Clear();
+  // A shard retires under the exclusive lock Fold() shares, so adding
+  // retired_ inside the fold sees every shard either live or retired.
+  FoldContext context{snapshot, false};
+  tls_.Fold(
+      [](void* entry, void* res) {
+        auto* ctx = static_cast<FoldContext*>(res);
+        auto* shard = static_cast<Shard*>(entry);
+        if (!ctx->retired_added) {
+          std::lock_guard<SpinMutex> lock(shard->owner->retired_mutex_);
+          ctx->snapshot->Merge(shard->owner->retired_);
+          ctx->retired_added = true;
+        }
+        shard->AppendTo(ctx->snapshot);
+      },
+      &context);
+  if (!context.retired_added) {
+    std::lock_guard<SpinMutex> lock(retired_mutex_);
+    snapshot->Merge(retired_);
+  }
+}
+
+}  // namespace TERARKDB_NAMESPACE
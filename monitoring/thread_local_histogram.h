@@ -0,0 +1,149 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "port/likely.h"
+#include "port/port.h"
+#include "rocksdb/terark_namespace.h"
+#include "util/mutexlock.h"
+#include "util/thread_local.h"
+
+namespace TERARKDB_NAMESPACE {
+
+// Log-linear buckets in the spirit of HdrHistogram: values below
+// kSubBucketCount get a bucket each, above that every power of two is split
+// into kSubBucketCount buckets, so a bucket never spans more than 1/16 of
+// its values. Values above kMaxValue fall into the last bucket.
+struct LogLinearBuckets {
+  static const int kSubBucketBits = 4;
+  static const uint64_t kSubBucketCount = 1ULL << kSubBucketBits;
+  static const int kMaxValueBits = 36;
+  static const uint64_t kMaxValue = (1ULL << kMaxValueBits) - 1;
+  static const size_t kBucketCount =
+      (kMaxValueBits - kSubBucketBits + 1) * kSubBucketCount;
+
+  static size_t IndexForValue(uint64_t value) {
+    if (value < kSubBucketCount) {
+      return static_cast<size_t>(value);
+    }
+    if (value > kMaxValue) {
+      value = kMaxValue;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - kSubBucketBits;
+    return static_cast<size_t>((shift + 1) * kSubBucketCount +
+                               ((value >> shift) & (kSubBucketCount - 1)));
+  }
+
+  // Smallest value of the bucket
+  static uint64_t LowerBound(size_t index) {
+    if (index < kSubBucketCount) {
+      return index;
+    }
+    int shift = static_cast<int>(index / kSubBucketCount) - 1;
+    return (kSubBucketCount + index % kSubBucketCount) << shift;
+  }
+
+  // Largest value of the bucket
+  static uint64_t UpperBound(size_t index) {
+    if (index < kSubBucketCount) {
+      return index;
+    }
+    int shift = static_cast<int>(index / kSubBucketCount) - 1;
+    return LowerBound(index) + (1ULL << shift) - 1;
+  }
+};
+
+// A plain copy of a ThreadLocalHistogram, also used for the difference of two
+// copies when reporting per interval.
+struct HistogramSnapshot {
+  HistogramSnapshot() { Clear(); }
+
+  void Clear();
+  void Merge(const HistogramSnapshot& other);
+  // Leaves what was recorded after `older` was taken. max is kept as is.
+  void Subtract(const HistogramSnapshot& older);
+
+  double Percentile(double p) const;
+  double Average() const;
+  std::string ToString() const;
+
+  uint64_t count;
+  uint64_t sum;
+  uint64_t max;
+  uint64_t buckets[LogLinearBuckets::kBucketCount];
+};
+
+// A histogram for hot paths. Every thread records into its own cache line
+// aligned shard with plain relaxed stores, no atomic read-modify-write and no
+// lock, and shards are only summed when the histogram is read. A thread
+// allocates its shard on its first record and folds it into the histogram
+// when it exits, so memory is bounded by the number of live recording
+// threads, about 4KB each.
+class ThreadLocalHistogram {
+ public:
+  ThreadLocalHistogram();
+  ~ThreadLocalHistogram();
+
+  ThreadLocalHistogram(const ThreadLocalHistogram&) = delete;
+  ThreadLocalHistogram& operator=(const ThreadLocalHistogram&) = delete;
+
+  void Add(uint64_t value) {
+    Shard* shard = static_cast<Shard*>(tls_.Get());
+    if (UNLIKELY(shard == nullptr)) {
+      shard = NewShard();
+    }
+    shard->Add(value);
+  }
+
+  // Everything recorded so far, from all threads
+  void GetSnapshot(HistogramSnapshot* snapshot) const;
+
+ private:
+  struct ALIGN_AS(CACHE_LINE_SIZE) Shard {
+    explicit Shard(ThreadLocalHistogram* _owner);
+
+    void Add(uint64_t value) {
+      auto& bucket = buckets[LogLinearBuckets::IndexForValue(value)];
+      bucket.store(bucket.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+      count.store(count.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_relaxed);
+      sum.store(sum.load(std::memory_order_relaxed) + value,
+                std::memory_order_relaxed);
+      if (value > max.load(std::memory_order_relaxed)) {
+        max.store(value, std::memory_order_relaxed);
+      }
+    }
+    void AppendTo(HistogramSnapshot* snapshot) const;
+
+    void* operator new(size_t s) { return port::cacheline_aligned_alloc(s); }
+    void operator delete(void* p) { port::cacheline_aligned_free(p); }
+
+    ThreadLocalHistogram* owner;
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+    std::atomic<uint64_t> buckets[LogLinearBuckets::kBucketCount];
+  };
+
+  Shard* NewShard();
+  static void RetireShard(void* ptr);
+
+  // Shards of exited threads. RetireShard() runs under the global lock of
+  // ThreadLocalPtr, GetSnapshot() reads retired_ under that lock too unless
+  // no shard is alive, so a shard is never counted twice.
+  mutable SpinMutex retired_mutex_;
+  HistogramSnapshot retired_;
+  // Declared after retired_, destroying it retires the remaining shards
+  mutable ThreadLocalPtr tls_;
+};
+
+}  // namespace TERARKDB_NAMESPACE
@@ -82,6 +82,7 @@ ImmutableCFOptions::ImmutableCFOptions(const ImmutableDBOptions& db_options,
       preserve_deletes(db_options.preserve_deletes),
       listeners(db_options.listeners),
       row_cache(db_options.row_cache),
+      value_persistent_cache(db_options.value_persistent_cache),
       memtable_insert_with_hint_prefix_extractor(
           cf_options.memtable_insert_with_hint_prefix_extractor.get()),
       cf_paths(cf_options.cf_paths) {
@@ -171,6 +172,8 @@ void MutableCFOptions::Dump(Logger* log) const {
                  blob_size);
   ROCKS_LOG_INFO(log, "                     blob_large_key_ratio: %f",
                  blob_large_key_ratio);
+  ROCKS_LOG_INFO(log, "                enable_adaptive_blob_size: %d",
+                 enable_adaptive_blob_size);
   ROCKS_LOG_INFO(log, "                            blob_gc_ratio: %f",
                  blob_gc_ratio);
   ROCKS_LOG_INFO(log, "      soft_pending_compaction_bytes_limit: %" PRIu64,
@@ -265,6 +268,7 @@ MutableCFOptions::MutableCFOptions(const ColumnFamilyOptions& options, Env* env)
       max_subcompactions(options.max_subcompactions),
       blob_size(options.blob_size),
       blob_large_key_ratio(options.blob_large_key_ratio),
+      enable_adaptive_blob_size(options.enable_adaptive_blob_size),
       blob_gc_ratio(options.blob_gc_ratio),
       soft_pending_compaction_bytes_limit(
           options.soft_pending_compaction_bytes_limit),
@@ -129,6 +129,8 @@ struct ImmutableCFOptions {
 
   std::shared_ptr<Cache> row_cache;
 
+  std::shared_ptr<PersistentCache> value_persistent_cache;
+
   const SliceTransform* memtable_insert_with_hint_prefix_extractor;
 
   std::vector<DbPath> cf_paths;
@@ -158,6 +160,7 @@ struct MutableCFOptions {
         max_subcompactions(0),
         blob_size(0),
         blob_large_key_ratio(0),
+        enable_adaptive_blob_size(false),
         blob_gc_ratio(0),
         soft_pending_compaction_bytes_limit(0),
         hard_pending_compaction_bytes_limit(0),
@@ -217,6 +220,7 @@ struct MutableCFOptions {
   uint32_t max_subcompactions;
   size_t blob_size;
   double blob_large_key_ratio;
+  bool enable_adaptive_blob_size;
   double blob_gc_ratio;
   uint64_t soft_pending_compaction_bytes_limit;
   uint64_t hard_pending_compaction_bytes_limit;
@@ -82,6 +82,7 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       wal_recovery_mode(options.wal_recovery_mode),
       allow_2pc(options.allow_2pc),
       row_cache(options.row_cache),
+      value_persistent_cache(options.value_persistent_cache),
 #ifndef ROCKSDB_LITE
       wal_filter(options.wal_filter),
 #endif  // ROCKSDB_LITE
@@ -229,6 +230,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "                              Options.row_cache: None");
   }
+  ROCKS_LOG_HEADER(log, "                 Options.value_persistent_cache: %p",
+                   value_persistent_cache.get());
 #ifndef ROCKSDB_LITE
   ROCKS_LOG_HEADER(log, "                             Options.wal_filter: %s",
                    wal_filter ? wal_filter->Name() : "None");
@@ -266,6 +269,7 @@ MutableDBOptions::MutableDBOptions()
       stats_dump_period_sec(600),
       stats_persist_period_sec(600),
       stats_history_buffer_size(1024 * 1024),
+      op_trace_sample_rate(0),
       max_open_files(-1),
       bytes_per_sync(0),
       wal_bytes_per_sync(0),
@@ -287,6 +291,7 @@ MutableDBOptions::MutableDBOptions(const DBOptions& options)
       stats_dump_period_sec(options.stats_dump_period_sec),
       stats_persist_period_sec(options.stats_persist_period_sec),
       stats_history_buffer_size(options.stats_history_buffer_size),
+      op_trace_sample_rate(options.op_trace_sample_rate),
       max_open_files(options.max_open_files),
       bytes_per_sync(options.bytes_per_sync),
       wal_bytes_per_sync(options.wal_bytes_per_sync),
@@ -322,6 +327,8 @@ void MutableDBOptions::Dump(Logger* log) const {
                    stats_persist_period_sec);
   ROCKS_LOG_HEADER(log, "              Options.stats_history_buffer_size: %d",
                    stats_history_buffer_size);
+  ROCKS_LOG_HEADER(log, "                   Options.op_trace_sample_rate: %u",
+                   op_trace_sample_rate);
   ROCKS_LOG_HEADER(log, "                         Options.max_open_files: %d",
                    max_open_files);
   ROCKS_LOG_HEADER(log,
@@ -75,6 +75,7 @@ struct ImmutableDBOptions {
   WALRecoveryMode wal_recovery_mode;
   bool allow_2pc;
   std::shared_ptr<Cache> row_cache;
+  std::shared_ptr<PersistentCache> value_persistent_cache;
 #ifndef ROCKSDB_LITE
   WalFilter* wal_filter;
 #endif  // ROCKSDB_LITE
@@ -110,6 +111,7 @@ struct MutableDBOptions {
   unsigned int stats_dump_period_sec;
   unsigned int stats_persist_period_sec;
   size_t stats_history_buffer_size;
+  uint32_t op_trace_sample_rate;
   int max_open_files;
   uint64_t bytes_per_sync;
   uint64_t wal_bytes_per_sync;
@@ -257,6 +257,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                    blob_size);
   ROCKS_LOG_HEADER(log, "                   Options.blob_large_key_ratio: %f",
                    blob_large_key_ratio);
+  ROCKS_LOG_HEADER(log, "              Options.enable_adaptive_blob_size: %d",
+                   enable_adaptive_blob_size);
   ROCKS_LOG_HEADER(log, "                          Options.blob_gc_ratio: %f",
                    blob_gc_ratio);
 
@@ -560,6 +562,8 @@ ReadOptions::ReadOptions()
       read_tier(kReadAllTier),
       verify_checksums(true),
       fill_cache(true),
+      fill_persistent_cache(true),
+      cache_admission(CacheAdmission::kAdmitDefault),
       tailing(false),
       managed(false),
       total_order_seek(false),
@@ -578,6 +582,8 @@ ReadOptions::ReadOptions(bool cksum, bool cache)
       read_tier(kReadAllTier),
       verify_checksums(cksum),
       fill_cache(cache),
+      fill_persistent_cache(true),
+      cache_admission(CacheAdmission::kAdmitDefault),
       tailing(false),
       managed(false),
       total_order_seek(false),
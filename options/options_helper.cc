@@ -93,6 +93,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.persist_stats_to_disk = immutable_db_options.persist_stats_to_disk;
   options.stats_history_buffer_size =
       mutable_db_options.stats_history_buffer_size;
+  options.op_trace_sample_rate = mutable_db_options.op_trace_sample_rate;
   options.advise_random_on_open = immutable_db_options.advise_random_on_open;
   options.allow_mmap_populate = immutable_db_options.allow_mmap_populate;
   options.write_buffer_flush_pri = immutable_db_options.write_buffer_flush_pri;
@@ -126,6 +127,7 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.wal_recovery_mode = immutable_db_options.wal_recovery_mode;
   options.allow_2pc = immutable_db_options.allow_2pc;
   options.row_cache = immutable_db_options.row_cache;
+  options.value_persistent_cache = immutable_db_options.value_persistent_cache;
 #ifndef ROCKSDB_LITE
   options.wal_filter = immutable_db_options.wal_filter;
 #endif  // ROCKSDB_LITE
@@ -169,6 +171,8 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
       mutable_cf_options.disable_auto_compactions;
   cf_opts.blob_size = mutable_cf_options.blob_size;
   cf_opts.blob_large_key_ratio = mutable_cf_options.blob_large_key_ratio;
+  cf_opts.enable_adaptive_blob_size =
+      mutable_cf_options.enable_adaptive_blob_size;
   cf_opts.blob_gc_ratio = mutable_cf_options.blob_gc_ratio;
   cf_opts.soft_pending_compaction_bytes_limit =
       mutable_cf_options.soft_pending_compaction_bytes_limit;
@@ -1731,6 +1735,10 @@ std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct DBOptions, stats_persist_period_sec),
           OptionType::kUInt, OptionVerificationType::kNormal, true,
           offsetof(struct MutableDBOptions, stats_persist_period_sec)}},
+        {"op_trace_sample_rate",
+         {offsetof(struct DBOptions, op_trace_sample_rate),
+          OptionType::kUInt32T, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableDBOptions, op_trace_sample_rate)}},
         {"persist_stats_to_disk",
          {offsetof(struct DBOptions, persist_stats_to_disk),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
@@ -1948,6 +1956,10 @@ std::unordered_map<std::string, OptionTypeInfo>
          {offset_of(&ColumnFamilyOptions::blob_large_key_ratio),
           OptionType::kDouble, OptionVerificationType::kNormal, true,
           offsetof(struct MutableCFOptions, blob_large_key_ratio)}},
+        {"enable_adaptive_blob_size",
+         {offset_of(&ColumnFamilyOptions::enable_adaptive_blob_size),
+          OptionType::kBoolean, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, enable_adaptive_blob_size)}},
         {"blob_gc_ratio",
          {offset_of(&ColumnFamilyOptions::blob_gc_ratio), OptionType::kDouble,
           OptionVerificationType::kNormal, true,
@@ -200,6 +200,8 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
       {offsetof(struct DBOptions, listeners),
        sizeof(std::vector<std::shared_ptr<EventListener>>)},
       {offsetof(struct DBOptions, row_cache), sizeof(std::shared_ptr<Cache>)},
+      {offsetof(struct DBOptions, value_persistent_cache),
+       sizeof(std::shared_ptr<PersistentCache>)},
       {offsetof(struct DBOptions, metrics_reporter_factory),
        sizeof(std::shared_ptr<MetricsReporterFactory>)},
       {offsetof(struct DBOptions, wal_filter), sizeof(const WalFilter*)},
@@ -277,6 +279,7 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "stats_persist_period_sec=54321;"
                              "persist_stats_to_disk=true;"
                              "stats_history_buffer_size=14159;"
+                             "op_trace_sample_rate=1000;"
                              "allow_fallocate=true;"
                              "allow_mmap_reads=false;"
                              "use_direct_reads=false;"
@@ -467,6 +470,7 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "disable_auto_compactions=false;"
       "blob_size=1028;"
       "blob_large_key_ratio=0.5;"
+      "enable_adaptive_blob_size=true;"
       "blob_size=1024;"
       "blob_gc_ratio=0.05;"
       "report_bg_io_stats=true;"
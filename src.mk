@@ -1,6 +1,8 @@
 # These are the sources from which librocksdb.a is built:
 LIB_SOURCES =                                                   \
+  cache/admission_cache.cc                                      \
   cache/clock_cache.cc                                          \
+  cache/hot_key_sketch.cc                                       \
   cache/lirs_cache.cc                                           \
   cache/lru_cache.cc                                            \
   cache/sharded_cache.cc                                        \
@@ -76,20 +78,24 @@ LIB_SOURCES =                                                   \
   memtable/hash_cuckoo_rep.cc                                   \
   memtable/hash_linklist_rep.cc                                 \
   memtable/hash_skiplist_rep.cc                                 \
+  memtable/hash_sorted_rep.cc                                   \
   memtable/skiplistrep.cc                                       \
   memtable/terark_zip_entry_index.cc                            \
   memtable/terark_zip_memtable.cc                               \
   memtable/vectorrep.cc                                         \
   memtable/write_buffer_manager.cc                              \
+  monitoring/file_io_stats.cc                                   \
   monitoring/histogram.cc                                       \
   monitoring/histogram_windowing.cc                             \
   monitoring/in_memory_stats_history.cc                         \
   monitoring/instrumented_mutex.cc                              \
   monitoring/iostats_context.cc                                 \
+  monitoring/op_tracer.cc                                       \
   monitoring/perf_context.cc                                    \
   monitoring/perf_level.cc                                      \
   monitoring/persistent_stats_history.cc                        \
   monitoring/statistics.cc                                      \
+  monitoring/thread_local_histogram.cc                          \
   monitoring/thread_status_impl.cc                              \
   monitoring/thread_status_updater.cc                           \
   monitoring/thread_status_updater_debug.cc                     \
@@ -170,6 +176,7 @@ LIB_SOURCES =                                                   \
   util/jemalloc_nodump_allocator.cc                             \
   util/lazy_buffer.cc                                           \
   util/log_buffer.cc                                            \
+  util/memory_governor.cc                                       \
   util/murmurhash.cc                                            \
   util/random.cc                                                \
   util/rate_limiter.cc                                          \
@@ -285,6 +292,7 @@ TEST_LIB_SOURCES = \
   utilities/cassandra/test_utils.cc                             \
 
 MAIN_SOURCES =                                                          \
+  cache/admission_cache_test.cc                                         \
   cache/cache_bench.cc                                                  \
   cache/cache_test.cc                                                   \
   db/column_family_test.cc                                              \
@@ -371,6 +379,7 @@ MAIN_SOURCES =                                                          \
   env/env_basic_test.cc                                                 \
   env/env_test.cc                                                       \
   env/mock_env_test.cc                                                  \
+  memtable/hash_sorted_rep_test.cc                                      \
   memtable/inlineskiplist_test.cc                                       \
   memtable/memtablerep_bench.cc                                         \
   memtable/skiplist_test.cc                                             \
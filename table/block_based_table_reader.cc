@@ -146,8 +146,10 @@ Cache::Handle* GetEntryFromCache(Cache* block_cache, const Slice& key,
                                  uint64_t* block_cache_miss_stats,
                                  uint64_t* block_cache_hit_stats,
                                  Statistics* statistics,
-                                 GetContext* get_context) {
+                                 GetContext* get_context, uint64_t file_number,
+                                 const char* block_type) {
   auto cache_handle = block_cache->Lookup(key, statistics);
+  block_cache->RecordHotKey(key, file_number, block_type);
   if (cache_handle != nullptr) {
     PERF_COUNTER_ADD(block_cache_hit_count, 1);
     if (get_context != nullptr) {
@@ -1252,7 +1254,8 @@ Status BlockBasedTable::GetDataBlockFromCache(
             ? (is_index ? &get_context->get_context_stats_.num_cache_index_hit
                         : &get_context->get_context_stats_.num_cache_data_hit)
             : nullptr,
-        statistics, get_context);
+        statistics, get_context, rep->file_number,
+        is_index ? "index" : "data");
     if (block->cache_handle != nullptr) {
       block->value =
           reinterpret_cast<Block*>(block_cache->Value(block->cache_handle));
@@ -1301,13 +1304,15 @@ Status BlockBasedTable::GetDataBlockFromCache(
     if (block_cache != nullptr && block->value->own_bytes() &&
         read_options.fill_cache) {
       size_t charge = block->value->ApproximateMemoryUsage();
-      s = block_cache->Insert(block_cache_key, block->value, charge,
-                              &DeleteCachedEntry<Block>,
-                              &(block->cache_handle));
+      s = block_cache->InsertWithAdmission(
+          block_cache_key, block->value, charge, &DeleteCachedEntry<Block>,
+          &(block->cache_handle), Cache::Priority::LOW,
+          read_options.cache_admission);
 #ifndef NDEBUG
       block_cache->TEST_mark_as_data_block(block_cache_key, charge);
 #endif  // NDEBUG
-      if (s.ok()) {
+      // a block rejected by the admission policy comes back without a handle
+      if (s.ok() && block->cache_handle != nullptr) {
         if (get_context != nullptr) {
           get_context->get_context_stats_.num_cache_add++;
           get_context->get_context_stats_.num_cache_bytes_write += charge;
@@ -1334,7 +1339,7 @@ Status BlockBasedTable::GetDataBlockFromCache(
             RecordTick(statistics, BLOCK_CACHE_DATA_BYTES_INSERT, charge);
           }
         }
-      } else {
+      } else if (!s.ok()) {
         RecordTick(statistics, BLOCK_CACHE_ADD_FAILURES);
         delete block->value;
         block->value = nullptr;
@@ -1350,7 +1355,7 @@ Status BlockBasedTable::GetDataBlockFromCache(
 Status BlockBasedTable::PutDataBlockToCache(
     const Slice& block_cache_key, const Slice& compressed_block_cache_key,
     Cache* block_cache, Cache* block_cache_compressed,
-    const ReadOptions& /*read_options*/, const ImmutableCFOptions& ioptions,
+    const ReadOptions& read_options, const ImmutableCFOptions& ioptions,
     CachableEntry<Block>* cached_block, BlockContents* raw_block_contents,
     CompressionType raw_block_comp_type, uint32_t format_version,
     const Slice& compression_dict, SequenceNumber seq_no,
@@ -1414,14 +1419,15 @@ Status BlockBasedTable::PutDataBlockToCache(
   // insert into uncompressed block cache
   if (block_cache != nullptr && cached_block->value->own_bytes()) {
     size_t charge = cached_block->value->ApproximateMemoryUsage();
-    s = block_cache->Insert(block_cache_key, cached_block->value, charge,
-                            &DeleteCachedEntry<Block>,
-                            &(cached_block->cache_handle), priority);
+    s = block_cache->InsertWithAdmission(
+        block_cache_key, cached_block->value, charge,
+        &DeleteCachedEntry<Block>, &(cached_block->cache_handle), priority,
+        read_options.cache_admission);
 #ifndef NDEBUG
     block_cache->TEST_mark_as_data_block(block_cache_key, charge);
 #endif  // NDEBUG
-    if (s.ok()) {
-      assert(cached_block->cache_handle != nullptr);
+    // a block rejected by the admission policy comes back without a handle
+    if (s.ok() && cached_block->cache_handle != nullptr) {
       if (get_context != nullptr) {
         get_context->get_context_stats_.num_cache_add++;
         get_context->get_context_stats_.num_cache_bytes_write += charge;
@@ -1449,7 +1455,7 @@ Status BlockBasedTable::PutDataBlockToCache(
       }
       assert(reinterpret_cast<Block*>(block_cache->Value(
                  cached_block->cache_handle)) == cached_block->value);
-    } else {
+    } else if (!s.ok()) {
       RecordTick(statistics, BLOCK_CACHE_ADD_FAILURES);
       delete cached_block->value;
       cached_block->value = nullptr;
@@ -1575,7 +1581,7 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
                   : nullptr,
       get_context ? &get_context->get_context_stats_.num_cache_filter_hit
                   : nullptr,
-      statistics, get_context);
+      statistics, get_context, rep_->file_number, "filter");
 
   FilterBlockReader* filter = nullptr;
   if (cache_handle != nullptr) {
@@ -1656,7 +1662,7 @@ InternalIteratorBase<BlockHandle>* BlockBasedTable::NewIndexIterator(
                   : nullptr,
       get_context ? &get_context->get_context_stats_.num_cache_index_hit
                   : nullptr,
-      statistics, get_context);
+      statistics, get_context, rep_->file_number, "index");
 
   if (cache_handle == nullptr && no_io) {
     if (input_iter != nullptr) {
@@ -2234,6 +2240,7 @@ void BlockBasedTableIteratorBase<TBlockIter, TValue>::InitDataBlock() {
     if (!for_compaction_ && read_options_.readahead_size == 0) {
       num_file_reads_++;
       if (num_file_reads_ > 2) {
+        read_options_.fill_persistent_cache = false;
         if (!rep->file->use_direct_io() &&
             (data_block_handle.offset() +
                  static_cast<size_t>(data_block_handle.size()) +
@@ -2372,6 +2379,14 @@ FragmentedRangeTombstoneIterator* BlockBasedTable::NewRangeTombstoneIterator(
       rep_->fragmented_range_dels, rep_->internal_comparator, snapshot);
 }
 
+void BlockBasedTable::UpdateMaxCoveringTombstoneSeq(
+    const ReadOptions& read_options, const Slice& user_key,
+    SequenceNumber* max_covering_tombstone_seq) {
+  UpdateMaxCoveringTombstoneSeq(rep_->fragmented_range_dels.get(),
+                                rep_->internal_comparator, read_options,
+                                user_key, max_covering_tombstone_seq);
+}
+
 bool BlockBasedTable::FullFilterKeyMayMatch(
     const ReadOptions& read_options, FilterBlockReader* filter,
     const Slice& internal_key, const bool no_io,
@@ -119,6 +119,11 @@ class BlockBasedTable : public TableReader {
   FragmentedRangeTombstoneIterator* NewRangeTombstoneIterator(
       const ReadOptions& read_options) override;
 
+  using TableReader::UpdateMaxCoveringTombstoneSeq;
+  void UpdateMaxCoveringTombstoneSeq(
+      const ReadOptions& read_options, const Slice& user_key,
+      SequenceNumber* max_covering_tombstone_seq) override;
+
   // @param skip_filters Disables loading/accessing the filter block
   Status Get(const ReadOptions& readOptions, const Slice& key,
              GetContext* get_context, const SliceTransform* prefix_extractor,
@@ -566,7 +571,12 @@ class BlockBasedTableIteratorBase : public InternalIteratorBase<TValue> {
         is_index_(is_index),
         key_includes_seq_(key_includes_seq),
         index_key_is_full_(index_key_is_full),
-        for_compaction_(for_compaction) {}
+        for_compaction_(for_compaction) {
+    if (for_compaction_ || read_options_.readahead_size != 0) {
+      // blocks of a sequential scan are unlikely to be read again soon
+      read_options_.fill_persistent_cache = false;
+    }
+  }
 
   ~BlockBasedTableIteratorBase() { delete index_iter_; }
 
@@ -631,7 +641,8 @@ class BlockBasedTableIteratorBase : public InternalIteratorBase<TValue> {
 
  protected:
   BlockBasedTable* table_;
-  const ReadOptions read_options_;
+  // fill_persistent_cache is turned off once the iterator starts readahead
+  ReadOptions read_options_;
   const InternalKeyComparator& icomp_;
   InternalIteratorBase<BlockHandle>* index_iter_;
   TBlockIter block_iter_;
@@ -149,7 +149,7 @@ inline void BlockFetcher::PrepareBufferForBlockFromFile() {
 
 inline void BlockFetcher::InsertCompressedBlockToPersistentCacheIfNeeded() {
   if (status_.ok() && read_options_.fill_cache &&
-      cache_options_.persistent_cache &&
+      read_options_.fill_persistent_cache && cache_options_.persistent_cache &&
       cache_options_.persistent_cache->IsCompressed()) {
     // insert to raw cache
     PersistentCacheHelper::InsertRawPage(cache_options_, handle_, used_buf_,
@@ -159,7 +159,7 @@ inline void BlockFetcher::InsertCompressedBlockToPersistentCacheIfNeeded() {
 
 inline void BlockFetcher::InsertUncompressedBlockToPersistentCacheIfNeeded() {
   if (status_.ok() && !got_from_prefetch_buffer_ && read_options_.fill_cache &&
-      cache_options_.persistent_cache &&
+      read_options_.fill_persistent_cache && cache_options_.persistent_cache &&
       !cache_options_.persistent_cache->IsCompressed()) {
     // insert to uncompressed cache
     PersistentCacheHelper::InsertUncompressedPage(cache_options_, handle_,
@@ -5,9 +5,12 @@
 
 #include "table/persistent_cache_helper.h"
 
+#include "rocksdb/persistent_cache.h"
 #include "rocksdb/terark_namespace.h"
 #include "table/block_based_table_reader.h"
 #include "table/format.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
 
 namespace TERARKDB_NAMESPACE {
 
@@ -112,4 +115,60 @@ Status PersistentCacheHelper::LookupUncompressedPage(
   return Status::OK();
 }
 
+namespace {
+// record keys have a different shape than the block keys of
+// BlockBasedTable, the tag only makes a clash between them less likely
+const char kRecordKeyTag = '\xff';
+
+void GetRecordKey(uint64_t file_number, const Slice& record_id,
+                  std::string* key) {
+  key->reserve(1 + sizeof(uint64_t) + record_id.size());
+  key->push_back(kRecordKeyTag);
+  PutFixed64(key, file_number);
+  key->append(record_id.data(), record_id.size());
+}
+}  // namespace
+
+void PersistentCacheHelper::InsertRecord(PersistentCache* cache,
+                                         uint64_t file_number,
+                                         const Slice& record_id,
+                                         const Slice& data) {
+  assert(cache != nullptr);
+  std::string key;
+  GetRecordKey(file_number, record_id, &key);
+  std::string value;
+  value.reserve(data.size() + sizeof(uint32_t));
+  value.append(data.data(), data.size());
+  PutFixed32(&value, crc32c::Mask(crc32c::Value(data.data(), data.size())));
+  cache->Insert(key, value.data(), value.size());
+}
+
+bool PersistentCacheHelper::LookupRecord(PersistentCache* cache,
+                                         uint64_t file_number,
+                                         const Slice& record_id,
+                                         std::string* data,
+                                         Statistics* statistics) {
+  assert(cache != nullptr);
+  std::string key;
+  GetRecordKey(file_number, record_id, &key);
+  std::unique_ptr<char[]> value;
+  size_t size;
+  Status s = cache->Lookup(key, &value, &size);
+  if (!s.ok() || size < sizeof(uint32_t)) {
+    // cache miss
+    RecordTick(statistics, PERSISTENT_CACHE_MISS);
+    return false;
+  }
+  size -= sizeof(uint32_t);
+  uint32_t crc = crc32c::Unmask(DecodeFixed32(value.get() + size));
+  if (crc != crc32c::Value(value.get(), size)) {
+    // stale or torn record, read it from the table again
+    RecordTick(statistics, PERSISTENT_CACHE_MISS);
+    return false;
+  }
+  RecordTick(statistics, PERSISTENT_CACHE_HIT);
+  data->assign(value.get(), size);
+  return true;
+}
+
 }  // namespace TERARKDB_NAMESPACE
@@ -14,6 +14,7 @@
 namespace TERARKDB_NAMESPACE {
 
 struct BlockContents;
+class PersistentCache;
 
 // PersistentCacheHelper
 //
@@ -40,6 +41,23 @@ class PersistentCacheHelper {
   static Status LookupUncompressedPage(
       const PersistentCacheOptions& cache_options, const BlockHandle& handle,
       BlockContents* contents);
+
+  // Records are values read out of a table one at a time (separated blob
+  // values, TerarkZip records) instead of whole blocks. They are keyed by
+  // (file_number, record_id) and stored with a checksum trailer, a record
+  // whose checksum doesn't match is treated as a miss. A cache holding
+  // records must not be shared between DBs, file numbers are only unique
+  // within one DB.
+
+  // insert record into cache, the write is asynchronous if the cache
+  // pipelines its writes
+  static void InsertRecord(PersistentCache* cache, uint64_t file_number,
+                           const Slice& record_id, const Slice& data);
+
+  // lookup record from cache, return true and fill data on hit
+  static bool LookupRecord(PersistentCache* cache, uint64_t file_number,
+                           const Slice& record_id, std::string* data,
+                           Statistics* statistics);
 };
 
 }  // namespace TERARKDB_NAMESPACE
@@ -9,6 +9,7 @@
 
 #include "table_reader.h"
 
+#include "rocksdb/snapshot.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/terark_namespace.h"
 #include "table/get_context.h"
@@ -46,4 +47,22 @@ void TableReader::UpdateMaxCoveringTombstoneSeq(
   }
 }
 
+void TableReader::UpdateMaxCoveringTombstoneSeq(
+    const FragmentedRangeTombstoneList* tombstones,
+    const InternalKeyComparator& icmp, const ReadOptions& readOptions,
+    const Slice& user_key, SequenceNumber* max_covering_tombstone_seq) {
+  if (tombstones == nullptr || max_covering_tombstone_seq == nullptr ||
+      readOptions.ignore_range_deletions) {
+    return;
+  }
+  SequenceNumber snapshot = kMaxSequenceNumber;
+  if (readOptions.snapshot != nullptr) {
+    snapshot = readOptions.snapshot->GetSequenceNumber();
+  }
+  FragmentedRangeTombstoneIterator range_del_iter(tombstones, icmp, snapshot);
+  *max_covering_tombstone_seq =
+      std::max(*max_covering_tombstone_seq,
+               range_del_iter.MaxCoveringTombstoneSeqnum(user_key));
+}
+
 }  // namespace TERARKDB_NAMESPACE
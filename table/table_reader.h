@@ -125,11 +125,19 @@ class TableReader {
   virtual void SetTableCacheHandle(Cache* /*table_cache*/,
                                    Cache::Handle* /*handle*/) {}
 
-  void UpdateMaxCoveringTombstoneSeq(
+  // Readers that keep their tombstones fragmented should override this with
+  // a call to the static version below, it doesn't allocate.
+  virtual void UpdateMaxCoveringTombstoneSeq(
       const ReadOptions& readOptions, const Slice& user_key,
       SequenceNumber* max_covering_tombstone_seq);
 
   virtual void Close() {}
+
+ protected:
+  static void UpdateMaxCoveringTombstoneSeq(
+      const FragmentedRangeTombstoneList* tombstones,
+      const InternalKeyComparator& icmp, const ReadOptions& readOptions,
+      const Slice& user_key, SequenceNumber* max_covering_tombstone_seq);
 };
 
 }  // namespace TERARKDB_NAMESPACE
@@ -415,6 +415,7 @@ bool TerarkZipCFOptionsFromEnv(ColumnFamilyOptions& cfo,
   MyOverrideInt(cfo, max_subcompactions);
   MyOverrideXiB(cfo, blob_size);
   MyOverrideDouble(cfo, blob_large_key_ratio);
+  MyOverrideBool(cfo, enable_adaptive_blob_size);
   MyOverrideDouble(cfo, blob_gc_ratio);
 
   if (tzo.debugLevel) {
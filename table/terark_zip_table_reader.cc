@@ -13,8 +13,10 @@
 #include "table/get_context.h"
 #include "table/internal_iterator.h"
 #include "table/meta_blocks.h"
+#include "table/persistent_cache_helper.h"
 #include "table/sst_file_writer_collectors.h"
 #include "table/terark_zip_common.h"
+#include "util/coding.h"
 #include "util/util.h"
 
 #ifndef _MSC_VER
@@ -829,6 +831,14 @@ TerarkZipTableReaderBase::NewRangeTombstoneIterator(
                                               snapshot);
 }
 
+void TerarkZipTableReaderBase::UpdateMaxCoveringTombstoneSeq(
+    const ReadOptions& read_options, const Slice& user_key,
+    SequenceNumber* max_covering_tombstone_seq) {
+  UpdateMaxCoveringTombstoneSeq(
+      fragmented_range_dels_.get(), table_reader_options_.internal_comparator,
+      read_options, user_key, max_covering_tombstone_seq);
+}
+
 std::shared_ptr<const TableProperties>
 TerarkZipTableReaderBase::GetTableProperties() const {
   if (table_properties_) {
@@ -888,7 +898,29 @@ static const byte_t* FsPread(void* vself, size_t offset, size_t len,
 
 void TerarkZipSubReader::GetRecordAppend(size_t recId,
                                          valvec<byte_t>* tbuf) const {
-  if (storeUsePread_) {
+  if (persistent_cache_ != nullptr) {
+    char record_id[sizeof(uint64_t) * 2];
+    EncodeFixed64(record_id, subIndex_);
+    EncodeFixed64(record_id + sizeof(uint64_t), recId);
+    Slice record_id_slice(record_id, sizeof record_id);
+    std::string record;
+    if (PersistentCacheHelper::LookupRecord(persistent_cache_, file_number_,
+                                            record_id_slice, &record,
+                                            statistics_)) {
+      tbuf->append((const byte_t*)record.data(), record.size());
+      return;
+    }
+    size_t offset = tbuf->size();
+    if (cache_) {
+      store_->pread_record_append(cache_, storeFD_, storeOffset_, recId, tbuf);
+    } else {
+      store_->fspread_record_append(&FsPread, (void*)this, storeOffset_, recId,
+                                    tbuf);
+    }
+    PersistentCacheHelper::InsertRecord(
+        persistent_cache_, file_number_, record_id_slice,
+        Slice((const char*)tbuf->data() + offset, tbuf->size() - offset));
+  } else if (storeUsePread_) {
     auto cache = cache_;
     if (cache)
       store_->pread_record_append(cache, storeFD_, storeOffset_, recId, tbuf);
@@ -1272,6 +1304,10 @@ Status TerarkZipTableReader::Open(RandomAccessFileReader* file,
     }
   }
   subReader_.file_number_ = table_reader_options_.file_number;
+  if (subReader_.storeUsePread_) {
+    subReader_.persistent_cache_ = ioptions.value_persistent_cache.get();
+    subReader_.statistics_ = ioptions.statistics;
+  }
   long long t1 = g_pf.now();
   subReader_.index_->BuildCache(tzto_.indexCacheRatio);
   long long t2 = g_pf.now();
@@ -1449,6 +1485,7 @@ Status TerarkZipTableMultiReader::SubIndex::Init(
     fstring offsetMemory, const byte_t* baseAddress,
     AbstractBlobStore::Dictionary dict, int minPreadLen,
     RandomAccessFile* fileObj, LruReadonlyCache* cache, uint64_t file_number,
+    PersistentCache* persistent_cache, Statistics* statistics,
     bool warmUpIndexOnOpen, bool reverse) {
   TerarkZipMultiOffsetInfo offsetInfo;
   if (!offsetInfo.risk_set_memory(offsetMemory.data(), offsetMemory.size())) {
@@ -1499,6 +1536,10 @@ Status TerarkZipTableMultiReader::SubIndex::Init(
         offset += curr.type;
       }
       part.file_number_ = file_number;
+      if (part.storeUsePread_) {
+        part.persistent_cache_ = persistent_cache;
+        part.statistics_ = statistics;
+      }
       if (part.storeUsePread_ && cache) {
         if (cache_fi_ < 0) {
           cache_fi_ = cache->open(fileFD);
@@ -1731,7 +1772,9 @@ Status TerarkZipTableMultiReader::Open(RandomAccessFileReader* file,
           ? AbstractBlobStore::Dictionary(fstringOf(dict), 0, false)
           : getVerifyDict(dict),
       tzto_.minPreadLen, file_->file(), table_factory_->cache(),
-      table_reader_options_.file_number, tzto_.warmUpIndexOnOpen,
+      table_reader_options_.file_number,
+      table_reader_options_.ioptions.value_persistent_cache.get(),
+      table_reader_options_.ioptions.statistics, tzto_.warmUpIndexOnOpen,
       isReverseBytewiseOrder_);
   if (!s.ok()) {
     return s;
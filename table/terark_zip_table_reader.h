@@ -65,6 +65,11 @@ class TerarkZipTableReaderBase : public TableReader, boost::noncopyable {
   virtual FragmentedRangeTombstoneIterator* NewRangeTombstoneIterator(
       const ReadOptions& read_options) override;
 
+  using TableReader::UpdateMaxCoveringTombstoneSeq;
+  void UpdateMaxCoveringTombstoneSeq(
+      const ReadOptions& read_options, const Slice& user_key,
+      SequenceNumber* max_covering_tombstone_seq) override;
+
   std::shared_ptr<const TableProperties> GetTableProperties() const override;
 
   void MmapColdize(const void* addr, size_t len);
@@ -143,6 +148,9 @@ struct TerarkZipSubReader {
   unique_ptr<terark::AbstractBlobStore> store_;
   bitfield_array<2> type_;
   uint64_t file_number_;
+  // secondary cache for records read by pread, nullptr if disabled
+  PersistentCache* persistent_cache_ = nullptr;
+  Statistics* statistics_ = nullptr;
 
   enum {
     FlagNone = 0,
@@ -268,7 +276,8 @@ class TerarkZipTableMultiReader : public TerarkZipTableReaderBase {
     Status Init(fstring offsetMemory, const byte_t* baseAddress,
                 terark::AbstractBlobStore::Dictionary dict, int minPreadLen,
                 RandomAccessFile* fileObj, LruReadonlyCache* cache,
-                uint64_t file_number, bool warmUpIndexOnOpen, bool reverse);
+                uint64_t file_number, PersistentCache* persistent_cache,
+                Statistics* statistics, bool warmUpIndexOnOpen, bool reverse);
 
     size_t GetSubCount() const;
     const TerarkZipSubReader* GetSubReader(size_t i) const;
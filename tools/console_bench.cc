@@ -0,0 +1,323 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A redis-benchmark style load generator for the console server
+// (utilities/console). Every client is a blocking connection on its own
+// thread sending `pipeline` commands per round trip.
+//
+// Usage:
+//   console_bench --address=unix:/path/to/db/CONSOLE --clients=64
+//       --pipeline=16 --requests=1000000 --tests=set,get,mset,mget
+
+#include <cstdio>
+
+#ifndef GFLAGS
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif  // __STDC_FORMAT_MACROS
+
+#include <inttypes.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "rocksdb/terark_namespace.h"
+#include "util/gflags_compat.h"
+#include "util/string_util.h"
+#include "utilities/console/anet.h"
+#include "utilities/console/resp_machine.h"
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+using GFLAGS_NAMESPACE::SetUsageMessage;
+
+DEFINE_string(address, "tcp:127.0.0.1:6379",
+              "Console address, unix:<path> or tcp:<host>:<port>");
+DEFINE_int32(clients, 50, "Number of parallel connections");
+DEFINE_uint64(requests, 100000, "Total number of requests per test");
+DEFINE_int32(pipeline, 1, "Number of commands sent per round trip");
+DEFINE_int32(value_size, 3, "Value size of SET/MSET");
+DEFINE_uint64(keyspace, 100000, "Keys are picked randomly in [0, keyspace)");
+DEFINE_int32(keys_per_command, 10, "Number of keys of MSET/MGET");
+DEFINE_string(tests, "set,get", "Comma separated tests: set,get,mset,mget");
+
+namespace TERARKDB_NAMESPACE {
+namespace {
+
+int Connect(const std::string& address) {
+  char err[ANET_ERR_LEN];
+  int fd = -1;
+  if (address.compare(0, 5, "unix:") == 0) {
+    fd = anetUnixConnect(err, const_cast<char*>(address.c_str() + 5));
+  } else if (address.compare(0, 4, "tcp:") == 0) {
+    auto pos = address.rfind(':');
+    if (pos <= 4) {
+      fprintf(stderr, "ERROR: invalid address %s\n", address.c_str());
+      return -1;
+    }
+    std::string host = address.substr(4, pos - 4);
+    int port = atoi(address.c_str() + pos + 1);
+    fd = anetTcpConnect(err, const_cast<char*>(host.c_str()), port);
+    if (fd >= 0) {
+      anetEnableTcpNoDelay(nullptr, fd);
+    }
+  } else {
+    fprintf(stderr, "ERROR: invalid address %s\n", address.c_str());
+    return -1;
+  }
+  if (fd < 0) {
+    fprintf(stderr, "ERROR: connect %s: %s\n", address.c_str(), err);
+  }
+  return fd;
+}
+
+// Returns the length of the first complete reply in [p, end), 0 if the reply
+// is incomplete
+size_t ParseReply(const char* p, const char* end, bool* is_error) {
+  const char* begin = p;
+  const char* crlf = static_cast<const char*>(memchr(p, '\r', end - p));
+  if (crlf == nullptr || crlf + 1 >= end) {
+    return 0;
+  }
+  char type = *p;
+  long long len = strtoll(p + 1, nullptr, 10);
+  p = crlf + 2;
+  switch (type) {
+    case '-':
+      *is_error = true;
+      break;
+    case '+':
+    case ':':
+      break;
+    case '$':
+      if (len >= 0) {
+        if (end - p < len + 2) {
+          return 0;
+        }
+        p += len + 2;
+      }
+      break;
+    case '*':
+      for (long long i = 0; i < len; ++i) {
+        size_t n = ParseReply(p, end, is_error);
+        if (n == 0) {
+          return 0;
+        }
+        p += n;
+      }
+      break;
+    default:
+      fprintf(stderr, "ERROR: unexpected reply type '%c'\n", type);
+      abort();
+  }
+  return p - begin;
+}
+
+struct ClientStats {
+  uint64_t requests = 0;
+  uint64_t errors = 0;
+  // micros of each round trip
+  std::vector<uint64_t> latencies;
+};
+
+class Client {
+ public:
+  Client(const std::string& test, uint64_t seed)
+      : test_(test), rnd_(seed), value_(FLAGS_value_size, 'x') {}
+
+  bool Run(int fd, std::atomic<int64_t>* remaining, ClientStats* stats) {
+    Env* env = Env::Default();
+    char buf[16384];
+    while (true) {
+      int64_t n = remaining->fetch_sub(FLAGS_pipeline);
+      if (n <= 0) {
+        return true;
+      }
+      n = std::min<int64_t>(n, FLAGS_pipeline);
+
+      request_.clear();
+      for (int64_t i = 0; i < n; ++i) {
+        AppendCommand();
+      }
+      uint64_t start = env->NowMicros();
+      size_t offset = 0;
+      while (offset < request_.size()) {
+        ssize_t w =
+            write(fd, request_.data() + offset, request_.size() - offset);
+        if (w <= 0) {
+          fprintf(stderr, "ERROR: write: %s\n", strerror(errno));
+          return false;
+        }
+        offset += w;
+      }
+
+      int64_t replies = 0;
+      while (replies < n) {
+        bool is_error = false;
+        size_t len = reply_.empty()
+                         ? 0
+                         : ParseReply(reply_.data(),
+                                      reply_.data() + reply_.size(), &is_error);
+        if (len == 0) {
+          ssize_t r = read(fd, buf, sizeof buf);
+          if (r <= 0) {
+            fprintf(stderr, "ERROR: read: %s\n",
+                    r == 0 ? "connection closed" : strerror(errno));
+            return false;
+          }
+          reply_.append(buf, r);
+          continue;
+        }
+        reply_.erase(0, len);
+        stats->errors += is_error;
+        ++replies;
+      }
+      stats->latencies.push_back(env->NowMicros() - start);
+      stats->requests += n;
+    }
+  }
+
+ private:
+  std::string RandomKey() {
+    char key[32];
+    snprintf(key, sizeof key, "key:%012" PRIu64, rnd_() % FLAGS_keyspace);
+    return key;
+  }
+
+  void AppendCommand() {
+    if (test_ == "set") {
+      AppendArgv({"SET", RandomKey(), value_});
+    } else if (test_ == "get") {
+      AppendArgv({"GET", RandomKey()});
+    } else if (test_ == "mset") {
+      std::vector<std::string> argv{"MSET"};
+      for (int i = 0; i < FLAGS_keys_per_command; ++i) {
+        argv.emplace_back(RandomKey());
+        argv.emplace_back(value_);
+      }
+      AppendArgv(argv);
+    } else {  // mget
+      std::vector<std::string> argv{"MGET"};
+      for (int i = 0; i < FLAGS_keys_per_command; ++i) {
+        argv.emplace_back(RandomKey());
+      }
+      AppendArgv(argv);
+    }
+  }
+
+  void AppendArgv(const std::vector<std::string>& argv) {
+    RespMachine::AppendArrayLength(&request_, argv.size());
+    for (auto& arg : argv) {
+      RespMachine::AppendBulkString(&request_, arg);
+    }
+  }
+
+  std::string test_;
+  std::mt19937_64 rnd_;
+  std::string value_;
+  std::string request_;
+  std::string reply_;
+};
+
+bool RunTest(const std::string& test) {
+  std::vector<int> fds;
+  for (int i = 0; i < FLAGS_clients; ++i) {
+    int fd = Connect(FLAGS_address);
+    if (fd < 0) {
+      for (int f : fds) {
+        close(f);
+      }
+      return false;
+    }
+    fds.push_back(fd);
+  }
+
+  std::atomic<int64_t> remaining{static_cast<int64_t>(FLAGS_requests)};
+  std::vector<ClientStats> stats(FLAGS_clients);
+  std::atomic<bool> ok{true};
+  std::vector<std::thread> threads;
+  uint64_t start = Env::Default()->NowMicros();
+  for (int i = 0; i < FLAGS_clients; ++i) {
+    threads.emplace_back([&, i] {
+      Client client(test, i + 1);
+      if (!client.Run(fds[i], &remaining, &stats[i])) {
+        ok = false;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  uint64_t elapsed = Env::Default()->NowMicros() - start;
+  for (int fd : fds) {
+    close(fd);
+  }
+
+  ClientStats total;
+  for (auto& s : stats) {
+    total.requests += s.requests;
+    total.errors += s.errors;
+    total.latencies.insert(total.latencies.end(), s.latencies.begin(),
+                           s.latencies.end());
+  }
+  std::sort(total.latencies.begin(), total.latencies.end());
+  auto percentile = [&](double p) -> double {
+    if (total.latencies.empty()) {
+      return 0;
+    }
+    size_t i = static_cast<size_t>(p * (total.latencies.size() - 1));
+    return total.latencies[i] / 1000.0;
+  };
+  std::string name = test;
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+  fprintf(stdout,
+          "%s: %.2f requests per second, %" PRIu64 " requests, %" PRIu64
+          " errors, %d clients, pipeline %d\n"
+          "  round trip ms: p50 %.3f, p99 %.3f, p99.9 %.3f, max %.3f\n",
+          name.c_str(), total.requests * 1e6 / std::max<uint64_t>(elapsed, 1),
+          total.requests, total.errors, FLAGS_clients, FLAGS_pipeline,
+          percentile(0.5), percentile(0.99), percentile(0.999),
+          percentile(1.0));
+  return ok;
+}
+
+}  // namespace
+}  // namespace TERARKDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+  if (FLAGS_clients <= 0 || FLAGS_pipeline <= 0 || FLAGS_keyspace == 0 ||
+      FLAGS_keys_per_command <= 0 || FLAGS_value_size < 0) {
+    fprintf(stderr, "ERROR: invalid options\n");
+    return 1;
+  }
+  for (auto& test : TERARKDB_NAMESPACE::StringSplit(FLAGS_tests, ',')) {
+    if (test != "set" && test != "get" && test != "mset" && test != "mget") {
+      fprintf(stderr, "ERROR: unknown test %s\n", test.c_str());
+      return 1;
+    }
+    if (!TERARKDB_NAMESPACE::RunTest(test)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+#endif  // GFLAGS
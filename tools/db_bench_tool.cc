@@ -39,6 +39,7 @@
 #include "hdfs/env_hdfs.h"
 #include "monitoring/histogram.h"
 #include "monitoring/statistics.h"
+#include "monitoring/thread_local_histogram.h"
 #include "options/cf_options.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
@@ -77,6 +78,7 @@
 #include "utilities/merge_operators.h"
 #include "utilities/merge_operators/bytesxor.h"
 #include "utilities/persistent_cache/block_cache_tier.h"
+#include "utilities/trace/bytedance_metrics_reporter.h"
 
 #ifdef OS_WIN
 #include <io.h>  // open/close
@@ -129,6 +131,7 @@ DEFINE_string(
     "compress,"
     "uncompress,"
     "acquireload,"
+    "statsoverhead,"
     "fillseekseq,"
     "randomtransaction,"
     "randomreplacekeys,"
@@ -186,6 +189,8 @@ DEFINE_string(
     "\tcrc32c        -- repeated crc32c of 4K of data\n"
     "\txxhash        -- repeated xxHash of 4K of data\n"
     "\tacquireload   -- load N*1000 times\n"
+    "\tstatsoverhead -- record N ticker and histogram samples through "
+    "each statistics path and report the cost per sample\n"
     "\tfillseekseq   -- write N values in sequential key, then read "
     "them by seeking to each key\n"
     "\trandomtransaction     -- execute N random transactions and "
@@ -724,6 +729,19 @@ DEFINE_int32(transaction_sleep, 0,
 DEFINE_uint64(transaction_lock_timeout, 100,
               "If using a transaction_db, specifies the lock wait timeout in"
               " milliseconds before failing a transaction waiting on a lock");
+
+DEFINE_bool(transaction_deadlock_detect, false,
+            "If using a transaction_db, have transactions check for deadlocks "
+            "while waiting on a lock");
+
+DEFINE_uint64(transaction_deadlock_detect_interval, 0,
+              "If using a transaction_db, run deadlock detection in a "
+              "background thread every this many milliseconds instead of in "
+              "each waiting transaction. 0 disables the background detector.");
+
+DEFINE_uint64(transaction_num_stripes, 16,
+              "If using a transaction_db, number of lock table stripes per "
+              "column family");
 DEFINE_string(
     options_file, "",
     "The path to a RocksDB options file.  If specified, then db_bench will "
@@ -759,6 +777,14 @@ DEFINE_bool(use_stderr_info_logger, false,
 
 DEFINE_string(trace_file, "", "Trace workload to a file. ");
 
+DEFINE_int32(trace_replay_threads, 1,
+             "The number of threads to replay the trace with, the records "
+             "are sharded by key so the operations on a key keep their order");
+
+DEFINE_double(trace_replay_fast_forward, 1.0,
+              "Divides the recorded intervals between the trace records when "
+              "replaying, 0 replays as fast as possible");
+
 static enum TERARKDB_NAMESPACE::CompressionType StringToCompressionType(
     const char* ctype) {
   assert(ctype);
@@ -978,6 +1004,9 @@ DEFINE_uint64(blob_size, size_t(-1), "Key Value Separate blob size");
 
 DEFINE_double(blob_large_key_ratio, 1, "Key Value Separate large key ratio");
 
+DEFINE_bool(enable_adaptive_blob_size, false,
+            "Adapt blob size per compaction output range");
+
 DEFINE_double(blob_gc_ratio, 0.2, "Blob SST gc ratio");
 
 DEFINE_uint64(wal_ttl_seconds, 0, "Set the TTL for the WAL Files in seconds.");
@@ -2770,6 +2799,12 @@ class Benchmark {
         method = &Benchmark::xxHash;
       } else if (name == "acquireload") {
         method = &Benchmark::AcquireLoad;
+      } else if (name == "statsoverhead") {
+        stats_overhead_statistics_ = dbstats ? dbstats : CreateDBStatistics();
+        stats_overhead_histogram_.reset(new ThreadLocalHistogram());
+        stats_overhead_reporter_ = stats_overhead_factory_.BuildHistReporter(
+            stats_overhead_name_, "", nullptr);
+        method = &Benchmark::StatsOverhead;
       } else if (name == "compress") {
         method = &Benchmark::Compress;
       } else if (name == "uncompress") {
@@ -2917,6 +2952,13 @@ class Benchmark {
  private:
   std::shared_ptr<TimestampEmulator> timestamp_emulator_;
 
+  // What statsoverhead records into, shared by all threads
+  std::shared_ptr<Statistics> stats_overhead_statistics_;
+  std::unique_ptr<ThreadLocalHistogram> stats_overhead_histogram_;
+  ByteDanceMetricsReporterFactory stats_overhead_factory_;
+  const std::string stats_overhead_name_ = "db_bench_stats_overhead";
+  HistReporterHandle* stats_overhead_reporter_ = nullptr;
+
   struct ThreadArg {
     Benchmark* bm;
     SharedState* shared;
@@ -3087,6 +3129,50 @@ class Benchmark {
     if (ptr == nullptr) exit(1);  // Disable unused variable warning.
   }
 
+  // Measures the instrumentation itself: every pass records FLAGS_num
+  // samples the way an operation does, the difference to the baseline pass
+  // is what the statistics cost per operation.
+  void StatsOverhead(ThreadState* thread) {
+    static const char* kPassNames[] = {"baseline", "statistics",
+                                       "thread-local-histogram", "reporter"};
+    const int64_t ops = FLAGS_num;
+    Statistics* statistics = stats_overhead_statistics_.get();
+    uint64_t sink = 0;
+    std::string msg = "(ns per sample:";
+    for (int pass = 0; pass < 4; ++pass) {
+      uint64_t start = FLAGS_env->NowNanos();
+      for (int64_t i = 0; i < ops; ++i) {
+        // spread the samples over the buckets like latencies would
+        uint64_t value = (static_cast<uint64_t>(i) * 2654435761U) & 4095;
+        switch (pass) {
+          case 0:
+            sink += value;
+            break;
+          case 1:
+            RecordTick(statistics, NUMBER_KEYS_READ);
+            MeasureTime(statistics, DB_GET, value);
+            break;
+          case 2:
+            stats_overhead_histogram_->Add(value);
+            break;
+          case 3:
+            stats_overhead_reporter_->AddRecord(value);
+            break;
+        }
+      }
+      uint64_t elapsed = FLAGS_env->NowNanos() - start;
+      thread->stats.FinishedOps(nullptr, nullptr, ops, kOthers);
+      char buf[100];
+      snprintf(buf, sizeof(buf), " %s %.1f", kPassNames[pass],
+               static_cast<double>(elapsed) / std::max<int64_t>(ops, 1));
+      msg.append(buf);
+    }
+    msg.append(")");
+    thread->stats.AddMessage(msg);
+    // Print so result is not dead
+    fprintf(stderr, "... sum=%" PRIu64 "\r", sink);
+  }
+
   void Compress(ThreadState* thread) {
     RandomGenerator gen;
     Slice input = gen.Generate(FLAGS_block_size);
@@ -3542,6 +3628,7 @@ class Benchmark {
     options.enable_lazy_compaction = FLAGS_enable_lazy_compaction;
     options.blob_size = FLAGS_blob_size;
     options.blob_large_key_ratio = FLAGS_blob_large_key_ratio;
+    options.enable_adaptive_blob_size = FLAGS_enable_adaptive_blob_size;
     options.blob_gc_ratio = FLAGS_blob_gc_ratio;
     options.optimize_filters_for_hits = FLAGS_optimize_filters_for_hits;
 
@@ -3752,6 +3839,9 @@ class Benchmark {
       } else if (FLAGS_transaction_db) {
         TransactionDB* ptr;
         TransactionDBOptions txn_db_options;
+        txn_db_options.num_stripes = FLAGS_transaction_num_stripes;
+        txn_db_options.deadlock_detect_interval =
+            FLAGS_transaction_deadlock_detect_interval;
         s = TransactionDB::Open(options, txn_db_options, db_name,
                                 column_families, &db->cfh, &ptr);
         if (s.ok()) {
@@ -3778,6 +3868,9 @@ class Benchmark {
     } else if (FLAGS_transaction_db) {
       TransactionDB* ptr = nullptr;
       TransactionDBOptions txn_db_options;
+      txn_db_options.num_stripes = FLAGS_transaction_num_stripes;
+      txn_db_options.deadlock_detect_interval =
+          FLAGS_transaction_deadlock_detect_interval;
       s = CreateLoggerFromOptions(db_name, options, &options.info_log);
       if (s.ok()) {
         s = TransactionDB::Open(options, txn_db_options, db_name, &ptr);
@@ -5454,6 +5547,7 @@ class Benchmark {
     TransactionOptions txn_options;
     txn_options.lock_timeout = FLAGS_transaction_lock_timeout;
     txn_options.set_snapshot = FLAGS_transaction_set_snapshot;
+    txn_options.deadlock_detect = FLAGS_transaction_deadlock_detect;
 
     RandomTransactionInserter inserter(&thread->rand, write_options_,
                                        read_options, FLAGS_num,
@@ -5807,10 +5901,13 @@ class Benchmark {
     }
     Replayer replayer(db_with_cfh->db, db_with_cfh->cfh,
                       std::move(trace_reader));
-    s = replayer.Replay();
+    s = replayer.MultiThreadReplay(
+        static_cast<uint32_t>(std::max(FLAGS_trace_replay_threads, 1)),
+        FLAGS_trace_replay_fast_forward);
     if (s.ok()) {
       fprintf(stdout, "Replay started from trace_file: %s\n",
               FLAGS_trace_file.c_str());
+      fprintf(stdout, "%s\n", replayer.GetLatencyReport().c_str());
     } else {
       fprintf(stderr, "Starting replay failed. Error: %s\n",
               s.ToString().c_str());
@@ -0,0 +1,101 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <rocksdb/compaction_dispatcher.h>
+#include <rocksdb/db.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+class DaemonWorker
+    : public TERARKDB_NAMESPACE::RemoteCompactionDispatcher::Worker {
+  std::string output_dir_;
+  std::atomic<uint64_t> next_file_{0};
+
+  std::string GenerateOutputFileName(size_t file_index) override {
+    // jobs run concurrently, keep names unique across the daemon lifetime
+    char buffer[64];
+    snprintf(buffer, sizeof buffer, "/Worker-%d-%llu-%zu", int(getpid()),
+             (unsigned long long)next_file_.fetch_add(1), file_index);
+    return output_dir_ + buffer;
+  }
+
+ public:
+  DaemonWorker(std::string output_dir)
+      : Worker(TERARKDB_NAMESPACE::EnvOptions(),
+               TERARKDB_NAMESPACE::Env::Default()),
+        output_dir_(std::move(output_dir)) {}
+};
+
+// Shutdown() takes a mutex, which isn't async-signal-safe, so the handler
+// only writes to a pipe and a thread calls Shutdown()
+static int g_signal_pipe[2] = {-1, -1};
+
+static void OnSignal(int) {
+  int saved_errno = errno;
+  char c = 0;
+  if (::write(g_signal_pipe[1], &c, 1) < 0) {
+    // nothing can be done in a signal handler
+  }
+  errno = saved_errno;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    fprintf(stderr,
+            "usage: %s <unix:path | tcp:host:port> <output_dir> [max_jobs]\n",
+            argv[0]);
+    return 1;
+  }
+  size_t max_jobs = argc > 3 ? strtoul(argv[3], nullptr, 10)
+                             : std::thread::hardware_concurrency();
+  DaemonWorker worker(argv[2]);
+  if (::pipe(g_signal_pipe) != 0 ||
+      ::fcntl(g_signal_pipe[1], F_SETFL, O_NONBLOCK) != 0) {
+    fprintf(stderr, "ERROR: signal pipe: %s\n", strerror(errno));
+    return 1;
+  }
+  std::thread signal_thread([&worker] {
+    char c;
+    ssize_t n;
+    do {
+      n = ::read(g_signal_pipe[0], &c, 1);
+    } while (n < 0 && errno == EINTR);
+    worker.Shutdown();
+  });
+  signal(SIGINT, OnSignal);
+  signal(SIGTERM, OnSignal);
+  signal(SIGPIPE, SIG_IGN);
+
+  fprintf(stderr, "INFO: compaction worker serving on %s, max_jobs = %zu\n",
+          argv[1], max_jobs);
+  auto s = worker.Serve(argv[1], max_jobs);
+  // wake up the signal thread if Serve() returned on its own
+  OnSignal(0);
+  signal_thread.join();
+  if (!s.ok()) {
+    fprintf(stderr, "ERROR: %s\n", s.ToString().c_str());
+    return 1;
+  }
+  return 0;
+}
+
+// a shell script starting the daemon:
+// ----------------------------------------------
+// env TerarkZipTable_localTempDir=/tmp \
+//   remote_compaction_worker_daemon unix:/tmp/compact.sock /data/compact 8
+// ----------------------------------------------
+// and the db side:
+// ----------------------------------------------
+// env TerarkDB_compactionWorkerAddress=unix:/tmp/compact.sock db_bench ...
+// ----------------------------------------------
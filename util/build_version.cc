@@ -0,0 +1,4 @@
+#include "build_version.h"
+const char* rocksdb_build_git_sha = "rocksdb_build_git_sha:@60a6bdb5a4e0cec6b781f53fcbfcd4e2f5afe238@";
+const char* rocksdb_build_git_date = "rocksdb_build_git_date:@2026/10/16 21:14:53@";
+const char* rocksdb_build_compile_date = __DATE__;
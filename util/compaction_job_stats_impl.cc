@@ -42,6 +42,9 @@ void CompactionJobStats::Reset() {
 
   num_single_del_fallthru = 0;
   num_single_del_mismatch = 0;
+
+  num_output_records_separated = 0;
+  num_output_records_inline = 0;
 }
 
 void CompactionJobStats::Add(const CompactionJobStats& stats) {
@@ -74,6 +77,9 @@ void CompactionJobStats::Add(const CompactionJobStats& stats) {
 
   num_single_del_fallthru += stats.num_single_del_fallthru;
   num_single_del_mismatch += stats.num_single_del_mismatch;
+
+  num_output_records_separated += stats.num_output_records_separated;
+  num_output_records_inline += stats.num_output_records_inline;
 }
 
 #else
@@ -87,12 +87,13 @@ Status DeleteScheduler::DeleteFile(const std::string& file_path,
                                    const std::string& dir_to_sync,
                                    const bool force_bg) {
   Status s;
-  if (rate_bytes_per_sec_.load() <= 0 ||
+  if (rate_bytes_per_sec_.load() <= 0 || !env_->NeedsThrottledDeletion() ||
       (!force_bg &&
        total_trash_size_.load() >
            sst_file_manager_->GetTotalSize() * max_trash_db_ratio_.load())) {
-    // Rate limiting is disabled or trash size makes up more than
-    // max_trash_db_ratio_ (default 25%) of the total DB size
+    // Rate limiting is disabled, deleting is cheap on this Env or trash size
+    // makes up more than max_trash_db_ratio_ (default 25%) of the total DB
+    // size
     TEST_SYNC_POINT("DeleteScheduler::DeleteFile");
     s = env_->DeleteFile(file_path);
     if (s.ok()) {
@@ -242,7 +243,7 @@ void DeleteScheduler::BackgroundEmptyTrash() {
       }
 
       // Get new file to delete
-      const FileAndDir& fad = queue_.front();
+      FileAndDir& fad = queue_.front();
       std::string path_in_trash = fad.fname;
 
       // We dont need to hold the lock while deleting the file
@@ -250,8 +251,7 @@ void DeleteScheduler::BackgroundEmptyTrash() {
       uint64_t deleted_bytes = 0;
       bool is_complete = true;
       // Delete file from trash and update total_penlty value
-      Status s =
-          DeleteTrashFile(path_in_trash, fad.dir, &deleted_bytes, &is_complete);
+      Status s = DeleteTrashFile(&fad, &deleted_bytes, &is_complete);
       total_deleted_bytes += deleted_bytes;
       mu_.Lock();
       if (is_complete) {
@@ -292,18 +292,22 @@ void DeleteScheduler::BackgroundEmptyTrash() {
   }
 }
 
-Status DeleteScheduler::DeleteTrashFile(const std::string& path_in_trash,
-                                        const std::string& dir_to_sync,
+Status DeleteScheduler::DeleteTrashFile(FileAndDir* fad,
                                         uint64_t* deleted_bytes,
                                         bool* is_complete) {
+  const std::string& path_in_trash = fad->fname;
+  const std::string& dir_to_sync = fad->dir;
   uint64_t file_size;
   Status s = env_->GetFileSize(path_in_trash, &file_size);
   *is_complete = true;
   TEST_SYNC_POINT("DeleteScheduler::DeleteTrashFile:DeleteFile");
   if (s.ok()) {
     bool need_full_delete = true;
+    // Holes keep the file size
+    assert(file_size >= fad->punched_bytes);
+    uint64_t remaining_size = file_size - fad->punched_bytes;
     if (pause_truncate_.load() == 0 && bytes_max_delete_chunk_ != 0 &&
-        file_size > bytes_max_delete_chunk_) {
+        remaining_size > bytes_max_delete_chunk_) {
       uint64_t num_hard_links = 2;
       // We don't have to worry aobut data race between linking a new
       // file after the number of file link check and ftruncte because
@@ -312,14 +316,36 @@ Status DeleteScheduler::DeleteTrashFile(const std::string& path_in_trash,
       Status my_status = env_->NumFileLinks(path_in_trash, &num_hard_links);
       if (my_status.ok()) {
         if (num_hard_links == 1) {
-          std::unique_ptr<WritableFile> wf;
-          my_status =
-              env_->ReopenWritableFile(path_in_trash, &wf, EnvOptions());
-          if (my_status.ok()) {
-            my_status = wf->Truncate(file_size - bytes_max_delete_chunk_);
+          if (fad->file == nullptr) {
+            my_status = env_->ReopenWritableFile(path_in_trash, &fad->file,
+                                                 EnvOptions());
+          }
+          uint64_t new_size = remaining_size - bytes_max_delete_chunk_;
+          if (my_status.ok() && punch_hole_supported_) {
+            // Unlike truncating, this leaves the file size alone, so there
+            // is no metadata to fsync for each chunk
+            my_status = fad->file->PunchHole(new_size, bytes_max_delete_chunk_);
+            if (my_status.ok()) {
+              TEST_SYNC_POINT("DeleteScheduler::DeleteTrashFile:PunchHole");
+              fad->punched_bytes += bytes_max_delete_chunk_;
+            } else if (my_status.IsNotSupported()) {
+              ROCKS_LOG_INFO(info_log_,
+                             "Cannot delete files slowly by punching holes, "
+                             "truncating them instead -- %s",
+                             my_status.ToString().c_str());
+              punch_hole_supported_ = false;
+              my_status = Status::OK();
+            }
+          }
+          if (my_status.ok() && !punch_hole_supported_) {
+            my_status = fad->file->Truncate(new_size);
             if (my_status.ok()) {
               TEST_SYNC_POINT("DeleteScheduler::DeleteTrashFile:Fsync");
-              my_status = wf->Fsync();
+              my_status = fad->file->Fsync();
+            }
+            if (my_status.ok()) {
+              // The holes were cut off
+              fad->punched_bytes = 0;
             }
           }
           if (my_status.ok()) {
@@ -348,6 +374,7 @@ Status DeleteScheduler::DeleteTrashFile(const std::string& path_in_trash,
     }
 
     if (need_full_delete) {
+      fad->file.reset();
       s = env_->DeleteFile(path_in_trash);
       if (!dir_to_sync.empty()) {
         std::unique_ptr<Directory> dir_obj;
@@ -361,7 +388,7 @@ Status DeleteScheduler::DeleteTrashFile(const std::string& path_in_trash,
               reinterpret_cast<void*>(const_cast<std::string*>(&dir_to_sync)));
         }
       }
-      *deleted_bytes = file_size;
+      *deleted_bytes = remaining_size;
       sst_file_manager_->OnDeleteFile(path_in_trash);
     }
   }
@@ -14,12 +14,12 @@
 
 #include "monitoring/instrumented_mutex.h"
 #include "port/port.h"
+#include "rocksdb/env.h"
 #include "rocksdb/status.h"
 #include "rocksdb/terark_namespace.h"
 
 namespace TERARKDB_NAMESPACE {
 
-class Env;
 class Logger;
 class SstFileManagerImpl;
 
@@ -29,7 +29,11 @@ class SstFileManagerImpl;
 // if they are happening in a rate faster than rate_bytes_per_sec,
 //
 // Rate limiting can be turned off by setting rate_bytes_per_sec = 0, In this
-// case DeleteScheduler will delete files immediately.
+// case DeleteScheduler will delete files immediately. Files are also deleted
+// immediately if Env::NeedsThrottledDeletion() is false.
+//
+// Large files are freed bytes_max_delete_chunk at a time from the end by
+// punching holes, or by truncating them where holes are not supported.
 class DeleteScheduler {
  public:
   DeleteScheduler(Env* env, int64_t rate_bytes_per_sec, Logger* info_log,
@@ -86,9 +90,10 @@ class DeleteScheduler {
  private:
   Status MarkAsTrash(const std::string& file_path, std::string* path_in_trash);
 
-  Status DeleteTrashFile(const std::string& path_in_trash,
-                         const std::string& dir_to_sync,
-                         uint64_t* deleted_bytes, bool* is_complete);
+  struct FileAndDir;
+
+  Status DeleteTrashFile(FileAndDir* fad, uint64_t* deleted_bytes,
+                         bool* is_complete);
 
   void BackgroundEmptyTrash();
 
@@ -101,9 +106,14 @@ class DeleteScheduler {
   InstrumentedMutex mu_;
 
   struct FileAndDir {
-    FileAndDir(const std::string& f, const std::string& d) : fname(f), dir(d) {}
+    FileAndDir(const std::string& f, const std::string& d)
+        : fname(f), dir(d), punched_bytes(0) {}
     std::string fname;
     std::string dir;  // empty will be skipped.
+    // Bytes at the end of the file already freed by punching holes
+    uint64_t punched_bytes;
+    // Kept open while the file is deleted chunk by chunk
+    std::unique_ptr<WritableFile> file;
   };
 
   // Queue of trash files that need to be deleted
@@ -115,6 +125,9 @@ class DeleteScheduler {
   std::map<std::string, Status> bg_errors_;
 
   bool num_link_error_printed_ = false;
+  // Cleared once punching holes failed as not supported, chunks are then
+  // freed by truncating the file
+  bool punch_hole_supported_ = true;
   // Set to true in ~DeleteScheduler() to force BackgroundEmptyTrash to stop
   bool closing_;
   std::atomic<int> pause_truncate_;
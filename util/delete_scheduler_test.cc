@@ -92,23 +92,77 @@ class DeleteSchedulerTest : public testing::Test {
     return file_path;
   }
 
-  void NewDeleteScheduler() {
+  // If env is not nullptr, the DeleteScheduler uses it instead of env_
+  void NewDeleteScheduler(Env* env = nullptr) {
     // Tests in this file are for DeleteScheduler component and dont create any
     // DBs, so we need to set max_trash_db_ratio to 100% (instead of default
     // 25%)
-    sst_file_mgr_.reset(
-        new SstFileManagerImpl(env_, nullptr, rate_bytes_per_sec_,
-                               /* max_trash_db_ratio= */ 1.1, 128 * 1024));
+    sst_file_mgr_.reset(new SstFileManagerImpl(
+        env != nullptr ? env : env_, nullptr, rate_bytes_per_sec_,
+        /* max_trash_db_ratio= */ 1.1, 128 * 1024));
     delete_scheduler_ = sst_file_mgr_->delete_scheduler();
   }
 
+  // Whether the file system of the dummy dirs can punch holes
+  bool PunchHoleSupported() {
+    std::string file_path = dummy_files_dirs_[0] + "/punch_hole_probe";
+    std::unique_ptr<WritableFile> f;
+    EXPECT_OK(env_->NewWritableFile(file_path, &f, EnvOptions()));
+    EXPECT_OK(f->Append(std::string(8192, 'A')));
+    Status s = f->PunchHole(0, 4096);
+    EXPECT_OK(f->Close());
+    EXPECT_OK(env_->DeleteFile(file_path));
+    return s.ok();
+  }
+
   Env* env_;
   std::vector<std::string> dummy_files_dirs_;
   int64_t rate_bytes_per_sec_;
   DeleteScheduler* delete_scheduler_;
+  // outlives sst_file_mgr_, which may use it
+  std::unique_ptr<Env> wrapped_env_;
   std::unique_ptr<SstFileManagerImpl> sst_file_mgr_;
 };
 
+namespace {
+// Env whose files can't punch holes, as on file systems without
+// FALLOC_FL_PUNCH_HOLE
+class NoPunchHoleEnv : public EnvWrapper {
+ public:
+  explicit NoPunchHoleEnv(Env* base) : EnvWrapper(base) {}
+
+  Status ReopenWritableFile(const std::string& fname,
+                            std::unique_ptr<WritableFile>* result,
+                            const EnvOptions& options) override {
+    class NoPunchHoleFile : public WritableFileWrapper {
+     public:
+      explicit NoPunchHoleFile(std::unique_ptr<WritableFile>&& file)
+          : WritableFileWrapper(file.get()), file_(std::move(file)) {}
+      Status PunchHole(uint64_t /*offset*/, uint64_t /*len*/) override {
+        return Status::NotSupported("PunchHole");
+      }
+
+     private:
+      std::unique_ptr<WritableFile> file_;
+    };
+    std::unique_ptr<WritableFile> file;
+    Status s = target()->ReopenWritableFile(fname, &file, options);
+    if (s.ok()) {
+      result->reset(new NoPunchHoleFile(std::move(file)));
+    }
+    return s;
+  }
+};
+
+// Env on which deleting a file is cheap, e.g. ZenFS
+class CheapDeletionEnv : public EnvWrapper {
+ public:
+  explicit CheapDeletionEnv(Env* base) : EnvWrapper(base) {}
+
+  bool NeedsThrottledDeletion() const override { return false; }
+};
+}  // namespace
+
 // Test the basic functionality of DeleteScheduler (Rate Limiting).
 // 1- Create 100 dummy files
 // 2- Delete the 100 dummy files using DeleteScheduler
@@ -448,12 +502,16 @@ TEST_F(DeleteSchedulerTest, StartBGEmptyTrashMultipleTimes) {
 
 TEST_F(DeleteSchedulerTest, DeletePartialFile) {
   int bg_delete_file = 0;
-  int bg_fsync = 0;
+  int bg_punch_hole = 0;
+  int bg_truncate = 0;
   TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
       "DeleteScheduler::DeleteTrashFile:DeleteFile",
       [&](void*) { bg_delete_file++; });
   TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
-      "DeleteScheduler::DeleteTrashFile:Fsync", [&](void*) { bg_fsync++; });
+      "DeleteScheduler::DeleteTrashFile:PunchHole",
+      [&](void*) { bg_punch_hole++; });
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::DeleteTrashFile:Fsync", [&](void*) { bg_truncate++; });
   TERARKDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
 
   rate_bytes_per_sec_ = 1024 * 1024;  // 1 MB / sec
@@ -473,19 +531,96 @@ TEST_F(DeleteSchedulerTest, DeletePartialFile) {
   auto bg_errors = delete_scheduler_->GetBackgroundErrors();
   ASSERT_EQ(bg_errors.size(), 0);
   ASSERT_EQ(7, bg_delete_file);
-  ASSERT_EQ(4, bg_fsync);
+  // Chunks are freed by punching holes, truncating only where the file
+  // system can't punch holes
+  if (PunchHoleSupported()) {
+    ASSERT_EQ(4, bg_punch_hole);
+    ASSERT_EQ(0, bg_truncate);
+  } else {
+    ASSERT_EQ(0, bg_punch_hole);
+    ASSERT_EQ(4, bg_truncate);
+  }
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+}
+
+TEST_F(DeleteSchedulerTest, DeletePartialFileByTruncating) {
+  int bg_delete_file = 0;
+  int bg_punch_hole = 0;
+  int bg_truncate = 0;
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::DeleteTrashFile:DeleteFile",
+      [&](void*) { bg_delete_file++; });
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::DeleteTrashFile:PunchHole",
+      [&](void*) { bg_punch_hole++; });
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::DeleteTrashFile:Fsync", [&](void*) { bg_truncate++; });
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  rate_bytes_per_sec_ = 1024 * 1024;  // 1 MB / sec
+  wrapped_env_.reset(new NoPunchHoleEnv(env_));
+  NewDeleteScheduler(wrapped_env_.get());
+
+  // Same batches as DeletePartialFile, but every chunk is truncated away
+  ASSERT_OK(
+      delete_scheduler_->DeleteFile(NewDummyFile("data_1", 500 * 1024), ""));
+  ASSERT_OK(
+      delete_scheduler_->DeleteFile(NewDummyFile("data_2", 100 * 1024), ""));
+  ASSERT_OK(
+      delete_scheduler_->DeleteFile(NewDummyFile("data_2", 200 * 1024), ""));
+
+  delete_scheduler_->WaitForEmptyTrash();
+
+  auto bg_errors = delete_scheduler_->GetBackgroundErrors();
+  ASSERT_EQ(bg_errors.size(), 0);
+  ASSERT_EQ(7, bg_delete_file);
+  ASSERT_EQ(0, bg_punch_hole);
+  ASSERT_EQ(4, bg_truncate);
+  ASSERT_EQ(0, CountNormalFiles());
+  ASSERT_EQ(0, CountTrashFiles());
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+}
+
+TEST_F(DeleteSchedulerTest, NoThrottledDeletion) {
+  int fg_delete_file = 0;
+  int bg_delete_file = 0;
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::DeleteFile", [&](void*) { fg_delete_file++; });
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::DeleteTrashFile:DeleteFile",
+      [&](void*) { bg_delete_file++; });
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  rate_bytes_per_sec_ = 1024;  // 1 KB / sec
+  wrapped_env_.reset(new CheapDeletionEnv(env_));
+  NewDeleteScheduler(wrapped_env_.get());
+
+  // Deleted right away despite the rate limit, without going through the
+  // trash
+  ASSERT_OK(
+      delete_scheduler_->DeleteFile(NewDummyFile("data_1", 500 * 1024), ""));
+  ASSERT_EQ(1, fg_delete_file);
+  ASSERT_EQ(0, CountNormalFiles());
+  ASSERT_EQ(0, CountTrashFiles());
+
+  delete_scheduler_->WaitForEmptyTrash();
+  ASSERT_EQ(0, bg_delete_file);
   TERARKDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
 }
 
 #ifdef OS_LINUX
 TEST_F(DeleteSchedulerTest, NoPartialDeleteWithLink) {
   int bg_delete_file = 0;
-  int bg_fsync = 0;
+  int bg_punch_hole = 0;
+  int bg_truncate = 0;
   TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
       "DeleteScheduler::DeleteTrashFile:DeleteFile",
       [&](void*) { bg_delete_file++; });
   TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
-      "DeleteScheduler::DeleteTrashFile:Fsync", [&](void*) { bg_fsync++; });
+      "DeleteScheduler::DeleteTrashFile:PunchHole",
+      [&](void*) { bg_punch_hole++; });
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::DeleteTrashFile:Fsync", [&](void*) { bg_truncate++; });
   TERARKDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
 
   rate_bytes_per_sec_ = 1024 * 1024;  // 1 MB / sec
@@ -506,7 +641,8 @@ TEST_F(DeleteSchedulerTest, NoPartialDeleteWithLink) {
   auto bg_errors = delete_scheduler_->GetBackgroundErrors();
   ASSERT_EQ(bg_errors.size(), 0);
   ASSERT_EQ(2, bg_delete_file);
-  ASSERT_EQ(0, bg_fsync);
+  ASSERT_EQ(0, bg_punch_hole);
+  ASSERT_EQ(0, bg_truncate);
   TERARKDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
 }
 #endif
@@ -10,6 +10,7 @@
 #include "util/file_reader_writer.h"
 
 #include <algorithm>
+#include <chrono>
 #include <mutex>
 
 #include "monitoring/histogram.h"
@@ -34,6 +35,36 @@ bool IsFileSectorAligned(const size_t off, size_t sector_size) {
 }  // namespace
 #endif
 
+namespace {
+// Reports the latency of a rate limited IO to rate limiters tuning by it.
+// Buffered appends only copy into the page cache, so for buffered files the
+// syncs are timed instead
+class RateLimitedIOTimer {
+ public:
+  explicit RateLimitedIOTimer(RateLimiter* rate_limiter)
+      : rate_limiter_(rate_limiter != nullptr &&
+                              rate_limiter->IsIOLatencyTracked()
+                          ? rate_limiter
+                          : nullptr) {
+    if (rate_limiter_ != nullptr) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+  ~RateLimitedIOTimer() {
+    if (rate_limiter_ != nullptr) {
+      rate_limiter_->RecordIOLatency(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start_)
+              .count());
+    }
+  }
+
+ private:
+  RateLimiter* rate_limiter_;
+  std::chrono::steady_clock::time_point start_;
+};
+}  // namespace
+
 Status SequentialFileReader::Read(size_t n, Slice* result, char* scratch) {
   Status s;
   if (use_direct_io()) {
@@ -60,6 +91,7 @@ Status SequentialFileReader::Read(size_t n, Slice* result, char* scratch) {
     s = file_->Read(n, result, scratch);
   }
   IOSTATS_ADD(bytes_read, result->size());
+  RecordFileIO(io_file_type_, false /* is_write */, result->size());
   return s;
 }
 
@@ -80,6 +112,7 @@ RandomAccessFileReader::RandomAccessFileReader(
     const std::vector<std::shared_ptr<EventListener>>& listeners)
     : file_(std::move(raf)),
       file_name_(std::move(_file_name)),
+      io_file_type_(IOFileTypeFromName(file_name_)),
       env_(env),
       stats_(stats),
       hist_type_(hist_type),
@@ -216,6 +249,7 @@ Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice* result,
     }
     IOSTATS_ADD_IF_POSITIVE(bytes_read, result->size());
   }
+  RecordFileIO(io_file_type_, false /* is_write */, result->size());
   if (stats_ != nullptr && file_read_hist_ != nullptr) {
     file_read_hist_->Add(elapsed);
   }
@@ -419,6 +453,7 @@ Status WritableFileWriter::SyncInternal(bool use_fsync) {
   Status s;
   IOSTATS_TIMER_GUARD(fsync_nanos);
   TEST_SYNC_POINT("WritableFileWriter::SyncInternal:0");
+  RateLimitedIOTimer io_timer(rate_limiter_);
   if (use_fsync) {
     s = writable_file_->Fsync();
   } else {
@@ -462,6 +497,7 @@ Status WritableFileWriter::AutoRangeSync(uint64_t filesize_for_sync) {
 Status WritableFileWriter::RangeSync(uint64_t offset, uint64_t nbytes) {
   IOSTATS_TIMER_GUARD(range_sync_nanos);
   TEST_SYNC_POINT("WritableFileWriter::RangeSync:0");
+  RateLimitedIOTimer io_timer(rate_limiter_);
   return writable_file_->RangeSync(offset, nbytes);
 }
 
@@ -517,6 +553,7 @@ Status WritableFileWriter::WriteBuffered(const char* data, size_t size,
     }
 
     IOSTATS_ADD(bytes_written, allowed);
+    RecordFileIO(io_file_type_, true /* is_write */, allowed);
     TEST_KILL_RANDOM("WritableFileWriter::WriteBuffered:0", rocksdb_kill_odds);
 
     left -= allowed;
@@ -576,7 +613,10 @@ Status WritableFileWriter::WriteDirect() {
         start_ts = std::chrono::system_clock::now();
       }
       // direct writes must be positional
-      s = writable_file_->PositionedAppend(Slice(src, size), write_offset);
+      {
+        RateLimitedIOTimer io_timer(rate_limiter_);
+        s = writable_file_->PositionedAppend(Slice(src, size), write_offset);
+      }
       if (ShouldNotifyListeners()) {
         auto finish_ts = std::chrono::system_clock::now();
         NotifyOnFileWriteFinish(write_offset, size, start_ts, finish_ts, s);
@@ -588,6 +628,7 @@ Status WritableFileWriter::WriteDirect() {
     }
 
     IOSTATS_ADD(bytes_written, size);
+    RecordFileIO(io_file_type_, true /* is_write */, size);
     left -= size;
     src += size;
     write_offset += size;
@@ -11,6 +11,7 @@
 #include <sstream>
 #include <string>
 
+#include "monitoring/file_io_stats.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
 #include "rocksdb/listener.h"
@@ -34,12 +35,16 @@ class SequentialFileReader {
  private:
   std::unique_ptr<SequentialFile> file_;
   std::string file_name_;
+  IOFileType io_file_type_;
   std::atomic<size_t> offset_;  // read offset
 
  public:
   explicit SequentialFileReader(std::unique_ptr<SequentialFile>&& _file,
                                 const std::string& _file_name)
-      : file_(std::move(_file)), file_name_(_file_name), offset_(0) {}
+      : file_(std::move(_file)),
+        file_name_(_file_name),
+        io_file_type_(IOFileTypeFromName(_file_name)),
+        offset_(0) {}
 
   SequentialFileReader(SequentialFileReader&& o) ROCKSDB_NOEXCEPT {
     *this = std::move(o);
@@ -47,6 +52,8 @@ class SequentialFileReader {
 
   SequentialFileReader& operator=(SequentialFileReader&& o) ROCKSDB_NOEXCEPT {
     file_ = std::move(o.file_);
+    file_name_ = std::move(o.file_name_);
+    io_file_type_ = o.io_file_type_;
     return *this;
   }
 
@@ -88,6 +95,7 @@ class RandomAccessFileReader {
 
   std::unique_ptr<RandomAccessFile> file_;
   std::string file_name_;
+  IOFileType io_file_type_;
   Env* env_;
   Statistics* stats_;
   uint32_t hist_type_;
@@ -121,6 +129,8 @@ class RandomAccessFileReader {
 
   const std::string& file_name() const { return file_name_; }
 
+  void set_io_file_type(IOFileType type) { io_file_type_ = type; }
+
   void set_use_fsread(bool b) { use_fsread_ = b; }
   bool use_fsread() const { return use_fsread_; }
   bool use_direct_io() const { return file_->use_direct_io(); }
@@ -149,6 +159,7 @@ class WritableFileWriter {
 
   std::unique_ptr<WritableFile> writable_file_;
   std::string file_name_;
+  IOFileType io_file_type_;
   AlignedBuffer buf_;
   size_t max_buffer_size_;
   // Actually written data size can be used for truncate
@@ -174,6 +185,7 @@ class WritableFileWriter {
       const std::vector<std::shared_ptr<EventListener>>& listeners = {})
       : writable_file_(std::move(file)),
         file_name_(_file_name),
+        io_file_type_(IOFileTypeFromName(_file_name)),
         buf_(),
         max_buffer_size_(options.writable_file_max_buffer_size),
         filesize_(0),
@@ -210,6 +222,9 @@ class WritableFileWriter {
 
   const std::string& file_name() const { return file_name_; }
 
+  // Sst writers know what kind of sst they write, the name does not tell
+  void set_io_file_type(IOFileType type) { io_file_type_ = type; }
+
   Status Append(const Slice& data);
 
   Status Pad(const size_t pad_bytes);
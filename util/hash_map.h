@@ -63,6 +63,15 @@ class HashMap {
         [key](const std::pair<K, V>& p) { return p.first == key; });
     return it->second;
   }
+
+  template <typename Func>
+  void ForEach(Func&& func) {
+    for (auto& bucket : table_) {
+      for (auto& p : bucket) {
+        func(p.first, p.second);
+      }
+    }
+  }
 };
 
 }  // namespace TERARKDB_NAMESPACE
@@ -0,0 +1,115 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/memory_governor.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "port/port.h"
+#include "rocksdb/terark_namespace.h"
+
+namespace TERARKDB_NAMESPACE {
+
+MemoryGovernor::MemoryGovernor(size_t limit, std::shared_ptr<Cache> cache,
+                               size_t min_cache_capacity)
+    : limit_(limit),
+      min_cache_capacity_(std::min(min_cache_capacity, limit)),
+      cache_(std::move(cache)),
+      reserved_(0),
+      cache_capacity_(0) {
+  for (auto& usage : usage_) {
+    usage.store(0, std::memory_order_relaxed);
+  }
+  if (cache_ != nullptr) {
+    cache_capacity_ = limit_;
+    cache_->SetCapacity(cache_capacity_);
+  }
+}
+
+void MemoryGovernor::Reserve(Consumer consumer, size_t mem) {
+  assert(consumer < kNumConsumers);
+  usage_[consumer].fetch_add(mem, std::memory_order_relaxed);
+  reserved_.fetch_add(mem, std::memory_order_relaxed);
+  AdjustCacheCapacity();
+}
+
+void MemoryGovernor::Release(Consumer consumer, size_t mem) {
+  assert(consumer < kNumConsumers);
+  assert(usage_[consumer].load(std::memory_order_relaxed) >= mem);
+  usage_[consumer].fetch_sub(mem, std::memory_order_relaxed);
+  reserved_.fetch_sub(mem, std::memory_order_relaxed);
+  AdjustCacheCapacity();
+}
+
+size_t MemoryGovernor::GetTotalUsage() const {
+  size_t usage = GetReservedUsage();
+  if (cache_ != nullptr) {
+    usage += cache_->GetUsage();
+  }
+  return usage;
+}
+
+std::string MemoryGovernor::GetBreakdown() const {
+  std::string result;
+  char buf[128];
+  snprintf(buf, sizeof(buf), "governor-limit: %" ROCKSDB_PRIszt "\n", limit_);
+  result.append(buf);
+  for (int i = 0; i < kNumConsumers; ++i) {
+    auto consumer = static_cast<Consumer>(i);
+    snprintf(buf, sizeof(buf), "governor-%s: %" ROCKSDB_PRIszt "\n",
+             ConsumerName(consumer), GetUsage(consumer));
+    result.append(buf);
+  }
+  if (cache_ != nullptr) {
+    snprintf(buf, sizeof(buf),
+             "governor-block-cache: %" ROCKSDB_PRIszt " / %" ROCKSDB_PRIszt
+             "\n",
+             cache_->GetUsage(), cache_->GetCapacity());
+    result.append(buf);
+  }
+  snprintf(buf, sizeof(buf), "governor-under-pressure: %d\n",
+           UnderPressure() ? 1 : 0);
+  result.append(buf);
+  return result;
+}
+
+const char* MemoryGovernor::ConsumerName(Consumer consumer) {
+  switch (consumer) {
+    case kMemTable:
+      return "memtables";
+    case kTableReader:
+      return "table-readers";
+    case kCompaction:
+      return "compactions";
+    default:
+      assert(false);
+      return "unknown";
+  }
+}
+
+void MemoryGovernor::AdjustCacheCapacity() {
+  if (cache_ == nullptr) {
+    return;
+  }
+  // SetCapacity() may evict entries under the cache shard locks, so only
+  // resize once the target moved by a noticeable fraction of the limit.
+  size_t granularity = std::max<size_t>(limit_ / 64, 1);
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  // Read the reservations under the lock, so a concurrent caller can't
+  // apply a stale target after a newer one.
+  size_t reserved = GetReservedUsage();
+  size_t target = reserved + min_cache_capacity_ < limit_
+                      ? limit_ - reserved
+                      : min_cache_capacity_;
+  size_t diff = target > cache_capacity_ ? target - cache_capacity_
+                                         : cache_capacity_ - target;
+  if (diff >= granularity || (target == min_cache_capacity_ && diff > 0)) {
+    cache_capacity_ = target;
+    cache_->SetCapacity(cache_capacity_);
+  }
+}
+
+}  // namespace TERARKDB_NAMESPACE
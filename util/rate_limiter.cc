@@ -9,6 +9,7 @@
 
 #include "util/rate_limiter.h"
 
+#include "monitoring/file_io_stats.h"
 #include "monitoring/statistics.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
@@ -337,4 +338,365 @@ RateLimiter* NewGenericRateLimiter(
                                 mode, Env::Default(), auto_tuned);
 }
 
+constexpr int IOClassRateLimiter::kNumClasses;
+
+// Pending request
+struct IOClassRateLimiter::Req {
+  explicit Req(int64_t _bytes, int _io_class, port::Mutex* _mu)
+      : request_bytes(_bytes),
+        bytes(_bytes),
+        io_class(_io_class),
+        cv(_mu),
+        granted(false) {}
+  int64_t request_bytes;
+  int64_t bytes;
+  int io_class;
+  port::CondVar cv;
+  bool granted;
+};
+
+IOClassRateLimiter::IOClassRateLimiter(
+    const IOClassRateLimiterOptions& options, Env* env)
+    : RateLimiter(options.mode),
+      refill_period_us_(options.refill_period_us),
+      max_bytes_per_sec_(options.rate_bytes_per_sec),
+      target_io_latency_us_(options.target_io_latency_us),
+      env_(env),
+      rate_bytes_per_sec_(options.rate_bytes_per_sec),
+      refill_bytes_per_period_(
+          CalculateRefillBytesPerPeriod(options.rate_bytes_per_sec)),
+      available_bytes_(0),
+      num_waiting_(0),
+      io_latency_sum_(0),
+      io_latency_count_(0),
+      stop_(false),
+      exit_cv_(&request_mutex_),
+      requests_to_wait_(0),
+      next_refill_us_(NowMicrosMonotonic(env_)),
+      leader_(nullptr),
+      num_drains_(0),
+      prev_num_drains_(0),
+      tuned_time_(NowMicrosMonotonic(env_)) {
+  for (int i = 0; i < kNumClasses; ++i) {
+    class_weights_[i] = std::max(options.class_weights[i], 0);
+    total_requests_[i].store(0, std::memory_order_relaxed);
+    total_bytes_through_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+IOClassRateLimiter::~IOClassRateLimiter() {
+  MutexLock g(&request_mutex_);
+  stop_ = true;
+  requests_to_wait_ = 0;
+  for (auto& queue : queue_) {
+    requests_to_wait_ += static_cast<int32_t>(queue.size());
+    for (auto& r : queue) {
+      r->cv.Signal();
+    }
+  }
+  while (requests_to_wait_ > 0) {
+    exit_cv_.Wait();
+  }
+}
+
+void IOClassRateLimiter::SetBytesPerSecond(int64_t bytes_per_second) {
+  assert(bytes_per_second > 0);
+  rate_bytes_per_sec_.store(bytes_per_second, std::memory_order_relaxed);
+  refill_bytes_per_period_.store(
+      CalculateRefillBytesPerPeriod(bytes_per_second),
+      std::memory_order_relaxed);
+}
+
+int64_t IOClassRateLimiter::GetTotalBytesThrough(
+    const Env::IOPriority pri) const {
+  int64_t total = 0;
+  for (int i = 0; i < kNumClasses; ++i) {
+    if (pri == Env::IO_TOTAL ||
+        (pri == Env::IO_HIGH) ==
+            (i == static_cast<int>(RateLimiterIOClass::kFlush))) {
+      total += total_bytes_through_[i].load(std::memory_order_relaxed);
+    }
+  }
+  return total;
+}
+
+int64_t IOClassRateLimiter::GetTotalRequests(const Env::IOPriority pri) const {
+  int64_t total = 0;
+  for (int i = 0; i < kNumClasses; ++i) {
+    if (pri == Env::IO_TOTAL ||
+        (pri == Env::IO_HIGH) ==
+            (i == static_cast<int>(RateLimiterIOClass::kFlush))) {
+      total += total_requests_[i].load(std::memory_order_relaxed);
+    }
+  }
+  return total;
+}
+
+void IOClassRateLimiter::RecordIOLatency(uint64_t micros) {
+  io_latency_sum_.fetch_add(micros, std::memory_order_relaxed);
+  io_latency_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+RateLimiterIOClass IOClassRateLimiter::CurrentIOClass(Env::IOPriority pri) {
+  const IOContext* context = get_io_context();
+  if (context != nullptr) {
+    switch (context->originator) {
+      case kIOOriginatorFlush:
+        return RateLimiterIOClass::kFlush;
+      case kIOOriginatorGarbageCollection:
+        return RateLimiterIOClass::kGarbageCollection;
+      case kIOOriginatorMapCompaction:
+        return RateLimiterIOClass::kMapCompaction;
+      default:
+        break;
+    }
+    if (context->originator >= kIOOriginatorCompaction &&
+        context->originator < kIOOriginatorCount) {
+      switch (static_cast<CompactionReason>(context->originator -
+                                            kIOOriginatorCompaction)) {
+        case CompactionReason::kLevelL0FilesNum:
+        case CompactionReason::kUniversalSortedRunNum:
+          // Unblocks writes, even when writing the bottommost level
+          return RateLimiterIOClass::kL0Compaction;
+        case CompactionReason::kBottommostFiles:
+          return RateLimiterIOClass::kBottommostCompaction;
+        default:
+          return context->bottommost ? RateLimiterIOClass::kBottommostCompaction
+                                     : RateLimiterIOClass::kCompaction;
+      }
+    }
+  }
+  return pri == Env::IO_HIGH ? RateLimiterIOClass::kFlush
+                             : RateLimiterIOClass::kCompaction;
+}
+
+bool IOClassRateLimiter::TryAcquire(int64_t bytes) {
+  int64_t available = available_bytes_.load(std::memory_order_relaxed);
+  while (available >= bytes) {
+    if (available_bytes_.compare_exchange_weak(available, available - bytes,
+                                               std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IOClassRateLimiter::IsQueueFront(const Req* r) const {
+  const auto& queue = queue_[r->io_class];
+  return !queue.empty() && queue.front() == r;
+}
+
+void IOClassRateLimiter::SignalQueueFront() {
+  for (auto& queue : queue_) {
+    if (!queue.empty()) {
+      queue.front()->cv.Signal();
+      return;
+    }
+  }
+}
+
+void IOClassRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
+                                 Statistics* stats) {
+  assert(bytes <= refill_bytes_per_period_.load(std::memory_order_relaxed));
+  TEST_SYNC_POINT("IOClassRateLimiter::Request");
+  const int io_class = static_cast<int>(CurrentIOClass(pri));
+  total_requests_[io_class].fetch_add(1, std::memory_order_relaxed);
+
+  // Nobody is waiting, so the queues can not be overtaken
+  if (num_waiting_.load(std::memory_order_acquire) == 0 && TryAcquire(bytes)) {
+    total_bytes_through_[io_class].fetch_add(bytes, std::memory_order_relaxed);
+    return;
+  }
+
+  MutexLock g(&request_mutex_);
+
+  if (target_io_latency_us_ > 0) {
+    static const int kRefillsPerTune = 100;
+    std::chrono::microseconds now(NowMicrosMonotonic(env_));
+    if (now - tuned_time_ >=
+        kRefillsPerTune * std::chrono::microseconds(refill_period_us_)) {
+      Tune();
+    }
+  }
+
+  if (stop_) {
+    return;
+  }
+
+  if (num_waiting_.load(std::memory_order_relaxed) == 0 && TryAcquire(bytes)) {
+    total_bytes_through_[io_class].fetch_add(bytes, std::memory_order_relaxed);
+    return;
+  }
+
+  // Request cannot be satisfied at this moment, enqueue
+  Req r(bytes, io_class, &request_mutex_);
+  queue_[io_class].push_back(&r);
+  num_waiting_.fetch_add(1, std::memory_order_release);
+
+  // Leader election works like in GenericRateLimiter::Request()
+  do {
+    bool timedout = false;
+    if (leader_ == nullptr && IsQueueFront(&r)) {
+      leader_ = &r;
+      int64_t delta = next_refill_us_ - NowMicrosMonotonic(env_);
+      delta = delta > 0 ? delta : 0;
+      if (delta == 0) {
+        timedout = true;
+      } else {
+        int64_t wait_until = env_->NowMicros() + delta;
+        RecordTick(stats, NUMBER_RATE_LIMITER_DRAINS);
+        ++num_drains_;
+        timedout = r.cv.TimedWait(wait_until);
+      }
+    } else {
+      r.cv.Wait();
+    }
+
+    // request_mutex_ is held from now on
+    if (stop_) {
+      --requests_to_wait_;
+      exit_cv_.Signal();
+      return;
+    }
+
+    assert(r.granted || IsQueueFront(&r));
+
+    if (leader_ == &r) {
+      if (timedout) {
+        Refill();
+        leader_ = nullptr;
+        if (r.granted) {
+          // Let the next waiter take over as leader
+          SignalQueueFront();
+          break;
+        }
+      } else {
+        // Spontaneous wake up, need to continue to wait
+        assert(!r.granted);
+        leader_ = nullptr;
+      }
+    } else {
+      assert(!timedout);
+    }
+  } while (!r.granted);
+}
+
+int64_t IOClassRateLimiter::GrantQueue(int io_class, int64_t bytes) {
+  auto* queue = &queue_[io_class];
+  int64_t used = 0;
+  while (!queue->empty() && used < bytes) {
+    auto* next_req = queue->front();
+    int64_t grant = std::min(next_req->request_bytes, bytes - used);
+    // Partial grants avoid starving large requests
+    next_req->request_bytes -= grant;
+    used += grant;
+    if (next_req->request_bytes > 0) {
+      break;
+    }
+    total_bytes_through_[io_class].fetch_add(next_req->bytes,
+                                             std::memory_order_relaxed);
+    queue->pop_front();
+    num_waiting_.fetch_sub(1, std::memory_order_relaxed);
+
+    next_req->granted = true;
+    if (next_req != leader_) {
+      // Quota granted, signal the thread
+      next_req->cv.Signal();
+    }
+  }
+  return used;
+}
+
+void IOClassRateLimiter::Refill() {
+  TEST_SYNC_POINT("IOClassRateLimiter::Refill");
+  next_refill_us_ = NowMicrosMonotonic(env_) + refill_period_us_;
+  // Carry over the left over quota from the last period
+  auto refill_bytes_per_period =
+      refill_bytes_per_period_.load(std::memory_order_relaxed);
+  int64_t budget = available_bytes_.exchange(0, std::memory_order_relaxed);
+  if (budget < refill_bytes_per_period) {
+    budget += refill_bytes_per_period;
+  }
+
+  // Each waiting class gets its share, what a class does not use is carried
+  // over to the next refill, where it may go to other classes
+  int64_t total_weight = 0;
+  for (int i = 0; i < kNumClasses; ++i) {
+    if (!queue_[i].empty()) {
+      total_weight += class_weights_[i];
+    }
+  }
+  int64_t left = budget;
+  for (int i = 0; i < kNumClasses && total_weight > 0; ++i) {
+    if (!queue_[i].empty() && class_weights_[i] > 0) {
+      auto share = static_cast<int64_t>(static_cast<double>(budget) *
+                                        class_weights_[i] / total_weight);
+      left -= GrantQueue(i, std::min(share, left));
+    }
+  }
+  if (total_weight == 0) {
+    // Only classes of weight 0 are waiting
+    for (int i = 0; i < kNumClasses && left > 0; ++i) {
+      left -= GrantQueue(i, left);
+    }
+  }
+  if (left > 0) {
+    available_bytes_.fetch_add(left, std::memory_order_relaxed);
+  }
+}
+
+int64_t IOClassRateLimiter::CalculateRefillBytesPerPeriod(
+    int64_t rate_bytes_per_sec) {
+  if (port::kMaxInt64 / rate_bytes_per_sec < refill_period_us_) {
+    return port::kMaxInt64 / 1000000;
+  } else {
+    return std::max(kMinRefillBytesPerPeriod,
+                    rate_bytes_per_sec * refill_period_us_ / 1000000);
+  }
+}
+
+void IOClassRateLimiter::Tune() {
+  const int kAdjustFactorPct = 5;
+  // computed rate limit will be in
+  // `[max_bytes_per_sec_ / kAllowedRangeFactor, max_bytes_per_sec_]`.
+  const int kAllowedRangeFactor = 20;
+
+  tuned_time_ = std::chrono::microseconds(NowMicrosMonotonic(env_));
+  uint64_t io_count = io_latency_count_.exchange(0, std::memory_order_relaxed);
+  uint64_t io_latency_sum =
+      io_latency_sum_.exchange(0, std::memory_order_relaxed);
+  int64_t num_drains = num_drains_ - prev_num_drains_;
+  prev_num_drains_ = num_drains_;
+  if (io_count == 0) {
+    return;
+  }
+
+  int64_t prev_bytes_per_sec = GetBytesPerSecond();
+  int64_t new_bytes_per_sec = prev_bytes_per_sec;
+  if (io_latency_sum / io_count > target_io_latency_us_) {
+    // The device falls behind, back off
+    int64_t sanitized_prev_bytes_per_sec =
+        std::min(prev_bytes_per_sec, port::kMaxInt64 / 100);
+    new_bytes_per_sec =
+        std::max(max_bytes_per_sec_ / kAllowedRangeFactor,
+                 sanitized_prev_bytes_per_sec * 100 / (100 + kAdjustFactorPct));
+  } else if (num_drains > 0) {
+    // The device keeps up and requests had to wait
+    int64_t sanitized_prev_bytes_per_sec = std::min(
+        prev_bytes_per_sec, port::kMaxInt64 / (100 + kAdjustFactorPct));
+    new_bytes_per_sec =
+        std::min(max_bytes_per_sec_,
+                 sanitized_prev_bytes_per_sec * (100 + kAdjustFactorPct) / 100);
+  }
+  if (new_bytes_per_sec != prev_bytes_per_sec) {
+    SetBytesPerSecond(std::max<int64_t>(new_bytes_per_sec, 1));
+  }
+}
+
+RateLimiter* NewIOClassRateLimiter(const IOClassRateLimiterOptions& options) {
+  assert(options.rate_bytes_per_sec > 0);
+  assert(options.refill_period_us > 0);
+  return new IOClassRateLimiter(options, Env::Default());
+}
+
 }  // namespace TERARKDB_NAMESPACE
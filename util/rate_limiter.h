@@ -112,4 +112,108 @@ class GenericRateLimiter : public RateLimiter {
   std::chrono::microseconds tuned_time_;
 };
 
+// Shares the rate among RateLimiterIOClass, see NewIOClassRateLimiter()
+class IOClassRateLimiter : public RateLimiter {
+ public:
+  static constexpr int kNumClasses =
+      static_cast<int>(RateLimiterIOClass::kNumClasses);
+
+  IOClassRateLimiter(const IOClassRateLimiterOptions& options, Env* env);
+
+  virtual ~IOClassRateLimiter();
+
+  virtual void SetBytesPerSecond(int64_t bytes_per_second) override;
+
+  using RateLimiter::Request;
+  virtual void Request(const int64_t bytes, const Env::IOPriority pri,
+                       Statistics* stats) override;
+
+  virtual int64_t GetSingleBurstBytes() const override {
+    return refill_bytes_per_period_.load(std::memory_order_relaxed);
+  }
+
+  // IO_HIGH counts kFlush, IO_LOW counts the other classes
+  virtual int64_t GetTotalBytesThrough(
+      const Env::IOPriority pri = Env::IO_TOTAL) const override;
+
+  virtual int64_t GetTotalRequests(
+      const Env::IOPriority pri = Env::IO_TOTAL) const override;
+
+  virtual int64_t GetBytesPerSecond() const override {
+    return rate_bytes_per_sec_.load(std::memory_order_relaxed);
+  }
+
+  virtual bool IsIOLatencyTracked() const override {
+    return target_io_latency_us_ > 0;
+  }
+
+  virtual void RecordIOLatency(uint64_t micros) override;
+
+  int64_t GetTotalBytesThrough(RateLimiterIOClass io_class) const {
+    return total_bytes_through_[static_cast<int>(io_class)].load(
+        std::memory_order_relaxed);
+  }
+
+  int64_t GetTotalRequests(RateLimiterIOClass io_class) const {
+    return total_requests_[static_cast<int>(io_class)].load(
+        std::memory_order_relaxed);
+  }
+
+  // The class of a request from this thread
+  static RateLimiterIOClass CurrentIOClass(Env::IOPriority pri);
+
+ private:
+  struct Req;
+
+  bool TryAcquire(int64_t bytes);
+  bool IsQueueFront(const Req* r) const;
+  void SignalQueueFront();
+  void Refill();
+  // Grants up to bytes to the waiting requests of io_class, returns the
+  // bytes used
+  int64_t GrantQueue(int io_class, int64_t bytes);
+  int64_t CalculateRefillBytesPerPeriod(int64_t rate_bytes_per_sec);
+  void Tune();
+
+  uint64_t NowMicrosMonotonic(Env* env) {
+    return env->NowNanos() / std::milli::den;
+  }
+
+  const int64_t kMinRefillBytesPerPeriod = 100;
+
+  const int64_t refill_period_us_;
+  const int64_t max_bytes_per_sec_;
+  const uint64_t target_io_latency_us_;
+  int32_t class_weights_[kNumClasses];
+  Env* const env_;
+
+  std::atomic<int64_t> rate_bytes_per_sec_;
+  std::atomic<int64_t> refill_bytes_per_period_;
+  // Taken without request_mutex_ while num_waiting_ is 0
+  std::atomic<int64_t> available_bytes_;
+  std::atomic<int64_t> num_waiting_;
+
+  std::atomic<int64_t> total_requests_[kNumClasses];
+  std::atomic<int64_t> total_bytes_through_[kNumClasses];
+
+  std::atomic<uint64_t> io_latency_sum_;
+  std::atomic<uint64_t> io_latency_count_;
+
+  // This mutex guard all states below
+  mutable port::Mutex request_mutex_;
+
+  bool stop_;
+  port::CondVar exit_cv_;
+  int32_t requests_to_wait_;
+
+  int64_t next_refill_us_;
+
+  Req* leader_;
+  std::deque<Req*> queue_[kNumClasses];
+
+  int64_t num_drains_;
+  int64_t prev_num_drains_;
+  std::chrono::microseconds tuned_time_;
+};
+
 }  // namespace TERARKDB_NAMESPACE
@@ -15,10 +15,13 @@
 
 #include <inttypes.h>
 
+#include <atomic>
 #include <chrono>
 #include <limits>
+#include <vector>
 
 #include "db/db_test_util.h"
+#include "monitoring/file_io_stats.h"
 #include "rocksdb/env.h"
 #include "rocksdb/terark_namespace.h"
 #include "util/random.h"
@@ -233,6 +236,132 @@ TEST_F(RateLimiterTest, AutoTuneIncreaseWhenFull) {
   ASSERT_LT(new_bytes_per_sec, orig_bytes_per_sec);
 }
 
+TEST_F(RateLimiterTest, IOClassShares) {
+  const int kRefills = 200;
+  const int kThreadsPerClass = 2;
+
+  IOClassRateLimiterOptions options;
+  options.rate_bytes_per_sec = 10 << 20;
+  options.refill_period_us = 1000;
+  std::unique_ptr<RateLimiter> limiter(NewIOClassRateLimiter(options));
+
+  // The bytes granted are checked against the number of refills rather than
+  // the elapsed time, so a slow or loaded machine can't fail the test
+  std::atomic<int> refills(0);
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "IOClassRateLimiter::Refill", [&](void* /*arg*/) {
+        refills.fetch_add(1, std::memory_order_relaxed);
+      });
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  // Each request takes more than a class's share of one refill, so both
+  // queues stay populated and every refilled byte is granted
+  int64_t request_bytes = limiter->GetSingleBurstBytes();
+  auto writer = [&](IOOriginator originator, Env::IOPriority pri) {
+    IOOriginatorScope io_originator_scope(originator);
+    while (refills.load(std::memory_order_relaxed) < kRefills) {
+      limiter->Request(request_bytes, pri, nullptr /* stats */,
+                       RateLimiter::OpType::kWrite);
+    }
+  };
+  std::vector<port::Thread> threads;
+  for (int i = 0; i < kThreadsPerClass; ++i) {
+    threads.emplace_back(writer, kIOOriginatorFlush, Env::IO_HIGH);
+    threads.emplace_back(
+        writer, IOOriginatorForCompaction(CompactionReason::kBottommostFiles),
+        Env::IO_LOW);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  int64_t refilled = refills.load() * limiter->GetSingleBurstBytes();
+  int64_t flush_bytes = limiter->GetTotalBytesThrough(Env::IO_HIGH);
+  int64_t compaction_bytes = limiter->GetTotalBytesThrough(Env::IO_LOW);
+  ASSERT_LE(flush_bytes + compaction_bytes, refilled);
+  ASSERT_GE(flush_bytes + compaction_bytes,
+            refilled - limiter->GetSingleBurstBytes());
+
+  // Both keep a share, the more urgent class the larger one
+  ASSERT_GT(compaction_bytes, 0);
+  ASSERT_GT(flush_bytes, 2 * compaction_bytes);
+
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+  auto* io_class_limiter = static_cast<IOClassRateLimiter*>(limiter.get());
+  ASSERT_EQ(flush_bytes, io_class_limiter->GetTotalBytesThrough(
+                             RateLimiterIOClass::kFlush));
+  ASSERT_EQ(compaction_bytes,
+            io_class_limiter->GetTotalBytesThrough(
+                RateLimiterIOClass::kBottommostCompaction));
+
+  {
+    IOOriginatorScope io_originator_scope(
+        IOOriginatorForCompaction(CompactionReason::kLevelL0FilesNum));
+    IOBottommostScope io_bottommost_scope(true);
+    ASSERT_EQ(RateLimiterIOClass::kL0Compaction,
+              IOClassRateLimiter::CurrentIOClass(Env::IO_LOW));
+  }
+  {
+    IOOriginatorScope io_originator_scope(
+        IOOriginatorForCompaction(CompactionReason::kLevelMaxLevelSize));
+    ASSERT_EQ(RateLimiterIOClass::kCompaction,
+              IOClassRateLimiter::CurrentIOClass(Env::IO_LOW));
+    IOBottommostScope io_bottommost_scope(true);
+    ASSERT_EQ(RateLimiterIOClass::kBottommostCompaction,
+              IOClassRateLimiter::CurrentIOClass(Env::IO_LOW));
+  }
+  {
+    IOOriginatorScope io_originator_scope(kIOOriginatorGarbageCollection);
+    ASSERT_EQ(RateLimiterIOClass::kGarbageCollection,
+              IOClassRateLimiter::CurrentIOClass(Env::IO_LOW));
+  }
+#endif  // ROCKSDB_SUPPORT_THREAD_LOCAL
+  ASSERT_EQ(RateLimiterIOClass::kFlush,
+            IOClassRateLimiter::CurrentIOClass(Env::IO_HIGH));
+}
+
+TEST_F(RateLimiterTest, IOClassAutoTuneByLatency) {
+  const int64_t kTimePerRefill = 1000000;
+  const int kRefillsPerTune = 100;  // needs to match util/rate_limiter.cc
+
+  SpecialEnv special_env(Env::Default());
+  special_env.no_slowdown_ = true;
+  special_env.time_elapse_only_sleep_ = true;
+
+  IOClassRateLimiterOptions options;
+  options.rate_bytes_per_sec = 1000;
+  options.refill_period_us = kTimePerRefill;
+  options.target_io_latency_us = 1000;
+  std::unique_ptr<RateLimiter> limiter(
+      new IOClassRateLimiter(options, &special_env));
+  ASSERT_TRUE(limiter->IsIOLatencyTracked());
+
+  // slower than the target, the rate goes down
+  limiter->RecordIOLatency(10 * options.target_io_latency_us);
+  special_env.SleepForMicroseconds(
+      static_cast<int>(kRefillsPerTune * kTimePerRefill));
+  limiter->Request(1 /* bytes */, Env::IO_LOW, nullptr /* stats */,
+                   RateLimiter::OpType::kWrite);
+  int64_t lowered_bytes_per_sec = limiter->GetBytesPerSecond();
+  ASSERT_LT(lowered_bytes_per_sec, options.rate_bytes_per_sec);
+
+  // fast enough but drained, the rate goes up again
+  limiter->RecordIOLatency(options.target_io_latency_us / 10);
+  int64_t burst = limiter->GetSingleBurstBytes();
+  for (int i = 0; i < 2; ++i) {
+    limiter->Request(burst, Env::IO_LOW, nullptr /* stats */,
+                     RateLimiter::OpType::kWrite);
+  }
+  special_env.SleepForMicroseconds(
+      static_cast<int>(kRefillsPerTune * kTimePerRefill));
+  // more than left over, so the tuner can be triggered
+  limiter->Request(burst, Env::IO_LOW, nullptr /* stats */,
+                   RateLimiter::OpType::kWrite);
+  ASSERT_GT(limiter->GetBytesPerSecond(), lowered_bytes_per_sec);
+}
+
 }  // namespace TERARKDB_NAMESPACE
 
 int main(int argc, char** argv) {
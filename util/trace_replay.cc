@@ -6,6 +6,9 @@
 #include "util/trace_replay.h"
 
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <sstream>
 #include <thread>
 
@@ -14,6 +17,7 @@
 #include "rocksdb/terark_namespace.h"
 #include "rocksdb/write_batch.h"
 #include "util/coding.h"
+#include "util/hash.h"
 #include "util/string_util.h"
 
 namespace TERARKDB_NAMESPACE {
@@ -148,11 +152,7 @@ Status Replayer::Replay() {
 
   std::chrono::system_clock::time_point replay_epoch =
       std::chrono::system_clock::now();
-  WriteOptions woptions;
-  ReadOptions roptions;
   Trace trace;
-  uint64_t ops = 0;
-  Iterator* single_iter = nullptr;
   while (s.ok()) {
     trace.reset();
     s = ReadTrace(&trace);
@@ -162,74 +162,286 @@ Status Replayer::Replay() {
 
     std::this_thread::sleep_until(
         replay_epoch + std::chrono::microseconds(trace.ts - header.ts));
-    if (trace.type == kTraceWrite) {
-      WriteBatch batch(trace.payload);
-      db_->Write(woptions, &batch);
-      ops++;
-    } else if (trace.type == kTraceGet) {
-      uint32_t cf_id = 0;
-      Slice key;
-      DecodeCFAndKey(trace.payload, &cf_id, &key);
-      if (cf_id > 0 && cf_map_.find(cf_id) == cf_map_.end()) {
-        return Status::Corruption("Invalid Column Family ID.");
-      }
+    if (trace.type == kTraceEnd) {
+      // Do nothing for now.
+      // TODO: Add some validations later.
+      break;
+    }
+    s = ReplayTrace(&trace, latency_);
+  }
 
-      std::string value;
-      if (cf_id == 0) {
-        db_->Get(roptions, key, &value);
-      } else {
-        db_->Get(roptions, cf_map_[cf_id], key, &value);
-      }
-      ops++;
-    } else if (trace.type == kTraceIteratorSeek) {
-      uint32_t cf_id = 0;
-      Slice key;
-      DecodeCFAndKey(trace.payload, &cf_id, &key);
-      if (cf_id > 0 && cf_map_.find(cf_id) == cf_map_.end()) {
-        return Status::Corruption("Invalid Column Family ID.");
-      }
+  if (s.IsIncomplete()) {
+    // Reaching eof returns Incomplete status at the moment.
+    // Could happen when killing a process without calling EndTrace() API.
+    // TODO: Add better error handling.
+    return Status::OK();
+  }
+  return s;
+}
 
-      if (cf_id == 0) {
-        single_iter = db_->NewIterator(roptions);
-      } else {
-        single_iter = db_->NewIterator(roptions, cf_map_[cf_id]);
+struct Replayer::Worker {
+  // bounds the memory used when the trace is read faster than replayed
+  static const size_t kMaxQueueSize = 1024;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<Trace> queue;
+  bool busy = false;
+  bool closing = false;
+  Status status;
+  HistogramImpl latency[kTraceMax];
+  std::thread thread;
+
+  void Run(Replayer* replayer, std::atomic<bool>* failed) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cv.wait(lock, [this] { return !queue.empty() || closing; });
+      if (queue.empty()) {
+        break;
       }
-      single_iter->Seek(key);
-      ops++;
-      delete single_iter;
-    } else if (trace.type == kTraceIteratorSeekForPrev) {
-      // Currently, only support to call the Seek()
-      uint32_t cf_id = 0;
-      Slice key;
-      DecodeCFAndKey(trace.payload, &cf_id, &key);
-      if (cf_id > 0 && cf_map_.find(cf_id) == cf_map_.end()) {
-        return Status::Corruption("Invalid Column Family ID.");
+      Trace trace = std::move(queue.front());
+      queue.pop_front();
+      busy = true;
+      lock.unlock();
+      cv.notify_all();
+      Status s = replayer->ReplayTrace(&trace, latency);
+      lock.lock();
+      busy = false;
+      if (!s.ok() && status.ok()) {
+        status = s;
+        failed->store(true, std::memory_order_relaxed);
       }
+      cv.notify_all();
+    }
+  }
+
+  void Push(Trace* trace) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return queue.size() < kMaxQueueSize; });
+    queue.emplace_back(std::move(*trace));
+    lock.unlock();
+    cv.notify_all();
+  }
+
+  void WaitForIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return queue.empty() && !busy; });
+  }
+
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      closing = true;
+    }
+    cv.notify_all();
+    thread.join();
+  }
+};
+
+namespace {
+// Marks the shards of the keys in a write batch, range deletions and
+// anything it can't tell apart touch every shard
+class ShardCollector : public WriteBatch::Handler {
+ public:
+  explicit ShardCollector(std::vector<char>* shards) : shards_(shards) {}
+
+  Status PutCF(uint32_t cf_id, const Slice& key, const Slice&) override {
+    return Add(cf_id, key);
+  }
+  Status DeleteCF(uint32_t cf_id, const Slice& key) override {
+    return Add(cf_id, key);
+  }
+  Status SingleDeleteCF(uint32_t cf_id, const Slice& key) override {
+    return Add(cf_id, key);
+  }
+  Status MergeCF(uint32_t cf_id, const Slice& key, const Slice&) override {
+    return Add(cf_id, key);
+  }
+  Status DeleteRangeCF(uint32_t, const Slice&, const Slice&) override {
+    return Status::NotSupported();
+  }
+
+ private:
+  Status Add(uint32_t cf_id, const Slice& key) {
+    (*shards_)[Hash(key.data(), key.size(), cf_id) % shards_->size()] = 1;
+    return Status::OK();
+  }
+
+  std::vector<char>* shards_;
+};
+}  // namespace
+
+void Replayer::GetShards(Trace* trace, std::vector<char>* shards) {
+  std::fill(shards->begin(), shards->end(), 0);
+  if (trace->type == kTraceWrite) {
+    WriteBatch batch(trace->payload);
+    ShardCollector collector(shards);
+    if (!batch.Iterate(&collector).ok()) {
+      std::fill(shards->begin(), shards->end(), 1);
+    }
+  } else {
+    uint32_t cf_id = 0;
+    Slice key;
+    DecodeCFAndKey(trace->payload, &cf_id, &key);
+    (*shards)[Hash(key.data(), key.size(), cf_id) % shards->size()] = 1;
+  }
+}
+
+Status Replayer::MultiThreadReplay(uint32_t threads_num, double fast_forward) {
+  if (threads_num == 0 || fast_forward < 0) {
+    return Status::InvalidArgument("Replayer::MultiThreadReplay");
+  }
+  Status s;
+  Trace header;
+  s = ReadHeader(&header);
+  if (!s.ok()) {
+    return s;
+  }
+
+  std::atomic<bool> failed{false};
+  std::vector<std::unique_ptr<Worker>> workers(threads_num);
+  for (auto& worker : workers) {
+    worker.reset(new Worker);
+    worker->thread = std::thread(&Worker::Run, worker.get(), this, &failed);
+  }
+
+  std::chrono::system_clock::time_point replay_epoch =
+      std::chrono::system_clock::now();
+  std::vector<char> shards(threads_num);
+  Trace trace;
+  while (s.ok() && !failed.load(std::memory_order_relaxed)) {
+    trace.reset();
+    s = ReadTrace(&trace);
+    if (!s.ok()) {
+      break;
+    }
+    if (trace.type == kTraceEnd) {
+      break;
+    }
+    if (trace.type != kTraceWrite && trace.type != kTraceGet &&
+        trace.type != kTraceIteratorSeek &&
+        trace.type != kTraceIteratorSeekForPrev) {
+      continue;
+    }
 
-      if (cf_id == 0) {
-        single_iter = db_->NewIterator(roptions);
+    if (fast_forward > 0) {
+      std::this_thread::sleep_until(
+          replay_epoch +
+          std::chrono::microseconds(
+              static_cast<uint64_t>((trace.ts - header.ts) / fast_forward)));
+    }
+    GetShards(&trace, &shards);
+    // Only this thread pushes. A record spanning several shards runs after
+    // the earlier records on all of them, and the next record is dispatched
+    // only once it finished, so nothing overtakes it on any of its keys.
+    size_t target = threads_num;
+    bool multi_shard = false;
+    for (size_t i = 0; i < threads_num; ++i) {
+      if (!shards[i]) {
+        continue;
+      }
+      if (target == threads_num) {
+        target = i;
       } else {
-        single_iter = db_->NewIterator(roptions, cf_map_[cf_id]);
+        multi_shard = true;
+        workers[i]->WaitForIdle();
       }
-      single_iter->SeekForPrev(key);
-      ops++;
-      delete single_iter;
-    } else if (trace.type == kTraceEnd) {
-      // Do nothing for now.
-      // TODO: Add some validations later.
-      break;
+    }
+    assert(target < threads_num);
+    workers[target]->Push(&trace);
+    if (multi_shard) {
+      workers[target]->WaitForIdle();
+    }
+  }
+
+  for (auto& worker : workers) {
+    worker->Close();
+    if (s.ok() || s.IsIncomplete()) {
+      s = worker->status;
+    }
+    for (int type = 0; type < kTraceMax; ++type) {
+      latency_[type].Merge(worker->latency[type]);
     }
   }
 
   if (s.IsIncomplete()) {
     // Reaching eof returns Incomplete status at the moment.
-    // Could happen when killing a process without calling EndTrace() API.
-    // TODO: Add better error handling.
     return Status::OK();
   }
   return s;
 }
 
+Status Replayer::ReplayTrace(Trace* trace, HistogramImpl* latency) {
+  Env* env = db_->GetEnv();
+  uint64_t start_micros = env->NowMicros();
+  if (trace->type == kTraceWrite) {
+    WriteBatch batch(trace->payload);
+    db_->Write(WriteOptions(), &batch);
+  } else if (trace->type == kTraceGet) {
+    uint32_t cf_id = 0;
+    Slice key;
+    DecodeCFAndKey(trace->payload, &cf_id, &key);
+    // Worker threads share cf_map_, look it up without operator[]
+    auto cf_iter = cf_map_.find(cf_id);
+    if (cf_id > 0 && cf_iter == cf_map_.end()) {
+      return Status::Corruption("Invalid Column Family ID.");
+    }
+
+    std::string value;
+    if (cf_id == 0) {
+      db_->Get(ReadOptions(), key, &value);
+    } else {
+      db_->Get(ReadOptions(), cf_iter->second, key, &value);
+    }
+  } else if (trace->type == kTraceIteratorSeek ||
+             trace->type == kTraceIteratorSeekForPrev) {
+    uint32_t cf_id = 0;
+    Slice key;
+    DecodeCFAndKey(trace->payload, &cf_id, &key);
+    auto cf_iter = cf_map_.find(cf_id);
+    if (cf_id > 0 && cf_iter == cf_map_.end()) {
+      return Status::Corruption("Invalid Column Family ID.");
+    }
+
+    std::unique_ptr<Iterator> single_iter;
+    if (cf_id == 0) {
+      single_iter.reset(db_->NewIterator(ReadOptions()));
+    } else {
+      single_iter.reset(db_->NewIterator(ReadOptions(), cf_iter->second));
+    }
+    if (trace->type == kTraceIteratorSeek) {
+      single_iter->Seek(key);
+    } else {
+      single_iter->SeekForPrev(key);
+    }
+  } else {
+    return Status::OK();
+  }
+  latency[trace->type].Add(env->NowMicros() - start_micros);
+  return Status::OK();
+}
+
+std::string Replayer::GetLatencyReport() const {
+  static const std::pair<TraceType, const char*> kNames[] = {
+      {kTraceWrite, "Write"},
+      {kTraceGet, "Get"},
+      {kTraceIteratorSeek, "IteratorSeek"},
+      {kTraceIteratorSeekForPrev, "IteratorSeekForPrev"},
+  };
+  std::string report;
+  for (auto& pair : kNames) {
+    const HistogramImpl& latency = latency_[pair.first];
+    if (latency.Empty()) {
+      continue;
+    }
+    report.append("Microseconds per ");
+    report.append(pair.second);
+    report.append(":\n");
+    report.append(latency.ToString());
+  }
+  return report;
+}
+
 Status Replayer::ReadHeader(Trace* header) {
   assert(header != nullptr);
   Status s = ReadTrace(header);
@@ -9,6 +9,7 @@
 #include <unordered_map>
 #include <utility>
 
+#include "monitoring/histogram.h"
 #include "rocksdb/env.h"
 #include "rocksdb/options.h"
 #include "rocksdb/terark_namespace.h"
@@ -88,14 +89,33 @@ class Replayer {
 
   Status Replay();
 
+  // Replay the trace on threads_num worker threads. Records are sharded by
+  // the hash of their column family and key, so the operations on one key
+  // keep their recorded order, a write batch touching the keys of several
+  // shards waits for those shards to drain first. The recorded inter-arrival
+  // times are divided by fast_forward, 0 replays as fast as possible.
+  Status MultiThreadReplay(uint32_t threads_num, double fast_forward = 1.0);
+
+  // Latency of the operations replayed so far, in micros
+  const HistogramImpl& GetLatency(TraceType type) const {
+    assert(type < kTraceMax);
+    return latency_[type];
+  }
+  std::string GetLatencyReport() const;
+
  private:
+  struct Worker;
+
   Status ReadHeader(Trace* header);
   Status ReadFooter(Trace* footer);
   Status ReadTrace(Trace* trace);
+  Status ReplayTrace(Trace* trace, HistogramImpl* latency);
+  void GetShards(Trace* trace, std::vector<char>* shards);
 
   DBImpl* db_;
   std::unique_ptr<TraceReader> trace_reader_;
   std::unordered_map<uint32_t, ColumnFamilyHandle*> cf_map_;
+  HistogramImpl latency_[kTraceMax];
 };
 
 }  // namespace TERARKDB_NAMESPACE
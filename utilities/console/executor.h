@@ -20,8 +20,25 @@ class Executor {
   virtual void Submit(const TERARKDB_NAMESPACE::autovector<nonstd::string_view>& argv,
                       Client* c, int fd) = 0;
 
-  virtual void Execute(size_t n, long curr_time, EventLoop<Client>* el) = 0;
+  // Prepare(), Run() and Finish() in one go on the event loop thread
+  void Execute(size_t n, long curr_time, EventLoop<Client>* el) {
+    Prepare(n, curr_time);
+    Run();
+    Finish(el);
+  }
 
+  // Takes the first n submitted tasks as the next batch, called on the event
+  // loop thread
+  virtual void Prepare(size_t n, long curr_time) = 0;
+
+  // Executes the batch against the DB, doesn't touch clients nor the event
+  // loop, so it may be called on any thread
+  virtual void Run() = 0;
+
+  // Sends the replies of the batch, called on the event loop thread
+  virtual void Finish(EventLoop<Client>* el) = 0;
+
+  // Tasks submitted and not yet taken by Prepare()
   virtual size_t GetTaskCount() const = 0;
 };
 
@@ -1,18 +1,33 @@
+#include <algorithm>
+#include <cstdlib>
 #include <deque>
-#include <map>
+#include <vector>
 
 #include "db/db_impl.h"
 #include "executor.h"
+#include "rocksdb/write_batch.h"
 #include "string_view.hpp"
 #include "util/autovector.h"
 
 namespace cheapis {
+constexpr size_t kDefaultScanCount = 10;
+constexpr size_t kMaxScanCount = 10000;
+
 class ExecutorMemImpl final : public Executor {
  private:
+  enum Kind {
+    kRead,   // GET, MGET
+    kWrite,  // SET, DEL, MSET
+    kOther,
+  };
+
   struct Task {
     TERARKDB_NAMESPACE::autovector<std::string> argv;
+    std::string reply;
     Client* c;
     int fd;
+    Kind kind;
+    bool skip = false;  // the client was closed when the batch was prepared
   };
 
  public:
@@ -29,11 +44,57 @@ class ExecutorMemImpl final : public Executor {
     }
     task.c = c;
     task.fd = fd;
+    task.kind = Classify(task.argv);
+  }
+
+  void Prepare(size_t n, long /* curr_time */) override {
+    assert(batch_.empty() && n <= tasks_.size());
+    if (n == tasks_.size()) {
+      batch_.swap(tasks_);
+    } else {
+      for (size_t i = 0; i < n; tasks_.pop_front(), ++i) {
+        batch_.emplace_back(std::move(tasks_.front()));
+      }
+    }
+    // Run() may be on another thread, it must not read the clients
+    for (auto& task : batch_) {
+      task.skip = task.c->close;
+    }
+  }
+
+  // Consecutive reads of the batch are served by one MultiGet and
+  // consecutive writes are group committed as one WriteBatch. Runs are cut
+  // whenever the kind changes, so every command observes the effects of the
+  // commands queued before it and replies keep the per-client order.
+  void Run() override {
+    size_t n = batch_.size();
+    size_t begin = 0;
+    while (begin < n) {
+      Kind kind = batch_[begin].kind;
+      size_t end = begin + 1;
+      if (kind != kOther) {
+        while (end < n && batch_[end].kind == kind) {
+          ++end;
+        }
+      }
+      switch (kind) {
+        case kRead:
+          ExecuteReads(begin, end);
+          break;
+        case kWrite:
+          ExecuteWrites(begin, end);
+          break;
+        case kOther:
+          ExecuteOther(&batch_[begin]);
+          break;
+      }
+      begin = end;
+    }
   }
 
-  void Execute(size_t n, long /* curr_time */, EventLoop<Client>* el) override {
-    for (size_t i = 0; i < n; tasks_.pop_front(), ++i) {
-      Task& task = tasks_.front();
+  void Finish(EventLoop<Client>* el) override {
+    flush_.clear();
+    for (auto& task : batch_) {
       Client* c = task.c;
       int fd = task.fd;
 
@@ -44,61 +105,262 @@ class ExecutorMemImpl final : public Executor {
         }
         continue;
       }
+      // a client with pending output is already waiting for kWritable
+      if (c->output.empty()) {
+        flush_.emplace_back(c, fd);
+      }
+      c->output.append(task.reply);
+    }
+    batch_.clear();
 
-      bool blocked = !c->output.empty();
-      auto& argv = task.argv;
-      if (argv[0] == "GET" && argv.size() == 2) {
-        auto it = map_.find(argv[1]);
-        if (it != map_.cend()) {
-          RespMachine::AppendBulkString(&c->output, it->second);
-        } else {
-          RespMachine::AppendNullArray(&c->output);
-        }
-      } else if (argv[0] == "SET" && argv.size() == 3) {
-        map_.emplace(std::move(argv[1]), std::move(argv[2]));
-        RespMachine::AppendSimpleString(&c->output, "OK");
-      } else if (argv[0] == "DEL" && argv.size() == 2) {
-        map_.erase(argv[1]);
-        RespMachine::AppendSimpleString(&c->output, "OK");
-      } else if (argv[0] == "TERARKDB_OPS_FULL_COMPACT" && argv.size() == 1) {
-        TERARKDB_NAMESPACE::CompactRangeOptions cro{};
-        cro.exclusive_manual_compaction = false;
-        auto s = db_->CompactRange(cro, nullptr, nullptr);
+    for (auto& pair : flush_) {
+      Client* c = pair.first;
+      int fd = pair.second;
+      ssize_t nwrite = write(fd, c->output.data(), c->output.size());
+      if (nwrite > 0) {
+        c->output.assign(c->output.data() + nwrite, c->output.size() - nwrite);
+      }
+      if (!c->output.empty()) {
+        el->AddEvent(fd, kWritable);
+      }
+    }
+  }
+
+  size_t GetTaskCount() const override { return tasks_.size(); }
+
+ private:
+  static Kind Classify(
+      const TERARKDB_NAMESPACE::autovector<std::string>& argv) {
+    const std::string& cmd = argv[0];
+    if ((cmd == "GET" && argv.size() == 2) ||
+        (cmd == "MGET" && argv.size() >= 2)) {
+      return kRead;
+    }
+    if ((cmd == "SET" && argv.size() == 3) ||
+        (cmd == "DEL" && argv.size() >= 2) ||
+        (cmd == "MSET" && argv.size() >= 3 && argv.size() % 2 == 1)) {
+      return kWrite;
+    }
+    return kOther;
+  }
+
+  // default_cf_handle_ is set once DB::Open has recovered the DB, the console
+  // is started earlier than that
+  bool IsReady(Task* task) const {
+    if (db_->DefaultColumnFamily() == nullptr) {
+      RespMachine::AppendError(&task->reply, "DB is not opened yet");
+      return false;
+    }
+    return true;
+  }
+
+  void ExecuteReads(size_t begin, size_t end) {
+    keys_.clear();
+    for (size_t i = begin; i < end; ++i) {
+      Task& task = batch_[i];
+      if (task.skip || !IsReady(&task)) {
+        continue;
+      }
+      for (size_t j = 1; j < task.argv.size(); ++j) {
+        keys_.emplace_back(task.argv[j]);
+      }
+    }
+    if (keys_.empty()) {
+      return;
+    }
+
+    values_.clear();
+    auto statuses =
+        db_->MultiGet(TERARKDB_NAMESPACE::ReadOptions(), keys_, &values_);
+    size_t k = 0;
+    for (size_t i = begin; i < end; ++i) {
+      Task& task = batch_[i];
+      if (task.skip || !task.reply.empty()) {
+        continue;
+      }
+      if (task.argv[0] == "GET") {
+        auto& s = statuses[k];
         if (s.ok()) {
-          RespMachine::AppendSimpleString(&c->output, "OK");
+          RespMachine::AppendBulkString(&task.reply, values_[k]);
+        } else if (s.IsNotFound()) {
+          RespMachine::AppendNullArray(&task.reply);
         } else {
           RespMachine::AppendError(
-              &c->output,
-              "Cannot do full compaction. Error message: " + s.ToString());
+              &task.reply, "Cannot get. Error message: " + s.ToString());
+        }
+        ++k;
+      } else {  // MGET
+        RespMachine::AppendArrayLength(&task.reply, task.argv.size() - 1);
+        for (size_t j = 1; j < task.argv.size(); ++j, ++k) {
+          if (statuses[k].ok()) {
+            RespMachine::AppendBulkString(&task.reply, values_[k]);
+          } else {
+            RespMachine::AppendNullBulkString(&task.reply);
+          }
         }
-      } else if (argv[0] == "PING" && argv.size() == 1) {
-        RespMachine::AppendSimpleString(&c->output, "PONG");
-      } else {
-        RespMachine::AppendError(&c->output, "Unsupported Command");
       }
+    }
+    assert(k == keys_.size());
+  }
 
-      if (!blocked) {
-        ssize_t nwrite = write(fd, c->output.data(), c->output.size());
-        if (nwrite > 0) {
-          c->output.assign(c->output.data() + nwrite,
-                           c->output.size() - nwrite);
+  void ExecuteWrites(size_t begin, size_t end) {
+    TERARKDB_NAMESPACE::WriteBatch batch;
+    size_t count = 0;
+    for (size_t i = begin; i < end; ++i) {
+      Task& task = batch_[i];
+      if (task.skip || !IsReady(&task)) {
+        continue;
+      }
+      auto& argv = task.argv;
+      if (argv[0] == "DEL") {
+        for (size_t j = 1; j < argv.size(); ++j) {
+          batch.Delete(argv[j]);
         }
-        if (!c->output.empty()) {
-          el->AddEvent(fd, kWritable);
+      } else {  // SET, MSET
+        for (size_t j = 1; j < argv.size(); j += 2) {
+          batch.Put(argv[j], argv[j + 1]);
         }
       }
+      ++count;
+    }
+    if (count == 0) {
+      return;
+    }
+
+    auto s = db_->Write(TERARKDB_NAMESPACE::WriteOptions(), &batch);
+    for (size_t i = begin; i < end; ++i) {
+      Task& task = batch_[i];
+      if (task.skip || !task.reply.empty()) {
+        continue;
+      }
+      if (s.ok()) {
+        RespMachine::AppendSimpleString(&task.reply, "OK");
+      } else {
+        RespMachine::AppendError(
+            &task.reply, "Cannot write. Error message: " + s.ToString());
+      }
     }
   }
 
-  size_t GetTaskCount() const override { return tasks_.size(); }
+  // SCAN cursor [COUNT count]
+  // The cursor is "0" to start a scan, otherwise it is the cursor returned by
+  // the previous call: '@' followed by the next key. "0" is returned when the
+  // scan is complete.
+  void ScanKeys(Task* task) {
+    auto& argv = task->argv;
+    size_t count = kDefaultScanCount;
+    if (argv.size() == 4 && (argv[2] == "COUNT" || argv[2] == "count")) {
+      char* end = nullptr;
+      long long ll = strtoll(argv[3].c_str(), &end, 10);
+      if (end == argv[3].c_str() || *end != '\0' || ll <= 0) {
+        RespMachine::AppendError(&task->reply, "Invalid COUNT");
+        return;
+      }
+      count = std::min(static_cast<size_t>(ll), kMaxScanCount);
+    } else if (argv.size() != 2) {
+      RespMachine::AppendError(&task->reply, "Unsupported SCAN arguments");
+      return;
+    }
+    const std::string& cursor = argv[1];
+    if (cursor != "0" && (cursor.empty() || cursor[0] != '@')) {
+      RespMachine::AppendError(&task->reply, "Invalid cursor");
+      return;
+    }
+
+    std::unique_ptr<TERARKDB_NAMESPACE::Iterator> iter(
+        db_->NewIterator(TERARKDB_NAMESPACE::ReadOptions()));
+    if (cursor == "0") {
+      iter->SeekToFirst();
+    } else {
+      iter->Seek(TERARKDB_NAMESPACE::Slice(cursor.data() + 1,
+                                           cursor.size() - 1));
+    }
+    std::vector<std::string> keys;
+    for (; iter->Valid() && keys.size() < count; iter->Next()) {
+      keys.emplace_back(iter->key().ToString());
+    }
+    if (!iter->status().ok()) {
+      RespMachine::AppendError(
+          &task->reply,
+          "Cannot scan. Error message: " + iter->status().ToString());
+      return;
+    }
+
+    RespMachine::AppendArrayLength(&task->reply, 2);
+    if (iter->Valid()) {
+      RespMachine::AppendBulkString(&task->reply, "@" + iter->key().ToString());
+    } else {
+      RespMachine::AppendBulkString(&task->reply, "0");
+    }
+    RespMachine::AppendArrayLength(&task->reply, keys.size());
+    for (auto& key : keys) {
+      RespMachine::AppendBulkString(&task->reply, key);
+    }
+  }
+
+  void ExecuteOther(Task* task) {
+    if (task->skip) {
+      return;
+    }
+    auto& argv = task->argv;
+    if (argv[0] == "SCAN" && argv.size() >= 2) {
+      if (IsReady(task)) {
+        ScanKeys(task);
+      }
+    } else if (argv[0] == "TERARKDB_OPS_FULL_COMPACT" && argv.size() == 1) {
+      TERARKDB_NAMESPACE::CompactRangeOptions cro{};
+      cro.exclusive_manual_compaction = false;
+      auto s = db_->CompactRange(cro, nullptr, nullptr);
+      if (s.ok()) {
+        RespMachine::AppendSimpleString(&task->reply, "OK");
+      } else {
+        RespMachine::AppendError(
+            &task->reply,
+            "Cannot do full compaction. Error message: " + s.ToString());
+      }
+    } else if (argv[0] == "TERARKDB_OPS_HOT_KEYS" && argv.size() == 1) {
+      if (IsReady(task)) {
+        std::string hot_keys;
+        if (db_->GetProperty(
+                TERARKDB_NAMESPACE::DB::Properties::kBlockCacheHotKeys,
+                &hot_keys)) {
+          RespMachine::AppendBulkString(&task->reply, hot_keys);
+        } else {
+          RespMachine::AppendError(&task->reply, "No block cache");
+        }
+      }
+    } else if (argv[0] == "TERARKDB_OPS_OP_TRACES" && argv.size() == 1) {
+      if (IsReady(task)) {
+        std::string op_traces;
+        db_->GetProperty(TERARKDB_NAMESPACE::DB::Properties::kOpTraces,
+                         &op_traces);
+        RespMachine::AppendBulkString(&task->reply, op_traces);
+      }
+    } else if (argv[0] == "TERARKDB_OPS_FILE_IO_STATS" && argv.size() == 1) {
+      if (IsReady(task)) {
+        std::string file_io_stats;
+        db_->GetProperty(TERARKDB_NAMESPACE::DB::Properties::kFileIOStats,
+                         &file_io_stats);
+        RespMachine::AppendBulkString(&task->reply, file_io_stats);
+      }
+    } else if (argv[0] == "PING" && argv.size() == 1) {
+      RespMachine::AppendSimpleString(&task->reply, "PONG");
+    } else {
+      RespMachine::AppendError(&task->reply, "Unsupported Command");
+    }
+  }
 
  private:
   std::deque<Task> tasks_;
-  std::map<std::string, std::string> map_;
+  std::deque<Task> batch_;
+  // reused across Execute() calls
+  std::vector<TERARKDB_NAMESPACE::Slice> keys_;
+  std::vector<std::string> values_;
+  std::vector<std::pair<Client*, int>> flush_;
   TERARKDB_NAMESPACE::DBImpl* db_;
 };
 
 std::unique_ptr<Executor> OpenExecutorMem(TERARKDB_NAMESPACE::DBImpl* db) {
   return std::make_unique<ExecutorMemImpl>(db);
 }
-}  // namespace cheapis
\ No newline at end of file
+}  // namespace cheapis
@@ -1,12 +1,20 @@
 #include "server.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "anet.h"
 #include "db/db_impl.h"
 #include "executor.h"
 #include "rocksdb/env.h"
+#include "rocksdb/threadpool.h"
 #include "util/logging.h"
 
 #if __clang__
@@ -30,6 +38,24 @@ constexpr unsigned int kTimeout = 360;
 constexpr unsigned int kReadLength = 4096;
 constexpr unsigned int kMaxInputBuffer = 10485760;
 constexpr unsigned int kUnixSocketPerm = 700;
+constexpr unsigned int kMaxReactors = 64;
+constexpr unsigned int kMaxExecutorThreads = 256;
+
+// One event loop thread, it owns the clients handed to it and their executor,
+// so the replies of a client keep their order
+struct Reactor {
+  std::unique_ptr<EventLoop<Client>> el;
+  std::unique_ptr<Executor> executor;
+  // fds accepted by the first reactor, waiting to be acquired by this one
+  std::mutex mutex;
+  std::vector<int> pending_fds;
+  // a batch is running on the executor pool
+  bool running = false;
+  std::atomic<bool> finished{false};
+  // signaled when the batch finished, for waiting without polling
+  std::mutex finish_mutex;
+  std::condition_variable finish_cv;
+};
 
 static void ReleaseOrMarkClient(int fd, Client *c, EventLoop<Client> *el) {
   if (c->ref_count == 0) {
@@ -120,10 +146,118 @@ static void WriteToClient(int fd, Client *c, long curr_time,
   }
 }
 
-static void ExecuteTasks(Executor *executor, long curr_time,
-                         EventLoop<Client> *el) {
-  size_t plan = (executor->GetTaskCount() + 1) / 2;
-  executor->Execute(plan, curr_time, el);
+static void ExecuteTasks(Reactor *reactor, ThreadPool *pool, long curr_time) {
+  Executor *executor = reactor->executor.get();
+  EventLoop<Client> *el = reactor->el.get();
+  if (reactor->running) {
+    // at most one batch in flight, the next one may depend on it
+    if (!reactor->finished.load(std::memory_order_acquire)) {
+      return;
+    }
+    executor->Finish(el);
+    reactor->running = false;
+  }
+
+  // Everything parsed in this tick goes in at once, so the executor can
+  // coalesce the commands of all clients into as few DB calls as possible
+  size_t plan = executor->GetTaskCount();
+  if (plan == 0) {
+    return;
+  }
+  if (pool == nullptr) {
+    executor->Execute(plan, curr_time, el);
+    return;
+  }
+  executor->Prepare(plan, curr_time);
+  reactor->running = true;
+  reactor->finished.store(false, std::memory_order_relaxed);
+  pool->SubmitJob([reactor] {
+    reactor->executor->Run();
+    std::lock_guard<std::mutex> lock(reactor->finish_mutex);
+    reactor->finished.store(true, std::memory_order_release);
+    reactor->finish_cv.notify_one();
+  });
+}
+
+static void WaitForTasks(Reactor *reactor) {
+  if (reactor->running) {
+    std::unique_lock<std::mutex> lock(reactor->finish_mutex);
+    reactor->finish_cv.wait(lock, [reactor] {
+      return reactor->finished.load(std::memory_order_acquire);
+    });
+    lock.unlock();
+    reactor->executor->Finish(reactor->el.get());
+    reactor->running = false;
+  }
+}
+
+static bool AcquireClient(int cfd, long curr_time, EventLoop<Client> *el,
+                          Logger *log) {
+  int r = el->Acquire(cfd, std::make_unique<Client>(curr_time));
+  if (r != 0) {
+    close(cfd);
+    ROCKS_LOG_WARN(log, "Failed acquiring the client's fd");
+    return false;
+  }
+  r = el->AddEvent(cfd, kReadable);
+  if (r != 0) {
+    el->Release(cfd);
+    ROCKS_LOG_WARN(log,
+                   "Failed adding the client's readable event. Error message: "
+                   "'%s'",
+                   strerror(errno));
+    return false;
+  }
+  anetNonBlock(nullptr, cfd);
+  anetEnableTcpNoDelay(nullptr, cfd);
+  anetKeepAlive(nullptr, cfd, kTCPKeepAlive);
+  return true;
+}
+
+// Clients are handed to the reactors round robin
+static void AcceptClients(int ac_fd, long curr_time,
+                          std::vector<std::unique_ptr<Reactor>> *reactors,
+                          size_t *next_reactor, Logger *log) {
+  int cport, cfd, max = kMaxAcceptPerCall;
+  char cip[kNetIPLength];
+  char err[ANET_ERR_LEN];
+
+  while (max--) {
+    cfd = anetTcpAccept(err, ac_fd, cip, sizeof(cip), &cport);
+    if (cfd < 0) {
+      if (errno != EAGAIN) {
+        ROCKS_LOG_WARN(log, "Failed accepting. Error message: '%s'", err);
+      }
+      break;
+    }
+
+    size_t i = (*next_reactor)++ % reactors->size();
+    Reactor *reactor = (*reactors)[i].get();
+    if (i == 0) {
+      if (!AcquireClient(cfd, curr_time, reactor->el.get(), log)) {
+        break;
+      }
+    } else {
+      std::lock_guard<std::mutex> lock(reactor->mutex);
+      reactor->pending_fds.push_back(cfd);
+    }
+    ROCKS_LOG_DEBUG(log, "Accepted %s:%d, reactor %zd", cip, cport, i);
+  }
+}
+
+static void AcquirePendingClients(Reactor *reactor, long curr_time,
+                                  Logger *log) {
+  std::vector<int> fds;
+  {
+    std::lock_guard<std::mutex> lock(reactor->mutex);
+    if (reactor->pending_fds.empty()) {
+      return;
+    }
+    fds.swap(reactor->pending_fds);
+  }
+  for (int cfd : fds) {
+    AcquireClient(cfd, curr_time, reactor->el.get(), log);
+  }
 }
 
 static void ServerCron(long *last_cron_time, long curr_time,
@@ -145,59 +279,24 @@ static void ServerCron(long *last_cron_time, long curr_time,
   }
 }
 
-int ServerMain(ServerRunner *runner, TERARKDB_NAMESPACE::DBImpl *db,
-               const std::string &path, Env *env, Logger *log) {
-#ifdef TERARKDB_ENABLE_CONSOLE
-  const int el_fd = EventLoop<Client>::Open();
-  if (el_fd < 0) {
-    ROCKS_LOG_ERROR(log, "Failed creating the event loop. Error message: '%s'",
-                    strerror(errno));
-    return 1;
-  }
-  EventLoop<Client> el(el_fd);
-
-  auto executor = OpenExecutorMem(db);
-  if (executor == nullptr) {
-    ROCKS_LOG_ERROR(log, "Failed creating the executor");
-    return 1;
-  }
-
-  char err[ANET_ERR_LEN];
-  int ac_fd;
-  if (path.empty()) {  // currently, it's just for debug
-    ac_fd = anetTcpServer(err, kPort, const_cast<char *>(kBindAddr), kBacklog);
-    if (ac_fd < 0) {
-      ROCKS_LOG_ERROR(
-          log, "Failed creating the TCP server. Error message: '%s'", err);
-      return 1;
-    }
-  } else {
-    std::string sock_path = path + "/CONSOLE";
-    unlink(sock_path.c_str()); /* don't care if this fails */
-    ac_fd = anetUnixServer(err, (char *)sock_path.c_str(), kUnixSocketPerm,
-                           kBacklog);
-    if (ac_fd < 0) {
-      ROCKS_LOG_ERROR(
-          log, "Failed creating the Unix socket server. Error message: '%s'",
-          err);
-      return 1;
-    }
-  }
-  anetNonBlock(nullptr, ac_fd);
-
-  int r = el.Acquire(ac_fd, std::make_unique<Client>());
-  if (r != 0) {
-    ROCKS_LOG_ERROR(log, "Failed acquiring the acceptor's fd");
-    return 1;
+static size_t GetEnvCount(const char *name, size_t default_value,
+                          size_t max_value) {
+  const char *value = getenv(name);
+  if (value == nullptr) {
+    return default_value;
   }
+  return std::min<size_t>(strtoul(value, nullptr, 10), max_value);
+}
 
-  r = el.AddEvent(ac_fd, kReadable);
-  if (r != 0) {
-    ROCKS_LOG_ERROR(
-        log, "Failed adding the acceptor's readable event. Error message: '%s'",
-        strerror(errno));
-    return 1;
-  }
+// Runs the event loop of reactors[index] until the server is closing,
+// the first reactor also accepts the clients on ac_fd
+static int ReactorMain(ServerRunner *runner, const std::atomic<bool> *stop,
+                       std::vector<std::unique_ptr<Reactor>> *reactors,
+                       size_t index, int ac_fd, ThreadPool *pool, Env *env,
+                       Logger *log) {
+  Reactor *reactor = (*reactors)[index].get();
+  EventLoop<Client> &el = *reactor->el;
+  size_t next_reactor = 0;
 
   int64_t last_cron_time = 0;
   auto status = env->GetCurrentTime(&last_cron_time);
@@ -208,17 +307,18 @@ int ServerMain(ServerRunner *runner, TERARKDB_NAMESPACE::DBImpl *db,
 
   struct timeval tv = {0};
   while (true) {
-    if (runner->closing_) {
-      runner->closed_ = true;
+    if (runner->closing_ || stop->load(std::memory_order_relaxed)) {
+      WaitForTasks(reactor);
       return 0;
     }
 
     tv.tv_sec = 0;
     tv.tv_usec = 1000;
-    r = el.Poll(&tv);
+    int r = el.Poll(&tv);
     if (r < 0) {
       ROCKS_LOG_ERROR(log, "Failed polling. Error message: '%s'",
                       strerror(errno));
+      WaitForTasks(reactor);
       return 1;
     }
 
@@ -229,50 +329,19 @@ int ServerMain(ServerRunner *runner, TERARKDB_NAMESPACE::DBImpl *db,
                       status.ToString().c_str());
     }
 
+    AcquirePendingClients(reactor, curr_time, log);
     const auto &events = el.GetEvents();
     for (int i = 0; i < r; ++i) {
       const auto &event = events[i];
 
       int efd = EventLoop<Client>::GetEventFD(event);
       if (efd == ac_fd) {  // acceptor
-        int cport, cfd, max = kMaxAcceptPerCall;
-        char cip[kNetIPLength];
-
-        while (max--) {
-          cfd = anetTcpAccept(err, ac_fd, cip, sizeof(cip), &cport);
-          if (cfd < 0) {
-            if (errno != EAGAIN) {
-              ROCKS_LOG_WARN(log, "Failed accepting. Error message: '%s'", err);
-            }
-            break;
-          }
-
-          r = el.Acquire(cfd, std::make_unique<Client>(curr_time));
-          if (r != 0) {
-            close(cfd);
-            ROCKS_LOG_WARN(log, "Failed acquiring the client's fd");
-            break;
-          }
-          r = el.AddEvent(cfd, kReadable);
-          if (r != 0) {
-            el.Release(cfd);
-            ROCKS_LOG_WARN(
-                log,
-                "Failed adding the client's readable event. Error message: "
-                "'%s'",
-                strerror(errno));
-            break;
-          }
-          anetNonBlock(nullptr, cfd);
-          anetEnableTcpNoDelay(nullptr, cfd);
-          anetKeepAlive(nullptr, cfd, kTCPKeepAlive);
-          ROCKS_LOG_DEBUG(log, "Accepted %s:%d", cip, cport);
-        }
+        AcceptClients(ac_fd, curr_time, reactors, &next_reactor, log);
       } else {  // processor
         auto &client = el.GetResource(efd);
         if (EventLoop<Client>::IsEventReadable(event)) {
-          ReadFromClient(efd, client.get(), curr_time, executor.get(), &el,
-                         log);
+          ReadFromClient(efd, client.get(), curr_time, reactor->executor.get(),
+                         &el, log);
         }
         if (EventLoop<Client>::IsEventWritable(event) && client != nullptr) {
           WriteToClient(efd, client.get(), curr_time, &el, log);
@@ -280,9 +349,107 @@ int ServerMain(ServerRunner *runner, TERARKDB_NAMESPACE::DBImpl *db,
       }
     }
 
-    ExecuteTasks(executor.get(), curr_time, &el);
+    ExecuteTasks(reactor, pool, curr_time);
     ServerCron(&last_cron_time, curr_time, &el, log);
   }
+}
+
+// TerarkDB_consoleReactors event loop threads serve the clients, 1 by
+// default. With TerarkDB_consoleExecutorThreads > 0 the DB calls run on a
+// separate pool of that many threads and never block the network I/O.
+int ServerMain(ServerRunner *runner, TERARKDB_NAMESPACE::DBImpl *db,
+               const std::string &path, Env *env, Logger *log) {
+#ifdef TERARKDB_ENABLE_CONSOLE
+  size_t num_reactors = std::max<size_t>(
+      GetEnvCount("TerarkDB_consoleReactors", 1, kMaxReactors), 1);
+  size_t num_executor_threads =
+      GetEnvCount("TerarkDB_consoleExecutorThreads", 0, kMaxExecutorThreads);
+
+  std::vector<std::unique_ptr<Reactor>> reactors;
+  for (size_t i = 0; i < num_reactors; ++i) {
+    const int el_fd = EventLoop<Client>::Open();
+    if (el_fd < 0) {
+      ROCKS_LOG_ERROR(log,
+                      "Failed creating the event loop. Error message: '%s'",
+                      strerror(errno));
+      return 1;
+    }
+    reactors.emplace_back(new Reactor);
+    reactors.back()->el.reset(new EventLoop<Client>(el_fd));
+
+    reactors.back()->executor = OpenExecutorMem(db);
+    if (reactors.back()->executor == nullptr) {
+      ROCKS_LOG_ERROR(log, "Failed creating the executor");
+      return 1;
+    }
+  }
+  EventLoop<Client> &el = *reactors.front()->el;
+
+  char err[ANET_ERR_LEN];
+  int ac_fd;
+  if (path.empty()) {  // currently, it's just for debug
+    ac_fd = anetTcpServer(err, kPort, const_cast<char *>(kBindAddr), kBacklog);
+    if (ac_fd < 0) {
+      ROCKS_LOG_ERROR(
+          log, "Failed creating the TCP server. Error message: '%s'", err);
+      return 1;
+    }
+  } else {
+    std::string sock_path = path + "/CONSOLE";
+    unlink(sock_path.c_str()); /* don't care if this fails */
+    ac_fd = anetUnixServer(err, (char *)sock_path.c_str(), kUnixSocketPerm,
+                           kBacklog);
+    if (ac_fd < 0) {
+      ROCKS_LOG_ERROR(
+          log, "Failed creating the Unix socket server. Error message: '%s'",
+          err);
+      return 1;
+    }
+  }
+  anetNonBlock(nullptr, ac_fd);
+
+  int r = el.Acquire(ac_fd, std::make_unique<Client>());
+  if (r != 0) {
+    ROCKS_LOG_ERROR(log, "Failed acquiring the acceptor's fd");
+    return 1;
+  }
+
+  r = el.AddEvent(ac_fd, kReadable);
+  if (r != 0) {
+    ROCKS_LOG_ERROR(
+        log, "Failed adding the acceptor's readable event. Error message: '%s'",
+        strerror(errno));
+    return 1;
+  }
+
+  std::unique_ptr<ThreadPool> pool;
+  if (num_executor_threads > 0) {
+    pool.reset(NewThreadPool(static_cast<int>(num_executor_threads)));
+  }
+  ROCKS_LOG_INFO(log, "Console serving with %zd reactors, %zd executor threads",
+                 num_reactors, num_executor_threads);
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < num_reactors; ++i) {
+    threads.emplace_back(ReactorMain, runner, &stop, &reactors, i, ac_fd,
+                         pool.get(), env, log);
+  }
+  r = ReactorMain(runner, &stop, &reactors, 0, ac_fd, pool.get(), env, log);
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  if (pool != nullptr) {
+    pool->JoinAllThreads();
+  }
+  for (auto &reactor : reactors) {
+    for (int cfd : reactor->pending_fds) {
+      close(cfd);
+    }
+  }
+  runner->closed_ = true;
+  return r;
 #else
   (void)runner;
   (void)db;
@@ -291,6 +458,11 @@ int ServerMain(ServerRunner *runner, TERARKDB_NAMESPACE::DBImpl *db,
   (void)log;
   (void)ServerCron;
   (void)ExecuteTasks;
+  (void)WaitForTasks;
+  (void)AcceptClients;
+  (void)AcquirePendingClients;
+  (void)ReactorMain;
+  (void)GetEnvCount;
   (void)WriteToClient;
   (void)ReadFromClient;
   runner->closed_ = true;
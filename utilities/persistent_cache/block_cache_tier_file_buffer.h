@@ -10,6 +10,7 @@
 
 #include "include/rocksdb/comparator.h"
 #include "rocksdb/terark_namespace.h"
+#include "util/aligned_buffer.h"
 #include "util/arena.h"
 #include "util/mutexlock.h"
 
@@ -19,11 +20,15 @@ namespace TERARKDB_NAMESPACE {
 // CacheWriteBuffer
 //
 // Buffer abstraction that can be manipulated via append
-// (not thread safe)
+// (not thread safe). The memory is page aligned so that it can be written to
+// a file opened for direct IO.
 class CacheWriteBuffer {
  public:
+  static const size_t kAlignment = 4 * 1024;
+
   explicit CacheWriteBuffer(const size_t size) : size_(size), pos_(0) {
-    buf_.reset(new char[size_]);
+    buf_.Alignment(kAlignment);
+    buf_.AllocateNewBuffer(size_);
     assert(!pos_);
     assert(size_);
   }
@@ -32,14 +37,14 @@ class CacheWriteBuffer {
 
   void Append(const char* buf, const size_t size) {
     assert(pos_ + size <= size_);
-    memcpy(buf_.get() + pos_, buf, size);
+    memcpy(Data() + pos_, buf, size);
     pos_ += size;
     assert(pos_ <= size_);
   }
 
   void FillTrailingZeros() {
     assert(pos_ <= size_);
-    memset(buf_.get() + pos_, '0', size_ - pos_);
+    memset(Data() + pos_, '0', size_ - pos_);
     pos_ = size_;
   }
 
@@ -47,10 +52,10 @@ class CacheWriteBuffer {
   size_t Free() const { return size_ - pos_; }
   size_t Capacity() const { return size_; }
   size_t Used() const { return pos_; }
-  char* Data() const { return buf_.get(); }
+  char* Data() const { return const_cast<char*>(buf_.BufferStart()); }
 
  private:
-  std::unique_ptr<char[]> buf_;
+  AlignedBuffer buf_;
   const size_t size_;
   size_t pos_;
 };
@@ -37,6 +37,8 @@ DEFINE_int32(iosize, 4 * 1024, "Read IO size");
 DEFINE_int32(writer_iosize, 4 * 1024, "File writer IO size");
 DEFINE_int32(writer_qdepth, 1, "File writer qdepth");
 DEFINE_bool(enable_pipelined_writes, false, "Enable async writes");
+DEFINE_bool(enable_direct_reads, true, "Read cache files with direct IO");
+DEFINE_bool(enable_direct_writes, false, "Write cache files with direct IO");
 DEFINE_string(cache_type, "block_cache",
               "Cache type. (block_cache, volatile, tiered)");
 DEFINE_bool(benchmark, false, "Benchmark mode");
@@ -62,6 +64,8 @@ std::unique_ptr<PersistentCacheTier> NewBlockCache() {
   opt.writer_dispatch_size = FLAGS_writer_iosize;
   opt.writer_qdepth = FLAGS_writer_qdepth;
   opt.pipeline_writes = FLAGS_enable_pipelined_writes;
+  opt.enable_direct_reads = FLAGS_enable_direct_reads;
+  opt.enable_direct_writes = FLAGS_enable_direct_writes;
   opt.max_write_pipeline_backlog_size = std::numeric_limits<uint64_t>::max();
   std::unique_ptr<PersistentCacheTier> cache(new BlockCacheTier(opt));
   Status status = cache->Open();
@@ -100,6 +104,8 @@ std::unique_ptr<PersistentTieredCache> NewTieredCache() {
   opt.writer_dispatch_size = FLAGS_writer_iosize;
   opt.writer_qdepth = FLAGS_writer_qdepth;
   opt.pipeline_writes = FLAGS_enable_pipelined_writes;
+  opt.enable_direct_reads = FLAGS_enable_direct_reads;
+  opt.enable_direct_writes = FLAGS_enable_direct_writes;
   opt.max_write_pipeline_backlog_size = std::numeric_limits<uint64_t>::max();
   return NewTieredCache(FLAGS_cache_size * pct, opt);
 }
@@ -149,6 +155,10 @@ class CacheTierBenchmark {
     std::ostringstream msg;
     msg << "Test stats" << std::endl
         << "* Elapsed: " << sec << " s" << std::endl
+        << "* Write P99: " << stats_.write_latency_.Percentile(99) << " us"
+        << std::endl
+        << "* Read P99: " << stats_.read_latency_.Percentile(99) << " us"
+        << std::endl
         << "* Write Latency:" << std::endl
         << stats_.write_latency_.ToString() << std::endl
         << "* Read Latency:" << std::endl
@@ -322,6 +332,8 @@ int main(int argc, char** argv) {
       << "* writer_qdepth=" << FLAGS_writer_qdepth << std::endl
       << "* enable_pipelined_writes=" << FLAGS_enable_pipelined_writes
       << std::endl
+      << "* enable_direct_reads=" << FLAGS_enable_direct_reads << std::endl
+      << "* enable_direct_writes=" << FLAGS_enable_direct_writes << std::endl
       << "* cache_type=" << FLAGS_cache_type << std::endl
       << "* benchmark=" << FLAGS_benchmark << std::endl
       << "* volatile_cache_pct=" << FLAGS_volatile_cache_pct << std::endl;
@@ -15,6 +15,7 @@
 #include <thread>
 
 #include "rocksdb/terark_namespace.h"
+#include "table/persistent_cache_helper.h"
 #include "utilities/persistent_cache/block_cache_tier.h"
 
 namespace TERARKDB_NAMESPACE {
@@ -160,6 +161,37 @@ TEST_F(PersistentCacheTierTest, DISABLED_BlockCacheInsertWithFileCreateError) {
   TERARKDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
 }
 
+// records of blob values and TerarkZip tables
+TEST_F(PersistentCacheTierTest, RecordTest) {
+  for (int pipelined = 0; pipelined < 2; ++pipelined) {
+    if (pipelined) {
+      cache_ = NewBlockCache(Env::Default(), path_);
+    } else {
+      cache_ = std::make_shared<VolatileCacheTier>();
+    }
+    std::string value;
+    ASSERT_FALSE(PersistentCacheHelper::LookupRecord(cache_.get(), 1, "key1",
+                                                     &value, nullptr));
+    PersistentCacheHelper::InsertRecord(cache_.get(), 1, "key1", "value1");
+    PersistentCacheHelper::InsertRecord(cache_.get(), 1, "key2", "");
+    PersistentCacheHelper::InsertRecord(cache_.get(), 2, "key1", "value2");
+    Flush();
+    ASSERT_TRUE(PersistentCacheHelper::LookupRecord(cache_.get(), 1, "key1",
+                                                    &value, nullptr));
+    ASSERT_EQ("value1", value);
+    ASSERT_TRUE(PersistentCacheHelper::LookupRecord(cache_.get(), 1, "key2",
+                                                    &value, nullptr));
+    ASSERT_EQ("", value);
+    ASSERT_TRUE(PersistentCacheHelper::LookupRecord(cache_.get(), 2, "key1",
+                                                    &value, nullptr));
+    ASSERT_EQ("value2", value);
+    ASSERT_FALSE(PersistentCacheHelper::LookupRecord(cache_.get(), 3, "key1",
+                                                     &value, nullptr));
+    ASSERT_OK(cache_->Close());
+    cache_.reset();
+  }
+}
+
 #if defined(TRAVIS) || defined(ROCKSDB_VALGRIND_RUN)
 // Travis is unable to handle the normal version of the tests running out of
 // fds, out of space and timeouts. This is an easier version of the test
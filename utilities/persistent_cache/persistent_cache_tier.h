@@ -122,6 +122,11 @@ struct PersistentCacheConfig {
       return Status::InvalidArgument("invalid writer settings");
     }
 
+    // (3) direct writes need the dispatch size aligned to the page size
+    if (enable_direct_writes && writer_dispatch_size % (4 * 1024)) {
+      return Status::InvalidArgument("invalid direct write settings");
+    }
+
     return Status::OK();
   }
 
@@ -146,7 +151,8 @@ struct PersistentCacheConfig {
   bool enable_direct_reads = true;
 
   //
-  // Enable direct IO for writing
+  // Enable direct IO for writing. Write buffers are page aligned and flushed
+  // in writer_dispatch_size chunks, which then must be page aligned too
   //
   bool enable_direct_writes = false;
 
@@ -16,38 +16,6 @@ namespace TERARKDB_NAMESPACE {
 static std::mutex metrics_mtx;
 static std::atomic<bool> metrics_init{false};
 static const char default_namespace[] = "terarkdb.engine.stats";
-
-static int GetThreadID() {
-  static std::mutex mutex;
-  static std::vector<bool> pool;
-  static __thread int id;
-
-  struct ID {
-    ID() {
-      id = 0;
-      std::lock_guard<std::mutex> guard(mutex);
-      for (const auto& empty : pool) {
-        if (empty) {
-          pool[id] = false;
-          return;
-        }
-        ++id;
-      }
-      pool.emplace_back();
-    }
-
-    ~ID() {
-      std::lock_guard<std::mutex> guard(mutex);
-      pool[id] = true;
-    }
-  };
-  static thread_local ID _;
-
-  if (id >= static_cast<int>(8192)) {
-    return -1;
-  }
-  return id;
-}
 #else
 namespace {
 static ByteDanceHistReporterHandle dummy_hist_("", "", nullptr);
@@ -57,82 +25,75 @@ static ByteDanceCountReporterHandle dummy_count_("", "", nullptr);
 
 #ifdef TERARKDB_ENABLE_METRICS
 void ByteDanceHistReporterHandle::AddRecord(size_t val) {
-  auto* tls_stat_ptr = GetThreadLocalStats();
-  if (tls_stat_ptr == nullptr) {
+  stats_.Add(val);
+  uint64_t max = interval_max_.load(std::memory_order_relaxed);
+  while (val > max && !interval_max_.compare_exchange_weak(
+                          max, val, std::memory_order_relaxed)) {
+  }
+
+  auto curr_time = std::chrono::high_resolution_clock::now();
+  if (curr_time.time_since_epoch().count() <
+          next_report_time_.load(std::memory_order_relaxed) ||
+      report_lock_.load(std::memory_order_relaxed) ||
+      report_lock_.exchange(true, std::memory_order_acquire)) {
     return;
   }
+  if (curr_time.time_since_epoch().count() >=
+      next_report_time_.load(std::memory_order_relaxed)) {
+    next_report_time_.store(
+        (curr_time + std::chrono::seconds(5)).time_since_epoch().count(),
+        std::memory_order_relaxed);
+    Report(curr_time);
+  }
+  report_lock_.store(false, std::memory_order_release);
+}
 
-  auto& tls_stat = *tls_stat_ptr;
-  tls_stat.AppendRecord(val);
+void ByteDanceHistReporterHandle::Report(
+    std::chrono::high_resolution_clock::time_point curr_time) {
+  HistogramSnapshot stats;
+  stats_.GetSnapshot(&stats);
+  HistogramSnapshot interval = stats;
+  interval.Subtract(last_stats_);
+  interval.max = interval_max_.exchange(0, std::memory_order_relaxed);
+  last_stats_ = stats;
+  if (interval.count == 0) {
+    return;
+  }
+  size_t result[] = {
+      static_cast<size_t>(interval.Percentile(50)),
+      static_cast<size_t>(interval.Percentile(99)),
+      static_cast<size_t>(interval.Percentile(99.9)),
+      static_cast<size_t>(interval.Average()),
+      static_cast<size_t>(interval.Percentile(100)),
+  };
+
+  cpputil::metrics2::Metrics::emit_store(name_ + "_p50", result[0], tags_);
+  cpputil::metrics2::Metrics::emit_store(name_ + "_p99", result[1], tags_);
+  cpputil::metrics2::Metrics::emit_store(name_ + "_p999", result[2], tags_);
+  cpputil::metrics2::Metrics::emit_store(name_ + "_avg", result[3], tags_);
+  cpputil::metrics2::Metrics::emit_store(name_ + "_max", result[4], tags_);
 
-  auto curr_time = std::chrono::high_resolution_clock::now();
   auto diff_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                     curr_time - tls_stat.last_report_time)
+                     curr_time - last_log_time_)
                      .count();
-
-  if (diff_ms > 1000 && !merge_lock_.load(std::memory_order_relaxed) &&
-      !merge_lock_.exchange(true, std::memory_order_acquire)) {
-    stats_.Merge(tls_stat);
-
-    diff_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                  curr_time - stats_.last_report_time)
-                  .count();
-    if (diff_ms > 5000) {
-      auto result = stats_.GetResult({0.50, 0.99, 0.999});
-      stats_.Reset();
-      stats_.last_report_time = curr_time;
-      merge_lock_.store(false, std::memory_order_release);
-
-      cpputil::metrics2::Metrics::emit_store(name_ + "_p50", result[0], tags_);
-      cpputil::metrics2::Metrics::emit_store(name_ + "_p99", result[1], tags_);
-      cpputil::metrics2::Metrics::emit_store(name_ + "_p999", result[2], tags_);
-      cpputil::metrics2::Metrics::emit_store(name_ + "_avg", result[3], tags_);
-      cpputil::metrics2::Metrics::emit_store(name_ + "_max", result[4], tags_);
-
-      diff_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    curr_time - last_log_time_)
-                    .count();
-      if (diff_ms > 10 * 60 * 1000) {
-        ROCKS_LOG_INFO(log_, "name:%s P50, tags:%s, val:%zu", name_.c_str(),
-                       tags_.c_str(), result[0]);
-        ROCKS_LOG_INFO(log_, "name:%s P99, tags:%s, val:%zu", name_.c_str(),
-                       tags_.c_str(), result[1]);
-        ROCKS_LOG_INFO(log_, "name:%s P999, tags:%s, val:%zu", name_.c_str(),
-                       tags_.c_str(), result[2]);
-        ROCKS_LOG_INFO(log_, "name:%s Avg, tags:%s, val:%zu", name_.c_str(),
-                       tags_.c_str(), result[3]);
-        ROCKS_LOG_INFO(log_, "name:%s Max, tags:%s, val:%zu", name_.c_str(),
-                       tags_.c_str(), result[4]);
-        last_log_time_ = curr_time;
-      }
-    } else {
-      merge_lock_.store(false, std::memory_order_release);
-    }
-
-    tls_stat.Reset();
-    tls_stat.last_report_time = curr_time;
+  if (diff_ms > 10 * 60 * 1000) {
+    ROCKS_LOG_INFO(log_, "name:%s P50, tags:%s, val:%zu", name_.c_str(),
+                   tags_.c_str(), result[0]);
+    ROCKS_LOG_INFO(log_, "name:%s P99, tags:%s, val:%zu", name_.c_str(),
+                   tags_.c_str(), result[1]);
+    ROCKS_LOG_INFO(log_, "name:%s P999, tags:%s, val:%zu", name_.c_str(),
+                   tags_.c_str(), result[2]);
+    ROCKS_LOG_INFO(log_, "name:%s Avg, tags:%s, val:%zu", name_.c_str(),
+                   tags_.c_str(), result[3]);
+    ROCKS_LOG_INFO(log_, "name:%s Max, tags:%s, val:%zu", name_.c_str(),
+                   tags_.c_str(), result[4]);
+    last_log_time_ = curr_time;
   }
 }
 #else
 void ByteDanceHistReporterHandle::AddRecord(size_t) {}
 #endif
 
-HistStats<>* ByteDanceHistReporterHandle::GetThreadLocalStats() {
-#ifdef TERARKDB_ENABLE_METRICS
-  auto id = GetThreadID();
-  if (id == -1) {
-    return nullptr;
-  }
-  auto& s = stats_arr_[id];
-  if (s == nullptr) {
-    s = new HistStats<>;
-  }
-  return s;
-#else
-  return nullptr;
-#endif
-}
-
 #ifdef TERARKDB_ENABLE_METRICS
 void ByteDanceCountReporterHandle::AddCount(size_t n) {
   count_.fetch_add(n, std::memory_order_relaxed);
@@ -2,10 +2,10 @@
 #include <chrono>
 #include <list>
 
+#include "monitoring/thread_local_histogram.h"
 #include "rocksdb/env.h"
 #include "rocksdb/metrics_reporter.h"
 #include "rocksdb/terark_namespace.h"
-#include "stats.h"
 
 namespace TERARKDB_NAMESPACE {
 class ByteDanceHistReporterHandle : public HistReporterHandle {
@@ -16,42 +16,41 @@ class ByteDanceHistReporterHandle : public HistReporterHandle {
       : name_(name),
         tags_(tags),
         last_log_time_(std::chrono::high_resolution_clock::now()),
-        log_(log) {}
+        log_(log),
+        next_report_time_((last_log_time_ + std::chrono::seconds(5))
+                              .time_since_epoch()
+                              .count()) {}
 #else
   ByteDanceHistReporterHandle(const std::string& /*name*/,
                               const std::string& /*tags*/, Logger* /*log*/) {}
 #endif
 
-  ~ByteDanceHistReporterHandle() override {
-#ifdef TERARKDB_ENABLE_METRICS
-    for (auto* s : stats_arr_) {
-      delete s;
-    }
-#endif
-  }
+  ~ByteDanceHistReporterHandle() override = default;
 
  public:
   void AddRecord(size_t val) override;
 
  private:
 #ifdef TERARKDB_ENABLE_METRICS
-  enum {
-      kMaxThreadNum = 8192,
-  };
-
   const std::string& name_;
   const std::string& tags_;
 
   std::chrono::high_resolution_clock::time_point last_log_time_;
   Logger* log_;
 
-  std::array<HistStats<>*, kMaxThreadNum> stats_arr_{};
+  // Records go to per thread shards, the thread that first sees the report
+  // interval elapse sums them up and reports the difference to last_stats_.
+  std::atomic<int64_t> next_report_time_;
+  std::atomic<bool> report_lock_{false};
+  HistogramSnapshot last_stats_;
+  // The snapshot difference keeps the all-time max, so the max of the
+  // current interval is tracked separately
+  std::atomic<uint64_t> interval_max_{0};
 
-  std::atomic<bool> merge_lock_{false};
-  HistStats<> stats_;
-#endif
+  ThreadLocalHistogram stats_;
 
-  HistStats<>* GetThreadLocalStats();
+  void Report(std::chrono::high_resolution_clock::time_point curr_time);
+#endif
 };
 
 class ByteDanceCountReporterHandle : public CountReporterHandle {
@@ -49,7 +49,8 @@ PessimisticTransaction::PessimisticTransaction(
       lock_timeout_(0),
       deadlock_detect_(false),
       deadlock_detect_depth_(0),
-      skip_concurrency_control_(false) {
+      skip_concurrency_control_(false),
+      lock_escalation_threshold_(0) {
   txn_db_impl_ =
       static_cast_with_check<PessimisticTransactionDB, TransactionDB>(txn_db);
   db_impl_ = static_cast_with_check<DBImpl, DB>(db_);
@@ -65,6 +66,7 @@ void PessimisticTransaction::Initialize(const TransactionOptions& txn_options) {
   deadlock_detect_depth_ = txn_options.deadlock_detect_depth;
   write_batch_.SetMaxBytes(txn_options.max_write_batch_size);
   skip_concurrency_control_ = txn_options.skip_concurrency_control;
+  lock_escalation_threshold_ = txn_options.lock_escalation_threshold;
 
   lock_timeout_ = txn_options.lock_timeout * 1000;
   if (lock_timeout_ < 0) {
@@ -92,6 +94,7 @@ void PessimisticTransaction::Initialize(const TransactionOptions& txn_options) {
 
 PessimisticTransaction::~PessimisticTransaction() {
   txn_db_impl_->UnLock(this, &GetTrackedKeys());
+  UnLockRanges();
   if (expiration_time_ > 0) {
     txn_db_impl_->RemoveExpirableTransaction(txn_id_);
   }
@@ -102,9 +105,26 @@ PessimisticTransaction::~PessimisticTransaction() {
 
 void PessimisticTransaction::Clear() {
   txn_db_impl_->UnLock(this, &GetTrackedKeys());
+  UnLockRanges();
   TransactionBaseImpl::Clear();
 }
 
+void PessimisticTransaction::TrackRangeLock(uint32_t cfh_id) {
+  if (std::find(range_locked_cfs_.begin(), range_locked_cfs_.end(), cfh_id) ==
+      range_locked_cfs_.end()) {
+    range_locked_cfs_.push_back(cfh_id);
+  }
+}
+
+// Range locks must be released after the point locks they cover.
+void PessimisticTransaction::UnLockRanges() {
+  for (auto cfh_id : range_locked_cfs_) {
+    txn_db_impl_->UnLockRanges(this, cfh_id);
+  }
+  range_locked_cfs_.clear();
+  num_locked_since_escalation_.clear();
+}
+
 void PessimisticTransaction::Reinitialize(
     TransactionDB* txn_db, const WriteOptions& write_options,
     const TransactionOptions& txn_options) {
@@ -606,11 +626,72 @@ Status PessimisticTransaction::TryLock(ColumnFamilyHandle* column_family,
     // tracked key. It could also update the tracked_at_seq if it is lower than
     // the existing trackey seq.
     TrackKey(cfh_id, key_str, tracked_at_seq, read_only, exclusive);
+
+    if (lock_escalation_threshold_ > 0 && !previously_locked &&
+        ++num_locked_since_escalation_[cfh_id] >= lock_escalation_threshold_) {
+      EscalateLocks(column_family, cfh_id);
+    }
   }
 
   return s;
 }
 
+Status PessimisticTransaction::GetRangeLock(ColumnFamilyHandle* column_family,
+                                            const Slice& begin_key,
+                                            const Slice& end_key,
+                                            bool exclusive) {
+  if (UNLIKELY(skip_concurrency_control_)) {
+    return Status::OK();
+  }
+  uint32_t cfh_id = GetColumnFamilyID(column_family);
+  Status s = txn_db_impl_->TryRangeLock(this, cfh_id, begin_key.ToString(),
+                                        end_key.ToString(), exclusive,
+                                        lock_timeout_);
+  if (s.ok()) {
+    TrackRangeLock(cfh_id);
+  }
+  return s;
+}
+
+void PessimisticTransaction::EscalateLocks(ColumnFamilyHandle* column_family,
+                                           uint32_t cfh_id) {
+  num_locked_since_escalation_[cfh_id] = 0;
+
+  const auto& tracked_keys = GetTrackedKeys();
+  const auto tracked_keys_cf = tracked_keys.find(cfh_id);
+  assert(tracked_keys_cf != tracked_keys.end());
+  ColumnFamilyHandle* cfh =
+      column_family ? column_family : db_impl_->DefaultColumnFamily();
+  const Comparator* ucmp = cfh->GetComparator();
+
+  const std::string* smallest = nullptr;
+  const std::string* largest = nullptr;
+  bool exclusive = false;
+  for (const auto& key_iter : tracked_keys_cf->second) {
+    const std::string& key = key_iter.first;
+    if (smallest == nullptr || ucmp->Compare(key, *smallest) < 0) {
+      smallest = &key;
+    }
+    if (largest == nullptr || ucmp->Compare(key, *largest) > 0) {
+      largest = &key;
+    }
+    exclusive |= key_iter.second.exclusive;
+  }
+  assert(smallest != nullptr);
+
+  // Keep the point locks if any other transaction is in the way
+  Status s = txn_db_impl_->TryRangeLock(this, cfh_id, *smallest, *largest,
+                                        exclusive, 0 /* timeout */);
+  if (s.ok()) {
+    TrackRangeLock(cfh_id);
+    // Keys stay tracked for conflict checking, unlocking them again later is
+    // a no-op.
+    TransactionKeyMap keys_to_unlock;
+    keys_to_unlock.emplace(cfh_id, tracked_keys_cf->second);
+    txn_db_impl_->UnLock(this, &keys_to_unlock);
+  }
+}
+
 // Return OK() if this key has not been modified more recently than the
 // transaction snapshot_.
 // tracked_at_seq is the global seq at which we either locked the key or already
@@ -59,6 +59,10 @@ class PessimisticTransaction : public TransactionBaseImpl {
 
   Status RollbackToSavePoint() override;
 
+  Status GetRangeLock(ColumnFamilyHandle* column_family,
+                      const Slice& begin_key, const Slice& end_key,
+                      bool exclusive = true) override;
+
   Status SetName(const TransactionName& name) override;
 
   // Generate a new unique transaction identifier
@@ -187,6 +191,22 @@ class PessimisticTransaction : public TransactionBaseImpl {
   // Refer to TransactionOptions::skip_concurrency_control
   bool skip_concurrency_control_;
 
+  // Refer to TransactionOptions::lock_escalation_threshold
+  size_t lock_escalation_threshold_;
+
+  // Keys locked per column family since the last lock escalation.
+  std::unordered_map<uint32_t, size_t> num_locked_since_escalation_;
+
+  // Column families this transaction holds range locks in.
+  autovector<uint32_t> range_locked_cfs_;
+
+  void TrackRangeLock(uint32_t cfh_id);
+  void UnLockRanges();
+
+  // Replace the point locks of this column family with a range lock, if it
+  // can be acquired without waiting.
+  void EscalateLocks(ColumnFamilyHandle* column_family, uint32_t cfh_id);
+
   virtual Status ValidateSnapshot(ColumnFamilyHandle* column_family,
                                   const Slice& key,
                                   SequenceNumber* tracked_at_seq);
@@ -42,7 +42,8 @@ PessimisticTransactionDB::PessimisticTransactionDB(
                 txn_db_options_.custom_mutex_factory
                     ? txn_db_options_.custom_mutex_factory
                     : std::shared_ptr<TransactionDBMutexFactory>(
-                          new TransactionDBMutexFactoryImpl())) {
+                          new TransactionDBMutexFactoryImpl()),
+                txn_db_options_.deadlock_detect_interval) {
   assert(db_impl_ != nullptr);
   info_log_ = db_impl_->GetDBOptions().info_log;
 }
@@ -73,7 +74,8 @@ PessimisticTransactionDB::PessimisticTransactionDB(
                 txn_db_options_.custom_mutex_factory
                     ? txn_db_options_.custom_mutex_factory
                     : std::shared_ptr<TransactionDBMutexFactory>(
-                          new TransactionDBMutexFactoryImpl())) {
+                          new TransactionDBMutexFactoryImpl()),
+                txn_db_options_.deadlock_detect_interval) {
   assert(db_impl_ != nullptr);
 }
 
@@ -345,7 +347,7 @@ Status TransactionDB::WrapStackableDB(
 // allocate a LockMap for it.
 void PessimisticTransactionDB::AddColumnFamily(
     const ColumnFamilyHandle* handle) {
-  lock_mgr_.AddColumnFamily(handle->GetID());
+  lock_mgr_.AddColumnFamily(handle->GetID(), handle->GetComparator());
 }
 
 Status PessimisticTransactionDB::CreateColumnFamily(
@@ -359,7 +361,8 @@ Status PessimisticTransactionDB::CreateColumnFamily(
 
   s = db_->CreateColumnFamily(options, column_family_name, handle);
   if (s.ok()) {
-    lock_mgr_.AddColumnFamily((*handle)->GetID());
+    lock_mgr_.AddColumnFamily((*handle)->GetID(),
+                              (*handle)->GetComparator());
     UpdateCFComparatorMap(*handle);
   }
 
@@ -397,6 +400,20 @@ void PessimisticTransactionDB::UnLock(PessimisticTransaction* txn,
   lock_mgr_.UnLock(txn, cfh_id, key, GetEnv());
 }
 
+Status PessimisticTransactionDB::TryRangeLock(PessimisticTransaction* txn,
+                                              uint32_t cfh_id,
+                                              const std::string& begin_key,
+                                              const std::string& end_key,
+                                              bool exclusive, int64_t timeout) {
+  return lock_mgr_.TryRangeLock(txn, cfh_id, begin_key, end_key, GetEnv(),
+                                exclusive, timeout);
+}
+
+void PessimisticTransactionDB::UnLockRanges(PessimisticTransaction* txn,
+                                            uint32_t cfh_id) {
+  lock_mgr_.UnLockRanges(txn, cfh_id);
+}
+
 // Used when wrapping DB write operations in a transaction
 Transaction* PessimisticTransactionDB::BeginInternalTransaction(
     const WriteOptions& options) {
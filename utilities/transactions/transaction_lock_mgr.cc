@@ -16,11 +16,13 @@
 #include <algorithm>
 #include <condition_variable>
 #include <functional>
+#include <map>
 #include <mutex>
 #include <string>
 #include <vector>
 
 #include "monitoring/perf_context_imp.h"
+#include "rocksdb/comparator.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/terark_namespace.h"
 #include "rocksdb/utilities/transaction_db_mutex.h"
@@ -68,11 +70,62 @@ struct LockMapStripe {
   std::unordered_map<std::string, LockInfo> keys;
 };
 
+// A range lock held by a single transaction, keyed by its begin key
+struct RangeLockInfo {
+  // Inclusive
+  std::string end_key;
+  LockInfo lock_info;
+
+  RangeLockInfo(const std::string& end, const LockInfo& info)
+      : end_key(end), lock_info(info) {}
+};
+
+struct RangeLockTable {
+  struct UserKeyLess {
+    const Comparator* ucmp;
+    bool operator()(const std::string& a, const std::string& b) const {
+      return ucmp->Compare(a, b) < 0;
+    }
+  };
+
+  RangeLockTable(std::shared_ptr<TransactionDBMutexFactory> factory,
+                 const Comparator* _ucmp)
+      : ucmp(_ucmp), ranges(UserKeyLess{_ucmp}) {
+    mutex = factory->AllocateMutex();
+    cv = factory->AllocateCondVar();
+    assert(mutex);
+    assert(cv);
+  }
+
+  const Comparator* ucmp;
+
+  // Mutex must be held before modifying ranges
+  std::shared_ptr<TransactionDBMutex> mutex;
+
+  // Condition Variable for range lock requests waiting on a lock
+  std::shared_ptr<TransactionDBCondVar> cv;
+
+  // Held range locks ordered by begin key.  Only a few ranges are expected to
+  // be held at a time, overlap checks walk the ranges beginning before the
+  // end of the checked range.  Overlapping ranges of one transaction in the
+  // same mode are merged.
+  std::multimap<std::string, RangeLockInfo, UserKeyLess> ranges;
+
+  // Number of range lock requests waiting on cv, or about to
+  std::atomic<size_t> waiters{0};
+
+  // Bumped on every notification of cv, a range lock request compares it to
+  // tell whether a lock was released while it held no mutex.
+  // Protected by mutex.
+  uint64_t notify_seq = 0;
+};
+
 // Map of #num_stripes LockMapStripes
 struct LockMap {
   explicit LockMap(size_t num_stripes,
-                   std::shared_ptr<TransactionDBMutexFactory> factory)
-      : num_stripes_(num_stripes) {
+                   std::shared_ptr<TransactionDBMutexFactory> factory,
+                   const Comparator* ucmp)
+      : num_stripes_(num_stripes), range_table(factory, ucmp) {
     lock_map_stripes_.reserve(num_stripes);
     for (size_t i = 0; i < num_stripes; i++) {
       LockMapStripe* stripe = new LockMapStripe(factory);
@@ -95,6 +148,14 @@ struct LockMap {
 
   std::vector<LockMapStripe*> lock_map_stripes_;
 
+  // Number of entries in range_table.ranges, point lock requests skip
+  // range_table while it is 0.  A new range is counted before the point
+  // locks inside it are checked, so a point lock request taken after that
+  // check sees the range.
+  std::atomic<size_t> range_lock_cnt{0};
+
+  RangeLockTable range_table;
+
   size_t GetStripe(const std::string& key) const;
 };
 
@@ -168,16 +229,25 @@ void UnrefLockMapsCache(void* ptr) {
 TransactionLockMgr::TransactionLockMgr(
     TransactionDB* txn_db, size_t default_num_stripes, int64_t max_num_locks,
     uint32_t max_num_deadlocks,
-    std::shared_ptr<TransactionDBMutexFactory> mutex_factory)
+    std::shared_ptr<TransactionDBMutexFactory> mutex_factory,
+    uint64_t deadlock_detect_interval_ms)
     : txn_db_impl_(nullptr),
       default_num_stripes_(default_num_stripes),
       max_num_locks_(max_num_locks),
       lock_maps_cache_(new ThreadLocalPtr(&UnrefLockMapsCache)),
       dlock_buffer_(max_num_deadlocks),
+      background_deadlock_detect_(deadlock_detect_interval_ms > 0),
       mutex_factory_(mutex_factory) {
   assert(txn_db);
   txn_db_impl_ =
       static_cast_with_check<PessimisticTransactionDB, TransactionDB>(txn_db);
+  if (background_deadlock_detect_) {
+    Env* env = txn_db->GetEnv();
+    uint64_t interval_us = deadlock_detect_interval_ms * 1000;
+    deadlock_detector_.reset(
+        new RepeatableThread([this, env] { DetectDeadlocks(env); },
+                             "txn_deadlock", env, interval_us, interval_us));
+  }
 }
 
 TransactionLockMgr::~TransactionLockMgr() {}
@@ -189,13 +259,14 @@ size_t LockMap::GetStripe(const std::string& key) const {
   return stripe;
 }
 
-void TransactionLockMgr::AddColumnFamily(uint32_t column_family_id) {
+void TransactionLockMgr::AddColumnFamily(uint32_t column_family_id,
+                                         const Comparator* ucmp) {
   InstrumentedMutexLock l(&lock_map_mutex_);
 
   if (lock_maps_.find(column_family_id) == lock_maps_.end()) {
     lock_maps_.emplace(column_family_id,
-                       std::shared_ptr<LockMap>(
-                           new LockMap(default_num_stripes_, mutex_factory_)));
+                       std::shared_ptr<LockMap>(new LockMap(
+                           default_num_stripes_, mutex_factory_, ucmp)));
   } else {
     // column_family already exists in lock map
     assert(false);
@@ -312,15 +383,16 @@ Status TransactionLockMgr::TryLock(PessimisticTransaction* txn,
   LockInfo lock_info(txn->GetID(), txn->GetExpirationTime(), exclusive);
   int64_t timeout = txn->GetLockTimeout();
 
-  return AcquireWithTimeout(txn, lock_map, stripe, column_family_id, key, env,
-                            timeout, lock_info);
+  return AcquireWithTimeout(txn, lock_map_ptr, stripe, column_family_id, key,
+                            env, timeout, lock_info);
 }
 
 // Helper function for TryLock().
 Status TransactionLockMgr::AcquireWithTimeout(
-    PessimisticTransaction* txn, LockMap* lock_map, LockMapStripe* stripe,
-    uint32_t column_family_id, const std::string& key, Env* env,
-    int64_t timeout, const LockInfo& lock_info) {
+    PessimisticTransaction* txn, const std::shared_ptr<LockMap>& lock_map_ptr,
+    LockMapStripe* stripe, uint32_t column_family_id, const std::string& key,
+    Env* env, int64_t timeout, const LockInfo& lock_info) {
+  LockMap* lock_map = lock_map_ptr.get();
   Status result;
   uint64_t end_time = 0;
 
@@ -371,7 +443,10 @@ Status TransactionLockMgr::AcquireWithTimeout(
       // We are dependent on a transaction to finish, so perform deadlock
       // detection.
       if (wait_ids.size() != 0) {
-        if (txn->IsDeadlockDetect()) {
+        if (txn->IsDeadlockDetect() && background_deadlock_detect_) {
+          AddWaiter(txn, wait_ids, key, column_family_id, lock_info.exclusive,
+                    lock_map_ptr, stripe);
+        } else if (txn->IsDeadlockDetect()) {
           if (IncrementWaiters(txn, wait_ids, key, column_family_id,
                                lock_info.exclusive, env)) {
             result = Status::Busy(Status::SubCode::kDeadlock);
@@ -396,7 +471,13 @@ Status TransactionLockMgr::AcquireWithTimeout(
 
       if (wait_ids.size() != 0) {
         txn->ClearWaitingTxn();
-        if (txn->IsDeadlockDetect()) {
+        if (txn->IsDeadlockDetect() && background_deadlock_detect_) {
+          if (RemoveWaiter(txn, wait_ids)) {
+            result = Status::Busy(Status::SubCode::kDeadlock);
+            stripe->stripe_mutex->UnLock();
+            return result;
+          }
+        } else if (txn->IsDeadlockDetect()) {
           DecrementWaiters(txn, wait_ids);
         }
       }
@@ -447,14 +528,11 @@ bool TransactionLockMgr::IncrementWaiters(
     const autovector<TransactionID>& wait_ids, const std::string& key,
     const uint32_t& cf_id, const bool& exclusive, Env* const env) {
   auto id = txn->GetID();
-  std::vector<int> queue_parents(
-      static_cast<size_t>(txn->GetDeadlockDetectDepth()));
-  std::vector<TransactionID> queue_values(
-      static_cast<size_t>(txn->GetDeadlockDetectDepth()));
   std::lock_guard<std::mutex> lock(wait_txn_map_mutex_);
   assert(!wait_txn_map_.Contains(id));
 
-  wait_txn_map_.Insert(id, {wait_ids, cf_id, key, exclusive});
+  wait_txn_map_.Insert(
+      id, {wait_ids, cf_id, key, exclusive, nullptr, nullptr, 0, false});
 
   for (auto wait_id : wait_ids) {
     if (rev_wait_txn_map_.Contains(wait_id)) {
@@ -469,14 +547,29 @@ bool TransactionLockMgr::IncrementWaiters(
     return false;
   }
 
+  if (FindDeadlockPath(id, wait_ids, txn->GetDeadlockDetectDepth(), env)) {
+    DecrementWaitersImpl(txn, wait_ids);
+    return true;
+  }
+  return false;
+}
+
+// Walks the wait-for graph from id, records the path into dlock_buffer_ and
+// returns true if it leads back to id or is deeper than detect_depth.
+// Transactions already picked as deadlock victims are treated as not waiting.
+bool TransactionLockMgr::FindDeadlockPath(
+    TransactionID id, const autovector<TransactionID>& wait_ids,
+    int64_t detect_depth, Env* env) {
+  std::vector<int> queue_parents(static_cast<size_t>(detect_depth));
+  std::vector<TransactionID> queue_values(static_cast<size_t>(detect_depth));
+
   const auto* next_ids = &wait_ids;
   int parent = -1;
   int64_t deadlock_time = 0;
-  for (int tail = 0, head = 0; head < txn->GetDeadlockDetectDepth(); head++) {
+  for (int tail = 0, head = 0; head < detect_depth; head++) {
     int i = 0;
     if (next_ids) {
-      for (; i < static_cast<int>(next_ids->size()) &&
-             tail + i < txn->GetDeadlockDetectDepth();
+      for (; i < static_cast<int>(next_ids->size()) && tail + i < detect_depth;
            i++) {
         queue_values[tail + i] = (*next_ids)[i];
         queue_parents[tail + i] = parent;
@@ -495,7 +588,7 @@ bool TransactionLockMgr::IncrementWaiters(
       while (head != -1) {
         assert(wait_txn_map_.Contains(queue_values[head]));
 
-        auto extracted_info = wait_txn_map_.Get(queue_values[head]);
+        auto& extracted_info = wait_txn_map_.Get(queue_values[head]);
         path.push_back({queue_values[head], extracted_info.m_cf_id,
                         extracted_info.m_exclusive,
                         extracted_info.m_waiting_key});
@@ -504,10 +597,9 @@ bool TransactionLockMgr::IncrementWaiters(
       env->GetCurrentTime(&deadlock_time);
       std::reverse(path.begin(), path.end());
       dlock_buffer_.AddNewPath(DeadlockPath(path, deadlock_time));
-      deadlock_time = 0;
-      DecrementWaitersImpl(txn, wait_ids);
       return true;
-    } else if (!wait_txn_map_.Contains(next)) {
+    } else if (!wait_txn_map_.Contains(next) ||
+               wait_txn_map_.Get(next).m_deadlocked) {
       next_ids = nullptr;
       continue;
     } else {
@@ -519,10 +611,66 @@ bool TransactionLockMgr::IncrementWaiters(
   // Wait cycle too big, just assume deadlock.
   env->GetCurrentTime(&deadlock_time);
   dlock_buffer_.AddNewPath(DeadlockPath(deadlock_time, true));
-  DecrementWaitersImpl(txn, wait_ids);
   return true;
 }
 
+void TransactionLockMgr::AddWaiter(const PessimisticTransaction* txn,
+                                   const autovector<TransactionID>& wait_ids,
+                                   const std::string& key, uint32_t cf_id,
+                                   bool exclusive,
+                                   const std::shared_ptr<LockMap>& lock_map,
+                                   LockMapStripe* stripe) {
+  std::lock_guard<std::mutex> lock(wait_txn_map_mutex_);
+  auto id = txn->GetID();
+  assert(!wait_txn_map_.Contains(id));
+
+  wait_txn_map_.Insert(id, {wait_ids, cf_id, key, exclusive, lock_map, stripe,
+                            txn->GetDeadlockDetectDepth(), false});
+
+  for (auto wait_id : wait_ids) {
+    if (rev_wait_txn_map_.Contains(wait_id)) {
+      rev_wait_txn_map_.Get(wait_id)++;
+    } else {
+      rev_wait_txn_map_.Insert(wait_id, 1);
+    }
+  }
+}
+
+bool TransactionLockMgr::RemoveWaiter(
+    const PessimisticTransaction* txn,
+    const autovector<TransactionID>& wait_ids) {
+  std::lock_guard<std::mutex> lock(wait_txn_map_mutex_);
+  bool deadlocked = wait_txn_map_.Get(txn->GetID()).m_deadlocked;
+  DecrementWaitersImpl(txn, wait_ids);
+  return deadlocked;
+}
+
+void TransactionLockMgr::DetectDeadlocks(Env* env) {
+  std::vector<std::pair<std::shared_ptr<LockMap>, LockMapStripe*>> victims;
+  {
+    std::lock_guard<std::mutex> lock(wait_txn_map_mutex_);
+    wait_txn_map_.ForEach([&](TransactionID id, TrackedTrxInfo& info) {
+      // No deadlock if nobody is waiting on self.
+      if (info.m_deadlocked || !rev_wait_txn_map_.Contains(id)) {
+        return;
+      }
+      if (FindDeadlockPath(id, info.m_neighbors, info.m_detect_depth, env)) {
+        // Breaks every cycle through id, later walks treat id as not waiting
+        info.m_deadlocked = true;
+        victims.emplace_back(info.m_lock_map, info.m_stripe);
+      }
+    });
+  }
+  // Waiters check m_deadlocked with their stripe mutex held, take it before
+  // notifying so the wakeup can't slip in between the check and the wait.
+  for (auto& victim : victims) {
+    LockMapStripe* stripe = victim.second;
+    stripe->stripe_mutex->Lock();
+    stripe->stripe_cv->NotifyAll();
+    stripe->stripe_mutex->UnLock();
+  }
+}
+
 // Try to lock this key after we have acquired the mutex.
 // Sets *expire_time to the expiration time in microseconds
 //  or 0 if no expiration.
@@ -536,6 +684,19 @@ Status TransactionLockMgr::AcquireLocked(LockMap* lock_map,
   assert(txn_lock_info.txn_ids.size() == 1);
 
   Status result;
+  // Check range locks covering this key
+  if (lock_map->range_lock_cnt.load(std::memory_order_relaxed) > 0) {
+    bool covered = false;
+    RangeLockTable& range_table = lock_map->range_table;
+    range_table.mutex->Lock();
+    result = CheckRangeLocks(lock_map, key, key, env, txn_lock_info,
+                             expire_time, txn_ids, &covered);
+    range_table.mutex->UnLock();
+    if (!result.ok() || covered) {
+      return result;
+    }
+  }
+
   // Check if this key is already locked
   auto stripe_iter = stripe->keys.find(key);
   if (stripe_iter != stripe->keys.end()) {
@@ -627,9 +788,11 @@ void TransactionLockMgr::UnLockKey(const PessimisticTransaction* txn,
     }
   } else {
     // This key is either not locked or locked by someone else.  This should
-    // only happen if the unlocking transaction has expired.
-    assert(txn->GetExpirationTime() > 0 &&
-           txn->GetExpirationTime() < env->NowMicros());
+    // only happen if the unlocking transaction has expired, or the key is
+    // covered by a range lock.
+    assert((txn->GetExpirationTime() > 0 &&
+            txn->GetExpirationTime() < env->NowMicros()) ||
+           lock_map->range_lock_cnt.load(std::memory_order_relaxed) > 0);
   }
 }
 
@@ -654,6 +817,7 @@ void TransactionLockMgr::UnLock(PessimisticTransaction* txn,
 
   // Signal waiting threads to retry locking
   stripe->stripe_cv->NotifyAll();
+  NotifyRangeWaiters(lock_map);
 }
 
 void TransactionLockMgr::UnLock(const PessimisticTransaction* txn,
@@ -700,6 +864,360 @@ void TransactionLockMgr::UnLock(const PessimisticTransaction* txn,
       // Signal waiting threads to retry locking
       stripe->stripe_cv->NotifyAll();
     }
+    NotifyRangeWaiters(lock_map);
+  }
+}
+
+// Checks the range locks overlapping [begin_key, end_key] held by other
+// transactions.  Sets *covered if a range lock of this transaction already
+// contains [begin_key, end_key] in a strong enough mode.
+// REQUIRED:  Range lock table mutex must be held.
+Status TransactionLockMgr::CheckRangeLocks(
+    LockMap* lock_map, const std::string& begin_key,
+    const std::string& end_key, Env* env, const LockInfo& txn_lock_info,
+    uint64_t* expire_time, autovector<TransactionID>* txn_ids, bool* covered) {
+  RangeLockTable& range_table = lock_map->range_table;
+  const Comparator* ucmp = range_table.ucmp;
+  TransactionID txn_id = txn_lock_info.txn_ids[0];
+
+  Status result;
+  auto iter = range_table.ranges.begin();
+  while (iter != range_table.ranges.end() &&
+         ucmp->Compare(iter->first, end_key) <= 0) {
+    LockInfo& lock_info = iter->second.lock_info;
+    if (ucmp->Compare(iter->second.end_key, begin_key) < 0) {
+      // No overlap
+    } else if (lock_info.txn_ids[0] == txn_id) {
+      if ((lock_info.exclusive || !txn_lock_info.exclusive) &&
+          ucmp->Compare(iter->first, begin_key) <= 0 &&
+          ucmp->Compare(iter->second.end_key, end_key) >= 0) {
+        *covered = true;
+      }
+    } else if (lock_info.exclusive || txn_lock_info.exclusive) {
+      if (IsLockExpired(txn_id, lock_info, env, expire_time)) {
+        // lock is expired, can steal it
+        iter = range_table.ranges.erase(iter);
+        lock_map->range_lock_cnt--;
+        continue;
+      }
+      if (result.ok()) {
+        result = Status::TimedOut(Status::SubCode::kLockTimeout);
+        txn_ids->clear();
+      }
+      txn_ids->push_back(lock_info.txn_ids[0]);
+    }
+    ++iter;
+  }
+  return result;
+}
+
+// Try to insert [begin_key, end_key] into the range lock table.  Once it is
+// inserted, point lock requests inside the range see it, the point locks
+// taken before still have to be checked with CheckRangePointLocks().
+// REQUIRED:  Range lock table mutex must be held.
+Status TransactionLockMgr::AcquireRangeLocked(
+    LockMap* lock_map, const std::string& begin_key,
+    const std::string& end_key, Env* env, const LockInfo& txn_lock_info,
+    uint64_t* expire_time, autovector<TransactionID>* txn_ids, bool* covered) {
+  Status result =
+      CheckRangeLocks(lock_map, begin_key, end_key, env, txn_lock_info,
+                      expire_time, txn_ids, covered);
+  if (!result.ok() || *covered) {
+    return result;
+  }
+  lock_map->range_table.ranges.emplace(begin_key,
+                                       RangeLockInfo(end_key, txn_lock_info));
+  lock_map->range_lock_cnt++;
+  return result;
+}
+
+// Check the point locks of other transactions inside [begin_key, end_key].
+// Point lock tables are hashed, so every stripe is scanned, but only one
+// stripe mutex is held at a time.
+// REQUIRED:  No stripe mutex or range lock table mutex may be held.
+Status TransactionLockMgr::CheckRangePointLocks(
+    LockMap* lock_map, const std::string& begin_key,
+    const std::string& end_key, Env* env, const LockInfo& txn_lock_info,
+    uint64_t* expire_time, autovector<TransactionID>* txn_ids) {
+  const Comparator* ucmp = lock_map->range_table.ucmp;
+  TransactionID txn_id = txn_lock_info.txn_ids[0];
+  Status result;
+  for (auto stripe : lock_map->lock_map_stripes_) {
+    stripe->stripe_mutex->Lock();
+    auto iter = stripe->keys.begin();
+    while (iter != stripe->keys.end()) {
+      LockInfo& lock_info = iter->second;
+      if (ucmp->Compare(iter->first, begin_key) < 0 ||
+          ucmp->Compare(iter->first, end_key) > 0 ||
+          (!lock_info.exclusive && !txn_lock_info.exclusive) ||
+          (lock_info.txn_ids.size() == 1 && lock_info.txn_ids[0] == txn_id)) {
+        ++iter;
+        continue;
+      }
+      if (IsLockExpired(txn_id, lock_info, env, expire_time)) {
+        // lock is expired, can steal it.  If this transaction shared it, the
+        // range covers the key from now on.
+        iter = stripe->keys.erase(iter);
+        if (max_num_locks_ > 0) {
+          lock_map->lock_cnt--;
+        }
+        continue;
+      }
+      if (result.ok()) {
+        result = Status::TimedOut(Status::SubCode::kLockTimeout);
+        txn_ids->clear();
+      }
+      for (auto id : lock_info.txn_ids) {
+        if (id != txn_id) {
+          txn_ids->push_back(id);
+        }
+      }
+      ++iter;
+    }
+    stripe->stripe_mutex->UnLock();
+  }
+  return result;
+}
+
+// Replace the range inserted by AcquireRangeLocked() and the overlapping
+// ranges txn already held in the same mode by their union, and drop its
+// shared ranges inside an exclusive one, so repeated escalations keep one
+// range per transaction.
+// REQUIRED:  Range lock table mutex must be held.
+void TransactionLockMgr::MergeRangeLocked(LockMap* lock_map,
+                                          const std::string& begin_key,
+                                          const std::string& end_key,
+                                          const LockInfo& txn_lock_info) {
+  RangeLockTable& range_table = lock_map->range_table;
+  const Comparator* ucmp = range_table.ucmp;
+  TransactionID txn_id = txn_lock_info.txn_ids[0];
+  const std::string* merged_begin = &begin_key;
+  const std::string* merged_end = &end_key;
+  autovector<decltype(range_table.ranges.begin())> merged;
+  for (auto iter = range_table.ranges.begin();
+       iter != range_table.ranges.end() &&
+       ucmp->Compare(iter->first, end_key) <= 0;
+       ++iter) {
+    const LockInfo& lock_info = iter->second.lock_info;
+    if (lock_info.txn_ids[0] != txn_id ||
+        ucmp->Compare(iter->second.end_key, begin_key) < 0) {
+      continue;
+    }
+    if (lock_info.exclusive == txn_lock_info.exclusive) {
+      if (ucmp->Compare(iter->first, *merged_begin) < 0) {
+        merged_begin = &iter->first;
+      }
+      if (ucmp->Compare(iter->second.end_key, *merged_end) > 0) {
+        merged_end = &iter->second.end_key;
+      }
+      merged.push_back(iter);
+    } else if (txn_lock_info.exclusive &&
+               ucmp->Compare(iter->first, begin_key) >= 0 &&
+               ucmp->Compare(iter->second.end_key, end_key) <= 0) {
+      merged.push_back(iter);
+    }
+  }
+  if (merged.size() <= 1) {
+    // Only the range just inserted, or it was stolen as expired
+    return;
+  }
+  // Insert before erasing, range_lock_cnt must not drop to 0 meanwhile
+  range_table.ranges.emplace(*merged_begin,
+                             RangeLockInfo(*merged_end, txn_lock_info));
+  lock_map->range_lock_cnt++;
+  for (auto iter : merged) {
+    range_table.ranges.erase(iter);
+  }
+  lock_map->range_lock_cnt -= merged.size();
+  TEST_SYNC_POINT_CALLBACK("TransactionLockMgr::MergeRangeLocked:Merged",
+                           &merged);
+}
+
+// Remove the range inserted by AcquireRangeLocked() after its point lock
+// check failed.
+// REQUIRED:  Range lock table mutex must be held.
+void TransactionLockMgr::EraseRangeLocked(LockMap* lock_map,
+                                          const std::string& begin_key,
+                                          const std::string& end_key,
+                                          const LockInfo& txn_lock_info) {
+  RangeLockTable& range_table = lock_map->range_table;
+  auto range = range_table.ranges.equal_range(begin_key);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    const LockInfo& lock_info = iter->second.lock_info;
+    if (lock_info.txn_ids[0] == txn_lock_info.txn_ids[0] &&
+        lock_info.exclusive == txn_lock_info.exclusive &&
+        range_table.ucmp->Compare(iter->second.end_key, end_key) == 0) {
+      range_table.ranges.erase(iter);
+      lock_map->range_lock_cnt--;
+      return;
+    }
+  }
+}
+
+Status TransactionLockMgr::TryRangeLock(PessimisticTransaction* txn,
+                                        uint32_t column_family_id,
+                                        const std::string& begin_key,
+                                        const std::string& end_key, Env* env,
+                                        bool exclusive, int64_t timeout) {
+  // Lookup lock map for this column family id
+  std::shared_ptr<LockMap> lock_map_ptr = GetLockMap(column_family_id);
+  LockMap* lock_map = lock_map_ptr.get();
+  if (lock_map == nullptr) {
+    char msg[255];
+    snprintf(msg, sizeof(msg), "Column family id not found: %" PRIu32,
+             column_family_id);
+
+    return Status::InvalidArgument(msg);
+  }
+  RangeLockTable& range_table = lock_map->range_table;
+  if (range_table.ucmp->Compare(begin_key, end_key) > 0) {
+    return Status::InvalidArgument("Range lock begin key is after end key");
+  }
+
+  LockInfo lock_info(txn->GetID(), txn->GetExpirationTime(), exclusive);
+  uint64_t end_time = 0;
+  if (timeout > 0) {
+    end_time = env->NowMicros() + timeout;
+  }
+
+  Status result;
+  bool timed_out = false;
+  while (true) {
+    uint64_t expire_time_hint = 0;
+    autovector<TransactionID> wait_ids;
+    bool covered = false;
+    range_table.mutex->Lock();
+    result = AcquireRangeLocked(lock_map, begin_key, end_key, env, lock_info,
+                                &expire_time_hint, &wait_ids, &covered);
+    bool inserted = result.ok() && !covered;
+    // Count as a waiter before looking at the point locks, so a point lock
+    // released after its stripe was checked bumps notify_seq
+    range_table.waiters++;
+    uint64_t notify_seq = range_table.notify_seq;
+    range_table.mutex->UnLock();
+
+    if (inserted) {
+      // Point lock requests taken from now on see the range. The ones taken
+      // before are found here: a request holds its stripe mutex from its
+      // range check until its point lock is in place.
+      result = CheckRangePointLocks(lock_map, begin_key, end_key, env,
+                                    lock_info, &expire_time_hint, &wait_ids);
+    }
+    range_table.mutex->Lock();
+    bool released = notify_seq != range_table.notify_seq;
+    if (inserted) {
+      if (result.ok()) {
+        MergeRangeLocked(lock_map, begin_key, end_key, lock_info);
+      } else {
+        EraseRangeLocked(lock_map, begin_key, end_key, lock_info);
+        // Range requests may have waited on the range meanwhile
+        notify_seq = ++range_table.notify_seq;
+        range_table.cv->NotifyAll();
+        // Point requests too, their stripe mutexes go before ours
+        range_table.mutex->UnLock();
+        NotifyPointWaiters(lock_map);
+        range_table.mutex->Lock();
+        released |= notify_seq != range_table.notify_seq;
+      }
+    }
+    if (!result.ok() && timeout != 0 && !timed_out) {
+      PERF_TIMER_GUARD(key_lock_wait_time);
+      PERF_COUNTER_ADD(key_lock_wait_count, 1);
+      // Decide how long to wait
+      int64_t cv_end_time = -1;
+      if (expire_time_hint > 0 &&
+          (timeout < 0 || (timeout > 0 && expire_time_hint < end_time))) {
+        cv_end_time = expire_time_hint;
+      } else if (timeout >= 0) {
+        cv_end_time = end_time;
+      }
+
+      // Retry right away if a lock was released since we looked
+      Status wait_result;
+      if (!released) {
+        if (cv_end_time < 0) {
+          wait_result = range_table.cv->Wait(range_table.mutex);
+        } else {
+          uint64_t now = env->NowMicros();
+          if (static_cast<uint64_t>(cv_end_time) > now) {
+            wait_result = range_table.cv->WaitFor(range_table.mutex,
+                                                  cv_end_time - now);
+          } else {
+            wait_result = Status::TimedOut();
+          }
+        }
+      }
+      range_table.waiters--;
+      range_table.mutex->UnLock();
+
+      if (wait_result.IsTimedOut()) {
+        timed_out = true;
+        // Even though we timed out, we will still make one more attempt to
+        // acquire lock below (it is possible the lock expired and we
+        // were never signaled).
+      } else if (!wait_result.ok()) {
+        return wait_result;
+      }
+      continue;
+    }
+    range_table.waiters--;
+    range_table.mutex->UnLock();
+    return result;
+  }
+}
+
+void TransactionLockMgr::UnLockRanges(const PessimisticTransaction* txn,
+                                      uint32_t column_family_id) {
+  std::shared_ptr<LockMap> lock_map_ptr = GetLockMap(column_family_id);
+  LockMap* lock_map = lock_map_ptr.get();
+  if (lock_map == nullptr) {
+    // Column Family must have been dropped.
+    return;
+  }
+
+  RangeLockTable& range_table = lock_map->range_table;
+  TransactionID txn_id = txn->GetID();
+  size_t erased = 0;
+  range_table.mutex->Lock();
+  for (auto iter = range_table.ranges.begin();
+       iter != range_table.ranges.end();) {
+    if (iter->second.lock_info.txn_ids[0] == txn_id) {
+      iter = range_table.ranges.erase(iter);
+      ++erased;
+    } else {
+      ++iter;
+    }
+  }
+  lock_map->range_lock_cnt -= erased;
+  if (erased > 0) {
+    // Signal waiting threads to retry locking
+    range_table.notify_seq++;
+    range_table.cv->NotifyAll();
+  }
+  range_table.mutex->UnLock();
+
+  if (erased > 0) {
+    NotifyPointWaiters(lock_map);
+  }
+}
+
+void TransactionLockMgr::NotifyRangeWaiters(LockMap* lock_map) {
+  RangeLockTable& range_table = lock_map->range_table;
+  if (range_table.waiters.load(std::memory_order_relaxed) > 0) {
+    range_table.mutex->Lock();
+    range_table.notify_seq++;
+    range_table.cv->NotifyAll();
+    range_table.mutex->UnLock();
+  }
+}
+
+void TransactionLockMgr::NotifyPointWaiters(LockMap* lock_map) {
+  // Point lock waiters check range locks with their stripe mutex held, take
+  // it before notifying.
+  for (auto stripe : lock_map->lock_map_stripes_) {
+    stripe->stripe_mutex->Lock();
+    stripe->stripe_cv->NotifyAll();
+    stripe->stripe_mutex->UnLock();
   }
 }
 
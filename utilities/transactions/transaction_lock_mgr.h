@@ -17,12 +17,14 @@
 #include "rocksdb/utilities/transaction.h"
 #include "util/autovector.h"
 #include "util/hash_map.h"
+#include "util/repeatable_thread.h"
 #include "util/thread_local.h"
 #include "utilities/transactions/pessimistic_transaction.h"
 
 namespace TERARKDB_NAMESPACE {
 
 class ColumnFamilyHandle;
+class Comparator;
 struct LockInfo;
 struct LockMap;
 struct LockMapStripe;
@@ -47,6 +49,12 @@ struct TrackedTrxInfo {
   uint32_t m_cf_id;
   std::string m_waiting_key;
   bool m_exclusive;
+  // Only set when deadlocks are detected in background
+  std::shared_ptr<LockMap> m_lock_map;
+  LockMapStripe* m_stripe;
+  int64_t m_detect_depth;
+  // Chosen as the victim of a deadlock, the waiter will give up
+  bool m_deadlocked;
 };
 
 class Slice;
@@ -56,13 +64,15 @@ class TransactionLockMgr {
  public:
   TransactionLockMgr(TransactionDB* txn_db, size_t default_num_stripes,
                      int64_t max_num_locks, uint32_t max_num_deadlocks,
-                     std::shared_ptr<TransactionDBMutexFactory> factory);
+                     std::shared_ptr<TransactionDBMutexFactory> factory,
+                     uint64_t deadlock_detect_interval_ms = 0);
 
   ~TransactionLockMgr();
 
   // Creates a new LockMap for this column family.  Caller should guarantee
-  // that this column family does not already exist.
-  void AddColumnFamily(uint32_t column_family_id);
+  // that this column family does not already exist.  Range locks of this
+  // column family are ordered by ucmp.
+  void AddColumnFamily(uint32_t column_family_id, const Comparator* ucmp);
 
   // Deletes the LockMap for this column family.  Caller should guarantee that
   // this column family is no longer in use.
@@ -80,6 +90,20 @@ class TransactionLockMgr {
   void UnLock(PessimisticTransaction* txn, uint32_t column_family_id,
               const std::string& key, Env* env);
 
+  // Attempt to lock all keys in [begin_key, end_key].  If OK status is
+  // returned, the caller is responsible for calling UnLockRanges() for this
+  // column family.  Point locks of txn inside the range may be released
+  // afterwards, later point lock requests of txn covered by the range are
+  // granted without adding an entry to the lock table.
+  // timeout is in microseconds, negative to wait indefinitely.
+  Status TryRangeLock(PessimisticTransaction* txn, uint32_t column_family_id,
+                      const std::string& begin_key, const std::string& end_key,
+                      Env* env, bool exclusive, int64_t timeout);
+
+  // Release all range locks txn holds in this column family.
+  void UnLockRanges(const PessimisticTransaction* txn,
+                    uint32_t column_family_id);
+
   using LockStatusData = std::unordered_multimap<uint32_t, KeyLockInfo>;
   LockStatusData GetLockStatusData();
   std::vector<DeadlockPath> GetDeadlockInfoBuffer();
@@ -98,6 +122,7 @@ class TransactionLockMgr {
   // ourselves.
   //   - lock_map_mutex_
   //   - stripe mutexes in ascending cf id, ascending stripe order
+  //   - range lock table mutex
   //   - wait_txn_map_mutex_
   //
   // Must be held when accessing/modifying lock_maps_.
@@ -120,6 +145,9 @@ class TransactionLockMgr {
   HashMap<TransactionID, TrackedTrxInfo> wait_txn_map_;
   DeadlockInfoBuffer dlock_buffer_;
 
+  // Whether waiters leave deadlock detection to deadlock_detector_
+  const bool background_deadlock_detect_;
+
   // Used to allocate mutexes/condvars to use when locking keys
   std::shared_ptr<TransactionDBMutexFactory> mutex_factory_;
 
@@ -128,7 +156,8 @@ class TransactionLockMgr {
 
   std::shared_ptr<LockMap> GetLockMap(uint32_t column_family_id);
 
-  Status AcquireWithTimeout(PessimisticTransaction* txn, LockMap* lock_map,
+  Status AcquireWithTimeout(PessimisticTransaction* txn,
+                            const std::shared_ptr<LockMap>& lock_map_ptr,
                             LockMapStripe* stripe, uint32_t column_family_id,
                             const std::string& key, Env* env, int64_t timeout,
                             const LockInfo& lock_info);
@@ -141,6 +170,42 @@ class TransactionLockMgr {
   void UnLockKey(const PessimisticTransaction* txn, const std::string& key,
                  LockMapStripe* stripe, LockMap* lock_map, Env* env);
 
+  // REQUIRED: range lock table mutex must be held
+  Status CheckRangeLocks(LockMap* lock_map, const std::string& begin_key,
+                         const std::string& end_key, Env* env,
+                         const LockInfo& txn_lock_info, uint64_t* expire_time,
+                         autovector<TransactionID>* txn_ids, bool* covered);
+
+  // REQUIRED: range lock table mutex must be held
+  Status AcquireRangeLocked(LockMap* lock_map, const std::string& begin_key,
+                            const std::string& end_key, Env* env,
+                            const LockInfo& txn_lock_info,
+                            uint64_t* expire_time,
+                            autovector<TransactionID>* txn_ids, bool* covered);
+
+  // REQUIRED: no stripe mutex or range lock table mutex may be held
+  Status CheckRangePointLocks(LockMap* lock_map, const std::string& begin_key,
+                              const std::string& end_key, Env* env,
+                              const LockInfo& txn_lock_info,
+                              uint64_t* expire_time,
+                              autovector<TransactionID>* txn_ids);
+
+  // REQUIRED: range lock table mutex must be held
+  void MergeRangeLocked(LockMap* lock_map, const std::string& begin_key,
+                        const std::string& end_key,
+                        const LockInfo& txn_lock_info);
+
+  // REQUIRED: range lock table mutex must be held
+  void EraseRangeLocked(LockMap* lock_map, const std::string& begin_key,
+                        const std::string& end_key,
+                        const LockInfo& txn_lock_info);
+
+  // Wake up range lock requests waiting on point locks of lock_map
+  void NotifyRangeWaiters(LockMap* lock_map);
+
+  // Wake up point lock requests waiting on range locks of lock_map
+  void NotifyPointWaiters(LockMap* lock_map);
+
   bool IncrementWaiters(const PessimisticTransaction* txn,
                         const autovector<TransactionID>& wait_ids,
                         const std::string& key, const uint32_t& cf_id,
@@ -149,6 +214,26 @@ class TransactionLockMgr {
                         const autovector<TransactionID>& wait_ids);
   void DecrementWaitersImpl(const PessimisticTransaction* txn,
                             const autovector<TransactionID>& wait_ids);
+  // REQUIRED: wait_txn_map_mutex_ must be held
+  bool FindDeadlockPath(TransactionID id,
+                        const autovector<TransactionID>& wait_ids,
+                        int64_t detect_depth, Env* env);
+
+  // Background deadlock detection, AddWaiter() publishes the edges of txn and
+  // RemoveWaiter() withdraws them, returning true if txn was picked as the
+  // victim of a deadlock meanwhile.
+  void AddWaiter(const PessimisticTransaction* txn,
+                 const autovector<TransactionID>& wait_ids,
+                 const std::string& key, uint32_t cf_id, bool exclusive,
+                 const std::shared_ptr<LockMap>& lock_map,
+                 LockMapStripe* stripe);
+  bool RemoveWaiter(const PessimisticTransaction* txn,
+                    const autovector<TransactionID>& wait_ids);
+  void DetectDeadlocks(Env* env);
+
+  // Runs DetectDeadlocks() periodically, declared last so it is stopped
+  // before the state it walks is destroyed
+  std::unique_ptr<RepeatableThread> deadlock_detector_;
 
   // No copying allowed
   TransactionLockMgr(const TransactionLockMgr&);
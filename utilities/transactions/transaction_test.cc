@@ -715,6 +715,210 @@ TEST_P(TransactionStressTest, DeadlockCycle) {
   }
 }
 
+TEST_P(TransactionTest, RangeLock) {
+  WriteOptions write_options;
+  ReadOptions read_options;
+  TransactionOptions txn_options;
+  std::string value;
+  Status s;
+
+  Transaction* txn1 = db->BeginTransaction(write_options, txn_options);
+  Transaction* txn2 = db->BeginTransaction(write_options, txn_options);
+  ASSERT_TRUE(txn1);
+  ASSERT_TRUE(txn2);
+
+  ASSERT_TRUE(txn1->GetRangeLock(db->DefaultColumnFamily(), "d", "b")
+                  .IsInvalidArgument());
+  ASSERT_OK(txn1->GetRangeLock(db->DefaultColumnFamily(), "b", "d"));
+
+  // Keys inside the range can't be locked, even if they don't exist yet
+  s = txn2->GetForUpdate(read_options, "c", &value);
+  ASSERT_TRUE(s.IsTimedOut());
+  s = txn2->Put("d", "txn2");
+  ASSERT_TRUE(s.IsTimedOut());
+  ASSERT_OK(txn2->Put("a", "txn2"));
+  ASSERT_OK(txn2->Put("e", "txn2"));
+
+  // Overlapping ranges and point locks of others block range locks
+  s = txn2->GetRangeLock(db->DefaultColumnFamily(), "d", "f", false);
+  ASSERT_TRUE(s.IsTimedOut());
+  s = txn1->GetRangeLock(db->DefaultColumnFamily(), "a", "a");
+  ASSERT_TRUE(s.IsTimedOut());
+
+  // The range covers the keys of its owner
+  ASSERT_OK(txn1->Put("c", "txn1"));
+  auto lock_data = db->GetLockStatusData();
+  ASSERT_EQ(lock_data.size(), 2);
+
+  ASSERT_OK(txn1->Commit());
+  ASSERT_OK(txn2->Put("c", "txn2"));
+  ASSERT_OK(txn2->Commit());
+
+  ASSERT_OK(db->Get(read_options, "c", &value));
+  ASSERT_EQ(value, "txn2");
+
+  // Shared ranges only block exclusive requests
+  txn1 = db->BeginTransaction(write_options, txn_options, txn1);
+  txn2 = db->BeginTransaction(write_options, txn_options, txn2);
+  ASSERT_OK(txn1->GetRangeLock(db->DefaultColumnFamily(), "b", "d", false));
+  ASSERT_OK(txn2->GetRangeLock(db->DefaultColumnFamily(), "c", "e", false));
+  ASSERT_OK(txn2->GetForUpdate(read_options, "b", &value, false));
+  s = txn2->GetForUpdate(read_options, "c", &value);
+  ASSERT_TRUE(s.IsTimedOut());
+  ASSERT_OK(txn1->Rollback());
+  ASSERT_OK(txn2->GetForUpdate(read_options, "c", &value));
+  ASSERT_OK(txn2->Rollback());
+
+  delete txn1;
+  delete txn2;
+}
+
+TEST_P(TransactionTest, LockEscalation) {
+  WriteOptions write_options;
+  ReadOptions read_options;
+  TransactionOptions txn_options;
+  std::string value;
+  Status s;
+
+  txn_options.lock_escalation_threshold = 4;
+  Transaction* txn1 = db->BeginTransaction(write_options, txn_options);
+  Transaction* txn2 = db->BeginTransaction(write_options, TransactionOptions());
+  ASSERT_TRUE(txn1);
+  ASSERT_TRUE(txn2);
+
+  ASSERT_OK(txn1->Put("k1", "txn1"));
+  ASSERT_OK(txn1->Put("k2", "txn1"));
+  ASSERT_OK(txn1->Put("k4", "txn1"));
+  ASSERT_EQ(db->GetLockStatusData().size(), 3);
+
+  // Escalated to [k1, k5], point locks are released
+  ASSERT_OK(txn1->Put("k5", "txn1"));
+  ASSERT_EQ(db->GetLockStatusData().size(), 0);
+
+  s = txn2->GetForUpdate(read_options, "k3", &value);
+  ASSERT_TRUE(s.IsTimedOut());
+  ASSERT_OK(txn2->Put("k6", "txn2"));
+
+  // Keys inside the range stay covered, keys outside take point locks until
+  // the next escalation, which is blocked by txn2 here
+  ASSERT_OK(txn1->Put("k3", "txn1"));
+  ASSERT_OK(txn1->Put("k0", "txn1"));
+  ASSERT_OK(txn1->Put("k7", "txn1"));
+  ASSERT_OK(txn1->Put("k8", "txn1"));
+  ASSERT_EQ(db->GetLockStatusData().size(), 4);
+  ASSERT_OK(txn2->Commit());
+
+  ASSERT_OK(txn1->Commit());
+  ASSERT_EQ(db->GetLockStatusData().size(), 0);
+  ASSERT_OK(db->Get(read_options, "k3", &value));
+  ASSERT_EQ(value, "txn1");
+
+  delete txn1;
+  delete txn2;
+}
+
+TEST_P(TransactionTest, LockEscalationMergesRanges) {
+  WriteOptions write_options;
+  ReadOptions read_options;
+  TransactionOptions txn_options;
+  std::string value;
+  Status s;
+
+  std::atomic<int> merges{0};
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "TransactionLockMgr::MergeRangeLocked:Merged",
+      [&](void* /*arg*/) { merges++; });
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  txn_options.lock_escalation_threshold = 2;
+  Transaction* txn1 = db->BeginTransaction(write_options, txn_options);
+  Transaction* txn2 = db->BeginTransaction(write_options, TransactionOptions());
+  ASSERT_TRUE(txn1);
+  ASSERT_TRUE(txn2);
+
+  // Every escalation replaces the previous range by a larger one
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_OK(txn1->Put("k" + ToString(i), "txn1"));
+  }
+  ASSERT_EQ(db->GetLockStatusData().size(), 0);
+  ASSERT_EQ(merges.load(), 4);
+  for (int i = 0; i < 10; ++i) {
+    s = txn2->GetForUpdate(read_options, "k" + ToString(i), &value);
+    ASSERT_TRUE(s.IsTimedOut());
+  }
+  ASSERT_OK(txn2->Put("l", "txn2"));
+
+  // A shared range inside an exclusive one is dropped, an overlapping shared
+  // range is merged
+  ASSERT_OK(txn2->GetRangeLock(db->DefaultColumnFamily(), "m", "o", false));
+  ASSERT_OK(txn2->GetRangeLock(db->DefaultColumnFamily(), "n", "p", false));
+  ASSERT_EQ(merges.load(), 5);
+  ASSERT_OK(txn2->GetRangeLock(db->DefaultColumnFamily(), "m", "q"));
+  ASSERT_EQ(merges.load(), 6);
+  s = txn1->GetForUpdate(read_options, "p", &value, false);
+  ASSERT_TRUE(s.IsTimedOut());
+
+  ASSERT_OK(txn1->Commit());
+  ASSERT_OK(txn2->Commit());
+  ASSERT_OK(db->Get(read_options, "k5", &value));
+  ASSERT_EQ(value, "txn1");
+  ASSERT_OK(db->Get(read_options, "l", &value));
+  ASSERT_EQ(value, "txn2");
+
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  TERARKDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+  delete txn1;
+  delete txn2;
+}
+
+TEST_P(TransactionTest, BackgroundDeadlockDetect) {
+  WriteOptions write_options;
+  ReadOptions read_options;
+  TransactionOptions txn_options;
+
+  txn_db_options.deadlock_detect_interval = 1;
+  ASSERT_OK(ReOpen());
+
+  txn_options.lock_timeout = 1000000;
+  txn_options.deadlock_detect = true;
+
+  // T1 -> T2 -> T1, one of them has to be picked by the detector
+  Transaction* txns[2];
+  for (int i = 0; i < 2; i++) {
+    txns[i] = db->BeginTransaction(write_options, txn_options);
+    ASSERT_TRUE(txns[i]);
+    ASSERT_OK(txns[i]->GetForUpdate(read_options, ToString(i), nullptr));
+  }
+
+  std::atomic<int> deadlocks(0);
+  std::atomic<int> granted(0);
+  std::vector<port::Thread> threads;
+  for (int i = 0; i < 2; i++) {
+    threads.emplace_back([&, i] {
+      auto s = txns[i]->GetForUpdate(read_options, ToString(1 - i), nullptr);
+      if (s.IsDeadlock()) {
+        deadlocks++;
+      } else if (s.ok()) {
+        granted++;
+      }
+      txns[i]->Rollback();
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(deadlocks.load(), 1);
+  ASSERT_EQ(granted.load(), 1);
+
+  auto dlock_buffer = db->GetDeadlockInfoBuffer();
+  ASSERT_EQ(dlock_buffer.size(), 1);
+  ASSERT_FALSE(dlock_buffer[0].limit_exceeded);
+  ASSERT_EQ(dlock_buffer[0].path.size(), 2);
+
+  delete txns[0];
+  delete txns[1];
+}
+
 TEST_P(TransactionStressTest, DeadlockStress) {
   const uint32_t NUM_TXN_THREADS = 10;
   const uint32_t NUM_KEYS = 100;
@@ -404,7 +404,7 @@ struct WriteBatchWithIndex::Rep {
         last_entry_offset(0),
         last_sub_batch_offset(0),
         sub_batch_cnt(1) {
-    factory_context = index_factory->NewContext(&arena);
+    factory_context = index_factory->NewContext(&context_arena);
   }
   ~Rep() {
     for (auto& pair : entry_indices) {
@@ -425,6 +425,9 @@ struct WriteBatchWithIndex::Rep {
   };
   std::vector<ComparatorIndexPair> entry_indices;
   Arena arena;
+  // Holds factory_context, which is kept across Clear() so factories can
+  // carry state from one batch to the next
+  Arena context_arena;
   const WriteBatchEntryIndexFactory* index_factory;
   WriteBatchEntryIndexContext* factory_context;
   bool overwrite_key;
@@ -565,12 +568,8 @@ void WriteBatchWithIndex::Rep::ClearIndex() {
       pair.index = nullptr;
     }
   }
-  if (factory_context != nullptr) {
-    factory_context->~WriteBatchEntryIndexContext();
-  }
   arena.~Arena();
   new (&arena) Arena();
-  factory_context = index_factory->NewContext(&arena);
   free_entry = nullptr;
   last_entry_offset = 0;
   last_sub_batch_offset = 0;
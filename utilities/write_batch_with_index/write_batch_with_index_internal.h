@@ -131,6 +131,8 @@ class WriteBatchEntryIndexFactory {
  public:
   // object MUST allocated from arena, allow return nullptr
   // context will not delete, only by calling destructor
+  // context lives as long as the WriteBatchWithIndex, indexes created with it
+  // are destroyed and created again on each Clear()
   virtual WriteBatchEntryIndexContext* NewContext(Arena*) const;
   virtual WriteBatchEntryIndex* New(WriteBatchEntryIndexContext* ctx,
                                     WriteBatchKeyExtractor e,
@@ -22,6 +22,7 @@
 #include "util/testharness.h"
 #include "utilities/merge_operators.h"
 #include "utilities/merge_operators/string_append/stringappend.h"
+#include "utilities/write_batch_with_index/write_batch_with_index_internal.h"
 
 namespace TERARKDB_NAMESPACE {
 
@@ -1868,6 +1869,37 @@ TEST_F(WriteBatchWithIndexTest, SingleDeleteDeltaIterTest) {
   }
 }
 
+TEST_F(WriteBatchWithIndexTest, PatriciaIndexReuseAfterClear) {
+  auto index_type = GetWriteBatchEntryIndexFactory("patricia");
+  ASSERT_TRUE(index_type != nullptr);
+  ASSERT_STREQ("patricia", index_type->Name());
+
+  Status s;
+  std::string value;
+  DBOptions db_options;
+  WriteBatchWithIndex batch(BytewiseComparator(), 0, true /* overwrite_key */,
+                            0, index_type);
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 10000; ++i) {
+      char key[32];
+      snprintf(key, sizeof(key), "long/common/prefix/%08d", i);
+      batch.Put(key, ToString(i + round));
+    }
+    s = batch.GetFromBatch(db_options, "long/common/prefix/00001234", &value);
+    ASSERT_OK(s);
+    ASSERT_EQ(ToString(1234 + round), value);
+    std::unique_ptr<WBWIIterator> iter(batch.NewIterator());
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ++count;
+    }
+    ASSERT_EQ(10000, count);
+    batch.Clear();
+    s = batch.GetFromBatch(db_options, "long/common/prefix/00001234", &value);
+    ASSERT_TRUE(s.IsNotFound());
+  }
+}
+
 }  // namespace TERARKDB_NAMESPACE
 
 int main(int argc, char** argv) {